@@ -1,7 +1,47 @@
 #include "Background.h"
 
+#include <algorithm>  // For std::min
+#include <cstdlib>    // For calloc
+#include <cstring>    // For memcpy and memset
+
 namespace tsgl {
 
+static const GLchar* screenVertexShader =
+  "#version 330 core\n"
+  "layout (location = 0) in vec3 aPos;"
+  "layout (location = 1) in vec2 aTexCoord;"
+  "out vec2 TexCoords;"
+  "void main() {"
+  "gl_Position = vec4(aPos.xy, 0.0, 1.0);"
+  "TexCoords = aTexCoord;"
+  "}";
+
+// A quad covering the whole framebuffer, in clip coordinates, with texture coordinates
+static const GLfloat screenQuad[30] = {
+     1.0f,  1.0f, 0.0f,   1.0f, 1.0f,
+     1.0f, -1.0f, 0.0f,   1.0f, 0.0f,
+    -1.0f, -1.0f, 0.0f,   0.0f, 0.0f,
+     1.0f,  1.0f, 0.0f,   1.0f, 1.0f,
+    -1.0f, -1.0f, 0.0f,   0.0f, 0.0f,
+    -1.0f,  1.0f, 0.0f,   0.0f, 1.0f
+};
+
+// Declarations available to a post effect's source, which follows this
+static const char* postEffectPreamble =
+  "#version 330 core\n"
+  "in vec2 TexCoords;\n"
+  "out vec4 FragColor;\n"
+  "uniform sampler2D image;\n"
+  "uniform sampler2D original;\n"
+  "uniform vec2 resolution;\n"
+  "uniform vec2 texel;\n"
+  "#line 1\n";
+
+static const char* postEffectMain =
+  "\nvoid main() {\n"
+  "FragColor = effect(TexCoords);\n"
+  "}\n";
+
  /*!
   * \brief Explicitly constructs a new Background.
   * \details Explicit constructor for a Background object.
@@ -23,11 +63,9 @@ Background::Background(GLint width, GLint height, const ColorFloat &clearColor)
     toClear = false;
     complete = false;
     newPixelsDrawn = true;
+    postFBO[0] = postFBO[1] = postTexture[0] = postTexture[1] = 0;
 
-    pixelTextureBuffer = new uint8_t[myWidth * myHeight * 4];
-    for (int i = 0; i < myWidth * myHeight * 4; ++i) {
-        pixelTextureBuffer[i] = 0;
-    }
+    pixelTextureBuffer = (uint8_t*) calloc(myWidth * myHeight * 4, 1);   // Zeroed by the system as pages are touched
     pixelBufferMutex.unlock();
 
     myWorldZ = 4000;
@@ -53,10 +91,7 @@ void Background::init(Shader * shapeS, Shader * textS, Shader * textureS, Camera
     glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     readPixelMutex.lock();
-    readPixelBuffer = new uint8_t[myWidth * myHeight * 3];
-    for (int i = 0; i < myWidth * myHeight * 3; ++i) {
-      readPixelBuffer[i] = 0;
-    }
+    readPixelBuffer = (uint8_t*) calloc(myWidth * myHeight * 3, 1);
     readPixelMutex.unlock();
     // configure MSAA framebuffer
     // --------------------------
@@ -146,6 +181,8 @@ void Background::draw() {
 
     glViewport(0,0,myWidth,myHeight);
 
+    drawUnderlay();
+
     drawableMutex.lock();
     for (unsigned int i = 0; i < myDrawables->size(); i++)
     {
@@ -192,9 +229,7 @@ void Background::draw() {
         glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 5, vertices, GL_DYNAMIC_DRAW);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        for (int i = 0; i < myWidth * myHeight * 4; ++i) {
-            pixelTextureBuffer[i] = 0;
-        }
+        memset(pixelTextureBuffer, 0, myWidth * myHeight * 4);
         newPixelsDrawn = false;
     }
     pixelBufferMutex.unlock();
@@ -219,6 +254,9 @@ void Background::draw() {
     // glPixelStorei(GL_PACK_ALIGNMENT, 4);
     readPixelMutex.unlock();
 
+    // effects change only what is shown, not what getPixel() reads or what the next frame draws over
+    glBindTexture(GL_TEXTURE_2D, applyPostEffects());
+
     // render non-MSAA framebuffer's texture to default framebuffer
     glPixelStorei(GL_UNPACK_ALIGNMENT,4);
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
@@ -231,6 +269,113 @@ void Background::draw() {
     glEnable(GL_DEPTH_TEST);
 }
 
+/*! \brief Draws anything that should lie beneath this frame's Drawables and pixels.
+ *  \details Called by draw() with the multisampled framebuffer bound, after any pending clear. Does nothing by
+ *    default; subclasses that generate their contents every frame override it.
+ */
+void Background::drawUnderlay() { }
+
+/*! \brief Runs the post effects over this frame's image.
+ *  \details Called by draw() with the default framebuffer bound. Each effect draws the previous effect's output
+ *    (the frame itself, for the first) into one of two textures, alternating between them. Leaves the default
+ *    framebuffer bound and the texture shader in use.
+ *  \return The texture holding the last effect's output, or the frame itself if there are no effects.
+ */
+GLuint Background::applyPostEffects() {
+    postEffectMutex.lock();
+    for (unsigned i = 0; i < retiredShaders.size(); ++i) {
+        glDeleteProgram(retiredShaders[i]->ID);
+        delete retiredShaders[i];
+    }
+    retiredShaders.clear();
+    if (myPostEffects.empty()) {
+        postEffectMutex.unlock();
+        return intermediateTexture;
+    }
+
+    if (!postFBO[0]) {
+        glGenFramebuffers(2, postFBO);
+        glGenTextures(2, postTexture);
+        for (int i = 0; i < 2; ++i) {
+            glBindFramebuffer(GL_FRAMEBUFFER, postFBO[i]);
+            glBindTexture(GL_TEXTURE_2D, postTexture[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, myWidth, myHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, postTexture[i], 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                TsglErr("FRAMEBUFFER CREATION FAILED");
+        }
+    }
+
+    glViewport(0, 0, myWidth, myHeight);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+    glActiveTexture(GL_TEXTURE0);
+    GLuint input = intermediateTexture;
+    int target = 0;
+    for (unsigned i = 0; i < myPostEffects.size(); ++i) {
+        PostEffectPass& pass = myPostEffects[i];
+        if (!pass.shader && !pass.failed) {
+            pass.shader = createScreenShader(postEffectPreamble + pass.source + postEffectMain);
+            pass.failed = !pass.shader;
+            if (pass.failed)
+                TsglErr("Post effect " + to_string(i) + " failed to compile, and will be skipped.");
+        }
+        if (!pass.shader)
+            continue;
+        glBindFramebuffer(GL_FRAMEBUFFER, postFBO[target]);
+        pass.shader->use();
+        pass.shader->setInt("image", 0);
+        pass.shader->setInt("original", 1);
+        pass.shader->setVec2("resolution", myWidth, myHeight);
+        pass.shader->setVec2("texel", 1.0f / myWidth, 1.0f / myHeight);
+        for (std::map<std::string, float>::iterator it = pass.uniforms.begin(); it != pass.uniforms.end(); ++it)
+            pass.shader->setFloat(it->first, it->second);
+        glBindTexture(GL_TEXTURE_2D, input);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        drawScreenQuad();
+        input = postTexture[target];
+        target = 1 - target;
+    }
+    postEffectMutex.unlock();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+    textureShader->use();
+    return input;
+}
+
+/*! \brief Compiles a fragment shader to run over the whole framebuffer with drawScreenQuad().
+ *  \details Must be called on the rendering thread. Compile errors are printed as usual.
+ *  \param fragmentSource The complete source of the fragment shader. It receives the texture coordinates
+ *    (0,0 at the bottom left to 1,1 at the top right) as <code>in vec2 TexCoords</code>.
+ *  \return A new Shader, or 0 if the source failed to compile.
+ */
+Shader * Background::createScreenShader(const std::string& fragmentSource) {
+    Shader * shader = new Shader(screenVertexShader, fragmentSource.c_str());
+    GLint linked = 0;
+    glGetProgramiv(shader->ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(shader->ID);
+        delete shader;
+        return 0;
+    }
+    return shader;
+}
+
+/*! \brief Draws a quad covering the whole viewport with the Shader in use.
+ */
+void Background::drawScreenQuad() {
+    glBufferData(GL_ARRAY_BUFFER, sizeof(screenQuad), screenQuad, GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
 /*! \brief Activates the corresponding Shader for a given Drawable.
  *  \param sType Unsigned int with a corresponding value for each type of Shader.
  */
@@ -638,6 +783,45 @@ void Background::drawPixel(float x, float y, ColorInt c) {
     pixelBufferMutex.unlock();
 }
 
+/*!
+ * \brief Draws a whole block of pixels to the Background at once.
+ * \details Copies a <code>w</code> x <code>h</code> block of RGBA8 pixels into the pixel buffer while holding its lock
+ *   only once, which is far cheaper than calling drawPixel() for every pixel of a large region.
+ * \details Rows are read top to bottom: row 0 of <code>rgba</code> lands at Background row <code>y</code>, row 1 at
+ *   <code>y - 1</code>, and so on. Parts of the block that fall outside the Background are clipped.
+ *   \param x The x coordinate of the block's left column.
+ *   \param y The y coordinate of the block's top row.
+ *   \param w Width of the block in pixels.
+ *   \param h Height of the block in pixels.
+ *   \param rgba Pointer to the first byte of the top-left pixel, 4 bytes per pixel.
+ *   \param stride Number of bytes between the starts of consecutive rows (0 means tightly packed, <code>4 * w</code>).
+ * \note Unlike drawPixel(), the block replaces whatever was drawn to the same pixels this frame instead of
+ *   alpha blending with it. Pixels with an alpha of 0 are left untouched on the Background.
+ */
+void Background::drawPixels(int x, int y, int w, int h, const uint8_t* rgba, int stride) {
+    if (w <= 0 || h <= 0 || !rgba) {
+        TsglDebug("Cannot draw a block of pixels with non-positive width or height.");
+        return;
+    }
+    if (stride <= 0) stride = 4 * w;
+    int left = x + myWidth / 2;
+    int top = y + myHeight / 2;
+    int skipX = (left < 0) ? -left : 0;
+    int copyW = std::min(w, myWidth - left) - skipX;
+    if (copyW <= 0) return;
+
+    pixelBufferMutex.lock();
+    for (int row = 0; row < h; ++row) {
+        int intY = top - row;
+        if (intY < 0) break;
+        if (intY >= myHeight) continue;
+        memcpy(pixelTextureBuffer + (intY * myWidth + left + skipX) * 4,
+               rgba + row * stride + skipX * 4, copyW * 4);
+    }
+    newPixelsDrawn = true;
+    pixelBufferMutex.unlock();
+}
+
 /*!\brief Procedurally draws a Polyline to the Background.
  * \details Initializes a new Polyline based on the parameter values, and then adds it to the Array of Drawables to be rendered.
  * \param x The x coordinate of the Polyline's center location.
@@ -990,15 +1174,78 @@ ColorInt Background::getPixel(float x, float y) {
         TsglErr("Accessor x and y must be within Canvas parameters.");
         return ColorInt(0,0,0,0);
     }
-    readPixelMutex.lock();
+    readPixelMutex.lock_shared();
     int intX = (int) x + myWidth/2;
     int intY = (int) y + myHeight/2;
     int off = 3 * (intY * myWidth + intX);
     ColorInt c = ColorInt(readPixelBuffer[off], readPixelBuffer[off + 1], readPixelBuffer[off + 2], 255);
-    readPixelMutex.unlock();
+    readPixelMutex.unlock_shared();
     return c;
 }
 
+/*!
+ * \brief Copies a block of the Background's last rendered frame into a buffer.
+ * \details Takes the readback lock once for the whole block, instead of once per pixel as getPixel() does.
+ * \details The block is laid out like the one passed to drawPixels(): row 0 of <code>dst</code> is Background
+ *   row <code>y</code>, row 1 is <code>y - 1</code>, and so on, so a block read with getPixels() can be changed
+ *   and drawn back with drawPixels() using the same arguments. Parts of the block that fall outside the
+ *   Background are filled with zeros.
+ *   \param x The x coordinate of the block's left column.
+ *   \param y The y coordinate of the block's top row.
+ *   \param w Width of the block in pixels.
+ *   \param h Height of the block in pixels.
+ *   \param dst Pointer to the first byte of the top-left pixel of the buffer to fill.
+ *   \param stride Number of bytes between the starts of consecutive rows of <code>dst</code> (0 means tightly
+ *     packed, 3 or 4 times <code>w</code> depending on <code>format</code>).
+ *   \param format The layout of the pixels in <code>dst</code> (set to RGBA_PIXELS by default).
+ */
+void Background::getPixels(int x, int y, int w, int h, uint8_t* dst, int stride, PixelFormat format) {
+    if (w <= 0 || h <= 0 || !dst) {
+        TsglDebug("Cannot read a block of pixels with non-positive width or height.");
+        return;
+    }
+    const int bytes = (format == RGB_PIXELS) ? 3 : 4;
+    if (stride <= 0) stride = bytes * w;
+    const int left = x + myWidth / 2;
+    const int top = y + myHeight / 2;
+    const int first = std::max(left, 0), last = std::min(left + w, (int) myWidth);
+
+    readPixelMutex.lock_shared();
+    for (int row = 0; row < h; ++row) {
+        uint8_t* out = dst + (size_t) row * stride;
+        const int intY = top - row;
+        if (intY < 0 || intY >= myHeight || first >= last) {
+            memset(out, 0, (size_t) bytes * w);
+            continue;
+        }
+        memset(out, 0, (size_t) bytes * (first - left));
+        memset(out + (size_t) bytes * (last - left), 0, (size_t) bytes * (left + w - last));
+        const uint8_t* in = readPixelBuffer + ((size_t) intY * myWidth + first) * 3;
+        out += (size_t) bytes * (first - left);
+        if (format == RGB_PIXELS) {
+            memcpy(out, in, (size_t) 3 * (last - first));
+        } else {
+            for (int i = 0; i < last - first; ++i) {
+                out[4 * i] = in[3 * i];
+                out[4 * i + 1] = in[3 * i + 1];
+                out[4 * i + 2] = in[3 * i + 2];
+                out[4 * i + 3] = 255;
+            }
+        }
+    }
+    readPixelMutex.unlock_shared();
+}
+
+/*!
+ * \brief Locks the Background's last rendered frame for reading in place.
+ * \details Unlike getPixels(), nothing is copied: the returned PixelReadLock points straight at the buffer the
+ *   Background reads each frame back into, and keeps it from changing until the PixelReadLock is destroyed.
+ * \return A PixelReadLock for the whole frame.
+ */
+Background::PixelReadLock Background::lockPixels() {
+    return PixelReadLock(readPixelMutex, readPixelBuffer, myWidth, myHeight);
+}
+
 /*! \brief Mutator for the color used to clear the Background when clear() is called.
  *  \details Sets the clear color to the parameter ColorFloat.
  *  \param c ColorFloat assigned to the clear color of the Background.
@@ -1010,19 +1257,98 @@ void Background::setClearColor(ColorFloat c) {
     attribMutex.unlock();
 }
 
+/*!
+ * \brief Adds a full-screen shader pass to the end of the Background's post effect chain.
+ * \details Post effects run on the graphics card every frame, after the Background has been drawn and before it
+ *   is shown. Each one reads the output of the one before it, so effects can be stacked (a blur followed by
+ *   a greyscale, or two blurs for a wider one). They change only what is shown: getPixel() and the Background
+ *   itself keep the unprocessed image, and Drawables added to the Canvas are drawn on top of the result.
+ * \details The source must define the function <code>vec4 effect(vec2 uv)</code>, which returns the color of
+ *   the pixel at texture coordinates <code>uv</code> (0,0 at the bottom left to 1,1 at the top right). It may
+ *   read these uniforms:
+ *   - <code>sampler2D image</code>: the output of the previous effect.
+ *   - <code>sampler2D original</code>: the frame before any effects.
+ *   - <code>vec2 resolution</code>: the width and height of the Background in pixels.
+ *   - <code>vec2 texel</code>: the size of one pixel in texture coordinates.
+ *   .
+ *   and any <code>float</code> uniforms it declares itself, which are set with setPostEffectUniform().
+ *   PostEffects holds the sources of some common effects.
+ * \details The source is compiled the next time the Background is drawn. If it fails to compile, the errors
+ *   are printed and the effect is skipped.
+ * \param fragmentSource GLSL source defining <code>vec4 effect(vec2 uv)</code>.
+ * \return The position of the new effect in the chain, for setPostEffectUniform().
+ */
+unsigned Background::addPostEffect(const std::string& fragmentSource) {
+    PostEffectPass pass;
+    pass.source = fragmentSource;
+    pass.shader = 0;
+    pass.failed = false;
+    postEffectMutex.lock();
+    myPostEffects.push_back(pass);
+    unsigned index = myPostEffects.size() - 1;
+    postEffectMutex.unlock();
+    return index;
+}
+
+/*!
+ * \brief Mutator for a <code>float</code> uniform declared in a post effect's source.
+ * \param index The position of the effect in the chain, as returned by addPostEffect().
+ * \param name The name of the uniform.
+ * \param value The uniform's new value.
+ */
+void Background::setPostEffectUniform(unsigned index, const std::string& name, float value) {
+    postEffectMutex.lock();
+    if (index < myPostEffects.size())
+        myPostEffects[index].uniforms[name] = value;
+    else
+        TsglDebug("There is no post effect at index " + to_string(index) + ".");
+    postEffectMutex.unlock();
+}
+
+/*!
+ * \brief Removes every post effect, so the Background is shown as it is drawn.
+ */
+void Background::clearPostEffects() {
+    postEffectMutex.lock();
+    for (unsigned i = 0; i < myPostEffects.size(); ++i)
+        if (myPostEffects[i].shader)
+            retiredShaders.push_back(myPostEffects[i].shader);
+    myPostEffects.clear();
+    postEffectMutex.unlock();
+}
+
+/*!
+ * \brief Accessor for the number of effects in the post effect chain.
+ */
+unsigned Background::getPostEffectCount() {
+    postEffectMutex.lock();
+    unsigned count = myPostEffects.size();
+    postEffectMutex.unlock();
+    return count;
+}
+
 /*!
 * \brief Destructor for the Background.
 */
 Background::~Background() {
     myDrawables->clear();
-    delete [] readPixelBuffer;
-    delete [] pixelTextureBuffer;
+    free(readPixelBuffer);
+    free(pixelTextureBuffer);
     delete [] vertices;
     delete myDrawables;
     glDeleteTextures(1, &intermediateTexture);
     glDeleteFramebuffers(1, &intermediateFBO);
     glDeleteTextures(1, &multisampledTexture);
     glDeleteFramebuffers(1, &multisampledFBO);
+    clearPostEffects();
+    for (unsigned i = 0; i < retiredShaders.size(); ++i) {
+        glDeleteProgram(retiredShaders[i]->ID);
+        delete retiredShaders[i];
+    }
+    if (postFBO[0]) {
+        glDeleteTextures(2, postTexture);
+        glDeleteFramebuffers(2, postFBO);
+    }
 }
 
 }
\ No newline at end of file
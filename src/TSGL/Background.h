@@ -5,6 +5,10 @@
 #ifndef BACKGROUND_H_
 #define BACKGROUND_H_
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "Camera.h"
 
 #include "Array.h"          // Our own array for buffering drawing operations
@@ -16,6 +20,7 @@
 #include "Image.h"
 #include "Line.h"
 #include "Polyline.h"
+#include "ProfiledMutex.h"  // Our own mutexes that record contention
 #include "Rectangle.h"
 #include "RegularPolygon.h"
 #include "Square.h"
@@ -27,11 +32,85 @@
 
 namespace tsgl {
 
+/*!
+ * \brief The layout of the pixels copied by Background::getPixels().
+ * \details RGB_PIXELS is 3 bytes per pixel (R, G, B), the layout the Background reads back from the graphics
+ *   card, so it copies whole rows at memcpy speed. RGBA_PIXELS is 4 bytes per pixel with an alpha of 255,
+ *   the layout Background::drawPixels() takes.
+ */
+enum PixelFormat {
+    RGB_PIXELS, RGBA_PIXELS
+};
+
 /*! \class Background
  *  \brief Draw a Background for the Canvas with colored pixels.
  *  \details Background is a class for holding colored pixel data.
  */
 class Background {
+public:
+    /*! \class PixelReadLock
+     *  \brief Read access to the Background's last rendered frame without copying it.
+     *  \details A PixelReadLock holds a shared lock on the Background's readback buffer for as long as it exists,
+     *    so the frame it shows cannot change under it. Any number of threads may hold one at once. The buffer is
+     *    3 bytes per pixel (R, G, B), and its rows start at the bottom of the Background.
+     *  \details A PixelReadLock keeps when its hold began itself, so it may be moved to and destroyed on another
+     *    thread than the one that made it.
+     *  \warning The Canvas cannot finish drawing a frame while a PixelReadLock exists. Keep it only as long as it
+     *    takes to read what you need.
+     */
+    class PixelReadLock {
+     private:
+        ProfiledSharedMutex* myMutex;
+        uint64_t myAcquired;            // What lockSharedTimed() returned
+        const uint8_t* myData;
+        int myWidth, myHeight;
+
+        PixelReadLock(const PixelReadLock&);
+        PixelReadLock& operator=(const PixelReadLock&);
+     public:
+        PixelReadLock(ProfiledSharedMutex& mutex, const uint8_t* data, int width, int height)
+          : myMutex(&mutex), myAcquired(mutex.lockSharedTimed()), myData(data), myWidth(width),
+            myHeight(height) {}
+
+        PixelReadLock(PixelReadLock&& other)
+          : myMutex(other.myMutex), myAcquired(other.myAcquired), myData(other.myData), myWidth(other.myWidth),
+            myHeight(other.myHeight) {
+            other.myMutex = NULL;
+        }
+
+        ~PixelReadLock() { if (myMutex) myMutex->unlockSharedTimed(myAcquired); }
+
+        /*!
+         * \brief Accessor for the first byte of the bottom-left pixel.
+         */
+        const uint8_t* data() const { return myData; }
+
+        /*!
+         * \brief Accessor for the number of bytes in the buffer.
+         */
+        size_t size() const { return (size_t) myWidth * myHeight * 3; }
+
+        /*!
+         * \brief Accessor for the first byte of a row.
+         * \param y The row's y coordinate, in the same centered coordinates as Background::getPixel().
+         */
+        const uint8_t* row(int y) const { return myData + (size_t) (y + myHeight / 2) * myWidth * 3; }
+
+        /*!
+         * \brief Accessor for the number of bytes from the start of one row to the start of the next.
+         */
+        int stride() const { return myWidth * 3; }
+
+        /*!
+         * \brief Accessor for the width of the frame in pixels.
+         */
+        int width() const { return myWidth; }
+
+        /*!
+         * \brief Accessor for the height of the frame in pixels.
+         */
+        int height() const { return myHeight; }
+    };
 protected:
     GLint myWidth, myHeight;
     GLint framebufferWidth, framebufferHeight;
@@ -52,21 +131,40 @@ protected:
     ColorFloat baseColor;
     bool toClear;
 
-    std::mutex readPixelMutex;
+    ProfiledSharedMutex readPixelMutex{"Background::readPixelMutex"};
     uint8_t* readPixelBuffer;
 
-    std::mutex pixelBufferMutex;
+    ProfiledMutex pixelBufferMutex{"Background::pixelBufferMutex"};
     GLuint pixelTexture;
     uint8_t* pixelTextureBuffer;
     bool newPixelsDrawn;
 
     bool complete;
-    std::mutex attribMutex;
-    std::mutex drawableMutex;
+    ProfiledMutex attribMutex{"Background::attribMutex"};
+    ProfiledMutex drawableMutex{"Background::drawableMutex"};
   
     GLfloat * vertices;
 
+    struct PostEffectPass {
+        std::string source;
+        Shader * shader;
+        bool failed;
+        std::map<std::string, float> uniforms;
+    };
+    std::mutex postEffectMutex;
+    std::vector<PostEffectPass> myPostEffects;
+    std::vector<Shader*> retiredShaders;    // Removed effects, deleted on the rendering thread
+    GLuint postFBO[2], postTexture[2];
+
     virtual void selectShaders(unsigned int sType);
+
+    virtual void drawUnderlay();
+
+    GLuint applyPostEffects();
+
+    static Shader * createScreenShader(const std::string& fragmentSource);
+
+    void drawScreenQuad();
 public:
     Background(GLint width, GLint height, const ColorFloat &c = WHITE);
 
@@ -110,6 +208,8 @@ public:
 
     virtual void drawPixel(float x, float y, ColorInt c);
 
+    virtual void drawPixels(int x, int y, int w, int h, const uint8_t* rgba, int stride = 0);
+
     virtual void drawPolyline(float x, float y, float z, int numVertices, float lineVertices[], float yaw, float pitch, float roll, ColorFloat color);
 
     virtual void drawPolyline(float x, float y, float z, int numVertices, float lineVertices[], float yaw, float pitch, float roll, ColorFloat color[]);
@@ -156,6 +256,10 @@ public:
 
     virtual ColorInt getPixel(float x, float y);
 
+    virtual void getPixels(int x, int y, int w, int h, uint8_t* dst, int stride = 0, PixelFormat format = RGBA_PIXELS);
+
+    PixelReadLock lockPixels();
+
     /*!
     * \brief Accessor for color which is used to clear the Background when clear() is called.
     * \details Returns a ColorInt corresponding to the clear color of the Background.
@@ -164,6 +268,14 @@ public:
 
     virtual void setClearColor(ColorFloat c);
 
+    unsigned addPostEffect(const std::string& fragmentSource);
+
+    void setPostEffectUniform(unsigned index, const std::string& name, float value);
+
+    void clearPostEffects();
+
+    unsigned getPostEffectCount();
+
     virtual ~Background();
 };
 
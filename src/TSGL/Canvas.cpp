@@ -86,11 +86,15 @@ static const GLchar* textureFragmentShader =
 	"FragColor = texture(texture1, TexCoords) * vec4(1.0,1.0,1.0,alpha);"
   "}";
 
+bool Canvas::glewIsReady = false;
 bool Canvas::glfwIsReady = false;
 std::mutex Canvas::glfwMutex;
 GLFWvidmode const* Canvas::monInfo;
 unsigned Canvas::openCanvases = 0;
 
+// Number of updates the calling thread has open, on any Canvas
+static thread_local int updateDepth = 0;
+
  /*!
   * \brief Default Canvas constructor method.
   * \details This is the default constructor for the Canvas class.
@@ -126,19 +130,105 @@ Canvas::Canvas(int x, int y, int width, int height, std::string title, ColorFloa
   * \details Frees up memory that was allocated to a Canvas instance.
   */
 Canvas::~Canvas() {
+    stopDispatch();
     // Free our pointer memory
     delete drawTimer;
     delete camera;
-    delete [] screenBuffer;
+    free(screenBuffer);
     if (defaultBackground) {
       delete myBackground;
     }
     if (--openCanvases == 0) {
+        RenderService::shutdown();  // Free the shared resources, if any
         glfwIsReady = false;
         glfwTerminate();  // Terminate GLFW
     }
 }
 
+ /*!
+  * \brief Waits for open updates to be committed, then holds off new ones until endFrame().
+  * \details Called by the rendering thread before it reads the Drawables for a frame. Threads that call
+  *   beginUpdate() while this waits are held off too, so that a steady stream of overlapping updates cannot keep
+  *   the Canvas from ever drawing; only a thread that already has an update open may begin another.
+  *   pauseDrawing() is not held off, as it never was.
+  */
+void Canvas::beginFrame() {
+    std::unique_lock<std::mutex> lock(updateMutex);
+    frameWaiting = true;
+    updatesCommitted.wait(lock, [this]() { return openUpdates == 0; });
+    frameWaiting = false;
+    frameDrawing = true;
+}
+
+ /*!
+  * \brief Begins a frame like beginFrame() if no updates are open, without waiting for them if there are.
+  * \details Used by the RenderService, which draws other Canvases in the meantime. Even when it fails, new updates
+  *   are held off as beginFrame() would, so that the Canvas gets its frame once the open ones are committed.
+  * \return Whether the frame was begun.
+  */
+bool Canvas::tryBeginFrame() {
+    std::lock_guard<std::mutex> lock(updateMutex);
+    frameWaiting = (openUpdates > 0);
+    frameDrawing = !frameWaiting;
+    return frameDrawing;
+}
+
+ /*!
+  * \brief Begins a batch of changes to the Drawables on the Canvas.
+  * \details Waits until the Canvas is done reading the Drawables for the frame it is drawing, if any, and then
+  *   keeps it from starting another until the returned Update is committed. Use it to make several changes
+  *   appear at once:
+  * \code
+  *   Canvas::Update update = can.beginUpdate();
+  *   rect->setColor(RED);
+  *   label->setText("Done");
+  *   update.commit();
+  * \endcode
+  * \details Any number of threads may have an Update open at once; the Canvas draws as soon as the last of
+  *   them is committed, without polling. Updates work with std::thread, OpenMP, or any other threads.
+  * \note A thread may begin an Update while it has another open, but it should not wait on another thread
+  *   that is trying to begin one: the Canvas holds off new Updates while it waits for the open ones.
+  * \return An open Update, which commits itself when destroyed if commit() is not called first.
+  * \see Canvas::Update
+  */
+Canvas::Update Canvas::beginUpdate() {
+    return Update(this);
+}
+
+ /*!
+  * \brief Opens an Update on a Canvas.
+  *   \param can The Canvas to update.
+  */
+Canvas::Update::Update(Canvas * can) : myCanvas(can) {
+    myCanvas->enterUpdate(true);
+}
+
+ /*!
+  * \brief Takes over another Update, which is left committed.
+  *   \param other The Update to take over.
+  */
+Canvas::Update::Update(Update&& other) : myCanvas(other.myCanvas) {
+    other.myCanvas = NULL;
+}
+
+ /*!
+  * \brief Commits the Update, letting the Canvas draw the changes made since it was begun.
+  * \details Does nothing if the Update has already been committed.
+  */
+void Canvas::Update::commit() {
+    if (myCanvas) {
+        myCanvas->exitUpdate();
+        myCanvas = NULL;
+    }
+}
+
+ /*!
+  * \brief Destroys the Update, committing it if it is still open.
+  */
+Canvas::Update::~Update() {
+    commit();
+}
+
  /*!
   * \brief Binds a key or button to a function.
   * \details This function binds a key or mouse button to a function pointer.
@@ -163,11 +253,34 @@ void Canvas::bindToScroll(std::function<void(double, double)> function) {
     scrollFunction = function;
 }
 
+ /*!
+  * \brief Binds mouse movement to a function.
+  * \details Upon moving the mouse over the Canvas, Canvas will call the specified function with the mouse's new
+  *   position, as getMouseX() and getMouseY() would give it.
+  * \details Unless turned off with setCoalesceMouseMoves(), moves that arrive while the function is still
+  *   handling an earlier one are merged, so the function is called once with the latest position.
+  *   \param function A function taking x and y parameters to be called when the mouse moves.
+  */
+void Canvas::bindToMouseMove(std::function<void(double, double)> function) {
+    mouseMoveFunction = function;
+}
+
+ /*!
+  * \brief Binds every input event to a function.
+  * \details The function is called with each keyboard, mouse button, scroll and mouse move event before the
+  *   function bound to it, if any. Each event carries the time it happened, which is when the operating
+  *   system reported it rather than when the handlers got to run.
+  *   \param function A function taking an InputEvent.
+  */
+void Canvas::bindToEvents(std::function<void(const InputEvent&)> function) {
+    eventFunction = function;
+}
+
 void Canvas::buttonCallback(GLFWwindow* window, int button, int action, int mods) {
     if (action == GLFW_REPEAT) return;
     Canvas* can = reinterpret_cast<Canvas*>(glfwGetWindowUserPointer(window));
-    int index = button + action * (GLFW_KEY_LAST + 1);
-    if (&(can->boundKeys[index]) != nullptr) if (can->boundKeys[index]) can->boundKeys[index]();
+    InputEvent event = { BUTTON_EVENT, button, action, mods, can->mouseX, can->mouseY, glfwGetTime() };
+    can->queueEvent(event);
 }
 
  /*!
@@ -180,6 +293,22 @@ void Canvas::clearBackground() {
   backgroundMutex.unlock();
 }
 
+ /*!
+  * \brief Publishes every frame drawn into a ring in shared memory, for other processes to read.
+  * \details Other processes on the same host attach with a FrameReader under the same name, and read the
+  *   frames where they lie, without copying them. The Canvas never waits for them.
+  * \details Each frame is read back into a pixel buffer and published one frame later, once the GPU has
+  *   finished with it, so the rendering thread does not stall on the read.
+  *   \param name The name readers attach with. It may not contain a '/'.
+  *   \param slots The number of frames the ring holds.
+  * \return Whether the ring was created. Any ring the Canvas was already exporting to is closed.
+  * \see stopExport(), FrameExport
+  */
+bool Canvas::exportFrames(const std::string& name, unsigned slots) {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    return frameExport.open(name, framebufferWidth, framebufferHeight, slots);
+}
+
  /*!
   * \brief Closes the Canvas window.
   * \details This function tells the Canvas to stop rendering and to close its rendering window.
@@ -237,8 +366,54 @@ void Canvas::clearObjectBuffer(bool shouldFreeMemory) {
   objectBuffer.clear();
 }
 
-void Canvas::draw()
-{
+void Canvas::cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
+    Canvas* can = reinterpret_cast<Canvas*>(glfwGetWindowUserPointer(window));
+    can->mouseX = xpos;
+    can->mouseY = ypos;
+    if (can->coalesceMouseMoves && can->mouseMovePending.exchange(true))
+        return;                                      // The move already queued will report the new position
+    InputEvent event = { MOUSE_MOVE_EVENT, 0, 0, 0, xpos, ypos, glfwGetTime() };
+    can->queueEvent(event);
+}
+
+ /*!
+  * \brief Runs the handlers bound to an input event.
+  *   \param event The event, which is brought up to date first if it is a coalesced mouse move.
+  */
+void Canvas::dispatchEvent(InputEvent& event) {
+    if (event.type == MOUSE_MOVE_EVENT && coalesceMouseMoves) {
+        mouseMovePending = false;                    // Later moves queue a new event from here on
+        event.x = mouseX;
+        event.y = mouseY;
+    }
+    if (eventFunction)
+        eventFunction(event);
+    if (event.type == BUTTON_EVENT) {
+        const int index = event.button + event.action * (GLFW_KEY_LAST + 1);
+        if (boundKeys[index]) boundKeys[index]();
+    } else if (event.type == SCROLL_EVENT) {
+        if (scrollFunction) scrollFunction(event.x, event.y);
+    } else if (mouseMoveFunction) {
+        mouseMoveFunction(getMouseX(), getMouseY());
+    }
+}
+
+ /*!
+  * \brief Runs the handlers for queued input events as they arrive, until the Canvas stops.
+  */
+void Canvas::dispatchLoop() {
+    InputEvent event;
+    for (;;) {
+        while (inputQueue.pop(event))
+            dispatchEvent(event);
+        std::unique_lock<std::mutex> lock(dispatchMutex);
+        dispatchWake.wait(lock, [this]() { return dispatchStopping || !inputQueue.empty(); });
+        if (dispatchStopping && inputQueue.empty())
+            return;
+    }
+}
+
+void Canvas::beginDrawing() {
     windowMutex.lock();
     glfwMakeContextCurrent(window);
     // Reset the window
@@ -246,100 +421,149 @@ void Canvas::draw()
     glfwMakeContextCurrent(NULL);
     windowMutex.unlock();
 
+    frameCounter = 0;
+    swapInterval = -1;
+}
+
+void Canvas::draw()
+{
+    beginDrawing();
+    while (!glfwWindowShouldClose(window))
+        drawFrame(true);
+    endDrawing();
+}
+
+bool Canvas::drawFrame(bool pollEvents)
+{
+    // The RenderService must not wait on one Canvas while the others go undrawn, so it comes back later instead
+    if (sharedRendering && !tryBeginFrame())
+      return false;
+
+    // this if, and the capturescreen variable, are necessary for screenshots to be 100% correct.
     bool captureScreen = false;
+    if (toRecord > 0) {
+      captureScreen = true;
+      --toRecord;
+    }
+    if (!sharedRendering) {
+      drawTimer->sleep(true);
+      beginFrame();
+    }
 
-    for (frameCounter = 0; !glfwWindowShouldClose(window); frameCounter++)
-    {
-        // this if, and the capturescreen variable, are necessary for screenshots to be 100% correct.
-        if (toRecord > 0) {
-          captureScreen = true;
-          --toRecord;
-        }
-        drawTimer->sleep(true);
+  #ifdef __APPLE__
+    windowMutex.lock();
+  #endif
+    glfwMakeContextCurrent(window);
 
-        syncMutex.lock();
+    // Only wait for the vertical refresh when pacing by it; otherwise the Timer alone decides.
+    // A shared rendering thread never waits for it, or every window would be held to the slowest.
+    const int wantedInterval = (drawTimer->getPacing() == PACE_VSYNC && !drawTimer->isVirtual() && !sharedRendering) ? 1 : 0;
+    if (wantedInterval != swapInterval) {
+      glfwSwapInterval(wantedInterval);
+      swapInterval = wantedInterval;
+    }
 
-      #ifdef __APPLE__
-        windowMutex.lock();
-      #endif
-        glfwMakeContextCurrent(window);
+    const FrameStats stats = drawTimer->getFrameStats();
+    if (stats.frames > 0)
+      realFPS = 1 / stats.mean;
+    if (showFPS && stats.frames > 0 && frameCounter % FPS == 0) {
+      std::cout << realFPS << "/" << FPS << " fps, frame time " << stats.mean * 1000 << " +/- " << stats.stddev * 1000
+                << " ms, max " << stats.max * 1000 << " ms, " << stats.missed << " of " << stats.frames << " missed" << std::endl;
+    }
 
-        realFPS = round(1 / drawTimer->getTimeBetweenSleeps());
-        if (showFPS) std::cout << realFPS << "/" << FPS << std::endl;
-        std::cout.flush();
+    // clear default framebuffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // clear default framebuffer
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // if background initialized draw it using its multisampled framebuffer
+    backgroundMutex.lock();
+    if (myBackground)
+      if (myBackground->isInitialized()) {
+        myBackground->draw();
+      }
+    backgroundMutex.unlock();
 
-        // if background initialized draw it using its multisampled framebuffer
-        backgroundMutex.lock();
-        if (myBackground)
-          if (myBackground->isInitialized()) {
-            myBackground->draw();
-          }
-        backgroundMutex.unlock();
-
-        // Scale to window size
-        glViewport(0, 0, framebufferWidth, framebufferHeight);
-        // winWidth = windowWidth;
-        // winHeight = windowHeight;
-
-        objectMutex.lock();
-        if (objectBuffer.size() > 0) {
-          // sort between opaques and transparents and then sort by center z. depth buffer takes care of the rest. not perfect, but good.
-          std::stable_sort(objectBuffer.begin(), objectBuffer.end(), [this](Drawable * a, Drawable * b)->bool {
-            if (a->getAlpha() == 1.0 && b->getAlpha() != 1.0)
-              return true;
-            else if (a->getAlpha() != 1.0 && b->getAlpha() == 1.0)
-              return false;
-            else
-              return (distanceBetween(a->getCenterX(), a->getCenterY(), a->getCenterZ(), camera->getPositionX(), camera->getPositionY(), camera->getPositionZ())
-                    > distanceBetween(b->getCenterX(), b->getCenterY(), b->getCenterZ(), camera->getPositionX(), camera->getPositionY(), camera->getPositionZ()));
-          });
-          for (unsigned int i = 0; i < objectBuffer.size(); i++) {
-            Drawable* d = objectBuffer[i];
-            if(d->isProcessed()) {
-              selectShaders(d->getShaderType());
-              if (d->getShaderType() == SHAPE_SHADER_TYPE) {
-                d->draw(shapeShader);
-              } else if (d->getShaderType() == TEXTURE_SHADER_TYPE) {
-                d->draw(textureShader);
-              } else if (d->getShaderType() == TEXT_SHADER_TYPE) {
-                d->draw(textShader);
-              }
-            }
+    // Scale to window size
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+    // winWidth = windowWidth;
+    // winHeight = windowHeight;
+
+    objectMutex.lock();
+    if (objectBuffer.size() > 0) {
+      // sort between opaques and transparents and then sort by center z. depth buffer takes care of the rest. not perfect, but good.
+      std::stable_sort(objectBuffer.begin(), objectBuffer.end(), [this](Drawable * a, Drawable * b)->bool {
+        if (a->getAlpha() == 1.0 && b->getAlpha() != 1.0)
+          return true;
+        else if (a->getAlpha() != 1.0 && b->getAlpha() == 1.0)
+          return false;
+        else
+          return (distanceBetween(a->getCenterX(), a->getCenterY(), a->getCenterZ(), camera->getPositionX(), camera->getPositionY(), camera->getPositionZ())
+                > distanceBetween(b->getCenterX(), b->getCenterY(), b->getCenterZ(), camera->getPositionX(), camera->getPositionY(), camera->getPositionZ()));
+      });
+      for (unsigned int i = 0; i < objectBuffer.size(); i++) {
+        Drawable* d = objectBuffer[i];
+        if(d->isProcessed()) {
+          selectShaders(d->getShaderType());
+          if (d->getShaderType() == SHAPE_SHADER_TYPE) {
+            d->draw(shapeShader);
+          } else if (d->getShaderType() == TEXTURE_SHADER_TYPE) {
+            d->draw(textureShader);
+          } else if (d->getShaderType() == TEXT_SHADER_TYPE) {
+            d->draw(textShader);
           }
         }
-        objectMutex.unlock();
-
-        if (captureScreen) {
-          // Update our screenBuffer copy with the default framebuffer
-          screenBufferMutex.lock();
-          glViewport(0,0,framebufferWidth,framebufferHeight);
-          glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-          glPixelStorei(GL_PACK_ALIGNMENT, 1);
-          glReadPixels(0, 0, framebufferWidth, framebufferHeight, GL_RGB, GL_UNSIGNED_BYTE, screenBuffer);
-          screenBufferMutex.unlock();
-          screenShot();
-          captureScreen = false;
-        }
-
-        // Update Screen
-        glfwSwapBuffers(window);
+      }
+    }
+    objectMutex.unlock();
+
+    if (captureScreen) {
+      // Update our screenBuffer copy with the default framebuffer
+      screenBufferMutex.lock();
+      glViewport(0,0,framebufferWidth,framebufferHeight);
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glReadPixels(0, 0, framebufferWidth, framebufferHeight, GL_RGB, GL_UNSIGNED_BYTE, screenBuffer);
+      screenBufferMutex.unlock();
+      screenShot();
+    }
+    exportFrame();
+    endFrame();                                  // The Drawables may change while the frame is shown
+    if (sharedRendering)
+      drawTimer->tick();                         // The RenderService draws the Canvas again once tick() says it is due
 
-      #ifndef __APPLE__
-        glfwPollEvents();                            // Handle any I/O
-      #endif
-        glfwGetCursorPos(window, &mouseX, &mouseY);
-        glfwMakeContextCurrent(NULL);                // We're drawing to window as soon as it's created
-      #ifdef __APPLE__
-        windowMutex.unlock();
-      #endif
+    // Update Screen
+    glfwSwapBuffers(window);
 
-        syncMutex.unlock();
+  #ifndef __APPLE__
+    if (pollEvents)
+      glfwPollEvents();                          // Handle any I/O
+  #endif
+    glfwMakeContextCurrent(NULL);                // We're drawing to window as soon as it's created
+  #ifdef __APPLE__
+    windowMutex.unlock();
+  #endif
 
-        if (toClose) glfwSetWindowShouldClose(window, GL_TRUE);
+    if (toClose) glfwSetWindowShouldClose(window, GL_TRUE);
+    if (frameCounter == 0) {
+      startupTimes.firstFrame = duration_d(highResClock::now() - constructed).count();
+      if (showFPS)
+        std::cout << "Started in " << startupTimes.firstFrame * 1000 << " ms: window " << startupTimes.window * 1000
+                  << " ms, shaders " << startupTimes.shaders * 1000 << " ms (" << startupTimes.compiledShaders
+                  << " compiled), background " << startupTimes.background * 1000 << " ms" << std::endl;
     }
+    ++frameCounter;
+    return true;
+}
+
+void Canvas::endDrawing() {
+    drawTimer->release();                            // No more frames for threads sleeping on virtual time
+    updateMutex.lock();
+    frameWaiting = false;                            // Nor updates held off by a frame tryBeginFrame() skipped
+    updateMutex.unlock();
+    frameDrawn.notify_all();
+    dispatchMutex.lock();
+    dispatchStopping = true;                         // No more events, either
+    dispatchMutex.unlock();
+    dispatchWake.notify_all();
 }
 
 //  /*!
@@ -358,10 +582,98 @@ void Canvas::draw()
 //     drawText(ws, x, y, size, color, fontFileName, rotation);
 // }
 
+ /*!
+  * \brief Lets updates begin again once the rendering thread is done reading the Drawables.
+  */
+void Canvas::endFrame() {
+    updateMutex.lock();
+    frameDrawing = false;
+    updateMutex.unlock();
+    frameDrawn.notify_all();
+}
+
+ /*!
+  * \brief Opens an update on the Canvas for the calling thread.
+  * \details Waits while the rendering thread is reading the Drawables. With <code>holdOff</code>, also waits
+  *   while it is waiting to, unless the calling thread already has an update open.
+  *   \param holdOff Whether to wait behind a rendering thread that is waiting for the open updates. Updates from
+  *     beginUpdate() do; pauseDrawing() does not, since older code pauses from threads that then wait on each
+  *     other, as at an OpenMP barrier.
+  */
+void Canvas::enterUpdate(bool holdOff) {
+    std::unique_lock<std::mutex> lock(updateMutex);
+    if (holdOff && updateDepth == 0)
+        frameDrawn.wait(lock, [this]() { return !frameDrawing && !frameWaiting; });
+    else
+        frameDrawn.wait(lock, [this]() { return !frameDrawing; });
+    ++openUpdates;
+    ++updateDepth;
+}
+
 void Canvas::errorCallback(int error, const char* string) {
     fprintf(stderr, "%i: %s\n", error, string);
 }
 
+ /*!
+  * \brief Reads the frame just drawn back into a pixel buffer, and publishes the frame before it.
+  * \details Called by the rendering thread with the Canvas' context current. Creates the pixel buffers when
+  *   an export starts, and deletes them once it stops.
+  */
+void Canvas::exportFrame() {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    if (!frameExport.isOpen()) {
+      if (exportBuffers[0]) {
+        glDeleteBuffers(2, exportBuffers);
+        exportBuffers[0] = exportBuffers[1] = 0;
+      }
+      return;
+    }
+    const GLsizeiptr bytes = 4 * framebufferWidth * framebufferHeight;
+    if (!exportBuffers[0]) {
+      glGenBuffers(2, exportBuffers);
+      for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, exportBuffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+      }
+      exportReads = 0;
+    }
+
+    // Start reading this frame back into one buffer...
+    const int current = exportReads % 2;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, exportBuffers[current]);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, framebufferWidth, framebufferHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    exportTimes[current] = drawTimer->getTime();
+
+    // ...and publish the last one, which the GPU has had a whole frame to finish
+    if (exportReads > 0) {
+      const int previous = 1 - current;
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, exportBuffers[previous]);
+      const void * pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+      if (pixels) {
+        memcpy(frameExport.beginFrame(), pixels, bytes);
+        frameExport.endFrame(exportTimes[previous]);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      }
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ++exportReads;
+}
+
+ /*!
+  * \brief Commits an update on the Canvas for the calling thread.
+  * \details Wakes the rendering thread if this was the last open update.
+  */
+void Canvas::exitUpdate() {
+    updateMutex.lock();
+    --updateDepth;
+    const bool last = (--openUpdates == 0);
+    updateMutex.unlock();
+    if (last)
+        updatesCommitted.notify_one();
+}
+
  /*!
   * \brief Accessor for the current background.
   * \return The Background that the Canvas draws when draw() is called.
@@ -396,6 +708,15 @@ int Canvas::getDisplayWidth() {
   return monInfo->width;
 }
 
+ /*!
+  * \brief Accessor for the number of input events lost because the queue was full.
+  * \details The queue holds InputQueue::CAPACITY events, so events are only lost when handlers fall that far
+  *   behind, or when nothing calls pollEvents() with DISPATCH_POLL.
+  */
+unsigned Canvas::getDroppedEvents() {
+    return droppedEvents;
+}
+
  /*!
   * \brief Accessor for the current frame number.
   * \return The number of actual draw cycles / frames the Canvas has rendered so far.
@@ -407,12 +728,24 @@ int Canvas::getFrameNumber() {
 
  /*!
   * \brief Accessor for the current FPS.
-  * \return The average number of frames being rendered per second.
+  * \return The average number of frames being rendered per second, over the last two seconds or so.
+  * \see getFrameStats()
   */
 float Canvas::getFPS() {
     return realFPS;
 }
 
+ /*!
+  * \brief Accessor for statistics of the time between recent frames.
+  * \details Use these rather than getFPS() to judge how smoothly the Canvas is drawing: a steady frame rate
+  *   has a small standard deviation and no missed frames, even if the average is on target either way.
+  * \return Statistics of the time between the last 120 or so frames, in seconds.
+  * \see Timer::getFrameStats()
+  */
+FrameStats Canvas::getFrameStats() {
+    return drawTimer->getFrameStats();
+}
+
  /*!
   * \brief Accessor for the mouse's x-position.
   * \return The x coordinates of the mouse on the Canvas.
@@ -452,9 +785,21 @@ uint8_t* Canvas::getScreenBuffer() {
     return screenBuffer;
 }
 
+ /*!
+  * \brief Accessor for how long opening the Canvas took.
+  * \details The times are also printed after the first frame if setShowFPS(true) was called before start().
+  *   Time spent on the shaders drops to almost nothing once the ShaderCache holds them, or when the Canvas
+  *   shares them through the RenderService.
+  * \return The StartupTimes of the Canvas.
+  */
+StartupTimes Canvas::getStartupTimes() {
+    return startupTimes;
+}
+
  /*!
   * \brief Accessor for the time since the Canvas was initialized.
-  * \return The elapsed time in microseconds since the Canvas has started drawing.
+  * \return The elapsed time in microseconds since the Canvas has started drawing. On virtual time, this moves on
+  *   by exactly one period per frame (see setVirtualTime()).
   */
 double Canvas::getTime() {
     return drawTimer->getTime();
@@ -502,11 +847,15 @@ int Canvas::getWindowY() {
 
 void Canvas::glDestroy() {
     // Free up our resources
-    delete textShader;
-    delete shapeShader;
-    delete textureShader;
+    if (!sharedRendering) {               // The RenderService frees shared shaders with the last Canvas
+      delete textShader;
+      delete shapeShader;
+      delete textureShader;
+    }
     glDeleteBuffers(1, &VBO);
     glDeleteVertexArrays(1, &VAO);
+    if (exportBuffers[0])
+      glDeleteBuffers(2, exportBuffers);
 }
 
  /*!
@@ -537,6 +886,13 @@ void Canvas::handleIO() {
 }
 
 void Canvas::init(int xx, int yy, int ww, int hh, std::string title, ColorFloat backgroundColor, Background * background, double timerLength) {
+    constructed = highResClock::now();
+    startupTimes.window = startupTimes.shaders = startupTimes.background = startupTimes.firstFrame = 0;
+    startupTimes.compiledShaders = 0;
+    // Read any cached shader binaries while the window is being created
+    ShaderCache::prefetch(textVertexShader, textFragmentShader);
+    ShaderCache::prefetch(shapeVertexShader, shapeFragmentShader);
+    ShaderCache::prefetch(textureVertexShader, textureFragmentShader);
     ++openCanvases;
 
     if (ww == -1)
@@ -551,8 +907,18 @@ void Canvas::init(int xx, int yy, int ww, int hh, std::string title, ColorFloat
     toClose = false;
     windowClosed = false;
     frameCounter = 0;
-    syncMutexLocked = 0;
-	  syncMutexOwner = -1;
+    exportBuffers[0] = exportBuffers[1] = 0;
+    exportReads = 0;
+    swapInterval = -1;
+    sharedRendering = RenderService::isEnabled();
+    openUpdates = 0;
+    frameDrawing = frameWaiting = false;
+    inputDispatch = DISPATCH_THREAD;
+    dispatchStopping = false;
+    coalesceMouseMoves = true;
+    mouseMovePending = false;
+    droppedEvents = 0;
+    mouseX = mouseY = 0;
 
     started = false;                  // We haven't started the window yet
     monitorX = xx;
@@ -610,15 +976,32 @@ void Canvas::initGl() {
     glfwMakeContextCurrent(NULL);   // Reset the context
 }
 
+unsigned Canvas::createShaders(Shader*& text, Shader*& shape, Shader*& texture) {
+    bool compiled[3];
+    text = ShaderCache::load(textVertexShader, textFragmentShader, &compiled[0]);
+
+    shape = ShaderCache::load(shapeVertexShader, shapeFragmentShader, &compiled[1]);
+
+    texture = ShaderCache::load(textureVertexShader, textureFragmentShader, &compiled[2]);
+
+    return compiled[0] + compiled[1] + compiled[2];
+}
+
 void Canvas::initGlew() {
-    // Enable Experimental GLEW to Render Properly
-    glewExperimental = GL_TRUE;
-    GLenum err = glewInit();
-    if (GLEW_OK != err) {
-        // Problem: glewInit failed, something is seriously wrong.
-        fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
-        exit(102);
+    // GLEW's entry points are the same for every context, so it is only initialized for the first Canvas
+    glfwMutex.lock();
+    if (!glewIsReady) {
+      // Enable Experimental GLEW to Render Properly
+      glewExperimental = GL_TRUE;
+      GLenum err = glewInit();
+      if (GLEW_OK != err) {
+          // Problem: glewInit failed, something is seriously wrong.
+          fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
+          exit(102);
+      }
+      glewIsReady = true;
     }
+    glfwMutex.unlock();
 
     const GLubyte* gfxVendor = glGetString(GL_VENDOR);
     std::string gfx(gfxVendor, gfxVendor + strlen((char*)gfxVendor));
@@ -642,11 +1025,12 @@ void Canvas::initGlew() {
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-    textShader = new Shader(textVertexShader, textFragmentShader);
-
-    shapeShader = new Shader(shapeVertexShader, shapeFragmentShader);
-
-    textureShader = new Shader(textureVertexShader, textureFragmentShader);
+    const timepoint_d shadersStart = highResClock::now();
+    if (sharedRendering)
+      startupTimes.compiledShaders = RenderService::shaders(textShader, shapeShader, textureShader);
+    else
+      startupTimes.compiledShaders = createShaders(textShader, shapeShader, textureShader);
+    startupTimes.shaders = duration_d(highResClock::now() - shadersStart).count();
 
     // char buf[PATH_MAX]; /* PATH_MAX incudes the \0 so +1 is not required */
     // char *res = realpath(".", buf);
@@ -667,6 +1051,7 @@ void Canvas::initGlfw() {
 }
 
 void Canvas::initBackground(Background * background, ColorFloat bgcolor) {
+    const timepoint_d backgroundStart = highResClock::now();
     backgroundMutex.lock();
     if (!background) {
       myBackground = new Background(winWidth, winHeight, bgcolor);
@@ -676,6 +1061,7 @@ void Canvas::initBackground(Background * background, ColorFloat bgcolor) {
     }
     myBackground->init(shapeShader, textShader, textureShader, camera, window);
     backgroundMutex.unlock();
+    startupTimes.background = duration_d(highResClock::now() - backgroundStart).count();
 }
 
 void Canvas::initWindow() {
@@ -699,7 +1085,8 @@ void Canvas::initWindow() {
     glfwWindowHint(GLFW_SAMPLES,4);
 
     glfwMutex.lock();                                  // GLFW crashes if you try to make more than one window at once
-    window = glfwCreateWindow(winWidth, winHeight, winTitle.c_str(), NULL, NULL);  // Windowed
+    GLFWwindow* share = sharedRendering ? RenderService::shareWindow() : NULL;
+    window = glfwCreateWindow(winWidth, winHeight, winTitle.c_str(), NULL, share);  // Windowed
  //   window = glfwCreateWindow(monInfo->width, monInfo->height, title_.c_str(), glfwGetPrimaryMonitor(), NULL);  // Fullscreen
     if (!window) {
         fprintf(stderr, "GLFW window creation failed. Was the library correctly initialized?\n");
@@ -724,6 +1111,8 @@ void Canvas::initWindow() {
     glfwSetMouseButtonCallback(window, buttonCallback);
     glfwSetKeyCallback(window, keyCallback);
     glfwSetScrollCallback(window, scrollCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwGetCursorPos(window, &mouseX, &mouseY);
 
     // Scale to window size
     GLint windowWidth, windowHeight;
@@ -735,12 +1124,12 @@ void Canvas::initWindow() {
     glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     screenBufferMutex.lock();
-    screenBuffer = new uint8_t[3 * (framebufferWidth) * framebufferHeight];
-    for (int i = 0; i < 3 * (framebufferWidth) * framebufferHeight; ++i) {
-      screenBuffer[i] = 0;
-    }
+    // calloc gets pages the system zeroes on first touch, so a Canvas that never captures never pays for them
+    screenBuffer = (uint8_t*) calloc(3 * framebufferWidth * framebufferHeight, 1);
     screenBufferMutex.unlock();
 
+    startupTimes.window = duration_d(highResClock::now() - constructed).count();
+
     // Get info of GPU and supported OpenGL version
     // printf("Renderer: %s\n", glGetString(GL_RENDERER));
     // printf("OpenGL version supported %s\n", glGetString(GL_VERSION));
@@ -758,28 +1147,80 @@ void Canvas::keyCallback(GLFWwindow* window, int key, int scancode, int action,
     buttonCallback(window, key, action, mods);
 }
 
+ /*!
+  * \brief Stops the Canvas from waiting for the calling thread on virtual time.
+  * \details On virtual time, every thread that has called sleep() is waited for before each frame, until it
+  *   exits. Call this from a thread that will not call sleep() again but does not exit, such as a thread of an
+  *   OpenMP team at the end of a parallel region, since OpenMP keeps its threads for the next region:
+  * \code
+  *   #pragma omp parallel
+  *   {
+  *     while (can.isOpen() && !done) {
+  *       can.sleep();
+  *       step(omp_get_thread_num());
+  *     }
+  *     can.leaveVirtualTime();
+  *   }
+  * \endcode
+  *   It returns at once, and does nothing if the Canvas is not on virtual time or the thread never slept on it.
+  *   If the thread calls sleep() again, it is waited for again from then on.
+  * \see setVirtualTime()
+  */
+void Canvas::leaveVirtualTime() {
+    drawTimer->leave();
+}
+
  /*!
   * \brief Pauses the rendering thread of the Canvas
   * \details This function forces the calling thread to wait until the Canvas finishes its draw cycle,
   *   them prevents the Canvas from rendering further updates until resumeDrawing is called.
+  * \details Like opening an Update with beginUpdate() and committing it with resumeDrawing(), except that it
+  *   does not wait while the Canvas is waiting for open updates. Threads that pause the Canvas may therefore
+  *   wait on each other, at a barrier for example, before they resume it.
   * \note This method may be called from any number of threads, so long as a matching number of calls
-  *   to resumeDrawing() are made.
-  * \warning <b>This function makes use of a mutex lock. Do not call this without later calling
-  *   resumeDrawing().</b>
-  * \see resumeDrawing()
+  *   to resumeDrawing() are made from the same threads.
+  * \warning <b>Do not call this without later calling resumeDrawing().</b>
+  * \see resumeDrawing(), beginUpdate()
   */
 void Canvas::pauseDrawing() {
-  #pragma omp critical (pauseResume)
-  {
-  if (syncMutexLocked == 0 && syncMutexOwner == -1) {
-    syncMutex.lock();
-    syncMutexOwner = omp_get_thread_num();
-  }
-  #pragma omp critical (syncMutLock)
-  {
-    ++syncMutexLocked;
-  }
-  }
+    enterUpdate(false);
+}
+
+ /*!
+  * \brief Runs the handlers for the input events that have arrived since the last call.
+  * \details With setInputDispatch(DISPATCH_POLL), input handlers run only when this is called, on the calling
+  *   thread, for example once per step of a simulation. With the default DISPATCH_THREAD this does nothing,
+  *   since events are handled as they arrive.
+  * \return The number of events handled.
+  */
+unsigned Canvas::pollEvents() {
+    if (inputDispatch != DISPATCH_POLL)
+        return 0;
+    unsigned handled = 0;
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        dispatchEvent(event);
+        ++handled;
+    }
+    return handled;
+}
+
+ /*!
+  * \brief Queues an input event, and wakes the dispatch thread for it.
+  * \details Called from the GLFW callbacks, on the thread polling for events. Never waits for a handler.
+  */
+void Canvas::queueEvent(const InputEvent& event) {
+    if (!inputQueue.push(event)) {
+        ++droppedEvents;
+        if (event.type == MOUSE_MOVE_EVENT)
+            mouseMovePending = false;
+        return;
+    }
+    if (inputDispatch == DISPATCH_THREAD) {
+        dispatchMutex.lock();                        // So the wakeup cannot slip in before the dispatcher waits
+        dispatchMutex.unlock();
+        dispatchWake.notify_one();
+    }
 }
 
  /*!
@@ -809,29 +1250,14 @@ void Canvas::reset() {
  /*!
   * \brief Resumes the rendering thread of the Canvas
   * \details This function should be called after pauseDrawing to let the Canvas' rendering thread
-  *   know that it may resume rendering.
+  *   know that it may resume rendering. The Canvas draws as soon as every thread that paused it has resumed.
   * \note This method may be called from any number of threads, so long as a matching number of calls
   *   to pauseDrawing() are made.
-  * \warning <b>This function makes use of a mutex lock. Do not call this without having
-  *   first called pauseDrawing().</b>
+  * \warning <b>Do not call this without having first called pauseDrawing() from the same thread.</b>
   * \see pauseDrawing()
   */
 void Canvas::resumeDrawing() {
-  #pragma omp critical (syncMutLock)
-  {
-    --syncMutexLocked;
-  }
-  #pragma omp critical (pauseResume)
-  {
-    if (syncMutexOwner == omp_get_thread_num()) {
-      while (syncMutexLocked > 0)
-        sleepFor(FRAME/2);
-      syncMutex.unlock();
-      syncMutexOwner = -1;
-    }
-  }
-  while (syncMutexOwner != -1)
-    sleepFor(FRAME/2);
+    exitUpdate();
 }
 
  /*!
@@ -970,7 +1396,8 @@ void Canvas::screenShot() {
 
 void Canvas::scrollCallback(GLFWwindow* window, double xpos, double ypos) {
     Canvas* can = reinterpret_cast<Canvas*>(glfwGetWindowUserPointer(window));
-    if (can->scrollFunction) can->scrollFunction(xpos, ypos);
+    InputEvent event = { SCROLL_EVENT, 0, 0, 0, xpos, ypos, glfwGetTime() };
+    can->queueEvent(event);
 }
 
  /*!
@@ -1011,6 +1438,84 @@ void Canvas::setBackgroundColor(ColorFloat color) {
     windowMutex.unlock();
 }
 
+ /*!
+  * \brief Mutates whether mouse moves are coalesced.
+  * \details When coalesced (the default), at most one mouse move waits in the queue at a time: moves that arrive
+  *   before it is handled update it instead of queueing more events, so a slow handler sees the latest
+  *   position instead of working through a backlog.
+  *   \param coalesce Whether to coalesce mouse moves.
+  */
+void Canvas::setCoalesceMouseMoves(bool coalesce) {
+    coalesceMouseMoves = coalesce;
+}
+
+ /*!
+  * \brief Mutates which thread runs the handlers bound to keys, buttons, scrolling and mouse moves.
+  * \details Input arrives on the rendering thread (on the main thread on OS X), which only timestamps each event
+  *   and queues it, so that slow handlers never hold up drawing.
+  *   - DISPATCH_THREAD (the default) runs the handlers on a thread of the Canvas' own as soon as events arrive.
+  *   - DISPATCH_POLL leaves the events queued until a thread calls pollEvents().
+  *   .
+  *   \param mode The new InputDispatch.
+  * \warning With DISPATCH_POLL, nothing is handled unless pollEvents() is called, including the escape key
+  *   closing the window.
+  */
+void Canvas::setInputDispatch(InputDispatch mode) {
+    if (mode == inputDispatch)
+        return;
+    if (std::this_thread::get_id() == dispatchThread.get_id()) {
+        TsglDebug("Cannot change the input dispatch from an input handler.");
+        return;
+    }
+    if (mode == DISPATCH_POLL) {
+        stopDispatch();
+        inputDispatch = mode;
+    } else {
+        inputDispatch = mode;
+        if (started && !isFinished)
+            startDispatch();
+    }
+}
+
+ /*!
+  * \brief Mutates how the Canvas paces its frames.
+  * \details
+  * - PACE_TIMER, the default, draws a frame every period of the Canvas' timer. The rendering thread sleeps
+  *   until just before each frame is due and spins for the rest, so frames start within microseconds of
+  *   their deadlines. The display's vertical refresh is not waited for.
+  * - PACE_VSYNC draws a frame every vertical refresh of the display, which rules out tearing. Threads calling
+  *   sleep() are still woken once per timer period.
+  * - PACE_UNCAPPED draws frames as fast as it can, for benchmarking; sleep() returns at once.
+  * .
+  *   \param mode The new PacingMode.
+  * \note A Canvas drawn by the RenderService paces PACE_VSYNC like PACE_TIMER.
+  * \see getFrameStats()
+  */
+void Canvas::setPacing(PacingMode mode) {
+    drawTimer->setPacing((sharedRendering && mode == PACE_VSYNC) ? PACE_TIMER : mode);
+}
+
+ /*!
+  * \brief Puts the Canvas on or off virtual time.
+  * \details On virtual time, sleep() does not really sleep, and every frame moves getTime() and getReps() on by
+  *   exactly one period of the Canvas' timer. Before drawing each frame, the Canvas waits for every thread
+  *   that sleeps on it to finish its step and call sleep() again; then it draws, and wakes them for the next
+  *   step. A simulation therefore produces the same frames however slow or fast each step is, and, with
+  *   recordForNumFrames(), renders an animation to disk as fast as the machine can go:
+  * \code
+  *   can.setVirtualTime(true);
+  *   can.recordForNumFrames(600);   // Ten seconds of animation at 60 frames per second
+  * \endcode
+  * \note A thread that has called sleep() and will not call it again should return, or call leaveVirtualTime()
+  *   or wait(), so that the Canvas stops waiting for it. Threads of an OpenMP team do not return at the end of a
+  *   parallel region, so they must call leaveVirtualTime() before it ends.
+  *   \param on Whether to use virtual time.
+  * \see Timer::setVirtual()
+  */
+void Canvas::setVirtualTime(bool on) {
+    drawTimer->setVirtual(on);
+}
+
  /*!
   * \brief Mutator for showing the FPS.
   *   \param b Whether to print the FPS to stdout every draw cycle (for debugging purposes).
@@ -1022,6 +1527,7 @@ void Canvas::setShowFPS(bool b) {
  /*!
   * \brief Sleeps the calling thread to sync with the Canvas.
   * \details Tells the calling thread to sleep until the Canvas' drawTimer expires.
+  * \details On virtual time, tells the calling thread to wait for the next frame instead (see setVirtualTime()).
   * \note It is recommened that you call sleep() at least once before doing any drawing;
   *   otherwise, the Canvas may not render the first frame of drawing.
   * \note <b>OS X:</b> This function automatically calls handleIO() on OS X.
@@ -1055,14 +1561,35 @@ void Canvas::sleepFor(float seconds) {
 int Canvas::start() {
     if (started) return -1;
     started = true;
+    startDispatch();
   #ifdef __APPLE__
     pthread_create(&renderThread,NULL,startDrawing,(void*)this);
   #else
-    renderThread = std::thread(Canvas::startDrawing, this);  // Spawn the rendering thread
+    if (sharedRendering)
+      RenderService::add(this);                              // Drawn in turn with the other Canvases
+    else
+      renderThread = std::thread(Canvas::startDrawing, this);  // Spawn the rendering thread
   #endif
     return 0;
 }
 
+void Canvas::startDispatch() {
+    if (inputDispatch != DISPATCH_THREAD || dispatchThread.joinable())
+        return;
+    dispatchStopping = false;
+    dispatchThread = std::thread(&Canvas::dispatchLoop, this);
+}
+
+void Canvas::stopDispatch() {
+    if (!dispatchThread.joinable())
+        return;
+    dispatchMutex.lock();
+    dispatchStopping = true;
+    dispatchMutex.unlock();
+    dispatchWake.notify_all();
+    dispatchThread.join();
+}
+
 #ifdef __APPLE__
 void* Canvas::startDrawing(void* cPtr) {
     Canvas* c = (Canvas*)cPtr;
@@ -1079,6 +1606,15 @@ void Canvas::startDrawing(Canvas *c) {
 }
 #endif
 
+void Canvas::finishDrawing() {
+    endDrawing();
+    glfwMakeContextCurrent(window);       // The vertex array and buffer belong to this window's context
+    glDestroy();
+    glfwMakeContextCurrent(NULL);
+    isFinished = true;
+    glfwDestroyWindow(window);
+}
+
  /*!
   * \brief Begins the process of closing the Canvas.
   * \details This function calls close() followed by wait() to gracefully close the Canvas
@@ -1090,6 +1626,16 @@ void Canvas::stop() {
     wait();
 }
 
+ /*!
+  * \brief Stops publishing frames to shared memory, and removes the ring's name.
+  * \details Readers still attached may finish reading the frames they have.
+  * \see exportFrames()
+  */
+void Canvas::stopExport() {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    frameExport.close();
+}
+
  /*!
   * \brief Stops recording the Canvas.
   * \details This function tells the Canvas to stop dumping images to the file system.
@@ -1172,13 +1718,18 @@ void Canvas::selectShaders(unsigned int sType) {
   */
 int Canvas::wait() {
   if (!started) return -1;  // If we haven't even started yet, return error code -1
+  drawTimer->leave();       // Don't hold up virtual time while waiting
   #ifdef __APPLE__
     while(!isFinished)
       sleepFor(0.1f);
     pthread_join(renderThread, NULL);
   #else
-    renderThread.join();
+    if (sharedRendering)
+      RenderService::wait(this);
+    else
+      renderThread.join();
   #endif
+    stopDispatch();
 
   return 0;
 }
@@ -22,24 +22,34 @@
 #include "TriangleStrip.h" // Our own class for drawing polygons with colored vertices
 #include "Ellipse.h"        // Our own class for drawing ellipses
 #include "Ellipsoid.h"      // Our own class for drawing ellipsoids
+#include "FrameExport.h"    // Our own ring of frames in shared memory
 #include "Circle.h" 	    // Our own class for drawing circles
 #include "ConcavePolygon.h" // Our own class for concave polygons with colored vertices
 #include "ConvexPolygon.h"  // Our own class for convex polygons with colored vertices
 #include "Image.h"          // Our own class for drawing images / textured quads
+#include "InputQueue.h"     // Our own queue for keyboard and mouse events
 #include "Keynums.h"        // Our enums for key presses
 #include "Line.h"           // Our own class for drawing straight lines
+#include "LockHeatmap.h"    // Our own class for drawing how contended locks are
 #include "Polyline.h"       // Our own class for drawing polylines
 #include "ProgressBar.h"    // Our own class for drawing progress bars
 #include "Pyramid.h"        // Our own class for drawing pyramids
 #include "Rectangle.h"      // Our own class for drawing rectangles
 #include "RegularPolygon.h" // Our own class for drawing regular polygons
+#include "RenderService.h"  // Our own thread for drawing several Canvases with shared resources
+#include "ShaderCache.h"    // Our own cache of linked shader programs on disk
+#include "ScalarField.h"    // Our own class for drawing colormapped grids of values
 #include "Sphere.h"         // Our own class for drawing spheres
 #include "Square.h"         // Our own class for drawing squares
 #include "Star.h"           // Our own class for drawing stars
+#include "StreamingPlot.h"  // Our own class for plotting live streams of samples
 #include "Text.h"           // Our own class for drawing text
+#include "TiledImage.h"     // Our own class for drawing images from tile pyramids
+#include "TimelineView.h"   // Our own class for drawing Gantt charts of threads' spans
 #include "Timer.h"          // Our own timer for steady FPS
 #include "Triangle.h"       // Our own class for drawing triangles
 #include "Util.h"           // Needed constants and has cmath for performing math operations
+#include "VideoSurface.h"   // Our own class for playing videos
 
 #include "Camera.h"
 #include "Shader.h"
@@ -51,18 +61,19 @@
 #include <fstream>
 #include <sys/stat.h>
 
+#include <condition_variable> // For the frame barrier between updates and the rendering thread
 #include <functional>       // For callback upon key presses
 #include <iostream>         // DEBUGGING
 #include <mutex>            // Needed for locking the Canvas for thread-safety
 #include <sstream>          // For string building
 #include <string>           // For window titles
 #include <algorithm>
+#include <atomic>
 #include <omp.h>
 #ifdef __APPLE__
   #include <pthread.h>
-#else
-  #include <thread>           // For spawning rendering in a different thread
 #endif
+#include <thread>           // For spawning rendering and input dispatch in different threads
 
 #include "gl_includes.h"
 
@@ -74,6 +85,17 @@
 
 namespace tsgl {
 
+/*!
+ * \brief How long the steps of opening a Canvas took, in seconds. See Canvas::getStartupTimes().
+ */
+struct StartupTimes {
+    double window;              //!< From the start of the constructor until the window and its context were made
+    double shaders;             //!< Making the shaders, whether compiled, loaded from the ShaderCache or shared
+    double background;          //!< Setting up the Background and its framebuffers
+    double firstFrame;          //!< From the start of the constructor to the end of the first frame, or 0 until then
+    unsigned compiledShaders;   //!< Number of the Canvas' three shaders that had to be compiled from source
+};
+
 /*! \class Canvas
  *  \brief A GL window with numerous built-in, thread-safe drawing operations.
  *  \details Canvas provides an easy-to-set-up, easy-to-use class for drawing various shapes.
@@ -86,6 +108,7 @@ namespace tsgl {
  *  \bug <b>Linux:</b> X forwarding does not work properly with TSGL.
  */
 class Canvas {
+    friend class RenderService;
 protected:
     typedef GLFWvidmode const*                      displayInfo;
     typedef std::function<void(double, double)>     doubleFunction;
@@ -93,41 +116,64 @@ protected:
 
     // float           aspect;                                             // Aspect ratio used for setting up the window
     bool        atiCard;                                                // Whether the vendor of the graphics card is ATI
-    std::mutex      backgroundMutex;                                    // Mutex for myBackground
+    ProfiledMutex   backgroundMutex{"Canvas::backgroundMutex"};         // Mutex for myBackground
     voidFunction    boundKeys    [(GLFW_KEY_LAST+1)*2];                 // Array of function objects for key binding
     Camera*         camera;
+    bool            coalesceMouseMoves;                                 // Whether a mouse move still in the queue is updated rather than queued again
     bool            defaultBackground;                                  // Boolean indicating whether myBackground has been set by an external source
+    std::mutex      dispatchMutex;                                      // Mutex for waking the dispatch thread
+    bool            dispatchStopping;                                   // Whether the dispatch thread should stop once the queue is empty
+    std::thread     dispatchThread;                                     // Thread that runs the handlers for queued input events
+    std::condition_variable dispatchWake;                               // Signaled when an event is queued, or the dispatch thread should stop
     Timer*          drawTimer;                                          // Timer to regulate drawing frequency
+    std::atomic<unsigned> droppedEvents;                                // Number of input events lost to a full queue
+    std::function<void(const InputEvent&)> eventFunction;               // Function object called for every input event
+    GLuint          exportBuffers[2];                                   // Pixel buffers the exported frames are read back into, in turn
+    std::mutex      exportMutex;                                        // Mutex for frameExport and the export buffers
+    unsigned        exportReads;                                        // Number of frames read back for export
+    double          exportTimes[2];                                     // Time of the frame in each export buffer
+    FrameExport     frameExport;                                        // Ring of frames in shared memory, if exporting
     GLint           framebufferWidth;
     GLint           framebufferHeight;
     int             frameCounter;                                       // Counter for the number of frames that have elapsed in the current session (for animations)
+    InputDispatch   inputDispatch;                                      // Which thread runs the handlers for input events
+    InputQueue      inputQueue;                                         // Input events waiting to be dispatched
     bool            isFinished;                                         // If the rendering is done, which will signal the window to close
     bool            keyDown;
     std::string     capturePrefix = "Image";                                          // If a key is being pressed. Prevents an action from happening twice
     int             monitorX, monitorY;                                 // Monitor position for upper left corner
-    double          mouseX, mouseY;                                     // Location of the mouse once HandleIO() has been called
+    double          mouseX, mouseY;                                     // Location of the mouse as of its last move
+    doubleFunction  mouseMoveFunction;                                  // Single function object for mouse moves
+    std::atomic<bool> mouseMovePending;                                 // Whether a coalesced mouse move is in the queue
     Background *    myBackground;                                       // Pointer to the Background drawn each frame
     std::vector<Drawable*> objectBuffer;                                // Holds a list of pointers to objects drawn each frame
-    std::mutex	    objectMutex;
-    int             realFPS;                                            // Actual FPS of drawing
+    ProfiledMutex   objectMutex{"Canvas::objectMutex"};                 // Mutex for objectBuffer
+    float           realFPS;                                            // Actual FPS of drawing
   #ifdef __APPLE__
     pthread_t     renderThread;                                         // Thread dedicated to rendering the Canvas
   #else
     std::thread   renderThread;                                         // Thread dedicated to rendering the Canvas
   #endif
     uint8_t*        screenBuffer;                                       // Array that is a copy of the screen
-    std::mutex      screenBufferMutex;                                  // mutex for the screenbuffer
+    ProfiledMutex   screenBufferMutex{"Canvas::screenBufferMutex"};     // mutex for the screenbuffer
     doubleFunction  scrollFunction;                                     // Single function object for scrolling
     Shader *        textShader;                                         // Shader for Text class
     Shader *        shapeShader;                                        // Shader for Shape class
     Shader *        textureShader;                                      // Shader for Background and Image classes
+    bool            sharedRendering;                                    // Whether the RenderService draws the Canvas, with shared resources
     bool            showFPS;                                            // Flag to show DEBUGGING FPS
+    StartupTimes    startupTimes;                                       // How long opening the Canvas took
+    timepoint_d     constructed;                                        // When the constructor started
     bool            started;                                            // Whether our canvas is running and the frame counter is counting
-    std::mutex      syncMutex;                                          // Mutex for syncing the rendering thread with a computational thread
-    int             syncMutexLocked;                                    // Whether the syncMutex is currently locked
-	  int             syncMutexOwner;                                     // Thread ID of the owner of the syncMutex
+    int             swapInterval;                                       // Swap interval last set for the window's context, or -1
     bool            toClose;                                            // If the Canvas has been asked to close
     unsigned int    toRecord;                                           // To record the screen each frame
+    std::mutex      updateMutex;                                        // Mutex for the frame barrier between updates and the rendering thread
+    std::condition_variable updatesCommitted;                           // Signaled when the last open update is committed
+    std::condition_variable frameDrawn;                                 // Signaled when the rendering thread is done reading the Drawables
+    int             openUpdates;                                        // Number of updates begun and not yet committed
+    bool            frameDrawing;                                       // Whether the rendering thread is reading the Drawables
+    bool            frameWaiting;                                       // Whether the rendering thread is waiting for updates to be committed
     GLint           uniModel,                                           // Model perspective of the camera
                     uniView,                                            // View perspective of the camera
                     uniProj;                                            // Projection of the camera
@@ -140,6 +186,7 @@ protected:
     std::string     winTitle;                                           // Title of the window
     GLint           winWidth;                                           // Width of the Canvas' window
 
+    static bool         glewIsReady;                                    // Whether GLEW has been initialized
     static bool         glfwIsReady;                                    // Whether or not we have info about our monitor
     static std::mutex   glfwMutex;                                      // Keeps GLFW createWindow from getting called at the same time in multiple threads
     static displayInfo  monInfo;                                        // Info about our display
@@ -147,8 +194,23 @@ protected:
 
     static void  buttonCallback(GLFWwindow* window, int key,
                    int action, int mods);                               // GLFW callback for mouse buttons
+    void         beginDrawing();                                        // Readies the window for the first frame
+    void         beginFrame();                                          // Waits for open updates, then holds off new ones
+    static unsigned createShaders(Shader*& text, Shader*& shape,
+                   Shader*& texture);                                   // Makes the shaders in the current context
+    static void  cursorPosCallback(GLFWwindow* window, double xpos,
+                   double ypos);                                        // GLFW callback for mouse moves
+    void         dispatchEvent(InputEvent& event);                      // Runs the handlers for an input event
+    void         dispatchLoop();                                        // Body of the dispatch thread
+    void         endFrame();                                            // Lets updates begin again
     void         draw();                                                // Draw loop for the Canvas
+    bool         drawFrame(bool pollEvents);                            // Draws a single frame, unless the RenderService must come back
+    void         endDrawing();                                          // Releases the threads waiting on frames or events
+    void         enterUpdate(bool holdOff);                             // Waits for the frame being drawn, then opens an update
     static void  errorCallback(int error, const char* string);          // Display where an error is coming from
+    void         exitUpdate();                                          // Commits an update, waking the rendering thread if it was the last
+    void         exportFrame();                                         // Reads the frame back and publishes the one before it
+    void         finishDrawing();                                       // Frees the window once the RenderService is done with it
     void         glDestroy();                                           // Destroys the GL and GLFW things that are specific for this canvas
     void         init(int xx,int yy,int ww,int hh,
                    std::string title,
@@ -160,6 +222,7 @@ protected:
     void         initGlew();                                            // Initialized the GLEW things specific to the Canvas
     static void  initGlfw();                                            // Initalizes GLFW for all future canvases.
     void         initWindow();                                          // Initalizes the window specific to the Canvas
+    void         queueEvent(const InputEvent& event);                   // Queues an input event for dispatch
     static void  keyCallback(GLFWwindow* window, int key,
                    int scancode, int action, int mods);                 // GLFW callback for keys
     void         screenShot();                                          // Takes a screenshot
@@ -172,8 +235,40 @@ protected:
     static void  startDrawing(Canvas *c);                               // Static method that is called by the render thread
   #endif
     virtual void         selectShaders(unsigned int choice);            // Select appropriate shader for type of Drawable
+    void         startDispatch();                                       // Starts the dispatch thread, if it is used and not running
+    void         stopDispatch();                                        // Stops the dispatch thread once it has emptied the queue
+    bool         tryBeginFrame();                                       // Like beginFrame(), but fails instead of waiting
 public:
 
+    /*! \class Update
+     *  \brief A batch of changes to the Drawables on a Canvas that appears in a single frame.
+     *  \details Returned by Canvas::beginUpdate(). While any Update is open, the Canvas does not start drawing a
+     *   frame, so changes made to several Drawables between beginUpdate() and commit() are never shown half
+     *   done. Any number of threads may hold an Update at once; the Canvas draws as soon as the last is
+     *   committed.
+     *  \details An Update commits itself when destroyed, if commit() has not been called already. It may be
+     *   moved, but not copied.
+     */
+    class Update {
+        friend class Canvas;
+        Canvas * myCanvas;                                              // The Canvas being updated, or NULL once committed
+
+        explicit Update(Canvas * can);
+        Update(const Update&);
+        Update& operator=(const Update&);
+     public:
+        Update(Update&& other);
+
+        void commit();
+
+        /*!
+         * \brief Accessor for whether the Update is still open.
+         */
+        bool isOpen() const { return myCanvas != NULL; }
+
+        ~Update();
+    };
+
     Canvas(double timerLength = 0.0f, Background * background = nullptr);
 
     Canvas(int x, int y, int width, int height, std::string title, ColorFloat backgroundColor = GRAY, Background * background = nullptr, double timerLength = 0.0f);
@@ -184,12 +279,20 @@ public:
 
     void bindToScroll(std::function<void(double, double)> function);
 
+    void bindToMouseMove(std::function<void(double, double)> function);
+
+    void bindToEvents(std::function<void(const InputEvent&)> function);
+
     void add(Drawable * shapePtr);
 
+    Update beginUpdate();
+
     void clearBackground();
 
     void close();
 
+    bool exportFrames(const std::string& name, unsigned slots = 4);
+
     void clearObjectBuffer(bool shouldFreeMemory = false);
 
     virtual Background * getBackground();
@@ -202,10 +305,14 @@ public:
 
     static int getDisplayWidth();
 
+    unsigned getDroppedEvents();
+
     int getFrameNumber();
 
     float getFPS();
 
+    FrameStats getFrameStats();
+
     virtual float getMouseX();
 
     virtual float getMouseY();
@@ -214,6 +321,8 @@ public:
 
     uint8_t* getScreenBuffer();
 
+    StartupTimes getStartupTimes();
+
     double getTime();
 
     double getTimeBetweenSleeps() const;
@@ -230,8 +339,12 @@ public:
 
     bool isOpen();
 
+    void leaveVirtualTime();
+
     void pauseDrawing();
 
+    unsigned pollEvents();
+
     void recordForNumFrames(unsigned int num_frames, const std::string& newCaputurePrefix = "");
 
     void remove(Drawable * shapePtr);
@@ -266,10 +379,18 @@ public:
 
     void setBackgroundColor(ColorFloat color);
 
+    void setCoalesceMouseMoves(bool coalesce);
+
     void setFont(std::string filename);
 
+    void setInputDispatch(InputDispatch mode);
+
+    void setPacing(PacingMode mode);
+
     void setShowFPS(bool b);
 
+    void setVirtualTime(bool on);
+
     void sleep();
 
     void sleepFor(float seconds);
@@ -278,6 +399,8 @@ public:
 
     void stop();
 
+    void stopExport();
+
     void stopRecording();
 
     void takeScreenShot(const std::string& newCapturePrefix = "");
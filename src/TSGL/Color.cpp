@@ -1,5 +1,7 @@
 #include "Color.h"
 
+#include <algorithm>
+
 //Workaround for VS not defining NAN (
 #ifdef _MSC_VER
 #define INFINITY (DBL_MAX + DBL_MAX)
@@ -558,4 +560,254 @@ ColorFloat Colors::highContrastColor(unsigned int index, int offset) {
     return ColorHSV(hue * 6.0f, sat, val, 1.0f);
 }
 
+
+// Converts a channel between 0 and 1 to a byte, rounding and clamping without branches
+static inline unsigned toByte(float c) {
+    c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+    return (unsigned) (c * 255.0f + 0.5f);
+}
+
+// Branch-free HSV to RGB for one channel, where n is 5 for red, 3 for green and 1 for blue.
+// Equivalent to ColorHSV::operator ColorFloat(), but simple enough for the compiler to vectorize.
+static inline float hsvChannel(float n, float h, float s, float v) {
+    float k = n + h;
+    k -= (k >= 6.0f) ? 6.0f : 0.0f;
+    float ramp = std::min(std::min(k, 4.0f - k), 1.0f);
+    ramp = ramp < 0.0f ? 0.0f : ramp;
+    return v - v * s * ramp;
+}
+
+/*!
+ * \brief Packs a ColorFloat into one RGBA8 pixel.
+ * \details Each component is rounded to the nearest of 256 levels.
+ *   \param c The color to pack.
+ * \return The color as four bytes in R, G, B, A order.
+ */
+uint32_t Colors::packRgba8(ColorFloat c) {
+    return packRgba8(toByte(c.R), toByte(c.G), toByte(c.B), toByte(c.A));
+}
+
+/*!
+ * \brief Packs a ColorInt into one RGBA8 pixel.
+ *   \param c The color to pack.
+ * \return The color as four bytes in R, G, B, A order.
+ */
+uint32_t Colors::packRgba8(ColorInt c) {
+    return packRgba8(c.R & 0xFF, c.G & 0xFF, c.B & 0xFF, c.A & 0xFF);
+}
+
+/*!
+ * \brief Unpacks an RGBA8 pixel into a ColorInt.
+ *   \param rgba The pixel, as four bytes in R, G, B, A order.
+ * \return The pixel's color.
+ */
+ColorInt Colors::unpackRgba8(uint32_t rgba) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return ColorInt(rgba >> 24, (rgba >> 16) & 0xFF, (rgba >> 8) & 0xFF, rgba & 0xFF);
+#else
+    return ColorInt(rgba & 0xFF, (rgba >> 8) & 0xFF, (rgba >> 16) & 0xFF, rgba >> 24);
+#endif
+}
+
+/*!
+ * \brief Converts arrays of HSV components to packed RGBA8 pixels.
+ * \details A batch version of ColorHSV::operator ColorFloat() followed by packRgba8(), written without
+ *   branches so that the compiler can vectorize it. Out of range components are clamped silently.
+ *   \param h Array of <code>n</code> hues, between 0 and 6 inclusive.
+ *   \param s Array of <code>n</code> saturations, between 0 and 1 inclusive.
+ *   \param v Array of <code>n</code> values, between 0 and 1 inclusive.
+ *   \param n Number of colors to convert.
+ *   \param out Array to receive <code>n</code> packed colors.
+ *   \param alpha Alpha component of every color (set to 1.0f by default).
+ */
+void Colors::hsvToRgba8(const float* h, const float* s, const float* v, size_t n, uint32_t* out, float alpha) {
+    const unsigned a = toByte(alpha);
+    for (size_t i = 0; i < n; ++i) {
+        const float hue = h[i] < 0.0f ? 0.0f : (h[i] > 6.0f ? 6.0f : h[i]);
+        const float sat = s[i] < 0.0f ? 0.0f : (s[i] > 1.0f ? 1.0f : s[i]);
+        const float val = v[i] < 0.0f ? 0.0f : (v[i] > 1.0f ? 1.0f : v[i]);
+        out[i] = packRgba8(toByte(hsvChannel(5.0f, hue, sat, val)), toByte(hsvChannel(3.0f, hue, sat, val)),
+                           toByte(hsvChannel(1.0f, hue, sat, val)), a);
+    }
+}
+
+/*!
+ * \brief Converts an array of hues to packed RGBA8 pixels with a shared saturation and value.
+ *   \param h Array of <code>n</code> hues, between 0 and 6 inclusive.
+ *   \param s Saturation of every color, between 0 and 1 inclusive.
+ *   \param v Value of every color, between 0 and 1 inclusive.
+ *   \param n Number of colors to convert.
+ *   \param out Array to receive <code>n</code> packed colors.
+ *   \param alpha Alpha component of every color (set to 1.0f by default).
+ */
+void Colors::hsvToRgba8(const float* h, float s, float v, size_t n, uint32_t* out, float alpha) {
+    const unsigned a = toByte(alpha);
+    clamp(s, 0, 1);
+    clamp(v, 0, 1);
+    for (size_t i = 0; i < n; ++i) {
+        const float hue = h[i] < 0.0f ? 0.0f : (h[i] > 6.0f ? 6.0f : h[i]);
+        out[i] = packRgba8(toByte(hsvChannel(5.0f, hue, s, v)), toByte(hsvChannel(3.0f, hue, s, v)),
+                           toByte(hsvChannel(1.0f, hue, s, v)), a);
+    }
+}
+
+/*!
+ * \brief Converts arrays of floating point red, green, and blue components to packed RGBA8 pixels.
+ *   \param r Array of <code>n</code> red components, between 0 and 1 inclusive.
+ *   \param g Array of <code>n</code> green components, between 0 and 1 inclusive.
+ *   \param b Array of <code>n</code> blue components, between 0 and 1 inclusive.
+ *   \param n Number of colors to convert.
+ *   \param out Array to receive <code>n</code> packed colors.
+ *   \param alpha Alpha component of every color (set to 1.0f by default).
+ */
+void Colors::rgbToRgba8(const float* r, const float* g, const float* b, size_t n, uint32_t* out, float alpha) {
+    const unsigned a = toByte(alpha);
+    for (size_t i = 0; i < n; ++i)
+        out[i] = packRgba8(toByte(r[i]), toByte(g[i]), toByte(b[i]), a);
+}
+
+/*!
+ * \brief Blends two colors by an array of biases, producing packed RGBA8 pixels.
+ * \details A batch version of blend() followed by packRgba8().
+ *   \param c1 The color for a bias of 0.
+ *   \param c2 The color for a bias of 1.
+ *   \param bias Array of <code>n</code> biases, clamped between 0 and 1.
+ *   \param n Number of colors to produce.
+ *   \param out Array to receive <code>n</code> packed colors.
+ */
+void Colors::blendToRgba8(ColorFloat c1, ColorFloat c2, const float* bias, size_t n, uint32_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        const float t = bias[i] < 0.0f ? 0.0f : (bias[i] > 1.0f ? 1.0f : bias[i]);
+        out[i] = packRgba8(toByte(c1.R + (c2.R - c1.R) * t), toByte(c1.G + (c2.G - c1.G) * t),
+                           toByte(c1.B + (c2.B - c1.B) * t), toByte(c1.A + (c2.A - c1.A) * t));
+    }
+}
+
+/*!
+ * \brief Constructs a Colormap filled with a single color.
+ *   \param size Number of entries in the table (set to 256 by default). At least 2.
+ *   \param color The color of every entry (set to BLACK by default).
+ * \return A new Colormap whose entries can be filled in with set().
+ */
+Colormap::Colormap(unsigned size, ColorFloat color) {
+    if (size < 2) {
+        TsglDebug("A Colormap needs at least 2 entries.");
+        size = 2;
+    }
+    table.assign(size, Colors::packRgba8(color));
+    maxIndex = size - 1;
+}
+
+/*!
+ * \brief Constructs a Colormap that is a gradient through evenly spaced color stops.
+ *   \param stops Array of the colors to pass through, from the entry for 0 to the entry for 1.
+ *   \param numStops Number of colors in <code>stops</code>.
+ *   \param size Number of entries in the table (set to 256 by default).
+ * \return A new Colormap that linearly interpolates between consecutive stops.
+ */
+Colormap::Colormap(const ColorFloat* stops, unsigned numStops, unsigned size) : Colormap(size) {
+    if (numStops == 0) {
+        TsglDebug("A Colormap gradient needs at least one color stop.");
+        return;
+    }
+    for (unsigned i = 0; i < table.size(); ++i) {
+        float pos = (numStops - 1) * (i / maxIndex);
+        unsigned stop = std::min((unsigned) pos, numStops > 1 ? numStops - 2 : 0);
+        if (numStops == 1)
+            table[i] = Colors::packRgba8(stops[0]);
+        else
+            table[i] = Colors::packRgba8(Colors::blend(stops[stop], stops[stop + 1], pos - stop));
+    }
+}
+
+/*!
+ * \brief Creates a Colormap that ramps through hues.
+ * \details The entry for 0 has hue <code>hueStart</code> and the entry for 1 has hue <code>hueEnd</code>.
+ *   \param hueStart The first hue, between 0 and 6 inclusive (set to 0 by default).
+ *   \param hueEnd The last hue, between 0 and 6 inclusive (set to 6 by default).
+ *   \param saturation Saturation of every entry (set to 1 by default).
+ *   \param value Value of every entry (set to 1 by default).
+ *   \param alpha Alpha of every entry (set to 1 by default).
+ *   \param size Number of entries in the table (set to 256 by default).
+ * \return A new Colormap.
+ */
+Colormap Colormap::hsvRamp(float hueStart, float hueEnd, float saturation, float value, float alpha, unsigned size) {
+    Colormap map(size);
+    std::vector<float> hues(map.size());
+    for (unsigned i = 0; i < hues.size(); ++i)
+        hues[i] = hueStart + (hueEnd - hueStart) * (i / map.maxIndex);
+    Colors::hsvToRgba8(&hues[0], saturation, value, hues.size(), &map.table[0], alpha);
+    return map;
+}
+
+/*!
+ * \brief Creates a Colormap that is a gradient between two colors.
+ *   \param from The color of the entry for 0.
+ *   \param to The color of the entry for 1.
+ *   \param size Number of entries in the table (set to 256 by default).
+ * \return A new Colormap.
+ */
+Colormap Colormap::gradient(ColorFloat from, ColorFloat to, unsigned size) {
+    ColorFloat stops[2] = { from, to };
+    return Colormap(stops, 2, size);
+}
+
+/*!
+ * \brief Creates a Colormap from any function of a parameter between 0 and 1.
+ * \details The function is called once per entry, with <code>i / (size - 1)</code> for entry i, so it can be
+ *   as expensive as it likes (for example, a chain of Colors::blend() calls).
+ *   \param f A function or lambda taking a float and returning a ColorFloat.
+ *   \param size Number of entries in the table (set to 256 by default).
+ * \return A new Colormap.
+ */
+Colormap Colormap::fromFunction(std::function<ColorFloat(float)> f, unsigned size) {
+    Colormap map(size);
+    for (unsigned i = 0; i < map.size(); ++i)
+        map.table[i] = Colors::packRgba8(f(i / map.maxIndex));
+    return map;
+}
+
+/*!
+ * \brief Mutator for one entry of the table.
+ *   \param i Index of the entry, less than size().
+ *   \param color The new color of the entry.
+ */
+void Colormap::set(unsigned i, ColorFloat color) {
+    if (i >= table.size()) {
+        TsglDebug("Colormap index out of range.");
+        return;
+    }
+    table[i] = Colors::packRgba8(color);
+}
+
+/*!
+ * \brief Maps an array of values to packed RGBA8 colors.
+ * \details Values are rescaled from [min, max] to [0, 1] and looked up as in map(float). The loop does no
+ *   conversions besides the rescale, and runs on the calling thread, so threads can each map their own rows.
+ *   \param values Array of <code>n</code> values.
+ *   \param n Number of values.
+ *   \param out Array to receive <code>n</code> packed colors.
+ *   \param min The value that maps to the first entry (set to 0 by default).
+ *   \param max The value that maps to the last entry (set to 1 by default).
+ */
+void Colormap::map(const float* values, size_t n, uint32_t* out, float min, float max) const {
+    const float scale = (max != min) ? maxIndex / (max - min) : 0.0f;
+    const uint32_t* lut = &table[0];
+    for (size_t i = 0; i < n; ++i) {
+        float index = (values[i] - min) * scale + 0.5f;
+        index = index > 0.0f ? index : 0.0f;                // Also catches NaN
+        index = index < maxIndex ? index : maxIndex;
+        out[i] = lut[(unsigned) index];
+    }
+}
+
+/*!
+ * \brief Maps a value between 0 and 1 to a ColorFloat.
+ *   \param t The value to map.
+ * \return The color of the table entry nearest to <code>t * (size() - 1)</code>.
+ */
+ColorFloat Colormap::getColor(float t) const {
+    return Colors::unpackRgba8(map(t));
+}
+
 }
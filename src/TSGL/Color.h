@@ -9,6 +9,9 @@
 #include <stdexcept>    // Needed for exceptions
 #include <cstdlib>      // Needed for rand()
 #include <sstream>      // Needed for Windows integer / float to string conversion
+#include <functional>   // Needed for Colormap::fromFunction()
+#include <stdint.h>     // Needed for packed RGBA8 colors
+#include <vector>       // Needed for Colormap tables
 #include <gl_includes.h>
 
 #include "Util.h"       // Clamp()
@@ -143,6 +146,33 @@ class Colors {
 
     static ColorFloat highContrastColor(unsigned int index, int offset = 0);
 
+    /*!
+     * \brief Packs 8-bit red, green, blue, and alpha components into one RGBA8 pixel.
+     * \details The bytes of the result are laid out in memory as R, G, B, A on any platform, which is the
+     *   layout Background::drawPixels() expects.
+     */
+    static inline uint32_t packRgba8(unsigned r, unsigned g, unsigned b, unsigned a = 255) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return (r << 24) | (g << 16) | (b << 8) | a;
+#else
+        return r | (g << 8) | (b << 16) | (a << 24);
+#endif
+    }
+
+    static uint32_t packRgba8(ColorFloat c);
+
+    static uint32_t packRgba8(ColorInt c);
+
+    static ColorInt unpackRgba8(uint32_t rgba);
+
+    static void hsvToRgba8(const float* h, const float* s, const float* v, size_t n, uint32_t* out, float alpha = 1.0f);
+
+    static void hsvToRgba8(const float* h, float s, float v, size_t n, uint32_t* out, float alpha = 1.0f);
+
+    static void rgbToRgba8(const float* r, const float* g, const float* b, size_t n, uint32_t* out, float alpha = 1.0f);
+
+    static void blendToRgba8(ColorFloat c1, ColorFloat c2, const float* bias, size_t n, uint32_t* out);
+
  private:
     Colors();
     ~Colors();
@@ -151,6 +181,66 @@ class Colors {
     static const ColorFloat* DISTINCT_ARRAY;
 };
 
+/*! \class Colormap
+ *  \brief A lookup table that maps numbers to precomputed RGBA8 colors.
+ *  \details A Colormap stores <code>size</code> packed RGBA8 colors (usually 256 or 4096), built once from an
+ *    HSV ramp, a gradient between color stops, or any function of a parameter between 0 and 1. Mapping a value
+ *    is then a single table lookup, instead of an HSV conversion or a blend with range checks on every pixel.
+ *  \details The packed colors have the byte layout used by Background::drawPixels(), so a row or block of
+ *    values can be turned into pixels with map() and uploaded in one call.
+ *  \details Colormaps are never modified by lookups, so any number of threads may share one.
+ */
+class Colormap {
+ private:
+    std::vector<uint32_t> table;
+    float maxIndex;
+ public:
+    Colormap(unsigned size = 256, ColorFloat color = BLACK);
+
+    Colormap(const ColorFloat* stops, unsigned numStops, unsigned size = 256);
+
+    static Colormap hsvRamp(float hueStart = 0.0f, float hueEnd = 6.0f, float saturation = 1.0f, float value = 1.0f,
+                            float alpha = 1.0f, unsigned size = 256);
+
+    static Colormap gradient(ColorFloat from, ColorFloat to, unsigned size = 256);
+
+    static Colormap fromFunction(std::function<ColorFloat(float)> f, unsigned size = 256);
+
+    /*!
+     * \brief Accessor for the number of entries in the table.
+     */
+    unsigned size() const { return table.size(); }
+
+    /*!
+     * \brief Accessor for the table itself, <code>size()</code> packed RGBA8 colors.
+     */
+    const uint32_t* data() const { return &table[0]; }
+
+    /*!
+     * \brief Accessor for one entry of the table.
+     * \param i Index of the entry, less than size().
+     */
+    uint32_t operator[](unsigned i) const { return table[i]; }
+
+    void set(unsigned i, ColorFloat color);
+
+    /*!
+     * \brief Maps a value between 0 and 1 to a packed RGBA8 color.
+     * \details Values outside of [0, 1] (and NaN) map to the nearest end of the table.
+     * \param t The value to map.
+     * \return The table entry nearest to <code>t * (size() - 1)</code>.
+     */
+    inline uint32_t map(float t) const {
+        if (!(t > 0.0f)) return table[0];
+        if (t >= 1.0f) return table[table.size() - 1];
+        return table[(unsigned) (t * maxIndex + 0.5f)];
+    }
+
+    void map(const float* values, size_t n, uint32_t* out, float min = 0.0f, float max = 1.0f) const;
+
+    ColorFloat getColor(float t) const;
+};
+
 }
 
 #endif /* COLOR_H_ */
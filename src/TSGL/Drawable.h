@@ -10,7 +10,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <mutex>        // Needed for locking the attribute mutex for thread-safety
+#include "ProfiledMutex.h"  // Needed for locking the attribute mutex for thread-safety
 
 namespace tsgl {
 
@@ -29,7 +29,7 @@ namespace tsgl {
  */
 class Drawable {
  protected:
-    std::mutex      attribMutex; ///< Protects the attributes of the Drawable from being accessed while simultaneously being changed
+    ProfiledMutex   attribMutex{"Drawable::attribMutex"}; ///< Protects the attributes of the Drawable from being accessed while simultaneously being changed
     GLfloat* vertices;
     float myCurrentYaw, myCurrentPitch, myCurrentRoll;
     float myXScale, myYScale, myZScale;
@@ -0,0 +1,353 @@
+#include "FrameExport.h"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+#ifdef __linux__
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <time.h>
+#endif
+
+#include "Error.h"
+
+namespace tsgl {
+
+namespace {
+
+const uint32_t MAGIC = 0x46475354;          // "TSGF"
+const uint32_t VERSION = 1;
+const size_t PAGE = 4096;
+
+// Header of one slot of the ring. The writer zeroes the sequence number while it fills the slot.
+struct FrameExportSlot {
+    std::atomic<uint64_t> sequence;         // Frame in the slot, or 0 while it is being written
+    double time;
+    char padding[48];                       // One cache line per slot
+};
+
+}
+
+// The start of the shared memory; the slot headers follow it, and the pixels start at dataOffset.
+struct FrameExportHeader {
+    std::atomic<uint32_t> magic;            // Set last, once the rest is ready
+    uint32_t version;
+    int32_t width, height;
+    uint32_t slots;
+    uint32_t reserved;
+    uint64_t slotBytes, dataOffset;
+    std::atomic<uint64_t> latest;           // Newest frame published, 0 before the first
+    std::atomic<uint32_t> published;        // Low bits of latest, which waiting readers sleep on
+    std::atomic<uint32_t> writerOpen;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == 8 && sizeof(std::atomic<uint32_t>) == 4,
+              "The shared memory layout needs plain, lock-free atomics");
+
+namespace {
+
+size_t roundToPage(size_t bytes) {
+    return (bytes + PAGE - 1) / PAGE * PAGE;
+}
+
+FrameExportSlot* slotAt(const FrameExportHeader* header, uint64_t sequence) {
+    char* slots = (char*) header + sizeof(FrameExportHeader);
+    return (FrameExportSlot*) (slots + (sequence % header->slots) * sizeof(FrameExportSlot));
+}
+
+uint8_t* pixelsAt(const FrameExportHeader* header, uint64_t sequence) {
+    return (uint8_t*) header + header->dataOffset + (sequence % header->slots) * header->slotBytes;
+}
+
+void wakeReaders(std::atomic<uint32_t>* word) {
+  #ifdef __linux__
+    syscall(SYS_futex, (uint32_t*) word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+  #else
+    (void) word;                            // Readers poll
+  #endif
+}
+
+// Sleeps until the word changes from value, or for at most seconds.
+void waitForWriter(const std::atomic<uint32_t>* word, uint32_t value, double seconds) {
+  #ifdef __linux__
+    timespec limit;
+    limit.tv_sec = (time_t) seconds;
+    limit.tv_nsec = (long) ((seconds - limit.tv_sec) * 1e9);
+    syscall(SYS_futex, (uint32_t*) word, FUTEX_WAIT, value, &limit, NULL, 0);
+  #else
+    (void) word; (void) value;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds < 0.001 ? seconds : 0.001));
+  #endif
+}
+
+}
+
+/*!
+ * \brief Constructs a FrameExport with no ring open.
+ */
+FrameExport::FrameExport() : myHeader(0), myBytes(0), mySequence(0) {}
+
+/*!
+ * \brief Creates a named ring in shared memory, closing any ring already open.
+ * \details A ring of the same name left behind by a writer that crashed is replaced.
+ *   \param name The name readers attach with. It may not contain a '/'.
+ *   \param width The width of the frames in pixels.
+ *   \param height The height of the frames in pixels.
+ *   \param slots The number of frames the ring holds. A reader has until the writer has published
+ *     <code>slots - 1</code> more frames to read one. At least 2.
+ * \return Whether the ring was created. An error is printed if it was not.
+ */
+bool FrameExport::open(const std::string& name, int width, int height, unsigned slots) {
+    close();
+    if (name.empty() || name.find('/') != std::string::npos) {
+        TsglDebug("A frame export needs a name without a '/'.");
+        return false;
+    }
+    if (width <= 0 || height <= 0 || slots < 2) {
+        TsglDebug("A frame export needs a positive size and at least 2 slots.");
+        return false;
+    }
+#ifdef _WIN32
+    TsglErr("Frame export needs POSIX shared memory, which this system does not have.");
+    return false;
+#else
+    const std::string shmName = "/" + name;
+    shm_unlink(shmName.c_str());
+    int file = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (file < 0) {
+        TsglErr("Could not create the shared memory " + name + ".");
+        return false;
+    }
+    const size_t slotBytes = roundToPage((size_t) width * height * 4);
+    const size_t dataOffset = roundToPage(sizeof(FrameExportHeader) + slots * sizeof(FrameExportSlot));
+    const size_t bytes = dataOffset + slots * slotBytes;
+    void * map = MAP_FAILED;
+    if (ftruncate(file, (off_t) bytes) == 0)
+        map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);                          // The mapping keeps the memory open
+    if (map == MAP_FAILED) {
+        shm_unlink(shmName.c_str());
+        TsglErr("Could not map the shared memory " + name + ".");
+        return false;
+    }
+
+    FrameExportHeader* header = new (map) FrameExportHeader;
+    header->version = VERSION;
+    header->width = width;
+    header->height = height;
+    header->slots = slots;
+    header->reserved = 0;
+    header->slotBytes = slotBytes;
+    header->dataOffset = dataOffset;
+    header->latest = 0;
+    header->published = 0;
+    header->writerOpen = 1;
+    for (unsigned i = 0; i < slots; ++i)
+        new (slotAt(header, i)) FrameExportSlot();
+    header->magic.store(MAGIC, std::memory_order_release);
+
+    myHeader = header;
+    myBytes = bytes;
+    myName = name;
+    mySequence = 0;
+    return true;
+#endif
+}
+
+/*!
+ * \brief Closes the ring and removes its name. Readers still attached can finish reading.
+ */
+void FrameExport::close() {
+    if (!myHeader)
+        return;
+#ifndef _WIN32
+    myHeader->writerOpen = 0;
+    myHeader->published.fetch_add(1);       // So that sleeping readers see a change
+    wakeReaders(&myHeader->published);
+    munmap((void*) myHeader, myBytes);
+    shm_unlink(("/" + myName).c_str());
+#endif
+    myHeader = 0;
+    myBytes = 0;
+    myName.clear();
+}
+
+/*!
+ * \brief Claims the slot for the next frame.
+ * \details Call endFrame() once the pixels are written. Only one thread may write frames.
+ * \return Where to write the next frame's pixels, or 0 if no ring is open.
+ */
+uint8_t * FrameExport::beginFrame() {
+    if (!myHeader)
+        return 0;
+    FrameExportSlot* slot = slotAt(myHeader, mySequence + 1);
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);   // Readers see the slot claimed before it changes
+    return pixelsAt(myHeader, mySequence + 1);
+}
+
+/*!
+ * \brief Publishes the frame written since beginFrame(), and wakes any readers waiting for it.
+ *   \param time The time of the frame, in seconds.
+ */
+void FrameExport::endFrame(double time) {
+    if (!myHeader)
+        return;
+    ++mySequence;
+    FrameExportSlot* slot = slotAt(myHeader, mySequence);
+    slot->time = time;
+    slot->sequence.store(mySequence, std::memory_order_release);
+    myHeader->latest.store(mySequence, std::memory_order_release);
+    myHeader->published.store((uint32_t) mySequence, std::memory_order_release);
+    wakeReaders(&myHeader->published);
+}
+
+/*!
+ * \brief Closes the ring.
+ */
+FrameExport::~FrameExport() {
+    close();
+}
+
+/*!
+ * \brief Constructs a FrameReader that is not attached to a ring.
+ */
+FrameReader::FrameReader() : myHeader(0), myBytes(0), myLastSequence(0), mySkipped(0) {}
+
+/*!
+ * \brief Attaches to the ring a FrameExport created, closing any ring already open.
+ *   \param name The name the ring was created with.
+ * \return Whether the reader attached. An error is printed if it did not.
+ */
+bool FrameReader::open(const std::string& name) {
+    close();
+#ifdef _WIN32
+    TsglErr("Frame export needs POSIX shared memory, which this system does not have.");
+    return false;
+#else
+    int file = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    if (file < 0) {
+        TsglErr("Could not open the shared memory " + name + ". Has the Canvas started exporting?");
+        return false;
+    }
+    struct stat info;
+    void * map = MAP_FAILED;
+    if (fstat(file, &info) == 0 && (size_t) info.st_size >= sizeof(FrameExportHeader))
+        map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (map == MAP_FAILED) {
+        TsglErr("Could not map the shared memory " + name + ".");
+        return false;
+    }
+    const FrameExportHeader* header = (const FrameExportHeader*) map;
+    if (header->magic.load(std::memory_order_acquire) != MAGIC || header->version != VERSION
+        || header->dataOffset + header->slots * header->slotBytes > (uint64_t) info.st_size) {
+        munmap(map, (size_t) info.st_size);
+        TsglErr("The shared memory " + name + " is not a frame export this version of TSGL can read.");
+        return false;
+    }
+    myHeader = header;
+    myBytes = (size_t) info.st_size;
+    myLastSequence = 0;
+    mySkipped = 0;
+    return true;
+#endif
+}
+
+/*!
+ * \brief Detaches from the ring. Frames returned by next() may no longer be read.
+ */
+void FrameReader::close() {
+    if (!myHeader)
+        return;
+#ifndef _WIN32
+    munmap((void*) myHeader, myBytes);
+#endif
+    myHeader = 0;
+    myBytes = 0;
+}
+
+/*!
+ * \brief Waits for a frame newer than the last one returned, and returns the newest.
+ * \details Frames published between the last one returned and this one are skipped (see getSkipped()).
+ *   \param frame Set to the newest frame. Its pixels stay in the ring, so check isValid() after reading them.
+ *   \param timeout The longest to wait in seconds, or a negative number to wait until the writer closes.
+ * \return Whether a frame was returned: false if the timeout passed or the writer closed first.
+ */
+bool FrameReader::next(ExportedFrame& frame, double timeout) {
+    if (!myHeader)
+        return false;
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+    for (;;) {
+        const uint64_t latest = myHeader->latest.load(std::memory_order_acquire);
+        if (latest > myLastSequence) {
+            const FrameExportSlot* slot = slotAt(myHeader, latest);
+            if (slot->sequence.load(std::memory_order_acquire) == latest) {
+                frame.pixels = pixelsAt(myHeader, latest);
+                frame.width = myHeader->width;
+                frame.height = myHeader->height;
+                frame.sequence = latest;
+                frame.time = slot->time;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot->sequence.load(std::memory_order_relaxed) == latest) {
+                    if (myLastSequence > 0)
+                        mySkipped += latest - myLastSequence - 1;
+                    myLastSequence = latest;
+                    return true;
+                }
+            }
+            continue;                       // Overwritten already, so there is a newer frame
+        }
+        if (!myHeader->writerOpen)
+            return false;
+        double wait = 0.1;                  // Look at the writer now and then, in case it died
+        if (timeout >= 0) {
+            const double left = timeout - std::chrono::duration<double>(clock::now() - start).count();
+            if (left <= 0)
+                return false;
+            if (left < wait)
+                wait = left;
+        }
+        waitForWriter(&myHeader->published, (uint32_t) latest, wait);
+    }
+}
+
+/*!
+ * \brief Checks that a frame was not overwritten, as far as the reader has read it.
+ * \details Call this after reading a frame's pixels: if it returns false, the writer reused the slot while
+ *   they were read, and what was read may mix two frames.
+ *   \param frame A frame returned by next().
+ * \return Whether the frame is still intact in the ring.
+ */
+bool FrameReader::isValid(const ExportedFrame& frame) const {
+    if (!myHeader)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotAt(myHeader, frame.sequence)->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
+/*!
+ * \brief Accessor for whether the writer still has the ring open.
+ */
+bool FrameReader::isWriterOpen() const {
+    return myHeader && myHeader->writerOpen;
+}
+
+/*!
+ * \brief Detaches from the ring.
+ */
+FrameReader::~FrameReader() {
+    close();
+}
+
+}
@@ -0,0 +1,131 @@
+/*
+ * FrameExport.h provides a ring of rendered frames in shared memory, and a reader for other processes.
+ */
+
+#ifndef FRAMEEXPORT_H_
+#define FRAMEEXPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace tsgl {
+
+struct FrameExportHeader;   // The layout of the shared memory, defined in FrameExport.cpp
+
+/*! \class FrameExport
+ *  \brief Publishes frames into a named ring in shared memory, for other processes on the same host to read.
+ *  \details Canvas::exportFrames() opens one of these and publishes every frame it draws; FrameReader attaches
+ *    to it by name from any process. The ring holds a few frames, each tagged with a sequence number:
+ *    - The writer never waits for readers. It overwrites the oldest frame, and a reader that falls behind
+ *      skips to the newest one.
+ *    - A reader reads the pixels where they lie in shared memory, without copying them, then checks that the
+ *      frame was not overwritten while it read (see FrameReader::isValid()).
+ *    - On Linux, readers waiting for a frame sleep on a futex in the shared memory, which the writer wakes;
+ *      elsewhere they poll.
+ *    .
+ *  \details Pixels are RGBA8, 4 bytes per pixel, with row 0 at the bottom, as OpenGL reads them.
+ *  \note Shared memory export needs a POSIX system. On Windows, open() fails with an error.
+ */
+class FrameExport {
+ private:
+    FrameExportHeader * myHeader;
+    size_t myBytes;
+    std::string myName;
+    uint64_t mySequence;
+
+    FrameExport(const FrameExport&);
+    FrameExport& operator=(const FrameExport&);
+ public:
+    FrameExport();
+
+    bool open(const std::string& name, int width, int height, unsigned slots = 4);
+
+    void close();
+
+    uint8_t * beginFrame();
+
+    void endFrame(double time);
+
+    /*!
+     * \brief Accessor for whether the ring is open.
+     */
+    bool isOpen() const { return myHeader != 0; }
+
+    /*!
+     * \brief Accessor for the name readers attach with.
+     */
+    const std::string& getName() const { return myName; }
+
+    /*!
+     * \brief Accessor for the number of frames published so far.
+     */
+    uint64_t getFrameCount() const { return mySequence; }
+
+    ~FrameExport();
+};
+
+/*!
+ * \brief A frame in a FrameExport ring, as seen by a FrameReader. The pixels are not copied.
+ */
+struct ExportedFrame {
+    const uint8_t * pixels;     //!< The frame's pixels in shared memory, RGBA8 with row 0 at the bottom
+    int width, height;          //!< Size of the frame in pixels
+    uint64_t sequence;          //!< Number of the frame, counting from 1
+    double time;                //!< Time of the frame on the writing Canvas' clock, in seconds
+};
+
+/*! \class FrameReader
+ *  \brief Attaches to a FrameExport ring by name and reads its frames in place.
+ *  \details A typical consumer, such as an encoder in another process:
+ *  \code
+ *    FrameReader reader;
+ *    reader.open("tsgl-frames");
+ *    ExportedFrame frame;
+ *    while (reader.next(frame)) {
+ *        encode(frame.pixels, frame.width, frame.height);
+ *        if (!reader.isValid(frame))
+ *            discardLastFrame();             // The writer lapped us while we read
+ *    }
+ *  \endcode
+ *  \details Each FrameReader should be used by one thread at a time; any number of readers may attach to the
+ *    same ring.
+ */
+class FrameReader {
+ private:
+    const FrameExportHeader * myHeader;
+    size_t myBytes;
+    uint64_t myLastSequence;
+    uint64_t mySkipped;
+
+    FrameReader(const FrameReader&);
+    FrameReader& operator=(const FrameReader&);
+ public:
+    FrameReader();
+
+    bool open(const std::string& name);
+
+    void close();
+
+    bool next(ExportedFrame& frame, double timeout = -1);
+
+    bool isValid(const ExportedFrame& frame) const;
+
+    bool isWriterOpen() const;
+
+    /*!
+     * \brief Accessor for whether the reader is attached to a ring.
+     */
+    bool isOpen() const { return myHeader != 0; }
+
+    /*!
+     * \brief Accessor for the number of frames published that next() skipped because a newer one was ready.
+     */
+    uint64_t getSkipped() const { return mySkipped; }
+
+    ~FrameReader();
+};
+
+}
+
+#endif /* FRAMEEXPORT_H_ */
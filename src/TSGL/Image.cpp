@@ -17,8 +17,20 @@ namespace tsgl {
   *   \param alpha The alpha of the Image.
   * \return A new Image is drawn with the specified coordinates, dimensions, and transparency.
   * \note <B>IMPORTANT</B>: In CartesianCanvas, *y* specifies the bottom, not the top, of the image.
+  * \note The file is decoded before the constructor returns, unless another Image already decoded it.
   */
-Image::Image(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha) : Drawable(x,y,z,yaw,pitch,roll) {
+Image::Image(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha)
+  : Image(x, y, z, filename, width, height, yaw, pitch, roll, alpha, true) { }
+
+/*!
+ * \brief Constructs an Image, optionally without waiting for its file to be decoded.
+ * \details Shared by the public constructor and loadAsync(); the parameters are the same, plus:
+ *   \param wait Whether to decode the file before returning.
+ */
+Image::Image(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha, bool wait) : Drawable(x,y,z,yaw,pitch,roll) {
+    myTexture = 0;
+    myTextureData = 0;
+    myTextureUploaded = false;
     if (width <= 0 || height <= 0) {
         TsglDebug("Cannot have an Image with width or height less than or equal to 0.");
         return;
@@ -35,9 +47,12 @@ Image::Image(float x, float y, float z, std::string filename, GLfloat width, GLf
     myAlpha = alpha;
 
 	// Load the image.
-    stbi_set_flip_vertically_on_load(true);
-    data = stbi_load(filename.c_str(), &pixelWidth, &pixelHeight, 0, 4);
-    tsglAssert(data, "stbi_load(filename) failed.");
+    if (wait) {
+        myData = ImageLoader::loadNow(filename);
+        tsglAssert(myData->isReady(), "stbi_load(filename) failed.");
+    } else {
+        myData = ImageLoader::load(filename);
+    }
     // vertex allocation and assignment
     vertices = new GLfloat[30];
 
@@ -58,6 +73,17 @@ Image::Image(float x, float y, float z, std::string filename, GLfloat width, GLf
     attribMutex.unlock();
 }
 
+ /*!
+  * \brief Creates a new Image without waiting for its file to be decoded.
+  * \details The file is decoded by ImageLoader's decoding threads. Until it is ready, the Image draws a
+  *   translucent grey rectangle in its place, and getPixelWidth() and getPixelHeight() return 0. The
+  *   parameters are the same as the constructor's.
+  * \return A new Image, to be added to a Canvas and deleted by the caller as usual.
+  */
+Image * Image::loadAsync(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha) {
+    return new Image(x, y, z, filename, width, height, yaw, pitch, roll, alpha, false);
+}
+
  /*!
   * \brief Draw the Image.
   * \details This function actually draws the Image to the Canvas.
@@ -82,28 +108,41 @@ void Image::draw(Shader * shader) {
     unsigned int alphaLoc = glGetUniformLocation(shader->ID, "alpha");
     glUniform1f(alphaLoc, myAlpha);
 
-    glGenTextures(1, &myTexture);
-    // enable textures and bind the texture id
-    glBindTexture(GL_TEXTURE_2D, myTexture);
+    if (!myTexture) {
+        glGenTextures(1, &myTexture);
+        glBindTexture(GL_TEXTURE_2D, myTexture);
 
-    // Set texture parameters for wrapping.
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // Set texture parameters for wrapping.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    // Set texture parameters for filtering.
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        // Set texture parameters for filtering.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    } else {
+        // enable textures and bind the texture id
+        glBindTexture(GL_TEXTURE_2D, myTexture);
+    }
 
-    // actually generate the texture + mipmaps
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);	
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pixelWidth, pixelHeight, 0,
-	           	 GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // upload the pixels only when they change, showing a placeholder until the file is decoded
+    attribMutex.lock();
+    const ImageData * current = myData->isReady() ? myData.get() : 0;
+    if (current != myTextureData || !myTextureUploaded) {
+        static const unsigned char placeholder[4] = { 128, 128, 128, 128 };
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (current)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, current->getWidth(), current->getHeight(), 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, current->getPixels());
+        else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        myTextureData = current;
+        myTextureUploaded = true;
+    }
+    attribMutex.unlock();
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 5, vertices, GL_DYNAMIC_DRAW);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    glDeleteTextures(1, &myTexture);
 }
 
 /**
@@ -174,14 +213,12 @@ void Image::changeHeightBy(GLfloat delta) {
  * \param height New height of the Image.
  */
 void Image::changeFile(std::string filename) {
+    std::shared_ptr<ImageData> data = ImageLoader::loadNow(filename);
+    tsglAssert(data->isReady(), "stbi_load(filename) failed.");
     attribMutex.lock();
-    init = false;
-    stbi_image_free(data); 
-	// Load the image.
-    stbi_set_flip_vertically_on_load(true);
-    data = stbi_load(filename.c_str(), &pixelWidth, &pixelHeight, 0, 4);
-    tsglAssert(data, "stbi_load(filename) failed.");
-    init = true;
+    myFile = filename;
+    myData = data;
+    myTextureUploaded = false;
     attribMutex.unlock();
 }
 
@@ -213,9 +250,41 @@ void Image::getFileResolution(std::string filename, int &width, int &height) {
     width = w; height = h;
 }
 
+/*!
+ * \brief Accessor for whether the Image's file has been decoded.
+ * \details Always true for Images made with the constructor; Images made with loadAsync() draw a placeholder
+ *   until it is.
+ */
+bool Image::isLoaded() {
+    attribMutex.lock();
+    bool ready = myData && myData->isReady();
+    attribMutex.unlock();
+    return ready;
+}
+
+/*!
+ * \brief Accessor for the height of the Image's file in pixels, or 0 if it has not been decoded yet.
+ */
+GLint Image::getPixelHeight() {
+    attribMutex.lock();
+    GLint height = myData ? myData->getHeight() : 0;
+    attribMutex.unlock();
+    return height;
+}
+
+/*!
+ * \brief Accessor for the width of the Image's file in pixels, or 0 if it has not been decoded yet.
+ */
+GLint Image::getPixelWidth() {
+    attribMutex.lock();
+    GLint width = myData ? myData->getWidth() : 0;
+    attribMutex.unlock();
+    return width;
+}
+
 Image::~Image() { 
-    glDeleteTextures(1, &myTexture);
-    stbi_image_free(data); 
+    if (myTexture)
+        glDeleteTextures(1, &myTexture);
 }
 
 
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "Drawable.h"           // For extending our Drawable object
+#include "ImageLoader.h"        // For sharing decoded files between Images
 #include <stb/stb_image.h>
 #include "TsglAssert.h"      // For unit testing purposes
 
@@ -20,18 +21,25 @@ namespace tsgl {
  *  \note For the time being, there is no way to measure the size of an image once it's loaded.
  *   Therefore, the width and height must be specified manually, and stretching may occur if the
  *   input dimensions don't match the images actual dimensions.
+ *  \details Decoded files are shared through ImageLoader, so Images of the same file decode it only once.
+ *   loadAsync() creates an Image without waiting for its file to be decoded.
  *  \warning Aside from an error message output to stderr, Image gives no indication if an image failed to load.
  */
 class Image : public Drawable {
  private:
-    unsigned char * data = 0;
+    std::shared_ptr<ImageData> myData;
+    const ImageData * myTextureData;    // What myTexture holds: myData once it is ready, 0 for the placeholder
+    bool myTextureUploaded;
     GLfloat myWidth, myHeight;
-    GLint pixelWidth, pixelHeight;
     std::string myFile;
     GLuint myTexture;
+
+    Image(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha, bool wait);
  public:
     Image(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha = 1.0f);
 
+    static Image * loadAsync(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha = 1.0f);
+
     virtual void draw(Shader * shader);
 
     /*!
@@ -58,9 +66,11 @@ class Image : public Drawable {
 
     void setAlpha(float newAlpha);
 
-    GLint getPixelHeight() { return pixelHeight; }
+    bool isLoaded();
+
+    GLint getPixelHeight();
 
-    GLint getPixelWidth() { return pixelWidth; }
+    GLint getPixelWidth();
 
     static void getFileResolution(std::string filename, int &width, int &height);
 
@@ -0,0 +1,237 @@
+#include "ImageLoader.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <thread>
+
+#include <stb/stb_image.h>
+#include "Error.h"
+
+namespace tsgl {
+
+namespace {
+
+// Shared state of the loader. Its destructor stops and joins the decoding threads at exit.
+struct LoaderState {
+    std::mutex mutex;                       // Protects everything below
+    std::condition_variable workAvailable;
+    std::map<std::string, std::shared_ptr<ImageData> > cache;
+    std::deque<std::shared_ptr<ImageData> > queue;
+    std::vector<std::thread> workers;
+    size_t cacheLimit, cacheBytes;
+    unsigned long clock;
+    bool stopping;
+
+    LoaderState() : cacheLimit(256 << 20), cacheBytes(0), clock(0), stopping(false) {}
+
+    ~LoaderState() {
+        mutex.lock();
+        stopping = true;
+        mutex.unlock();
+        workAvailable.notify_all();
+        for (unsigned i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+};
+
+LoaderState& loader() {
+    static LoaderState state;
+    return state;
+}
+
+}
+
+/*!
+ * \brief Constructs an ImageData for a file that has not been decoded yet.
+ */
+ImageData::ImageData(const std::string& filename) : myFile(filename), myPixels(0), myWidth(0), myHeight(0),
+  myState(QUEUED), myLastUsed(0) {}
+
+/*!
+ * \brief Blocks the calling thread until the file has been decoded, or has failed to decode.
+ */
+void ImageData::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    while (myState != READY && myState != FAILED)
+        stateChanged.wait(lock);
+}
+
+/*!
+ * \brief Frees the decoded pixels.
+ */
+ImageData::~ImageData() {
+    if (myPixels)
+        stbi_image_free(myPixels);
+}
+
+/*!
+ * \brief Finds a file's entry in the cache, or adds one.
+ *   \param filename The file to find.
+ *   \param queue Whether a new entry should be queued for a decoding thread.
+ * \return The file's entry.
+ */
+std::shared_ptr<ImageData> ImageLoader::request(const std::string& filename, bool queue) {
+    LoaderState& state = loader();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::shared_ptr<ImageData>& entry = state.cache[filename];
+    if (!entry) {
+        entry.reset(new ImageData(filename));
+        if (queue) {
+            if (state.workers.empty()) {
+                unsigned threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+                for (unsigned i = 0; i < threads; ++i)
+                    state.workers.push_back(std::thread(work));
+            }
+            state.queue.push_back(entry);
+            state.workAvailable.notify_one();
+        }
+    }
+    entry->myLastUsed = ++state.clock;
+    return entry;
+}
+
+/*!
+ * \brief Decodes a file on the calling thread and wakes anyone waiting for it.
+ * \details The caller must have moved the file's state to DECODING.
+ */
+void ImageLoader::decode(const std::shared_ptr<ImageData>& data) {
+    int w = 0, h = 0;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char * pixels = stbi_load(data->myFile.c_str(), &w, &h, 0, 4);
+    if (!pixels)
+        TsglErr("Could not load the image file " + data->myFile + ".");
+
+    data->stateMutex.lock();
+    data->myPixels = pixels;
+    data->myWidth = w;
+    data->myHeight = h;
+    data->myState = pixels ? ImageData::READY : ImageData::FAILED;
+    data->stateMutex.unlock();
+    data->stateChanged.notify_all();
+
+    LoaderState& state = loader();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::map<std::string, std::shared_ptr<ImageData> >::iterator it = state.cache.find(data->myFile);
+    if (it == state.cache.end() || it->second != data)
+        return;                             // Dropped by clearCache() while decoding
+    if (pixels) {
+        state.cacheBytes += (size_t) w * h * 4;
+        evict();
+    } else {
+        state.cache.erase(it);              // So that a later request tries the file again
+    }
+}
+
+/*!
+ * \brief Body of each decoding thread: takes queued files until the program exits.
+ */
+void ImageLoader::work() {
+    LoaderState& state = loader();
+    while (true) {
+        std::shared_ptr<ImageData> data;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            while (state.queue.empty() && !state.stopping)
+                state.workAvailable.wait(lock);
+            if (state.stopping)
+                return;
+            data = state.queue.front();
+            state.queue.pop_front();
+        }
+        int expected = ImageData::QUEUED;
+        if (data->myState.compare_exchange_strong(expected, ImageData::DECODING))
+            decode(data);                   // Otherwise loadNow() already took it
+    }
+}
+
+/*!
+ * \brief Drops the least recently requested unused files until the cache fits its limit.
+ * \details The caller must hold the loader's lock.
+ */
+void ImageLoader::evict() {
+    LoaderState& state = loader();
+    while (state.cacheBytes > state.cacheLimit) {
+        std::map<std::string, std::shared_ptr<ImageData> >::iterator oldest = state.cache.end();
+        for (std::map<std::string, std::shared_ptr<ImageData> >::iterator it = state.cache.begin();
+             it != state.cache.end(); ++it) {
+            if (it->second.use_count() == 1 && it->second->isReady() &&
+                (oldest == state.cache.end() || it->second->myLastUsed < oldest->second->myLastUsed))
+                oldest = it;
+        }
+        if (oldest == state.cache.end())
+            return;                         // Everything left is in use
+        state.cacheBytes -= (size_t) oldest->second->myWidth * oldest->second->myHeight * 4;
+        state.cache.erase(oldest);
+    }
+}
+
+/*!
+ * \brief Starts decoding an image file in the background.
+ * \details Returns at once. If the file is already cached, or already being decoded for another caller,
+ *   the existing ImageData is returned instead of decoding the file again.
+ *   \param filename The image file to load (.png, .bmp or .jpg).
+ * \return The ImageData that will hold the file's pixels. Check ImageData::isReady(), or call
+ *   ImageData::wait().
+ */
+std::shared_ptr<ImageData> ImageLoader::load(const std::string& filename) {
+    return request(filename, true);
+}
+
+/*!
+ * \brief Loads an image file, returning once it is decoded.
+ * \details Uses the cached pixels if there are any. If the file is still waiting in the queue, it is
+ *   decoded on the calling thread instead of waiting for a decoding thread to get to it.
+ *   \param filename The image file to load (.png, .bmp or .jpg).
+ * \return The file's ImageData, which is either ready or has failed.
+ */
+std::shared_ptr<ImageData> ImageLoader::loadNow(const std::string& filename) {
+    std::shared_ptr<ImageData> data = request(filename, false);
+    int expected = ImageData::QUEUED;
+    if (data->myState.compare_exchange_strong(expected, ImageData::DECODING))
+        decode(data);
+    else
+        data->wait();
+    return data;
+}
+
+/*!
+ * \brief Queues a list of image files to be decoded in the background.
+ * \details Files that are already cached or queued are skipped.
+ *   \param filenames The image files to load.
+ */
+void ImageLoader::prefetch(const std::vector<std::string>& filenames) {
+    for (unsigned i = 0; i < filenames.size(); ++i)
+        request(filenames[i], true);
+}
+
+/*!
+ * \brief Mutator for the most memory the cache keeps for files that no Image is using.
+ * \details Files in use are never dropped, even if they alone exceed the limit.
+ *   \param bytes The new limit, in bytes of decoded pixels (256 MB by default).
+ */
+void ImageLoader::setCacheLimit(size_t bytes) {
+    LoaderState& state = loader();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.cacheLimit = bytes;
+    evict();
+}
+
+/*!
+ * \brief Drops every decoded file that no Image is using.
+ */
+void ImageLoader::clearCache() {
+    LoaderState& state = loader();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::map<std::string, std::shared_ptr<ImageData> >::iterator it = state.cache.begin();
+    while (it != state.cache.end()) {
+        if (it->second.use_count() == 1 && it->second->isReady()) {
+            state.cacheBytes -= (size_t) it->second->myWidth * it->second->myHeight * 4;
+            state.cache.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
@@ -0,0 +1,118 @@
+/*
+ * ImageLoader.h provides a shared cache of decoded image files, filled by a small pool of decoding threads.
+ */
+
+#ifndef IMAGELOADER_H_
+#define IMAGELOADER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tsgl {
+
+/*! \class ImageData
+ *  \brief The decoded pixels of one image file, shared by every Image that draws it.
+ *  \details ImageData objects are created only by ImageLoader. The pixels are RGBA8, 4 bytes per pixel, with row
+ *    0 at the bottom of the image, ready to be uploaded as a texture. They are immutable once ready, so any
+ *    number of threads may read them.
+ */
+class ImageData {
+    friend class ImageLoader;
+ private:
+    enum State { QUEUED, DECODING, READY, FAILED };
+
+    std::string myFile;
+    unsigned char * myPixels;
+    int myWidth, myHeight;
+    std::atomic<int> myState;
+    unsigned long myLastUsed;          // For evicting the least recently used files first
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+
+    ImageData(const std::string& filename);
+    ImageData(const ImageData&);
+    ImageData& operator=(const ImageData&);
+ public:
+    /*!
+     * \brief Accessor for whether the file has been decoded.
+     */
+    bool isReady() const { return myState == READY; }
+
+    /*!
+     * \brief Accessor for whether the file failed to decode.
+     */
+    bool hasFailed() const { return myState == FAILED; }
+
+    void wait();
+
+    /*!
+     * \brief Accessor for the decoded pixels, or 0 if the file is not ready.
+     */
+    const unsigned char * getPixels() const { return isReady() ? myPixels : 0; }
+
+    /*!
+     * \brief Accessor for the width of the image in pixels, or 0 if the file is not ready.
+     */
+    int getWidth() const { return isReady() ? myWidth : 0; }
+
+    /*!
+     * \brief Accessor for the height of the image in pixels, or 0 if the file is not ready.
+     */
+    int getHeight() const { return isReady() ? myHeight : 0; }
+
+    /*!
+     * \brief Accessor for the name of the file the pixels come from.
+     */
+    const std::string& getFile() const { return myFile; }
+
+    ~ImageData();
+};
+
+/*! \class ImageLoader
+ *  \brief Decodes image files in the background and shares the results.
+ *  \details Decoding a large PNG or JPEG takes tens of milliseconds. ImageLoader moves that work off the calling
+ *    thread onto a small pool of decoding threads, and keeps the decoded pixels in a cache keyed by file name:
+ *    - load() returns at once. Every request for the same file, from any thread and whether or not the first
+ *      request has finished, gets the same ImageData, so a file is decoded at most once while it is cached.
+ *    - loadNow() returns only once the file is decoded, decoding it on the calling thread if no decoding
+ *      thread has started on it yet.
+ *    - prefetch() queues a list of files, for example the next slides of a slideshow.
+ *    .
+ *  \details The cache keeps files that are no longer used by any Image until it grows beyond its limit (see
+ *    setCacheLimit()), then drops the least recently requested ones.
+ *  \details Image::loadAsync() creates an Image that draws a placeholder until its file is ready. The Image
+ *    constructor and Background::drawImage() use loadNow(), so they also share the cache.
+ */
+class ImageLoader {
+ public:
+    static std::shared_ptr<ImageData> load(const std::string& filename);
+
+    static std::shared_ptr<ImageData> loadNow(const std::string& filename);
+
+    static void prefetch(const std::vector<std::string>& filenames);
+
+    static void setCacheLimit(size_t bytes);
+
+    static void clearCache();
+ private:
+    static std::shared_ptr<ImageData> request(const std::string& filename, bool queue);
+
+    static void decode(const std::shared_ptr<ImageData>& data);
+
+    static void work();
+
+    static void evict();
+
+    ImageLoader();
+    ~ImageLoader();
+    ImageLoader(const ImageLoader&);
+    ImageLoader& operator=(const ImageLoader&);
+};
+
+}
+
+#endif /* IMAGELOADER_H_ */
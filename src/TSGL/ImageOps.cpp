@@ -0,0 +1,328 @@
+#include "ImageOps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <omp.h>
+
+namespace tsgl {
+
+// The number of threads a filter should run with
+static int teamSize(unsigned threads) {
+    return threads ? (int) threads : omp_get_max_threads();
+}
+
+// Writes the red, green and blue bytes of a row from rounded floats, clamped to 0-255
+static inline void storeRow(uint8_t* row, const float* values, int w) {
+    for (int x = 0; x < w; ++x) {
+        for (int c = 0; c < 3; ++c) {
+            const float v = values[4 * x + c] + 0.5f;
+            row[4 * x + c] = (uint8_t) (v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v));
+        }
+    }
+}
+
+/*!
+ * \brief Copies the Background's last rendered frame into an array of RGBA8 pixels.
+ * \details The copy is taken with one call to Background::getPixels(), so it is one whole frame.
+ *   \param bg The Background to copy.
+ *   \param rgba Vector to hold the pixels. It is resized to <code>4 * bg->getWidth() * bg->getHeight()</code>
+ *     bytes, with row 0 at the top of the Background. Every alpha byte is 255.
+ */
+void ImageOps::snapshot(Background* bg, std::vector<uint8_t>& rgba) {
+    const int w = bg->getWidth(), h = bg->getHeight();
+    rgba.resize((size_t) w * h * 4);
+    bg->Background::getPixels(-w / 2, h - 1 - h / 2, w, h, &rgba[0]);
+}
+
+/*!
+ * \brief Draws an array of RGBA8 pixels over the whole Background.
+ * \details The pixels appear on the next frame, as with Background::drawPixels().
+ *   \param bg The Background to draw to.
+ *   \param rgba Array of <code>4 * bg->getWidth() * bg->getHeight()</code> bytes, laid out as by snapshot().
+ */
+void ImageOps::upload(Background* bg, const uint8_t* rgba) {
+    const int w = bg->getWidth(), h = bg->getHeight();
+    bg->Background::drawPixels(-w / 2, h - 1 - h / 2, w, h, rgba);
+}
+
+/*!
+ * \brief Replaces each pixel's color with the average of its red, green and blue components.
+ *   \param rgba The image to change.
+ *   \param w Width of the image in pixels.
+ *   \param h Height of the image in pixels.
+ *   \param stride Bytes from one row to the next (set to 0, for packed rows, by default).
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ */
+void ImageOps::greyscale(uint8_t* rgba, int w, int h, int stride, unsigned threads) {
+    if (stride <= 0) stride = 4 * w;
+    #pragma omp parallel for num_threads(teamSize(threads))
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = rgba + (size_t) y * stride;
+        for (int x = 0; x < w; ++x) {
+            const uint8_t grey = (row[4 * x] + row[4 * x + 1] + row[4 * x + 2]) / 3;
+            row[4 * x] = row[4 * x + 1] = row[4 * x + 2] = grey;
+        }
+    }
+}
+
+/*!
+ * \brief Replaces each red, green and blue component <code>c</code> with <code>255 - c</code>.
+ *   \param rgba The image to change.
+ *   \param w Width of the image in pixels.
+ *   \param h Height of the image in pixels.
+ *   \param stride Bytes from one row to the next (set to 0, for packed rows, by default).
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ */
+void ImageOps::invert(uint8_t* rgba, int w, int h, int stride, unsigned threads) {
+    if (stride <= 0) stride = 4 * w;
+    static const uint8_t mask[4] = { 255, 255, 255, 0 };
+    #pragma omp parallel for num_threads(teamSize(threads))
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = rgba + (size_t) y * stride;
+        for (int i = 0; i < 4 * w; ++i)
+            row[i] ^= mask[i & 3];
+    }
+}
+
+/*!
+ * \brief Blurs an image by averaging each pixel with the pixels in a square around it.
+ * \details Runs a sliding sum along each row and then down each column, so every pixel costs the same
+ *   no matter how large the radius is. Pixels beyond the edges repeat the nearest edge pixel.
+ *   \param rgba The image to blur.
+ *   \param w Width of the image in pixels.
+ *   \param h Height of the image in pixels.
+ *   \param radius Half the side of the square, not counting the center pixel. Nothing happens if it is 0.
+ *   \param stride Bytes from one row to the next (set to 0, for packed rows, by default).
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ */
+void ImageOps::boxBlur(uint8_t* rgba, int w, int h, int radius, int stride, unsigned threads) {
+    if (radius <= 0 || w <= 0 || h <= 0)
+        return;
+    if (stride <= 0) stride = 4 * w;
+    const size_t rowLength = 4 * (size_t) w;
+    std::vector<uint32_t> sums(rowLength * h);      // Sums along each row, before dividing
+    const float scale = 1.0f / ((2 * radius + 1) * (2 * radius + 1));
+
+    #pragma omp parallel num_threads(teamSize(threads))
+    {
+        #pragma omp for
+        for (int y = 0; y < h; ++y) {
+            const uint8_t* in = rgba + (size_t) y * stride;
+            uint32_t* out = &sums[y * rowLength];
+            uint32_t s[4];
+            for (int c = 0; c < 4; ++c) {
+                s[c] = (radius + 1) * in[c];
+                for (int k = 1; k <= radius; ++k)
+                    s[c] += in[4 * std::min(k, w - 1) + c];
+            }
+            for (int x = 0; x < w; ++x) {
+                const uint8_t* enter = in + 4 * std::min(x + radius + 1, w - 1);
+                const uint8_t* leave = in + 4 * std::max(x - radius, 0);
+                for (int c = 0; c < 4; ++c) {
+                    out[4 * x + c] = s[c];
+                    s[c] += enter[c] - leave[c];
+                }
+            }
+        }
+
+        // Each thread slides its own column sums down its own band of rows
+        const int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        const int first = h * tid / nthreads, last = h * (tid + 1) / nthreads;
+        if (first < last) {
+            std::vector<uint32_t> column(rowLength, 0);
+            std::vector<float> values(rowLength);
+            for (int k = first - radius; k <= first + radius; ++k) {
+                const uint32_t* in = &sums[std::min(std::max(k, 0), h - 1) * rowLength];
+                for (size_t i = 0; i < rowLength; ++i)
+                    column[i] += in[i];
+            }
+            for (int y = first; y < last; ++y) {
+                for (size_t i = 0; i < rowLength; ++i)
+                    values[i] = column[i] * scale;
+                storeRow(rgba + (size_t) y * stride, &values[0], w);
+                const uint32_t* enter = &sums[std::min(y + radius + 1, h - 1) * rowLength];
+                const uint32_t* leave = &sums[std::max(y - radius, 0) * rowLength];
+                for (size_t i = 0; i < rowLength; ++i)
+                    column[i] += enter[i] - leave[i];
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Blurs an image with a Gaussian kernel.
+ * \details The kernel is applied along the rows and then down the columns, and extends three standard
+ *   deviations each way. Pixels beyond the edges repeat the nearest edge pixel.
+ *   \param rgba The image to blur.
+ *   \param w Width of the image in pixels.
+ *   \param h Height of the image in pixels.
+ *   \param sigma Standard deviation of the kernel, in pixels. Nothing happens if it is not positive.
+ *   \param stride Bytes from one row to the next (set to 0, for packed rows, by default).
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ */
+void ImageOps::gaussianBlur(uint8_t* rgba, int w, int h, float sigma, int stride, unsigned threads) {
+    if (sigma <= 0.0f || w <= 0 || h <= 0)
+        return;
+    if (stride <= 0) stride = 4 * w;
+    const int radius = (int) ceil(3 * sigma);
+    std::vector<float> weights(2 * radius + 1);
+    float total = 0.0f;
+    for (int k = -radius; k <= radius; ++k)
+        total += weights[k + radius] = exp(-(k * k) / (2 * sigma * sigma));
+    for (size_t k = 0; k < weights.size(); ++k)
+        weights[k] /= total;
+
+    const size_t rowLength = 4 * (size_t) w;
+    std::vector<float> rows(rowLength * h);         // The image after blurring along the rows
+
+    #pragma omp parallel num_threads(teamSize(threads))
+    {
+        std::vector<float> padded(rowLength + 8 * radius);
+        #pragma omp for
+        for (int y = 0; y < h; ++y) {
+            const uint8_t* in = rgba + (size_t) y * stride;
+            for (int x = -radius; x < w + radius; ++x) {
+                const uint8_t* p = in + 4 * std::min(std::max(x, 0), w - 1);
+                for (int c = 0; c < 4; ++c)
+                    padded[4 * (x + radius) + c] = p[c];
+            }
+            float* out = &rows[y * rowLength];
+            std::fill(out, out + rowLength, 0.0f);
+            for (int k = 0; k <= 2 * radius; ++k) {
+                const float wk = weights[k];
+                const float* src = &padded[4 * k];
+                for (size_t i = 0; i < rowLength; ++i)
+                    out[i] += wk * src[i];
+            }
+        }
+
+        std::vector<float> values(rowLength);
+        #pragma omp for
+        for (int y = 0; y < h; ++y) {
+            std::fill(values.begin(), values.end(), 0.0f);
+            for (int k = -radius; k <= radius; ++k) {
+                const float wk = weights[k + radius];
+                const float* src = &rows[std::min(std::max(y + k, 0), h - 1) * rowLength];
+                for (size_t i = 0; i < rowLength; ++i)
+                    values[i] += wk * src[i];
+            }
+            storeRow(rgba + (size_t) y * stride, &values[0], w);
+        }
+    }
+}
+
+/*!
+ * \brief Replaces each pixel with a weighted sum of the pixels around it.
+ * \details The kernel is centered on each pixel, with its element <code>(kw / 2, kh / 2)</code> over the pixel
+ *   itself, and is not flipped. Results are rounded and clamped to 0-255, so kernels with negative weights
+ *   (edge detectors, for example) lose their negative responses. Pixels beyond the edges repeat the nearest
+ *   edge pixel. For blurs, boxBlur() and gaussianBlur() are much faster.
+ *   \param rgba The image to change.
+ *   \param w Width of the image in pixels.
+ *   \param h Height of the image in pixels.
+ *   \param kernel Array of <code>kw * kh</code> weights, one row of the kernel after another.
+ *   \param kw Width of the kernel.
+ *   \param kh Height of the kernel.
+ *   \param stride Bytes from one row to the next (set to 0, for packed rows, by default).
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ */
+void ImageOps::convolve(uint8_t* rgba, int w, int h, const float* kernel, int kw, int kh,
+                        int stride, unsigned threads) {
+    if (!kernel || kw <= 0 || kh <= 0 || w <= 0 || h <= 0) {
+        TsglDebug("Cannot convolve with an empty kernel or image.");
+        return;
+    }
+    if (stride <= 0) stride = 4 * w;
+    const size_t rowLength = 4 * (size_t) w;
+    std::vector<uint8_t> source(rowLength * h);     // Unchanged copy, since the filter works in place
+    for (int y = 0; y < h; ++y)
+        memcpy(&source[y * rowLength], rgba + (size_t) y * stride, rowLength);
+
+    #pragma omp parallel num_threads(teamSize(threads))
+    {
+        std::vector<float> padded(rowLength + 4 * (kw - 1));
+        std::vector<float> values(rowLength);
+        #pragma omp for
+        for (int y = 0; y < h; ++y) {
+            std::fill(values.begin(), values.end(), 0.0f);
+            for (int j = 0; j < kh; ++j) {
+                const uint8_t* in = &source[std::min(std::max(y + j - kh / 2, 0), h - 1) * rowLength];
+                for (int x = -(kw / 2); x < w + kw - 1 - kw / 2; ++x) {
+                    const uint8_t* p = in + 4 * std::min(std::max(x, 0), w - 1);
+                    for (int c = 0; c < 4; ++c)
+                        padded[4 * (x + kw / 2) + c] = p[c];
+                }
+                for (int i = 0; i < kw; ++i) {
+                    const float k = kernel[j * kw + i];
+                    const float* src = &padded[4 * i];
+                    for (size_t n = 0; n < rowLength; ++n)
+                        values[n] += k * src[n];
+                }
+            }
+            storeRow(rgba + (size_t) y * stride, &values[0], w);
+        }
+    }
+}
+
+/*!
+ * \brief Finds the Manhattan (city block) distance from every cell of a grid to the nearest marked cell.
+ * \details Works in two exact passes: down each column (across many columns at once) and then along each
+ *   row, so its cost is a small constant per cell however far apart the marked cells are.
+ *   \param mask Array of <code>w * h</code> bytes, one row after another. Nonzero bytes mark the cells
+ *     to measure from.
+ *   \param w Width of the grid.
+ *   \param h Height of the grid.
+ *   \param distance Array to receive <code>w * h</code> distances, laid out like <code>mask</code>. Marked
+ *     cells get 0; if no cell is marked, every cell gets -1.
+ *   \param threads Number of threads to use (set to 0, for OpenMP's default, by default).
+ * \return The largest distance in the grid, or -1 if no cell is marked.
+ */
+int ImageOps::distanceTransform(const uint8_t* mask, int w, int h, int* distance, unsigned threads) {
+    if (w <= 0 || h <= 0)
+        return -1;
+    const int far = w + h;      // Farther than any real distance
+    int maxDistance = 0;
+
+    #pragma omp parallel num_threads(teamSize(threads)) reduction(max:maxDistance)
+    {
+        // Down and then up each column, for a band of columns per thread
+        const int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        const int first = w * tid / nthreads, last = w * (tid + 1) / nthreads;
+        for (int x = first; x < last; ++x)
+            distance[x] = mask[x] ? 0 : far;
+        for (int y = 1; y < h; ++y) {
+            const uint8_t* m = mask + (size_t) y * w;
+            int* d = distance + (size_t) y * w;
+            const int* above = d - w;
+            for (int x = first; x < last; ++x)
+                d[x] = m[x] ? 0 : std::min(above[x] + 1, far);
+        }
+        for (int y = h - 2; y >= 0; --y) {
+            int* d = distance + (size_t) y * w;
+            const int* below = d + w;
+            for (int x = first; x < last; ++x)
+                d[x] = std::min(d[x], below[x] + 1);
+        }
+        #pragma omp barrier
+
+        // Right and then left along each row
+        #pragma omp for
+        for (int y = 0; y < h; ++y) {
+            int* d = distance + (size_t) y * w;
+            for (int x = 1; x < w; ++x)
+                d[x] = std::min(d[x], d[x - 1] + 1);
+            for (int x = w - 2; x >= 0; --x)
+                d[x] = std::min(d[x], d[x + 1] + 1);
+            for (int x = 0; x < w; ++x)
+                maxDistance = std::max(maxDistance, d[x]);
+        }
+    }
+
+    if (maxDistance < far)
+        return maxDistance;
+    std::fill(distance, distance + (size_t) w * h, -1);
+    return -1;
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * ImageOps.h provides parallel filters for whole images of RGBA8 pixels, such as snapshots of a Background.
+ */
+
+#ifndef IMAGEOPS_H_
+#define IMAGEOPS_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "Background.h"     // For reading and writing whole Backgrounds
+
+namespace tsgl {
+
+/*! \class ImageOps
+ *  \brief Image filters that work on a whole block of pixels at once.
+ *  \details ImageOps replaces loops of Background::getPixel() and Background::drawPixel() calls, which lock a
+ *    mutex and convert a color for every pixel, with three steps:
+ *    - snapshot() copies the Background's last rendered frame into a plain array of RGBA8 pixels.
+ *    - The filters below modify that array in place.
+ *    - upload() writes the array back to the Background in one call to Background::drawPixels().
+ *    .
+ *  \details Images are arrays of rows of 4-byte R, G, B, A pixels, with row 0 at the top. <code>stride</code>
+ *    is the number of bytes from the start of one row to the start of the next; 0 means the rows are packed
+ *    (<code>4 * w</code>). Filters change the red, green and blue bytes and leave alpha alone.
+ *  \details Each filter splits the image into bands of rows, one per thread, and its inner loops run along whole
+ *    rows without branches so that the compiler can vectorize them. Blurs run as two separable passes, one
+ *    along rows and one down columns, so their cost grows with the radius rather than its square.
+ *  \details <code>threads</code> is the number of OpenMP threads to use; 0 (the default) uses OpenMP's default.
+ */
+class ImageOps {
+ public:
+    static void snapshot(Background* bg, std::vector<uint8_t>& rgba);
+
+    static void upload(Background* bg, const uint8_t* rgba);
+
+    static void greyscale(uint8_t* rgba, int w, int h, int stride = 0, unsigned threads = 0);
+
+    static void invert(uint8_t* rgba, int w, int h, int stride = 0, unsigned threads = 0);
+
+    static void boxBlur(uint8_t* rgba, int w, int h, int radius, int stride = 0, unsigned threads = 0);
+
+    static void gaussianBlur(uint8_t* rgba, int w, int h, float sigma, int stride = 0, unsigned threads = 0);
+
+    static void convolve(uint8_t* rgba, int w, int h, const float* kernel, int kw, int kh,
+                         int stride = 0, unsigned threads = 0);
+
+    static int distanceTransform(const uint8_t* mask, int w, int h, int* distance, unsigned threads = 0);
+
+ private:
+    ImageOps();
+    ~ImageOps();
+    ImageOps(const ImageOps&);
+    ImageOps& operator=(const ImageOps&);
+};
+
+}
+
+#endif /* IMAGEOPS_H_ */
@@ -0,0 +1,81 @@
+#include "InputQueue.h"
+
+namespace tsgl {
+
+/*!
+ * \brief Constructs a new, empty InputQueue.
+ */
+InputQueue::InputQueue() {
+    mySlots = new Slot[CAPACITY];
+    for (size_t i = 0; i < CAPACITY; ++i)
+        mySlots[i].sequence.store(i, std::memory_order_relaxed);
+    myPushPosition.store(0, std::memory_order_relaxed);
+    myPopPosition.store(0, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Adds an event to the back of the queue.
+ *   \param event The event.
+ * \return True if the event was queued, false if the queue was full.
+ */
+bool InputQueue::push(const InputEvent& event) {
+    size_t position = myPushPosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = mySlots[position & (CAPACITY - 1)];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const ptrdiff_t difference = (ptrdiff_t) sequence - (ptrdiff_t) position;
+        if (difference == 0) {
+            if (myPushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.event = event;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;               // The slot still holds an event from the last time around
+        } else {
+            position = myPushPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/*!
+ * \brief Takes the event at the front of the queue.
+ *   \param event Set to the event taken.
+ * \return True if an event was taken, false if the queue was empty.
+ */
+bool InputQueue::pop(InputEvent& event) {
+    size_t position = myPopPosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = mySlots[position & (CAPACITY - 1)];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const ptrdiff_t difference = (ptrdiff_t) sequence - (ptrdiff_t) (position + 1);
+        if (difference == 0) {
+            if (myPopPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                event = slot.event;
+                slot.sequence.store(position + CAPACITY, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;               // The slot has not been written yet
+        } else {
+            position = myPopPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/*!
+ * \brief Whether the queue held no events at the moment it was checked.
+ */
+bool InputQueue::empty() const {
+    const size_t position = myPopPosition.load(std::memory_order_relaxed);
+    return mySlots[position & (CAPACITY - 1)].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+/*!
+ * \brief Destroys the InputQueue, discarding any events left in it.
+ */
+InputQueue::~InputQueue() {
+    delete [] mySlots;
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * InputQueue.h provides a lock-free queue of timestamped keyboard and mouse events.
+ */
+
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <atomic>
+#include <stddef.h>
+
+namespace tsgl {
+
+/*!
+ * \brief The kinds of InputEvent.
+ */
+enum InputEventType {
+    BUTTON_EVENT,       //!< A key or mouse button was pressed or released
+    SCROLL_EVENT,       //!< The mouse wheel was scrolled
+    MOUSE_MOVE_EVENT    //!< The mouse moved
+};
+
+/*!
+ * \brief A keyboard or mouse event, as queued by a Canvas.
+ */
+struct InputEvent {
+    InputEventType type;
+    int button;         //!< The key or mouse button, as in Keynums.h (BUTTON_EVENT only)
+    int action;         //!< TSGL_PRESS or TSGL_RELEASE (BUTTON_EVENT only)
+    int mods;           //!< Modifier keys held down, as a GLFW bit field (BUTTON_EVENT only)
+    double x, y;        //!< Scroll offsets, or the mouse's position in window pixels from the top left
+    double time;        //!< When the event happened, in seconds since GLFW was initialized
+};
+
+/*!
+ * \brief Which thread a Canvas runs its input handlers on. See Canvas::setInputDispatch().
+ */
+enum InputDispatch {
+    DISPATCH_THREAD,    //!< A thread of the Canvas' own, as soon as each event arrives
+    DISPATCH_POLL       //!< Whichever thread calls Canvas::pollEvents(), when it does
+};
+
+/*! \class InputQueue
+ *  \brief A bounded queue of InputEvents that never takes a lock.
+ *  \details Any number of threads may push and pop at once. Each slot carries a sequence number telling
+ *   whether it is ready to be written or read, so pushing or popping is a compare-and-swap on a shared
+ *   position and one store.
+ *  \details The queue holds CAPACITY events. Pushing to a full queue fails rather than waits, so that the
+ *   thread receiving input from the operating system is never held up by a slow consumer.
+ */
+class InputQueue {
+ private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        InputEvent event;
+    };
+
+    Slot * mySlots;
+    std::atomic<size_t> myPushPosition, myPopPosition;
+
+    InputQueue(const InputQueue&);
+    InputQueue& operator=(const InputQueue&);
+ public:
+    static const size_t CAPACITY = 1024;
+
+    InputQueue();
+
+    bool push(const InputEvent& event);
+
+    bool pop(InputEvent& event);
+
+    bool empty() const;
+
+    ~InputQueue();
+};
+
+}
+
+#endif /* INPUTQUEUE_H_ */
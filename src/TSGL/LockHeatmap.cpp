@@ -0,0 +1,148 @@
+#include "LockHeatmap.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace tsgl {
+
+ /*!
+  * \brief Explicitly constructs a new LockHeatmap.
+  * \details This is the explicit constructor for the LockHeatmap class.
+  *   \param x The x coordinate of the center of the LockHeatmap.
+  *   \param y The y coordinate of the center of the LockHeatmap.
+  *   \param z The z coordinate of the center of the LockHeatmap.
+  *   \param columns The number of sampling intervals shown across the heatmap.
+  *   \param rows The number of locks shown; locks profiled after the first <code>rows</code> are left out.
+  *   \param width The width of the LockHeatmap.
+  *   \param height The height of the LockHeatmap.
+  *   \param yaw The yaw orientation of the LockHeatmap.
+  *   \param pitch The pitch orientation of the LockHeatmap.
+  *   \param roll The roll orientation of the LockHeatmap.
+  *   \param metric What to show for each lock (set to LOCK_WAIT_TIME by default).
+  * \return A new, empty LockHeatmap that samples every tenth of a second, colored from black through red and
+  *   yellow to white.
+  */
+LockHeatmap::LockHeatmap(float x, float y, float z, int columns, int rows, GLfloat width, GLfloat height,
+                         float yaw, float pitch, float roll, LockHeatmapMetric metric)
+  : ScalarField(x, y, z, columns, rows, width, height, yaw, pitch, roll, FLOAT_FIELD) {
+    myMetric = metric;
+    myInterval = 0.1;
+    myLastSample = -1;
+    if (!init)
+        return;
+    myHistory.assign((size_t) columns * rows, 0.0f);
+    const ColorFloat stops[] = { BLACK, RED, YELLOW, WHITE };
+    setColormap(Colormap(stops, 4));
+}
+
+/*!
+ * \brief Adds a column for the interval since the last sample, and shifts the older ones left.
+ * \details The first sample only sets the starting point.
+ *   \param now The time of the sample, in seconds.
+ */
+void LockHeatmap::sample(double now) {
+    std::vector<LockStats> stats = LockProfiler::getStats();
+    const double elapsed = now - myLastSample;
+    const bool first = myLastSample < 0;
+    myLastSample = now;
+    attribMutex.lock();
+    const LockHeatmapMetric metric = myMetric;
+    myNames.clear();
+    for (unsigned i = 0; i < stats.size() && (int) i < getRows(); ++i)
+        myNames.push_back(stats[i].name);
+    attribMutex.unlock();
+    if (first) {
+        myLastStats.swap(stats);
+        return;
+    }
+
+    const int columns = getColumns(), rows = getRows();
+    for (int r = 0; r < rows; ++r) {
+        float* row = &myHistory[(size_t) r * columns];
+        std::copy(row + 1, row + columns, row);
+        float value = 0;
+        if (r < (int) stats.size()) {
+            const LockStats& s = stats[r];
+            double wait = s.waitTime, hold = s.holdTime;
+            double acquired = (double) s.acquisitions + s.sharedAcquisitions, contended = (double) s.contended;
+            if (r < (int) myLastStats.size()) {
+                const LockStats& p = myLastStats[r];
+                wait -= p.waitTime;
+                hold -= p.holdTime;
+                acquired -= (double) p.acquisitions + p.sharedAcquisitions;
+                contended -= (double) p.contended;
+            }
+            if (metric == LOCK_WAIT_TIME)
+                value = wait / elapsed;
+            else if (metric == LOCK_HOLD_TIME)
+                value = hold / elapsed;
+            else
+                value = (acquired > 0) ? contended / acquired : 0;
+            value = std::max(value, 0.0f);          // After LockProfiler::reset()
+        }
+        row[columns - 1] = value;
+    }
+    myLastStats.swap(stats);
+    setValues(0, 0, columns, rows, &myHistory[0]);
+}
+
+ /*!
+  * \brief Draw the LockHeatmap.
+  * \details This function actually draws the LockHeatmap to the Canvas.
+  * \details Takes a sample first if an interval has passed since the last, then draws the heatmap as a
+  *   ScalarField.
+  *   \param shader The Canvas' texture shader.
+  */
+void LockHeatmap::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+    attribMutex.lock();
+    const double interval = myInterval;
+    attribMutex.unlock();
+    const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (myLastSample < 0 || now - myLastSample >= interval)
+        sample(now);
+    ScalarField::draw(shader);
+}
+
+/*!
+ * \brief Mutates what the heatmap shows for each lock, from the next column on.
+ * \details Consider setRange() too: wait and hold times can go above 1 when several threads wait or read at once.
+ *   \param metric The new metric.
+ */
+void LockHeatmap::setMetric(LockHeatmapMetric metric) {
+    attribMutex.lock();
+    myMetric = metric;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the number of seconds each column covers.
+ * \details Sampling happens when the Canvas draws, so intervals shorter than a frame act as one frame.
+ *   \param seconds The new interval.
+ */
+void LockHeatmap::setInterval(double seconds) {
+    if (seconds <= 0) {
+        TsglDebug("Cannot have a LockHeatmap with an interval of 0 seconds or less.");
+        return;
+    }
+    attribMutex.lock();
+    myInterval = seconds;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Accessor for the name of the lock shown in a row, for labeling it.
+ *   \param row The row, 0 being the top.
+ * \return The name, or an empty string if no lock is shown in the row yet.
+ */
+std::string LockHeatmap::getLockName(int row) {
+    attribMutex.lock();
+    const std::string name = (row >= 0 && row < (int) myNames.size()) ? myNames[row] : "";
+    attribMutex.unlock();
+    return name;
+}
+
+}
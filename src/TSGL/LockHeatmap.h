@@ -0,0 +1,76 @@
+/*
+ * LockHeatmap.h extends ScalarField and provides a class for drawing how contended the profiled locks are.
+ */
+
+#ifndef LOCKHEATMAP_H_
+#define LOCKHEATMAP_H_
+
+#include <string>
+#include <vector>
+
+#include "ProfiledMutex.h"      // For the statistics we draw
+#include "ScalarField.h"        // For extending our ScalarField object
+
+namespace tsgl {
+
+/*!
+ * \brief What a LockHeatmap shows for each lock.
+ * \details
+ * - LOCK_WAIT_TIME: seconds spent waiting for the lock per second, which is the average number of threads
+ *   waiting for it.
+ * - LOCK_HOLD_TIME: seconds the lock was held per second, which is how busy it is.
+ * - LOCK_CONTENTION: the fraction of acquisitions that had to wait.
+ * .
+ */
+enum LockHeatmapMetric {
+    LOCK_WAIT_TIME, LOCK_HOLD_TIME, LOCK_CONTENTION
+};
+
+/*! \class LockHeatmap
+ *  \brief Draw how hot each profiled lock is, over time, as a scrolling heatmap.
+ *  \details Each row of the heatmap is one name of lock from LockProfiler::getStats(), the first profiled at the
+ *   top, and each column one sampling interval, the newest on the right. A cell's color shows the chosen
+ *   LockHeatmapMetric for that lock over that interval, from the first color of the Colormap for 0 to the last
+ *   for the top of the range (1 by default; see setRange()).
+ *  \details Locks are only counted while LockProfiler is enabled, so turn it on to see anything.
+ *  \details The heatmap samples the statistics when the Canvas draws it, at most once per interval, and shifts
+ *   the whole grid left by a column, so a heatmap of a few hundred columns costs next to nothing.
+ */
+class LockHeatmap : public ScalarField {
+ private:
+    LockHeatmapMetric myMetric;
+    double myInterval;
+    std::vector<std::string> myNames;       // Names of the locks in each row, as of the last sample
+
+    // Used only by the rendering thread
+    double myLastSample;
+    std::vector<float> myHistory;
+    std::vector<LockStats> myLastStats;
+
+    void sample(double now);
+ public:
+    LockHeatmap(float x, float y, float z, int columns, int rows, GLfloat width, GLfloat height,
+                float yaw, float pitch, float roll, LockHeatmapMetric metric = LOCK_WAIT_TIME);
+
+    virtual void draw(Shader * shader);
+
+    void setMetric(LockHeatmapMetric metric);
+
+    void setInterval(double seconds);
+
+    std::string getLockName(int row);
+
+    /*!
+     * \brief Accessor for what the heatmap shows for each lock.
+     */
+    LockHeatmapMetric getMetric() { return myMetric; }
+
+    /*!
+     * \brief Accessor for the number of seconds each column covers.
+     */
+    double getInterval() { return myInterval; }
+};
+
+}
+
+#endif /* LOCKHEATMAP_H_ */
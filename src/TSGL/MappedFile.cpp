@@ -0,0 +1,147 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "Error.h"
+
+namespace tsgl {
+
+/*!
+ * \brief Constructs a MappedFile with no file open.
+ */
+MappedFile::MappedFile() : myData(0), mySize(0) {}
+
+/*!
+ * \brief Maps a whole file into memory, closing any file already open.
+ *   \param filename The file to map.
+ * \return Whether the file was mapped. An error is printed if it was not.
+ */
+bool MappedFile::open(const std::string& filename) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        TsglErr("Could not open the file " + filename + ".");
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            myData = (const uint8_t*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);           // The view keeps the mapping open
+        }
+        mySize = (size_t) size.QuadPart;
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        TsglErr("Could not open the file " + filename + ".");
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        void * map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, file, 0);
+        if (map != MAP_FAILED) {
+            myData = (const uint8_t*) map;
+            mySize = (size_t) info.st_size;
+        }
+    }
+    ::close(file);                          // The mapping keeps the file open
+#endif
+    if (!myData) {
+        TsglErr("Could not map the file " + filename + " into memory.");
+        mySize = 0;
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Unmaps the file, if one is open.
+ */
+void MappedFile::close() {
+    if (!myData)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(myData);
+#else
+    munmap((void*) myData, mySize);
+#endif
+    myData = 0;
+    mySize = 0;
+}
+
+/*!
+ * \brief Asks the operating system to start reading part of the file from disk, without waiting for it.
+ * \details Call this ahead of reading bytes that are likely not in memory yet, so that the read that
+ *   follows does not stall on the disk. It does nothing where the operating system has no such request.
+ *   \param offset The first byte to read ahead.
+ *   \param bytes The number of bytes to read ahead.
+ */
+void MappedFile::prefetch(size_t offset, size_t bytes) const {
+#ifndef _WIN32
+    if (!myData || offset >= mySize)
+        return;
+    if (bytes > mySize - offset)
+        bytes = mySize - offset;
+    static const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t) (myData + offset);
+    const uintptr_t aligned = start & ~(page - 1);
+    posix_madvise((void*) aligned, start - aligned + bytes, POSIX_MADV_WILLNEED);
+#endif
+}
+
+/*!
+ * \brief Tells whether part of the file is in memory, so that reading it will not wait for the disk.
+ * \details Pages can be dropped again at any time under memory pressure, so the answer is a good guess rather
+ *   than a promise. Where the operating system cannot tell, every part of the file is reported to be in memory.
+ *   \param offset The first byte to check.
+ *   \param bytes The number of bytes to check.
+ * \return Whether every page holding those bytes is in memory.
+ */
+bool MappedFile::isResident(size_t offset, size_t bytes) const {
+#ifndef _WIN32
+    if (!myData || offset >= mySize)
+        return false;
+    if (bytes > mySize - offset)
+        bytes = mySize - offset;
+    static const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t) (myData + offset);
+    uintptr_t aligned = start & ~(page - 1);
+    size_t pages = (start - aligned + bytes + page - 1) / page;
+  #ifdef __APPLE__
+    char resident[64];
+  #else
+    unsigned char resident[64];
+  #endif
+    while (pages > 0) {                     // A few pages at a time, so no buffer has to be allocated
+        const size_t count = (pages < 64) ? pages : 64;
+        if (mincore((void*) aligned, count * page, resident) != 0)
+            return true;                    // Cannot tell, so do not hold anything back
+        for (size_t i = 0; i < count; ++i)
+            if (!(resident[i] & 1))
+                return false;
+        aligned += count * page;
+        pages -= count;
+    }
+#endif
+    return true;
+}
+
+/*!
+ * \brief Destroys the MappedFile, unmapping its file.
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+}
@@ -0,0 +1,55 @@
+/*
+ * MappedFile.h provides a read-only view of a whole file mapped into memory.
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace tsgl {
+
+/*! \class MappedFile
+ *  \brief A read-only file mapped into memory.
+ *  \details The operating system reads the pages of the file from disk the first time they are touched and
+ *    may drop them again under memory pressure, so mapping a file of any size is instant and uses only as
+ *    much memory as the parts that are read. Used by TiledImage and VideoSurface.
+ *  \details Any number of threads may read the mapped bytes at once.
+ *  \note The file must not be changed or truncated while it is mapped.
+ */
+class MappedFile {
+ private:
+    const uint8_t * myData;
+    size_t mySize;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+ public:
+    MappedFile();
+
+    bool open(const std::string& filename);
+
+    void close();
+
+    void prefetch(size_t offset, size_t bytes) const;
+
+    bool isResident(size_t offset, size_t bytes) const;
+
+    /*!
+     * \brief Accessor for the mapped bytes, or 0 if no file is open.
+     */
+    const uint8_t * data() const { return myData; }
+
+    /*!
+     * \brief Accessor for the size of the mapped file in bytes.
+     */
+    size_t size() const { return mySize; }
+
+    ~MappedFile();
+};
+
+}
+
+#endif /* MAPPEDFILE_H_ */
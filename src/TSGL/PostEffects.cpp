@@ -0,0 +1,74 @@
+#include "PostEffects.h"
+
+namespace tsgl {
+
+const char* const PostEffects::BLUR =
+    "uniform float spread;\n"
+    "vec4 effect(vec2 uv) {\n"
+    "    vec2 offset = texel * max(spread, 1.0);\n"
+    "    vec4 sum = vec4(0.0);\n"
+    "    float total = 0.0;\n"
+    "    for (int j = -3; j <= 3; ++j) {\n"
+    "        for (int i = -3; i <= 3; ++i) {\n"
+    "            float w = exp(-float(i * i + j * j) / 8.0);\n"
+    "            sum += w * texture(image, uv + vec2(i, j) * offset);\n"
+    "            total += w;\n"
+    "        }\n"
+    "    }\n"
+    "    return sum / total;\n"
+    "}\n";
+
+const char* const PostEffects::BLOOM =
+    "uniform float threshold;\n"
+    "vec4 effect(vec2 uv) {\n"
+    "    float t = threshold > 0.0 ? threshold : 0.7;\n"
+    "    vec3 glow = vec3(0.0);\n"
+    "    float total = 0.0;\n"
+    "    for (int j = -4; j <= 4; ++j) {\n"
+    "        for (int i = -4; i <= 4; ++i) {\n"
+    "            float w = exp(-float(i * i + j * j) / 12.0);\n"
+    "            vec3 c = texture(image, uv + vec2(i, j) * texel * 2.0).rgb;\n"
+    "            glow += w * max(c - vec3(t), vec3(0.0));\n"
+    "            total += w;\n"
+    "        }\n"
+    "    }\n"
+    "    vec4 c = texture(image, uv);\n"
+    "    return vec4(c.rgb + 2.0 * glow / total, c.a);\n"
+    "}\n";
+
+const char* const PostEffects::EDGES =
+    "float luma(vec2 uv) {\n"
+    "    return dot(texture(image, uv).rgb, vec3(0.299, 0.587, 0.114));\n"
+    "}\n"
+    "vec4 effect(vec2 uv) {\n"
+    "    float tl = luma(uv + texel * vec2(-1.0,  1.0)), t = luma(uv + texel * vec2(0.0,  1.0));\n"
+    "    float tr = luma(uv + texel * vec2( 1.0,  1.0)), l = luma(uv + texel * vec2(-1.0, 0.0));\n"
+    "    float r  = luma(uv + texel * vec2( 1.0,  0.0)), b = luma(uv + texel * vec2(0.0, -1.0));\n"
+    "    float bl = luma(uv + texel * vec2(-1.0, -1.0)), br = luma(uv + texel * vec2(1.0, -1.0));\n"
+    "    float gx = tr + 2.0 * r + br - tl - 2.0 * l - bl;\n"
+    "    float gy = tl + 2.0 * t + tr - bl - 2.0 * b - br;\n"
+    "    return vec4(vec3(clamp(length(vec2(gx, gy)), 0.0, 1.0)), 1.0);\n"
+    "}\n";
+
+const char* const PostEffects::GREYSCALE =
+    "vec4 effect(vec2 uv) {\n"
+    "    vec4 c = texture(image, uv);\n"
+    "    return vec4(vec3(dot(c.rgb, vec3(0.299, 0.587, 0.114))), c.a);\n"
+    "}\n";
+
+const char* const PostEffects::INVERT =
+    "vec4 effect(vec2 uv) {\n"
+    "    vec4 c = texture(image, uv);\n"
+    "    return vec4(1.0 - c.rgb, c.a);\n"
+    "}\n";
+
+const char* const PostEffects::SEPIA =
+    "vec4 effect(vec2 uv) {\n"
+    "    vec4 c = texture(image, uv);\n"
+    "    vec3 s = vec3(dot(c.rgb, vec3(0.393, 0.769, 0.189)),\n"
+    "                  dot(c.rgb, vec3(0.349, 0.686, 0.168)),\n"
+    "                  dot(c.rgb, vec3(0.272, 0.534, 0.131)));\n"
+    "    return vec4(min(s, vec3(1.0)), c.a);\n"
+    "}\n";
+
+}
@@ -0,0 +1,33 @@
+/*
+ * PostEffects.h provides the sources of common post effects for Background::addPostEffect().
+ */
+
+#ifndef POSTEFFECTS_H_
+#define POSTEFFECTS_H_
+
+namespace tsgl {
+
+/*! \class PostEffects
+ *  \brief GLSL sources of ready-made post effects.
+ *  \details Each member is a source that can be passed to Background::addPostEffect(), on its own or as one
+ *    step of a chain. Effects that take a parameter read it from a <code>float</code> uniform, which is set with
+ *    Background::setPostEffectUniform(); a uniform that is never set is 0, and the effect uses its default.
+ */
+class PostEffects {
+ public:
+    static const char* const BLUR;          //!< Gaussian blur. Uniform <code>spread</code>: pixels between taps (default 1).
+    static const char* const BLOOM;         //!< Glow around bright areas. Uniform <code>threshold</code>: brightness that glows (default 0.7).
+    static const char* const EDGES;         //!< Sobel edge detection, as white edges on black.
+    static const char* const GREYSCALE;     //!< Replaces each color with its luminance.
+    static const char* const INVERT;        //!< Replaces each color with its negative.
+    static const char* const SEPIA;         //!< Color grading toward old-photograph browns.
+ private:
+    PostEffects();
+    ~PostEffects();
+    PostEffects(const PostEffects&);
+    PostEffects& operator=(const PostEffects&);
+};
+
+}
+
+#endif /* POSTEFFECTS_H_ */
@@ -0,0 +1,370 @@
+#include "ProfiledMutex.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+
+namespace tsgl {
+
+// The counters of every lock with one name, updated by any thread that takes one of them.
+struct LockProfile {
+    std::string name;
+    std::atomic<uint64_t> acquisitions, sharedAcquisitions, contended, ownerChanges;
+    std::atomic<uint64_t> waitTotal, waitMax, holdTotal, holdMax;      // Nanoseconds
+    std::atomic<uint64_t> histogram[LOCK_HISTOGRAM_BUCKETS];
+
+    explicit LockProfile(const std::string& n) : name(n) { clear(); }
+
+    void clear() {
+        acquisitions = sharedAcquisitions = contended = ownerChanges = 0;
+        waitTotal = waitMax = holdTotal = holdMax = 0;
+        for (unsigned i = 0; i < LOCK_HISTOGRAM_BUCKETS; ++i)
+            histogram[i] = 0;
+    }
+};
+
+std::atomic<bool> LockProfiler::enabled(false);
+
+namespace {
+
+// The profiles of every name, in the order they were first profiled
+struct ProfilerState {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<LockProfile>> profiles;
+    std::map<std::string, LockProfile*> byName;
+};
+
+ProfilerState& profiler() {
+    static ProfilerState state;
+    return state;
+}
+
+// A shared hold being timed, on the thread that holds it
+struct SharedHold {
+    const ProfiledSharedMutex* mutex;
+    uint64_t start;
+};
+
+const unsigned MAX_SHARED_HOLDS = 8;
+thread_local SharedHold sharedHolds[MAX_SHARED_HOLDS];
+thread_local unsigned sharedHoldCount = 0;
+
+// Nanoseconds on a steady clock, never 0
+uint64_t ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() | 1;
+}
+
+// Finds the profile of a lock, looking its name up the first time
+LockProfile& profileOf(std::atomic<LockProfile*>& cached, const char* name) {
+    LockProfile* profile = cached.load(std::memory_order_acquire);
+    if (!profile) {
+        ProfilerState& state = profiler();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        LockProfile*& named = state.byName[name];
+        if (!named) {
+            state.profiles.push_back(std::unique_ptr<LockProfile>(new LockProfile(name)));
+            named = state.profiles.back().get();
+        }
+        profile = named;
+        cached.store(profile, std::memory_order_release);
+    }
+    return *profile;
+}
+
+void raiseTo(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+void recordWait(LockProfile& profile, uint64_t wait) {
+    if (wait == 0)
+        return;
+    profile.contended.fetch_add(1, std::memory_order_relaxed);
+    profile.waitTotal.fetch_add(wait, std::memory_order_relaxed);
+    raiseTo(profile.waitMax, wait);
+    unsigned bucket = 0;
+    while (bucket + 1 < LOCK_HISTOGRAM_BUCKETS && (wait >> (bucket + 1)))
+        ++bucket;
+    profile.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Counts an exclusive acquisition by a different thread than the last one
+void noteOwner(LockProfile& profile, std::thread::id& lastOwner) {
+    const std::thread::id self = std::this_thread::get_id();
+    if (lastOwner == self)
+        return;
+    if (lastOwner != std::thread::id())
+        profile.ownerChanges.fetch_add(1, std::memory_order_relaxed);
+    lastOwner = self;
+}
+
+void recordHold(LockProfile& profile, uint64_t hold) {
+    profile.holdTotal.fetch_add(hold, std::memory_order_relaxed);
+    raiseTo(profile.holdMax, hold);
+}
+
+}
+
+/*!
+ * \brief Turns profiling on or off for every profiled lock.
+ * \details Locks that are held when profiling is turned on are not timed until they are next acquired.
+ *   \param on Whether locks should be profiled.
+ */
+void LockProfiler::setEnabled(bool on) {
+    enabled.store(on);
+}
+
+/*!
+ * \brief Accessor for what the profiled locks have been through since they were first profiled or reset().
+ * \return One LockStats per name of lock, in the order the names were first profiled.
+ */
+std::vector<LockStats> LockProfiler::getStats() {
+    ProfilerState& state = profiler();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::vector<LockStats> stats(state.profiles.size());
+    for (unsigned i = 0; i < stats.size(); ++i) {
+        const LockProfile& p = *state.profiles[i];
+        LockStats& s = stats[i];
+        s.name = p.name;
+        s.acquisitions = p.acquisitions.load();
+        s.sharedAcquisitions = p.sharedAcquisitions.load();
+        s.contended = p.contended.load();
+        s.ownerChanges = p.ownerChanges.load();
+        s.waitTime = p.waitTotal.load() * 1e-9;
+        s.maxWait = p.waitMax.load() * 1e-9;
+        s.holdTime = p.holdTotal.load() * 1e-9;
+        s.maxHold = p.holdMax.load() * 1e-9;
+        for (unsigned b = 0; b < LOCK_HISTOGRAM_BUCKETS; ++b)
+            s.waitHistogram[b] = p.histogram[b].load();
+    }
+    return stats;
+}
+
+/*!
+ * \brief Sets the counters of every name of lock back to zero.
+ */
+void LockProfiler::reset() {
+    ProfilerState& state = profiler();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (unsigned i = 0; i < state.profiles.size(); ++i)
+        state.profiles[i]->clear();
+}
+
+/*!
+ * \brief Locks the mutex if it is free, without blocking.
+ * \return Whether the mutex was locked.
+ */
+bool ProfiledMutex::try_lock() {
+    if (!LockProfiler::enabled.load(std::memory_order_relaxed))
+        return myMutex.try_lock();
+    if (!myMutex.try_lock())
+        return false;
+    LockProfile& profile = profileOf(myProfile, myName);
+    profile.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    noteOwner(profile, myLastOwner);
+    myAcquired = ticks();
+    return true;
+}
+
+/*!
+ * \brief Locks the mutex and counts the acquisition, timing the wait only if the mutex was not free.
+ */
+void ProfiledMutex::lockProfiled() {
+    LockProfile& profile = profileOf(myProfile, myName);
+    uint64_t wait = 0;
+    if (!myMutex.try_lock()) {
+        const uint64_t start = ticks();
+        myMutex.lock();
+        wait = ticks() - start;
+    }
+    profile.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    recordWait(profile, wait);
+    noteOwner(profile, myLastOwner);
+    myAcquired = ticks();
+}
+
+/*!
+ * \brief Counts how long the mutex was held, and unlocks it.
+ */
+void ProfiledMutex::unlockProfiled() {
+    recordHold(profileOf(myProfile, myName), ticks() - myAcquired);
+    myAcquired = 0;
+    myMutex.unlock();
+}
+
+/*!
+ * \brief Takes the lock exclusively, or tries to.
+ *   \param wait Whether to wait for the lock if it is held.
+ * \return If <code>wait</code>, whether the lock had to be waited for; otherwise, whether it was taken.
+ */
+bool ProfiledSharedMutex::acquire(bool wait) {
+    std::unique_lock<std::mutex> lock(myMutex);
+    if (!myWriter && myReaders == 0) {
+        myWriter = true;
+        return !wait;
+    }
+    if (!wait)
+        return false;
+    ++myWaitingWriters;
+    while (myWriter || myReaders > 0)
+        myWritersCv.wait(lock);
+    --myWaitingWriters;
+    myWriter = true;
+    return true;
+}
+
+/*!
+ * \brief Takes the lock shared, or tries to.
+ *   \param wait Whether to wait for the lock if a writer holds it or is waiting for it.
+ * \return If <code>wait</code>, whether the lock had to be waited for; otherwise, whether it was taken.
+ */
+bool ProfiledSharedMutex::acquireShared(bool wait) {
+    std::unique_lock<std::mutex> lock(myMutex);
+    if (!myWriter && myWaitingWriters == 0) {
+        ++myReaders;
+        return !wait;
+    }
+    if (!wait)
+        return false;
+    while (myWriter || myWaitingWriters > 0)
+        myReadersCv.wait(lock);
+    ++myReaders;
+    return true;
+}
+
+/*!
+ * \brief Locks exclusively, blocking until no other thread holds the lock.
+ */
+void ProfiledSharedMutex::lock() {
+    if (!LockProfiler::enabled.load(std::memory_order_relaxed)) {
+        acquire(true);
+        return;
+    }
+    LockProfile& profile = profileOf(myProfile, myName);
+    const uint64_t start = ticks();
+    const bool waited = acquire(true);
+    const uint64_t now = ticks();
+    profile.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    recordWait(profile, waited ? now - start : 0);
+    noteOwner(profile, myLastOwner);
+    myAcquired = now;
+}
+
+/*!
+ * \brief Locks exclusively if no other thread holds the lock, without blocking.
+ * \return Whether the lock was taken.
+ */
+bool ProfiledSharedMutex::try_lock() {
+    if (!acquire(false))
+        return false;
+    if (LockProfiler::enabled.load(std::memory_order_relaxed)) {
+        LockProfile& profile = profileOf(myProfile, myName);
+        profile.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        noteOwner(profile, myLastOwner);
+        myAcquired = ticks();
+    }
+    return true;
+}
+
+/*!
+ * \brief Releases an exclusive hold, waking a waiting writer if there is one, and the readers if not.
+ */
+void ProfiledSharedMutex::unlock() {
+    if (myAcquired) {
+        recordHold(profileOf(myProfile, myName), ticks() - myAcquired);
+        myAcquired = 0;
+    }
+    std::lock_guard<std::mutex> lock(myMutex);
+    myWriter = false;
+    if (myWaitingWriters > 0)
+        myWritersCv.notify_one();
+    else
+        myReadersCv.notify_all();
+}
+
+/*!
+ * \brief Locks shared, blocking while a writer holds the lock or is waiting for it.
+ * \details The hold is timed in a list kept by the calling thread, so the same thread must call unlock_shared().
+ */
+void ProfiledSharedMutex::lock_shared() {
+    const uint64_t acquired = lockSharedTimed();
+    if (acquired && sharedHoldCount < MAX_SHARED_HOLDS) {
+        SharedHold hold = { this, acquired };
+        sharedHolds[sharedHoldCount++] = hold;
+        myProfiledReaders.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*!
+ * \brief Locks shared like lock_shared(), but leaves timing the hold to the caller.
+ * \details For holders that may be released on another thread than the one that locked, such as a lock object
+ *   that can be moved. Pass the returned value to unlockSharedTimed() to release the hold.
+ * \return When the hold began, or 0 if LockProfiler was off.
+ */
+uint64_t ProfiledSharedMutex::lockSharedTimed() {
+    if (!LockProfiler::enabled.load(std::memory_order_relaxed)) {
+        acquireShared(true);
+        return 0;
+    }
+    LockProfile& profile = profileOf(myProfile, myName);
+    const uint64_t start = ticks();
+    const bool waited = acquireShared(true);
+    const uint64_t now = ticks();
+    profile.sharedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    recordWait(profile, waited ? now - start : 0);
+    return now;
+}
+
+/*!
+ * \brief Locks shared if no writer holds the lock or is waiting for it, without blocking.
+ * \return Whether the lock was taken.
+ */
+bool ProfiledSharedMutex::try_lock_shared() {
+    if (!acquireShared(false))
+        return false;
+    if (LockProfiler::enabled.load(std::memory_order_relaxed)) {
+        profileOf(myProfile, myName).sharedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (sharedHoldCount < MAX_SHARED_HOLDS) {
+            SharedHold hold = { this, ticks() };
+            sharedHolds[sharedHoldCount++] = hold;
+            myProfiledReaders.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Releases a shared hold taken with lock_shared() or try_lock_shared() on the calling thread.
+ */
+void ProfiledSharedMutex::unlock_shared() {
+    uint64_t acquired = 0;
+    if (myProfiledReaders.load(std::memory_order_relaxed) > 0) {
+        for (unsigned i = sharedHoldCount; i > 0; --i) {    // Most recent first, as holds are usually nested
+            if (sharedHolds[i - 1].mutex != this)
+                continue;
+            acquired = sharedHolds[i - 1].start;
+            for (unsigned j = i; j < sharedHoldCount; ++j)
+                sharedHolds[j - 1] = sharedHolds[j];
+            --sharedHoldCount;
+            myProfiledReaders.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    unlockSharedTimed(acquired);
+}
+
+/*!
+ * \brief Releases a shared hold taken with lockSharedTimed(), from any thread, waking a waiting writer if it was
+ *   the last.
+ *   \param acquired What lockSharedTimed() returned.
+ */
+void ProfiledSharedMutex::unlockSharedTimed(uint64_t acquired) {
+    if (acquired)
+        recordHold(profileOf(myProfile, myName), ticks() - acquired);
+    std::lock_guard<std::mutex> lock(myMutex);
+    if (--myReaders == 0 && myWaitingWriters > 0)
+        myWritersCv.notify_one();
+}
+
+}
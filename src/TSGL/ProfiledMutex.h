@@ -0,0 +1,172 @@
+/*
+ * ProfiledMutex.h provides mutexes that measure how long threads wait for them and hold them.
+ */
+
+#ifndef PROFILEDMUTEX_H_
+#define PROFILEDMUTEX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tsgl {
+
+struct LockProfile;         // The counters of one name of lock, defined in ProfiledMutex.cpp
+
+//! Number of buckets in LockStats::waitHistogram
+static const unsigned LOCK_HISTOGRAM_BUCKETS = 32;
+
+/*!
+ * \brief What the profiled locks of one name have been through. See LockProfiler::getStats().
+ */
+struct LockStats {
+    std::string name;                   //!< The name the locks were given; locks with the same name are counted together
+    uint64_t acquisitions;              //!< Number of times a lock was taken exclusively
+    uint64_t sharedAcquisitions;        //!< Number of times a ProfiledSharedMutex was taken shared
+    uint64_t contended;                 //!< Number of acquisitions, of either kind, that had to wait
+    uint64_t ownerChanges;              //!< Number of exclusive acquisitions by a different thread than the one before
+    double waitTime, maxWait;           //!< Total and longest time spent waiting to acquire, in seconds
+    double holdTime, maxHold;           //!< Total and longest time a lock was held, in seconds
+    uint64_t waitHistogram[LOCK_HISTOGRAM_BUCKETS];    //!< Contended acquisitions by wait: bucket i counts waits
+                                                        //!< of 2^i to 2^(i+1) nanoseconds; the ends take the rest
+};
+
+/*! \class LockProfiler
+ *  \brief Turns lock profiling on and off, and reports what the profiled locks have been through.
+ *  \details Every ProfiledMutex and ProfiledSharedMutex has a name. Locks with the same name, such as the
+ *    <code>attribMutex</code> of every Drawable, are counted together, so getStats() reports one LockStats per
+ *    name, in the order the names were first profiled.
+ *  \details While profiling is off, which is the default, a profiled lock costs one extra load of a flag per lock
+ *    and unlock. While it is on, each acquisition also reads the clock and updates the shared counters of its
+ *    name, so the busiest locks become a little slower; that is the price of seeing them.
+ */
+class LockProfiler {
+ public:
+    static void setEnabled(bool on);
+
+    /*!
+     * \brief Accessor for whether locks are being profiled.
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static std::vector<LockStats> getStats();
+
+    static void reset();
+ private:
+    friend class ProfiledMutex;
+    friend class ProfiledSharedMutex;
+
+    static std::atomic<bool> enabled;
+
+    LockProfiler();
+    LockProfiler(const LockProfiler&);
+    LockProfiler& operator=(const LockProfiler&);
+    ~LockProfiler();
+};
+
+/*! \class ProfiledMutex
+ *  \brief A mutex that records, while LockProfiler is on, how long threads wait for it and hold it.
+ *  \details A ProfiledMutex can be used wherever a std::mutex is locked with lock() and unlock(), or through
+ *    std::lock_guard and std::unique_lock. It cannot be waited on with a std::condition_variable.
+ */
+class ProfiledMutex {
+ public:
+    /*!
+     * \brief Constructs a ProfiledMutex.
+     *   \param name The name to count the mutex under. It is not copied, so it should be a string literal.
+     */
+    explicit ProfiledMutex(const char * name = "mutex") : myName(name), myProfile(NULL), myAcquired(0) {}
+
+    /*!
+     * \brief Locks the mutex, blocking until it is free.
+     */
+    void lock() {
+        if (LockProfiler::enabled.load(std::memory_order_relaxed))
+            lockProfiled();
+        else
+            myMutex.lock();
+    }
+
+    bool try_lock();
+
+    /*!
+     * \brief Unlocks the mutex.
+     */
+    void unlock() {
+        if (myAcquired)                 // Locked while profiling
+            unlockProfiled();
+        else
+            myMutex.unlock();
+    }
+ private:
+    std::mutex myMutex;
+    const char * myName;
+    std::atomic<LockProfile*> myProfile;
+    uint64_t myAcquired;                // When the owner acquired the mutex, or 0 if it did not time it
+    std::thread::id myLastOwner;
+
+    void lockProfiled();
+    void unlockProfiled();
+
+    ProfiledMutex(const ProfiledMutex&);
+    ProfiledMutex& operator=(const ProfiledMutex&);
+};
+
+/*! \class ProfiledSharedMutex
+ *  \brief A readers-writer lock that records, while LockProfiler is on, how long threads wait for it and hold it.
+ *  \details Any number of threads may hold the lock shared, with lock_shared(), or one thread exclusively, with
+ *    lock(). Writers are preferred: once a thread is waiting to lock exclusively, new readers wait too.
+ *  \details Holds taken with lock_shared() are timed for up to 8 ProfiledSharedMutexes held at once by each
+ *    thread, and must be released by the thread that took them. A holder that may be released elsewhere keeps
+ *    its own start time with lockSharedTimed() and unlockSharedTimed() instead.
+ */
+class ProfiledSharedMutex {
+ public:
+    /*!
+     * \brief Constructs a ProfiledSharedMutex.
+     *   \param name The name to count the lock under. It is not copied, so it should be a string literal.
+     */
+    explicit ProfiledSharedMutex(const char * name = "shared mutex")
+      : myReaders(0), myWaitingWriters(0), myWriter(false), myName(name), myProfile(NULL), myAcquired(0),
+        myProfiledReaders(0) {}
+
+    void lock();
+
+    bool try_lock();
+
+    void unlock();
+
+    void lock_shared();
+
+    bool try_lock_shared();
+
+    void unlock_shared();
+
+    uint64_t lockSharedTimed();
+
+    void unlockSharedTimed(uint64_t acquired);
+ private:
+    std::mutex myMutex;                 // Protects the state of the lock below
+    std::condition_variable myReadersCv, myWritersCv;
+    unsigned myReaders, myWaitingWriters;
+    bool myWriter;
+    const char * myName;
+    std::atomic<LockProfile*> myProfile;
+    uint64_t myAcquired;                // When the writer acquired the lock, or 0 if it did not time it
+    std::thread::id myLastOwner;
+    std::atomic<unsigned> myProfiledReaders;    // Readers whose hold is being timed
+
+    bool acquire(bool wait);
+    bool acquireShared(bool wait);
+
+    ProfiledSharedMutex(const ProfiledSharedMutex&);
+    ProfiledSharedMutex& operator=(const ProfiledSharedMutex&);
+};
+
+}
+
+#endif /* PROFILEDMUTEX_H_ */
@@ -0,0 +1,267 @@
+#include "Random.h"
+
+#include <atomic>       // For the global seed and epoch
+#include <chrono>       // For a default seed when none is given
+#include <cstdlib>      // For std::getenv / strtoull
+#include <mutex>        // For stream index bookkeeping
+#include <random>       // For std::random_device
+#include <vector>
+#include <omp.h>        // For mapping OpenMP threads to streams
+
+namespace tsgl {
+
+namespace {
+
+const unsigned LANES = 8;                           // Width of the batch generator used by fillUniform()
+const uint64_t FREE_STREAM_BASE = 1ull << 32;       // First stream index handed out to non-OpenMP threads
+
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline uint32_t rotl32(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+/*
+ * An 8-lane xoshiro128+ generator stored as structure-of-arrays so that each step is a handful
+ * of independent 32-bit operations across the lanes, which GCC and Clang vectorize at -O2/-O3.
+ * It is seeded from a parent Random every time a batch is requested, so it never needs to persist.
+ */
+struct LaneGenerator {
+    uint32_t a[LANES], b[LANES], c[LANES], d[LANES];
+
+    explicit LaneGenerator(Random& parent) {
+        for (unsigned i = 0; i < LANES; ++i) {
+            uint64_t x = parent.next(), y = parent.next();
+            a[i] = (uint32_t) x; b[i] = (uint32_t) (x >> 32);
+            c[i] = (uint32_t) y; d[i] = (uint32_t) (y >> 32) | 1u;   // Never all zero
+        }
+    }
+
+    inline void step(uint32_t* out) {
+        for (unsigned i = 0; i < LANES; ++i) {
+            out[i] = a[i] + d[i];
+            const uint32_t t = b[i] << 9;
+            c[i] ^= a[i]; d[i] ^= b[i];
+            b[i] ^= c[i]; a[i] ^= d[i];
+            c[i] ^= t;
+            d[i] = rotl32(d[i], 11);
+        }
+    }
+};
+
+uint64_t defaultSeed() {
+    const char* env = std::getenv("TSGL_SEED");
+    if (env && *env)
+        return std::strtoull(env, nullptr, 0);
+    std::random_device rd;
+    return ((uint64_t) rd() << 32) ^ rd() ^ (uint64_t) std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+std::atomic<uint64_t>& globalSeed() {
+    static std::atomic<uint64_t> seed(defaultSeed());
+    return seed;
+}
+
+std::atomic<unsigned> seedEpoch(1);                 // Bumped by setSeed() so that threads reseed lazily
+std::atomic<uint64_t> nextFreeStream(FREE_STREAM_BASE);
+std::mutex ompStreamMutex;
+std::vector<bool> ompStreamClaimed;
+
+// Picks the stream index for the calling thread the first time it asks for one.
+uint64_t claimStream() {
+    if (omp_in_parallel()) {
+        unsigned tid = omp_get_thread_num();
+        std::lock_guard<std::mutex> lock(ompStreamMutex);
+        if (ompStreamClaimed.size() <= tid)
+            ompStreamClaimed.resize(tid + 1, false);
+        if (!ompStreamClaimed[tid]) {       // Nested teams reuse thread numbers; only the first owner gets it
+            ompStreamClaimed[tid] = true;
+            return tid;
+        }
+    }
+    return nextFreeStream++;
+}
+
+}
+
+/*!
+ * \brief Explicitly constructs a new Random stream.
+ * \details Derives the generator state from <code>seed</code> and <code>stream</code> with SplitMix64,
+ *   so different stream numbers under the same seed give independent sequences.
+ *   \param seed The seed for the stream.
+ *   \param stream The index of the stream under that seed.
+ * \return A new Random positioned at the start of the given stream.
+ */
+Random::Random(uint64_t seed, uint64_t stream) {
+    reseed(seed, stream);
+}
+
+/*!
+ * \brief Generates a uniformly distributed integer in [min, max].
+ * \details Uses Lemire's multiply-and-reject method, which is unbiased and needs no division in the common case.
+ *   \param min Inclusive lower bound.
+ *   \param max Inclusive upper bound.
+ * \note If <code>max</code> is less than <code>min</code> the bounds are swapped.
+ * \return A random integer between min and max, inclusive.
+ */
+int Random::uniformInt(int min, int max) {
+    if (max < min) { int tmp = min; min = max; max = tmp; }
+    const uint32_t range = (uint32_t) ((int64_t) max - (int64_t) min) + 1u;
+    if (range == 0)                                 // The full 32-bit range
+        return (int) nextU32();
+    uint64_t m = (uint64_t) nextU32() * range;
+    uint32_t low = (uint32_t) m;
+    if (low < range) {
+        const uint32_t threshold = (0u - range) % range;
+        while (low < threshold) {
+            m = (uint64_t) nextU32() * range;
+            low = (uint32_t) m;
+        }
+    }
+    return (int) ((int64_t) min + (int64_t) (m >> 32));
+}
+
+/*!
+ * \brief Fills a buffer with uniformly distributed floats in [min, max).
+ * \details Large buffers are generated eight values at a time by a vectorizable lane generator that
+ *   is seeded from this stream, so the call is deterministic for a given stream state.
+ *   \param out Pointer to the first float to write.
+ *   \param n Number of floats to write.
+ *   \param min Inclusive lower bound (defaults to 0).
+ *   \param max Exclusive upper bound (defaults to 1).
+ */
+void Random::fillUniform(float* out, size_t n, float min, float max) {
+    const float scale = (max - min) * (1.0f / 16777216.0f);
+    size_t i = 0;
+    if (n >= 4 * LANES) {
+        LaneGenerator lanes(*this);
+        uint32_t raw[LANES];
+        for (; i + LANES <= n; i += LANES) {
+            lanes.step(raw);
+            for (unsigned k = 0; k < LANES; ++k)
+                out[i + k] = min + (raw[k] >> 8) * scale;
+        }
+    }
+    for (; i < n; ++i)
+        out[i] = min + (nextU32() >> 8) * scale;
+}
+
+/*!
+ * \brief Fills a buffer with uniformly distributed integers in [min, max].
+ * \details Raw values come from the same vectorizable lane generator as the float overload, and are then
+ *   mapped into range with Lemire's method; the rare rejected values are redrawn from this stream.
+ *   \param out Pointer to the first integer to write.
+ *   \param n Number of integers to write.
+ *   \param min Inclusive lower bound.
+ *   \param max Inclusive upper bound.
+ */
+void Random::fillUniform(int* out, size_t n, int min, int max) {
+    if (max < min) { int tmp = min; min = max; max = tmp; }
+    const uint32_t range = (uint32_t) ((int64_t) max - (int64_t) min) + 1u;
+    const uint32_t threshold = range ? (0u - range) % range : 0;
+    size_t i = 0;
+    if (n >= 4 * LANES) {
+        LaneGenerator lanes(*this);
+        uint32_t raw[LANES];
+        for (; i + LANES <= n; i += LANES) {
+            lanes.step(raw);
+            for (unsigned k = 0; k < LANES; ++k) {
+                if (range == 0) { out[i + k] = (int) raw[k]; continue; }
+                uint64_t m = (uint64_t) raw[k] * range;
+                while ((uint32_t) m < threshold)
+                    m = (uint64_t) nextU32() * range;
+                out[i + k] = (int) ((int64_t) min + (int64_t) (m >> 32));
+            }
+        }
+    }
+    for (; i < n; ++i)
+        out[i] = uniformInt(min, max);
+}
+
+/*!
+ * \brief Advances the stream by 2^128 steps.
+ * \details Equivalent to 2^128 calls to next(); useful for carving non-overlapping subsequences out of one stream.
+ */
+void Random::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+                                     0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (unsigned i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (JUMP[i] & (1ull << b)) {
+                s0 ^= s[0]; s1 ^= s[1]; s2 ^= s[2]; s3 ^= s[3];
+            }
+            next();
+        }
+    }
+    s[0] = s0; s[1] = s1; s[2] = s2; s[3] = s3;
+}
+
+/*!
+ * \brief Resets the stream to the start of the sequence for a seed and stream index.
+ *   \param seed The new seed.
+ *   \param stream The index of the stream under that seed.
+ */
+void Random::reseed(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed;
+    uint64_t mixedStream = stream;
+    x ^= splitmix64(mixedStream);
+    for (unsigned i = 0; i < 4; ++i)
+        s[i] = splitmix64(x);
+}
+
+/*!
+ * \brief Accessor for the calling thread's random stream.
+ * \details The first call on a thread picks a stream index (the OpenMP thread number inside a parallel
+ *   region, otherwise the next unused index) and seeds it from the global seed. Later calls return the same
+ *   stream, reseeding it first if setSeed() has been called since.
+ * \return A reference to a Random owned by the calling thread. Never share it with other threads.
+ */
+Random& Random::local() {
+    static thread_local Random rng(0);
+    static thread_local unsigned epoch = 0;
+    static thread_local uint64_t stream = 0;
+    const unsigned current = seedEpoch.load(std::memory_order_acquire);
+    if (epoch != current) {
+        if (epoch == 0)
+            stream = claimStream();
+        rng.reseed(globalSeed().load(std::memory_order_relaxed), stream);
+        epoch = current;
+    }
+    return rng;
+}
+
+/*!
+ * \brief Creates a Random for a specific stream index under the global seed.
+ * \details Useful when work items, rather than threads, should own their own reproducible stream.
+ *   \param stream The index of the stream.
+ * \return A new Random positioned at the start of the given stream.
+ */
+Random Random::forStream(uint64_t stream) {
+    return Random(globalSeed().load(std::memory_order_relaxed), stream);
+}
+
+/*!
+ * \brief Accessor for the global seed.
+ * \return The seed all per-thread streams are derived from.
+ */
+uint64_t Random::getSeed() {
+    return globalSeed().load(std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Mutator for the global seed.
+ * \details Every thread's local() stream restarts from the new seed on its next call, making runs repeatable
+ *   for deterministic benchmarking. The <code>TSGL_SEED</code> environment variable sets the same seed
+ *   without recompiling.
+ *   \param seed The new global seed.
+ */
+void Random::setSeed(uint64_t seed) {
+    globalSeed().store(seed, std::memory_order_relaxed);
+    seedEpoch.fetch_add(1, std::memory_order_release);
+}
+
+}
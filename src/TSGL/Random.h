@@ -0,0 +1,95 @@
+/*
+ * Random.h provides fast, reproducibly seeded per-thread random number streams.
+ */
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstddef>      // For size_t
+#include <stdint.h>     // For fixed-width integer types
+
+namespace tsgl {
+
+/*! \class Random
+ *  \brief A fast pseudo-random number generator with independent per-thread streams.
+ *  \details Random wraps a xoshiro256** generator, which is much smaller and faster than std::mt19937
+ *    while still passing the usual statistical test batteries.
+ *  \details Every thread that calls Random::local() gets its own stream, so no locking is ever needed.
+ *    Each stream's state is derived from a single global seed and a stream index by SplitMix64, so streams
+ *    are statistically independent, and the whole program is reproducible once the global seed is fixed
+ *    with setSeed() or the <code>TSGL_SEED</code> environment variable.
+ *  \details Inside an OpenMP parallel region the stream index is the OpenMP thread number, so a run with
+ *    the same seed and thread count produces the same numbers on the same threads. Other threads are
+ *    numbered in the order they first ask for a stream.
+ *  \details fillUniform() generates whole batches through an 8-lane generator laid out so that the
+ *    compiler can vectorize it, which is the preferred way to produce large amounts of random data.
+ */
+class Random {
+ private:
+    uint64_t s[4];
+
+    static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+ public:
+    Random(uint64_t seed, uint64_t stream = 0);
+
+    /*!
+     * \brief Generates the next raw 64-bit value of the stream.
+     * \return A uniformly distributed 64-bit unsigned integer.
+     */
+    inline uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1];
+        s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /*!
+     * \brief Generates the next raw 32-bit value of the stream.
+     * \return A uniformly distributed 32-bit unsigned integer (the high bits of next()).
+     */
+    inline uint32_t nextU32() { return (uint32_t) (next() >> 32); }
+
+    int uniformInt(int min, int max);
+
+    /*!
+     * \brief Generates a uniformly distributed float in [0, 1).
+     * \return A float with 24 random bits of mantissa.
+     */
+    inline float uniformFloat() { return (nextU32() >> 8) * (1.0f / 16777216.0f); }
+
+    /*!
+     * \brief Generates a uniformly distributed float in [min, max).
+     *   \param min Inclusive lower bound.
+     *   \param max Exclusive upper bound.
+     */
+    inline float uniformFloat(float min, float max) { return min + (max - min) * uniformFloat(); }
+
+    /*!
+     * \brief Generates a uniformly distributed double in [0, 1).
+     * \return A double with 53 random bits of mantissa.
+     */
+    inline double uniformDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    void fillUniform(float* out, size_t n, float min = 0.0f, float max = 1.0f);
+
+    void fillUniform(int* out, size_t n, int min, int max);
+
+    void jump();
+
+    void reseed(uint64_t seed, uint64_t stream = 0);
+
+    static Random& local();
+
+    static Random forStream(uint64_t stream);
+
+    static uint64_t getSeed();
+
+    static void setSeed(uint64_t seed);
+};
+
+}
+
+#endif /* RANDOM_H_ */
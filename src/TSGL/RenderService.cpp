@@ -0,0 +1,215 @@
+#include "RenderService.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Canvas.h"
+#include "Error.h"
+
+namespace tsgl {
+
+namespace {
+
+// Shared state of the rendering service.
+struct ServiceState {
+    std::mutex mutex;                       // Protects everything below
+    std::condition_variable finished;       // Signaled when a Canvas is done and removed
+    std::vector<Canvas*> canvases;          // Canvases drawn by the rendering thread, in turn
+    std::thread thread;
+    bool enabled, running;
+    GLFWwindow* root;                       // Hidden window whose context the Canvases' contexts share with
+    Shader *text, *shape, *texture;
+
+    ServiceState() : enabled(false), running(false), root(NULL), text(NULL), shape(NULL), texture(NULL) {}
+};
+
+ServiceState& service() {
+    static ServiceState state;
+    return state;
+}
+
+}
+
+/*!
+ * \brief Turns the rendering service on or off for Canvases created afterward.
+ * \details Canvases that already exist are not affected.
+ *   \param on Whether Canvases should be drawn by the rendering service.
+ * \note <b>OS X:</b> this function does nothing, since OS X draws on the main thread.
+ */
+void RenderService::enable(bool on) {
+  #ifdef __APPLE__
+    if (on)
+        TsglDebug("The rendering service is not supported on OS X.");
+  #else
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.enabled = on;
+  #endif
+}
+
+/*!
+ * \brief Accessor for whether Canvases created now are drawn by the rendering service.
+ */
+bool RenderService::isEnabled() {
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.enabled;
+}
+
+/*!
+ * \brief Accessor for the number of Canvases the rendering thread is drawing.
+ */
+unsigned RenderService::getCanvasCount() {
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.canvases.size();
+}
+
+/*!
+ * \brief Returns the hidden window that new contexts share with, creating it if need be.
+ * \details Called by Canvas::initWindow() while it holds Canvas::glfwMutex and has set the window hints, so
+ *   the root context is made just like the Canvases' own.
+ */
+GLFWwindow* RenderService::shareWindow() {
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.root) {
+        state.root = glfwCreateWindow(1, 1, "", NULL, NULL);
+        if (!state.root)
+            TsglErr("Could not create the shared context for the rendering service.");
+    }
+    return state.root;
+}
+
+/*!
+ * \brief Gives a Canvas the shared shaders, compiling them if need be.
+ * \details The calling thread must have the context of a Canvas that shares with the root current.
+ *   \param text Set to the shader for Text.
+ *   \param shape Set to the shader for Shapes.
+ *   \param texture Set to the shader for Backgrounds and Images.
+ * \return The number of shaders that had to be compiled from source.
+ */
+unsigned RenderService::shaders(Shader*& text, Shader*& shape, Shader*& texture) {
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    unsigned compiled = 0;
+    if (!state.text)
+        compiled = Canvas::createShaders(state.text, state.shape, state.texture);
+    text = state.text;
+    shape = state.shape;
+    texture = state.texture;
+    return compiled;
+}
+
+/*!
+ * \brief Hands a Canvas to the rendering thread, starting the thread if it is not running.
+ *   \param can The Canvas to draw. It must have been created while the service was enabled.
+ */
+void RenderService::add(Canvas * can) {
+    can->beginDrawing();
+    ServiceState& state = service();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.canvases.push_back(can);
+    if (!state.running) {
+        if (state.thread.joinable())
+            state.thread.join();            // Done, but not yet joined, from an earlier batch of Canvases
+        state.running = true;
+        state.thread = std::thread(run);
+    }
+}
+
+/*!
+ * \brief Blocks until the rendering thread is done with a Canvas.
+ *   \param can The Canvas to wait for.
+ */
+void RenderService::wait(Canvas * can) {
+    ServiceState& state = service();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (std::find(state.canvases.begin(), state.canvases.end(), can) != state.canvases.end())
+        state.finished.wait(lock);
+}
+
+/*!
+ * \brief Stops the rendering thread and frees the shared resources.
+ * \details Called when the last Canvas is destroyed, before GLFW is terminated.
+ */
+void RenderService::shutdown() {
+    ServiceState& state = service();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (state.thread.joinable()) {
+        std::thread done;
+        done.swap(state.thread);
+        lock.unlock();
+        done.join();                        // Only Canvases that are being destroyed could still be drawn
+        lock.lock();
+    }
+    if (!state.root)
+        return;
+    if (state.text) {
+        glfwMakeContextCurrent(state.root);
+        Shader* shaders[] = { state.text, state.shape, state.texture };
+        for (unsigned i = 0; i < 3; ++i) {
+            glDeleteProgram(shaders[i]->ID);
+            delete shaders[i];
+        }
+        glfwMakeContextCurrent(NULL);
+        state.text = state.shape = state.texture = NULL;
+    }
+    glfwDestroyWindow(state.root);
+    state.root = NULL;
+}
+
+/*!
+ * \brief Body of the rendering thread: draws each Canvas whenever its next frame is due, until none are left.
+ * \details The thread sleeps until the Canvas whose frame comes first is due, then draws every Canvas that is
+ *   due by then and polls for input, so each Canvas keeps its own frame rate however slow the others are. A
+ *   Canvas whose window should close is finished and removed, waking any thread waiting for it.
+ * \details The thread never waits on one Canvas: a Canvas with updates open, or whose threads are still on
+ *   their step on virtual time, is skipped and looked at again every POLL seconds until it can be drawn.
+ */
+void RenderService::run() {
+    const double POLL = 0.001;
+    ServiceState& state = service();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    std::vector<Canvas*> held;                                  // Canvases skipped for their open updates
+    while (!state.canvases.empty()) {
+        const std::vector<Canvas*> canvases = state.canvases;   // Only this thread removes Canvases
+        lock.unlock();
+        double soonest = HUGE_VAL;
+        for (unsigned i = 0; i < canvases.size() && soonest > 0; ++i) {
+            double wait = 0;
+            if (std::find(held.begin(), held.end(), canvases[i]) != held.end())
+                wait = POLL;                                    // Due, but not drawable yet
+            else if (!glfwWindowShouldClose(canvases[i]->window)) {
+                wait = canvases[i]->drawTimer->getTimeToFrame();
+                if (wait == HUGE_VAL)
+                    wait = POLL;                                // Its threads are still on their step
+            }
+            soonest = std::min(soonest, wait);
+        }
+        if (soonest > 0)
+            Timer::threadSleepFor(soonest);
+        held.clear();
+        for (unsigned i = 0; i < canvases.size(); ++i) {
+            Canvas* can = canvases[i];
+            if (glfwWindowShouldClose(can->window)) {
+                can->finishDrawing();
+                lock.lock();
+                state.canvases.erase(std::find(state.canvases.begin(), state.canvases.end(), can));
+                state.finished.notify_all();
+                lock.unlock();
+            } else if (can->drawTimer->getTimeToFrame() <= 0 && !can->drawFrame(false)) {
+                held.push_back(can);
+            }
+        }
+        glfwPollEvents();                   // Handle any I/O, for every window at once
+        lock.lock();
+    }
+    state.running = false;
+}
+
+}
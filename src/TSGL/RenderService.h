@@ -0,0 +1,65 @@
+/*
+ * RenderService.h provides a single rendering thread, and shared GL resources, for any number of Canvases.
+ */
+
+#ifndef RENDERSERVICE_H_
+#define RENDERSERVICE_H_
+
+class Shader;
+struct GLFWwindow;
+
+namespace tsgl {
+
+class Canvas;
+
+/*! \class RenderService
+ *  \brief Draws every open Canvas from one thread, with GL resources shared between their windows.
+ *  \details By default each Canvas has a rendering thread and a GL context of its own, and compiles its own
+ *    shaders. A program that opens several Canvases pays for a thread per window, and for switching each
+ *    thread's context in and out twice a frame. Once enable() is called, Canvases created afterward instead:
+ *    - create their contexts sharing objects with a hidden root context, so that shaders, buffers and textures
+ *      (such as the glyphs of Text and the pixels of Image) made in any window are usable in all of them;
+ *    - use one set of shaders, compiled by the first of them and freed with the last;
+ *    - are drawn by a single rendering thread, which sleeps until the next Canvas is due for a frame, draws
+ *      each Canvas that is due, and polls for input; so each Canvas keeps its own frame rate.
+ *    .
+ *  \details Each Canvas keeps its own vertex array and Background, since vertex arrays and framebuffers
+ *    belong to a single context. Canvases created before enable() is called keep a thread of their own.
+ *  \details The rendering thread does not wait for the displays' vertical refresh, which would hold every
+ *    window to the slowest; PACE_VSYNC is paced like PACE_TIMER instead. Nor does it wait on any one Canvas: one
+ *    that has an Update open or is paused with Canvas::pauseDrawing(), or whose threads are still on their step
+ *    on virtual time, is skipped, and drawn within a millisecond of being ready, while the others go on drawing
+ *    and input is still handled.
+ *  \note <b>OS X:</b> the rendering service is not supported, since OS X draws on the main thread.
+ */
+class RenderService {
+ public:
+    static void enable(bool on = true);
+
+    static bool isEnabled();
+
+    static unsigned getCanvasCount();
+ private:
+    friend class Canvas;
+
+    static GLFWwindow* shareWindow();
+
+    static unsigned shaders(Shader*& text, Shader*& shape, Shader*& texture);
+
+    static void add(Canvas * can);
+
+    static void wait(Canvas * can);
+
+    static void shutdown();
+
+    static void run();
+
+    RenderService();
+    ~RenderService();
+    RenderService(const RenderService&);
+    RenderService& operator=(const RenderService&);
+};
+
+}
+
+#endif /* RENDERSERVICE_H_ */
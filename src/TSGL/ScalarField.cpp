@@ -0,0 +1,471 @@
+#include "ScalarField.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tsgl {
+
+// Same inputs as the Canvas' texture shader, so that its vertex attributes can be reused as they are
+static const GLchar* fieldVertexShader =
+  "#version 330 core\n"
+  "layout (location = 0) in vec3 aPos;"
+  "layout (location = 1) in vec2 aTexCoord;"
+  "out vec2 TexCoords;"
+  "uniform mat4 projection;"
+  "uniform mat4 view;"
+  "uniform mat4 model;"
+  "void main() {"
+  "gl_Position = projection * view * model * vec4(aPos, 1.0);"
+  "TexCoords = aTexCoord;"
+  "}";
+
+static const GLchar* fieldFragmentShader =
+  "#version 330 core\n"
+  "out vec4 FragColor;"
+  "in vec2 TexCoords;"
+  "uniform sampler2D field;"
+  "uniform sampler2D colormap;"
+  "uniform float valueScale;"
+  "uniform float minValue;"
+  "uniform float invRange;"
+  "uniform float mapSize;"
+  "uniform float alpha;"
+  "void main() {"
+  "float t = clamp((texture(field, TexCoords).r * valueScale - minValue) * invRange, 0.0, 1.0);"
+  "vec4 color = texture(colormap, vec2((t * (mapSize - 1.0) + 0.5) / mapSize, 0.5));"
+  "FragColor = color * vec4(1.0,1.0,1.0,alpha);"
+  "}";
+
+// Converts values of one type to another while copying, rounding and clamping floats stored as bytes
+static inline void convertValue(float in, float& out) { out = in; }
+static inline void convertValue(uint8_t in, float& out) { out = in; }
+static inline void convertValue(uint8_t in, uint8_t& out) { out = in; }
+static inline void convertValue(float in, uint8_t& out) {
+    out = (in > 0.0f) ? ((in < 255.0f) ? (uint8_t) (in + 0.5f) : 255) : 0;
+}
+
+// Copies a block of values into a field's storage, clipping it to the field
+template <typename In, typename Out>
+static void copyBlock(std::vector<Out>& dest, int columns, int rows, int column, int row, int w, int h,
+                      const In* values, int stride, int& firstRow, int& lastRow) {
+    if (stride <= 0)
+        stride = w;
+    const int c0 = std::max(column, 0), c1 = std::min(column + w, columns);
+    const int r0 = std::max(row, 0), r1 = std::min(row + h, rows);
+    firstRow = r0; lastRow = r1 - 1;
+    if (c0 >= c1 || r0 >= r1)
+        return;
+    for (int r = r0; r < r1; ++r) {
+        const In* src = values + (size_t) (r - row) * stride + (c0 - column);
+        Out* dst = &dest[(size_t) r * columns + c0];
+        for (int c = 0; c < c1 - c0; ++c)
+            convertValue(src[c], dst[c]);
+    }
+}
+
+ /*!
+  * \brief Explicitly constructs a new ScalarField.
+  * \details This is the explicit constructor for the ScalarField class.
+  *   \param x The x coordinate of the center of the ScalarField.
+  *   \param y The y coordinate of the center of the ScalarField.
+  *   \param z The z coordinate of the center of the ScalarField.
+  *   \param columns The number of columns of cells.
+  *   \param rows The number of rows of cells.
+  *   \param width The width of the ScalarField.
+  *   \param height The height of the ScalarField.
+  *   \param yaw The yaw orientation of the ScalarField.
+  *   \param pitch The pitch orientation of the ScalarField.
+  *   \param roll The roll orientation of the ScalarField.
+  *   \param format The type of the values (set to FLOAT_FIELD by default).
+  * \return A new ScalarField with every value 0, drawn with a black to white gradient.
+  *   FLOAT_FIELDs map values between 0 and 1 to the gradient, and BYTE_FIELDs values between 0 and 255.
+  */
+ScalarField::ScalarField(float x, float y, float z, int columns, int rows, GLfloat width, GLfloat height,
+                         float yaw, float pitch, float roll, ScalarFieldFormat format) : Drawable(x,y,z,yaw,pitch,roll) {
+    myShader = 0;
+    myFieldTexture = myColormapTexture = 0;
+    vertices = 0;
+    if (columns <= 0 || rows <= 0) {
+        TsglDebug("Cannot have a ScalarField with no rows or columns.");
+        return;
+    }
+    if (width <= 0 || height <= 0) {
+        TsglDebug("Cannot have a ScalarField with width or height less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    shaderType = TEXTURE_SHADER_TYPE;
+    myFormat = format;
+    myColumns = columns; myRows = rows;
+    myWidth = width; myHeight = height;
+    myXScale = width; myYScale = height; myZScale = 1;
+    myAlpha = 1.0f;
+    if (myFormat == FLOAT_FIELD)
+        myFloats.assign((size_t) columns * rows, 0.0f);
+    else
+        myBytes.assign((size_t) columns * rows, 0);
+    Colormap gray = Colormap::gradient(BLACK, WHITE);
+    myColormap.assign(gray.data(), gray.data() + gray.size());
+    myMin = 0;
+    myMax = (myFormat == FLOAT_FIELD) ? 1 : 255;
+    mySmooth = false;
+    myDirtyFirst = 0; myDirtyLast = rows - 1;
+    myColormapDirty = myFilterDirty = true;
+
+    // positions (x,y,z)    texture coords, with row 0 of the texture at the top
+    const GLfloat quad[30] = {
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, // top right
+         0.5f, -0.5f, 0.0f,   1.0f, 1.0f, // bottom right
+        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f, // bottom left
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, // top right
+        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f, // bottom left
+        -0.5f,  0.5f, 0.0f,   0.0f, 0.0f  // top left
+    };
+    vertices = new GLfloat[30];
+    memcpy(vertices, quad, sizeof(quad));
+    init = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Creates the shader program and textures, on the thread that renders the Canvas.
+ */
+void ScalarField::initGL() {
+    myShader = new Shader(fieldVertexShader, fieldFragmentShader);
+    glGenTextures(1, &myFieldTexture);
+    glBindTexture(GL_TEXTURE_2D, myFieldTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (myFormat == FLOAT_FIELD)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, myColumns, myRows, 0, GL_RED, GL_FLOAT, NULL);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, myColumns, myRows, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+
+    glGenTextures(1, &myColormapTexture);
+    glBindTexture(GL_TEXTURE_2D, myColormapTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+ /*!
+  * \brief Draw the ScalarField.
+  * \details This function actually draws the ScalarField to the Canvas.
+  * \details Only the rows written since the last draw are sent to the GPU, and the Colormap is only sent
+  *   when it changes, so a field that changes a little each frame costs little to draw.
+  *   \param shader The Canvas' texture shader, whose camera matrices are copied into the field's own shader.
+  */
+void ScalarField::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+    if (!myShader)
+        initGL();
+
+    // Take the changes made since the last draw
+    dirtyMutex.lock();
+    int first = myDirtyFirst, last = myDirtyLast;
+    bool colormapDirty = myColormapDirty, filterDirty = myFilterDirty, smooth = mySmooth;
+    myDirtyFirst = myRows; myDirtyLast = -1;
+    myColormapDirty = myFilterDirty = false;
+    dirtyMutex.unlock();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, myColormapTexture);
+    if (colormapDirty) {
+        attribMutex.lock();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, myColormap.size(), 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, myColormap.data());
+        attribMutex.unlock();
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, myFieldTexture);
+    if (filterDirty) {
+        const GLint filter = smooth ? GL_LINEAR : GL_NEAREST;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    }
+    if (first <= last) {
+        if (myFormat == FLOAT_FIELD)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, myColumns, last - first + 1, GL_RED, GL_FLOAT,
+                            &myFloats[(size_t) first * myColumns]);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, myColumns, last - first + 1, GL_RED, GL_UNSIGNED_BYTE,
+                            &myBytes[(size_t) first * myColumns]);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // Use the Canvas' camera for our own program
+    glm::mat4 projection, view;
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "projection"), glm::value_ptr(projection));
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "view"), glm::value_ptr(view));
+
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(myRotationPointX, myRotationPointY, myRotationPointZ));
+    model = glm::rotate(model, glm::radians(myCurrentYaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::rotate(model, glm::radians(myCurrentPitch), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(myCurrentRoll), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::translate(model, glm::vec3(myCenterX - myRotationPointX, myCenterY - myRotationPointY, myCenterZ - myRotationPointZ));
+    model = glm::scale(model, glm::vec3(myXScale, myYScale, myZScale));
+
+    myShader->use();
+    myShader->setMat4("projection", projection);
+    myShader->setMat4("view", view);
+    myShader->setMat4("model", model);
+    myShader->setInt("field", 0);
+    myShader->setInt("colormap", 1);
+    myShader->setFloat("valueScale", (myFormat == FLOAT_FIELD) ? 1.0f : 255.0f);
+    myShader->setFloat("minValue", myMin);
+    myShader->setFloat("invRange", (myMax != myMin) ? 1.0f / (myMax - myMin) : 0.0f);
+    myShader->setFloat("mapSize", myColormap.size());
+    myShader->setFloat("alpha", myAlpha);
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 5, vertices, GL_DYNAMIC_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    shader->use();
+}
+
+/*!
+ * \brief Records that some rows need to be uploaded again.
+ */
+void ScalarField::markDirty(int firstRow, int lastRow) {
+    if (firstRow > lastRow)
+        return;
+    dirtyMutex.lock();
+    myDirtyFirst = std::min(myDirtyFirst, firstRow);
+    myDirtyLast = std::max(myDirtyLast, lastRow);
+    dirtyMutex.unlock();
+}
+
+/*!
+ * \brief Checks that a block of cells lies within the field, printing a message if it does not.
+ */
+bool ScalarField::checkCell(int column, int row, int w, int h) {
+    if (!init)
+        return false;
+    if (column < 0 || row < 0 || column + w > myColumns || row + h > myRows) {
+        TsglDebug("ScalarField cell out of range.");
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Mutates the value of one cell.
+ * \details A value written to a BYTE_FIELD is rounded and clamped between 0 and 255.
+ * \param column The column of the cell.
+ * \param row The row of the cell, 0 being the top row.
+ * \param value The cell's new value.
+ */
+void ScalarField::setValue(int column, int row, float value) {
+    if (!checkCell(column, row))
+        return;
+    const size_t i = (size_t) row * myColumns + column;
+    if (myFormat == FLOAT_FIELD)
+        myFloats[i] = value;
+    else
+        convertValue(value, myBytes[i]);
+    markDirty(row, row);
+}
+
+/*!
+ * \brief Mutates the values of a block of cells.
+ * \details This is the fast way to fill a field: the values are copied straight into the field's storage,
+ *   and the rows they cover are sent to the GPU together at the next draw. Parts of the block that fall
+ *   outside of the field are ignored.
+ * \param column The column of the block's left edge.
+ * \param row The row of the block's top edge.
+ * \param w The width of the block, in cells.
+ * \param h The height of the block, in cells.
+ * \param values Array of the block's values, a row at a time from the top.
+ * \param stride Number of values between the starts of consecutive rows of <code>values</code>
+ *   (set to 0, meaning <code>w</code>, by default).
+ */
+void ScalarField::setValues(int column, int row, int w, int h, const float* values, int stride) {
+    if (!init || w <= 0 || h <= 0)
+        return;
+    int first, last;
+    if (myFormat == FLOAT_FIELD)
+        copyBlock(myFloats, myColumns, myRows, column, row, w, h, values, stride, first, last);
+    else
+        copyBlock(myBytes, myColumns, myRows, column, row, w, h, values, stride, first, last);
+    markDirty(first, last);
+}
+
+/*!
+ * \brief Mutates the values of a block of cells, from bytes.
+ * \details Best suited to BYTE_FIELDs, where the bytes are copied as they are.
+ * \param column The column of the block's left edge.
+ * \param row The row of the block's top edge.
+ * \param w The width of the block, in cells.
+ * \param h The height of the block, in cells.
+ * \param values Array of the block's values, a row at a time from the top.
+ * \param stride Number of values between the starts of consecutive rows of <code>values</code>
+ *   (set to 0, meaning <code>w</code>, by default).
+ */
+void ScalarField::setValues(int column, int row, int w, int h, const uint8_t* values, int stride) {
+    if (!init || w <= 0 || h <= 0)
+        return;
+    int first, last;
+    if (myFormat == FLOAT_FIELD)
+        copyBlock(myFloats, myColumns, myRows, column, row, w, h, values, stride, first, last);
+    else
+        copyBlock(myBytes, myColumns, myRows, column, row, w, h, values, stride, first, last);
+    markDirty(first, last);
+}
+
+/*!
+ * \brief Mutates the values of one whole row of cells.
+ * \param row The row, 0 being the top row.
+ * \param values Array of <code>getColumns()</code> values.
+ */
+void ScalarField::setRow(int row, const float* values) {
+    if (checkCell(0, row))
+        setValues(0, row, myColumns, 1, values);
+}
+
+/*!
+ * \brief Mutates the values of one whole row of cells, from bytes.
+ * \param row The row, 0 being the top row.
+ * \param values Array of <code>getColumns()</code> values.
+ */
+void ScalarField::setRow(int row, const uint8_t* values) {
+    if (checkCell(0, row))
+        setValues(0, row, myColumns, 1, values);
+}
+
+/*!
+ * \brief Mutates every cell to the same value.
+ * \param value The new value of every cell.
+ */
+void ScalarField::fill(float value) {
+    if (!init)
+        return;
+    if (myFormat == FLOAT_FIELD) {
+        std::fill(myFloats.begin(), myFloats.end(), value);
+    } else {
+        uint8_t b;
+        convertValue(value, b);
+        std::fill(myBytes.begin(), myBytes.end(), b);
+    }
+    markDirty(0, myRows - 1);
+}
+
+/*!
+ * \brief Accessor for the value of one cell.
+ * \param column The column of the cell.
+ * \param row The row of the cell, 0 being the top row.
+ * \return The cell's value, or 0 if the cell is out of range.
+ */
+float ScalarField::getValue(int column, int row) {
+    if (!checkCell(column, row))
+        return 0;
+    const size_t i = (size_t) row * myColumns + column;
+    return (myFormat == FLOAT_FIELD) ? myFloats[i] : myBytes[i];
+}
+
+/*!
+ * \brief Mutates the colors the values are mapped to.
+ * \details The value getMin() is drawn with the first color of the Colormap, getMax() with the last,
+ *   and values in between with the nearest entry.
+ * \param colormap The new Colormap. It is copied, so it may be changed or destroyed afterward.
+ */
+void ScalarField::setColormap(const Colormap& colormap) {
+    attribMutex.lock();
+    myColormap.assign(colormap.data(), colormap.data() + colormap.size());
+    attribMutex.unlock();
+    dirtyMutex.lock();
+    myColormapDirty = true;
+    dirtyMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the range of values spread across the Colormap.
+ * \details Values outside the range are drawn with the color at the nearest end of the Colormap.
+ * \param min The value drawn with the first color.
+ * \param max The value drawn with the last color.
+ * \note For BYTE_FIELDs, <code>min</code> and <code>max</code> are between 0 and 255.
+ */
+void ScalarField::setRange(float min, float max) {
+    if (min == max) {
+        TsglDebug("Cannot have a ScalarField range with min equal to max.");
+        return;
+    }
+    attribMutex.lock();
+    myMin = min;
+    myMax = max;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates how cells are scaled to the field's size.
+ * \param smooth If true, values are interpolated bilinearly between the centers of the cells before being
+ *   colored. If false, each cell is drawn as a flat rectangle.
+ */
+void ScalarField::setSmoothing(bool smooth) {
+    dirtyMutex.lock();
+    mySmooth = smooth;
+    myFilterDirty = true;
+    dirtyMutex.unlock();
+}
+
+/**
+ *  \brief Alters the ScalarField's transparency
+ *  \param alpha The ScalarField's new alpha value.
+ *  \note If parameter not 0.0 <= alpha <= 1.0 then this method will have no effect.
+ */
+void ScalarField::setAlpha(float alpha) {
+    if (alpha < 0.0 || alpha > 1.0) {
+        TsglDebug("Cannot have a ScalarField with alpha not 0.0 <= alpha <= 1.0.");
+        return;
+    }
+    attribMutex.lock();
+    myAlpha = alpha;
+    attribMutex.unlock();
+}
+
+/**
+ * \brief Mutates the distance from the left side of the ScalarField to its right side.
+ * \param width The ScalarField's new width.
+ */
+void ScalarField::setWidth(GLfloat width) {
+    if (width <= 0) {
+        TsglDebug("Cannot have a ScalarField with width less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    myWidth = width;
+    myXScale = width;
+    attribMutex.unlock();
+}
+
+/**
+ * \brief Mutates the distance from the top of the ScalarField to its bottom.
+ * \param height The ScalarField's new height.
+ */
+void ScalarField::setHeight(GLfloat height) {
+    if (height <= 0) {
+        TsglDebug("Cannot have a ScalarField with height less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    myHeight = height;
+    myYScale = height;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Destroys the ScalarField and its textures.
+ */
+ScalarField::~ScalarField() {
+    if (myFieldTexture)
+        glDeleteTextures(1, &myFieldTexture);
+    if (myColormapTexture)
+        glDeleteTextures(1, &myColormapTexture);
+    delete myShader;
+}
+
+}
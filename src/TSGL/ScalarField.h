@@ -0,0 +1,135 @@
+/*
+ * ScalarField.h extends Drawable and provides a class for drawing a grid of values as a colormapped image.
+ */
+
+#ifndef SCALARFIELD_H_
+#define SCALARFIELD_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "Drawable.h"           // For extending our Drawable object
+
+namespace tsgl {
+
+/*!
+ * \brief The type of the values stored in a ScalarField.
+ * \details FLOAT_FIELD stores one 32-bit float per cell. BYTE_FIELD stores one unsigned byte (0-255) per cell,
+ *   which is a quarter of the memory and upload bandwidth, and is enough for cell states.
+ */
+enum ScalarFieldFormat {
+    FLOAT_FIELD, BYTE_FIELD
+};
+
+/*! \class ScalarField
+ *  \brief Draw a grid of numbers to the Canvas, colored on the GPU.
+ *  \details ScalarField is a rectangle covered by a grid of <code>columns</code> x <code>rows</code> cells, each
+ *   holding one number. Threads write raw values into the field (one at a time, a row at a time, or a block
+ *   at a time) without doing any color work; when the Canvas draws the field, the rows that changed are
+ *   uploaded to a single-channel texture and a fragment shader looks each value up in a Colormap.
+ *  \details The grid and the rectangle it is drawn into are independent, so a field can have many more or many
+ *   fewer cells than the window has pixels. Cells can be drawn as flat squares (the default), or smoothly
+ *   interpolated between their centers with setSmoothing().
+ *  \details Row 0 is the top row of the field, and column 0 is its left column.
+ *  \details Writes from several threads at once are safe as long as they are to different cells.
+ *  \note The Canvas draws a ScalarField with its own shader program, which it creates the first time it draws.
+ */
+class ScalarField : public Drawable {
+ private:
+    ScalarFieldFormat myFormat;
+    int myColumns, myRows;
+    GLfloat myWidth, myHeight;
+    std::vector<float> myFloats;
+    std::vector<uint8_t> myBytes;
+    std::vector<uint32_t> myColormap;
+    float myMin, myMax;
+    bool mySmooth;
+
+    std::mutex dirtyMutex;              // Protects the dirty flags below, not the values themselves
+    int myDirtyFirst, myDirtyLast;      // Rows that have changed since the last upload
+    bool myColormapDirty, myFilterDirty;
+
+    Shader* myShader;
+    GLuint myFieldTexture, myColormapTexture;
+
+    void markDirty(int firstRow, int lastRow);
+    bool checkCell(int column, int row, int w = 1, int h = 1);
+    void initGL();
+ public:
+    ScalarField(float x, float y, float z, int columns, int rows, GLfloat width, GLfloat height,
+                float yaw, float pitch, float roll, ScalarFieldFormat format = FLOAT_FIELD);
+
+    virtual void draw(Shader * shader);
+
+    void setValue(int column, int row, float value);
+
+    void setValues(int column, int row, int w, int h, const float* values, int stride = 0);
+
+    void setValues(int column, int row, int w, int h, const uint8_t* values, int stride = 0);
+
+    void setRow(int row, const float* values);
+
+    void setRow(int row, const uint8_t* values);
+
+    void fill(float value);
+
+    float getValue(int column, int row);
+
+    void setColormap(const Colormap& colormap);
+
+    void setRange(float min, float max);
+
+    void setSmoothing(bool smooth);
+
+    void setAlpha(float alpha);
+
+    void setWidth(GLfloat width);
+
+    void setHeight(GLfloat height);
+
+    /*!
+     * \brief Accessor for the number of columns of cells.
+     */
+    int getColumns() { return myColumns; }
+
+    /*!
+     * \brief Accessor for the number of rows of cells.
+     */
+    int getRows() { return myRows; }
+
+    /*!
+     * \brief Accessor for the type of values the field stores.
+     */
+    ScalarFieldFormat getFormat() { return myFormat; }
+
+    /*!
+     * \brief Accessor for the field's width.
+     */
+    GLfloat getWidth() { return myWidth; }
+
+    /*!
+     * \brief Accessor for the field's height.
+     */
+    GLfloat getHeight() { return myHeight; }
+
+    /*!
+     * \brief Accessor for the value that maps to the first color of the Colormap.
+     */
+    float getMin() { return myMin; }
+
+    /*!
+     * \brief Accessor for the value that maps to the last color of the Colormap.
+     */
+    float getMax() { return myMax; }
+
+    /*!
+     * \brief Accessor for whether values are interpolated between cell centers.
+     */
+    bool getSmoothing() { return mySmooth; }
+
+    virtual ~ScalarField();
+};
+
+}
+
+#endif /* SCALARFIELD_H_ */
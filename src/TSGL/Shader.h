@@ -13,14 +13,11 @@ class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly; the Canvas has already initialized GLEW.
+    // retrievable asks the driver to keep the linked binary for ShaderCache.
     // ------------------------------------------------------------------------
-    Shader(const char* vertexShader, const char* fragmentShader, const char* geometryShader = nullptr)
+    Shader(const char* vertexShader, const char* fragmentShader, const char* geometryShader = nullptr, bool retrievable = false)
     {
-
-        GLenum err = glewInit();
-        if (err != GLEW_OK)
-            exit(1); // or handle the error in a nicer way
         if (!GLEW_VERSION_2_1)  // check that the machine supports the 2.1 API.
             exit(1); // or handle the error in a nicer way		
         // 2. compile shaders
@@ -52,6 +49,8 @@ public:
         glAttachShader(ID, fragment);
         if(geometryShader != nullptr)
             glAttachShader(ID, geometry);
+        if(retrievable)
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessery
@@ -61,6 +60,9 @@ public:
             glDeleteShader(geometry);
 
     }
+    // constructor that adopts a program that is already linked, such as one loaded by ShaderCache
+    // ------------------------------------------------------------------------
+    explicit Shader(unsigned int program) : ID(program) {}
     // activate the shader
     // ------------------------------------------------------------------------
     void use() 
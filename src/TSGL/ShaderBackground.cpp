@@ -0,0 +1,217 @@
+#include "ShaderBackground.h"
+
+namespace tsgl {
+
+// Declarations available to the user's source, which follows this
+static const char* shaderBackgroundPreamble =
+  "#version 330 core\n"
+  "in vec2 TexCoords;\n"
+  "out vec4 FragColor;\n"
+  "uniform float time;\n"
+  "uniform vec2 resolution;\n"
+  "uniform vec4 bounds;\n"
+  "#line 1\n";
+
+static const char* shaderBackgroundMain =
+  "\nvoid main() {\n"
+  "FragColor = shade(mix(bounds.xy, bounds.zw, TexCoords));\n"
+  "}\n";
+
+ /*!
+  * \brief Explicitly constructs a new ShaderBackground.
+  * \details Explicit constructor for a ShaderBackground object.
+  *   \param width ShaderBackground's width in pixels.
+  *   \param height ShaderBackground's height in pixels.
+  *   \param fragmentSource GLSL source defining <code>vec4 shade(vec2 position)</code>.
+  *   \param c A ColorFloat for the color the ShaderBackground is cleared to (set to BLACK by default).
+  * \return A new ShaderBackground, to be passed to a Canvas' constructor or Canvas::setBackground().
+  *   The shader is compiled the first time the Canvas draws the ShaderBackground.
+  */
+ShaderBackground::ShaderBackground(GLint width, GLint height, const std::string& fragmentSource, const ColorFloat &c)
+  : Background(width, height, c) {
+    attribMutex.lock();
+    mySource = fragmentSource;
+    mySourceChanged = true;
+    myShader = 0;
+    myBounds[0] = -width / 2.0f;
+    myBounds[1] = -height / 2.0f;
+    myBounds[2] = width / 2.0f;
+    myBounds[3] = height / 2.0f;
+    myStartTime = std::chrono::steady_clock::now();
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Runs the fragment shader over the whole framebuffer.
+ * \details Compiles the shader first if its source has changed, then sets the built-in and user uniforms.
+ */
+void ShaderBackground::drawUnderlay() {
+    attribMutex.lock();
+    if (mySourceChanged) {
+        if (myShader) {
+            glDeleteProgram(myShader->ID);
+            delete myShader;
+        }
+        myShader = createScreenShader(shaderBackgroundPreamble + mySource + shaderBackgroundMain);
+        if (!myShader)
+            TsglErr("ShaderBackground: the fragment shader failed to compile.");
+        mySourceChanged = false;
+    }
+    if (!myShader) {
+        attribMutex.unlock();
+        return;
+    }
+
+    myShader->use();
+    myShader->setFloat("time", getTime());
+    myShader->setVec2("resolution", myWidth, myHeight);
+    myShader->setVec4("bounds", myBounds[0], myBounds[1], myBounds[2], myBounds[3]);
+    for (std::map<std::string, Uniform>::iterator it = myUniforms.begin(); it != myUniforms.end(); ++it) {
+        const GLint loc = glGetUniformLocation(myShader->ID, it->first.c_str());
+        const Uniform& u = it->second;
+        const GLsizei count = u.values.size() / u.components;
+        switch (u.components) {
+            case 1: glUniform1fv(loc, count, &u.values[0]); break;
+            case 2: glUniform2fv(loc, count, &u.values[0]); break;
+            case 3: glUniform3fv(loc, count, &u.values[0]); break;
+            default: glUniform4fv(loc, count, &u.values[0]); break;
+        }
+    }
+    attribMutex.unlock();
+
+    glDisable(GL_DEPTH_TEST);           // Also keeps the quad out of the depth buffer
+    drawScreenQuad();
+    glEnable(GL_DEPTH_TEST);
+}
+
+/*!
+ * \brief Mutator for the fragment shader's source.
+ * \details The new source is compiled the next time the ShaderBackground is drawn. Uniforms set with
+ *   setUniform() and setUniformArray() are kept.
+ *   \param fragmentSource GLSL source defining <code>vec4 shade(vec2 position)</code>.
+ */
+void ShaderBackground::setShader(const std::string& fragmentSource) {
+    attribMutex.lock();
+    mySource = fragmentSource;
+    mySourceChanged = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for the coordinates passed to <code>shade()</code>.
+ * \details For example, pass a CartesianCanvas' getMinX(), getMinY(), getMaxX() and getMaxY() to shade in
+ *   Cartesian coordinates, and pass them again after zooming.
+ *   \param minX The x coordinate at the left edge of the Background.
+ *   \param minY The y coordinate at the bottom edge of the Background.
+ *   \param maxX The x coordinate at the right edge of the Background.
+ *   \param maxY The y coordinate at the top edge of the Background.
+ */
+void ShaderBackground::setBounds(float minX, float minY, float maxX, float maxY) {
+    attribMutex.lock();
+    myBounds[0] = minX;
+    myBounds[1] = minY;
+    myBounds[2] = maxX;
+    myBounds[3] = maxY;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Stores a uniform's value until the next draw.
+ */
+void ShaderBackground::storeUniform(const std::string& name, int components, const float* values, int count) {
+    attribMutex.lock();
+    Uniform& u = myUniforms[name];
+    u.components = components;
+    u.values.assign(values, values + components * count);
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for a <code>float</code> uniform declared in the shader's source.
+ *   \param name The name of the uniform.
+ *   \param x The uniform's new value.
+ */
+void ShaderBackground::setUniform(const std::string& name, float x) {
+    storeUniform(name, 1, &x, 1);
+}
+
+/*!
+ * \brief Mutator for a <code>vec2</code> uniform declared in the shader's source.
+ *   \param name The name of the uniform.
+ *   \param x The uniform's new x component.
+ *   \param y The uniform's new y component.
+ */
+void ShaderBackground::setUniform(const std::string& name, float x, float y) {
+    float v[2] = { x, y };
+    storeUniform(name, 2, v, 1);
+}
+
+/*!
+ * \brief Mutator for a <code>vec3</code> uniform declared in the shader's source.
+ *   \param name The name of the uniform.
+ *   \param x The uniform's new x component.
+ *   \param y The uniform's new y component.
+ *   \param z The uniform's new z component.
+ */
+void ShaderBackground::setUniform(const std::string& name, float x, float y, float z) {
+    float v[3] = { x, y, z };
+    storeUniform(name, 3, v, 1);
+}
+
+/*!
+ * \brief Mutator for a <code>vec4</code> uniform declared in the shader's source.
+ *   \param name The name of the uniform.
+ *   \param x The uniform's new x component.
+ *   \param y The uniform's new y component.
+ *   \param z The uniform's new z component.
+ *   \param w The uniform's new w component.
+ */
+void ShaderBackground::setUniform(const std::string& name, float x, float y, float z, float w) {
+    float v[4] = { x, y, z, w };
+    storeUniform(name, 4, v, 1);
+}
+
+/*!
+ * \brief Mutator for a <code>vec4</code> uniform declared in the shader's source, from a color.
+ *   \param name The name of the uniform.
+ *   \param color The uniform's new value, as (R, G, B, A).
+ */
+void ShaderBackground::setUniform(const std::string& name, const ColorFloat& color) {
+    float v[4] = { color.R, color.G, color.B, color.A };
+    storeUniform(name, 4, v, 1);
+}
+
+/*!
+ * \brief Mutator for an array uniform declared in the shader's source.
+ * \details For example, <code>uniform vec2 sites[16];</code> is set with
+ *   <code>setUniformArray("sites", xy, 16, 2)</code>, where <code>xy</code> holds 32 floats.
+ *   \param name The name of the uniform.
+ *   \param values Array of <code>count * components</code> floats.
+ *   \param count The number of elements to set, at most the declared length of the array.
+ *   \param components The number of floats in each element: 1 for <code>float</code>, up to 4 for
+ *     <code>vec4</code> (set to 1 by default).
+ */
+void ShaderBackground::setUniformArray(const std::string& name, const float* values, int count, int components) {
+    if (count <= 0 || components < 1 || components > 4) {
+        TsglDebug("ShaderBackground uniform arrays need a positive count and 1 to 4 components.");
+        return;
+    }
+    storeUniform(name, components, values, count);
+}
+
+/*!
+ * \brief Accessor for the value of the <code>time</code> uniform.
+ * \return The number of seconds since the ShaderBackground was created.
+ */
+float ShaderBackground::getTime() {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - myStartTime).count();
+}
+
+/*!
+ * \brief Destroys the ShaderBackground and its shader.
+ */
+ShaderBackground::~ShaderBackground() {
+    delete myShader;
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * ShaderBackground.h extends Background and provides a Background whose pixels are computed by a fragment shader.
+ */
+
+#ifndef SHADERBACKGROUND_H_
+#define SHADERBACKGROUND_H_
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Background.h"     // For extending our Background object
+
+namespace tsgl {
+
+/*! \class ShaderBackground
+ *  \brief A Background painted every frame by a user-supplied GLSL fragment shader.
+ *  \details ShaderBackground runs a short piece of GLSL once for every pixel of the Background, on every frame,
+ *   on the graphics card (or the system's software rasterizer). Per-pixel generators such as fractals,
+ *   gradients and color wheels written this way run in parallel across all pixels without any CPU threads,
+ *   and cost the same no matter how often they change.
+ *  \details The source must define the function <code>vec4 shade(vec2 position)</code>, which returns the RGBA
+ *   color of the pixel at <code>position</code>. Positions run from (minX, minY) at the bottom left of the
+ *   Background to (maxX, maxY) at the top right, as set by setBounds(); by default they are the same centered
+ *   pixel coordinates used by Background::drawPixel(). The source may also read these uniforms:
+ *   - <code>float time</code>: seconds since the ShaderBackground was created.
+ *   - <code>vec2 resolution</code>: the width and height of the Background in pixels.
+ *   - <code>vec4 bounds</code>: (minX, minY, maxX, maxY).
+ *   .
+ *   and any uniforms it declares itself, which are set with setUniform() and setUniformArray().
+ *  \details Since the shader repaints the whole Background every frame, anything drawn onto it with the
+ *   Background's draw functions lasts for one frame. Drawables added to the Canvas are drawn on top as usual.
+ *  \details If the source fails to compile, the errors are printed (with line numbers counted from the start of
+ *   the user's source) and the Background is drawn with its clear color.
+ */
+class ShaderBackground : public Background {
+ private:
+    struct Uniform {
+        int components;
+        std::vector<float> values;
+    };
+
+    std::string mySource;
+    bool mySourceChanged;
+    Shader * myShader;
+    std::map<std::string, Uniform> myUniforms;
+    GLfloat myBounds[4];
+    std::chrono::steady_clock::time_point myStartTime;
+
+    void storeUniform(const std::string& name, int components, const float* values, int count);
+ protected:
+    virtual void drawUnderlay();
+ public:
+    ShaderBackground(GLint width, GLint height, const std::string& fragmentSource, const ColorFloat &c = BLACK);
+
+    void setShader(const std::string& fragmentSource);
+
+    void setBounds(float minX, float minY, float maxX, float maxY);
+
+    void setUniform(const std::string& name, float x);
+
+    void setUniform(const std::string& name, float x, float y);
+
+    void setUniform(const std::string& name, float x, float y, float z);
+
+    void setUniform(const std::string& name, float x, float y, float z, float w);
+
+    void setUniform(const std::string& name, const ColorFloat& color);
+
+    void setUniformArray(const std::string& name, const float* values, int count, int components = 1);
+
+    float getTime();
+
+    /*!
+     * \brief Accessor for the x coordinate at the left edge of the Background.
+     */
+    float getMinX() { return myBounds[0]; }
+
+    /*!
+     * \brief Accessor for the y coordinate at the bottom edge of the Background.
+     */
+    float getMinY() { return myBounds[1]; }
+
+    /*!
+     * \brief Accessor for the x coordinate at the right edge of the Background.
+     */
+    float getMaxX() { return myBounds[2]; }
+
+    /*!
+     * \brief Accessor for the y coordinate at the top edge of the Background.
+     */
+    float getMaxY() { return myBounds[3]; }
+
+    virtual ~ShaderBackground();
+};
+
+}
+
+#endif /* SHADERBACKGROUND_H_ */
@@ -0,0 +1,279 @@
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+  #include <direct.h>
+#endif
+
+#include "Shader.h"
+
+namespace tsgl {
+
+namespace {
+
+const char MAGIC[] = "TSGL program binary 1\n";
+
+// Shared state of the cache.
+struct CacheState {
+    std::mutex mutex;                       // Protects everything below
+    bool located;                           // Whether the directory has been looked up or set
+    std::string directory;
+    std::map<uint64_t, std::shared_future<std::string> > files;  // Contents of each program's file, read or made
+
+    CacheState() : located(false) {}
+};
+
+CacheState& cache() {
+    static CacheState state;
+    return state;
+}
+
+// Names a program by its source, with 64-bit FNV-1a.
+uint64_t programKey(const char* vertexShader, const char* fragmentShader) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* source : { vertexShader, fragmentShader }) {
+        for (const char* c = source; *c; ++c) {
+            hash ^= (unsigned char) *c;
+            hash *= 1099511628211ull;
+        }
+        hash ^= 0xff;                       // So that moving text between the two sources changes the key
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string defaultDirectory() {
+    const char* env = std::getenv("TSGL_SHADER_CACHE");
+    if (env)
+        return env;
+  #ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if (base && *base)
+        return std::string(base) + "\\tsgl";
+  #else
+    const char* base = std::getenv("XDG_CACHE_HOME");
+    if (base && *base)
+        return std::string(base) + "/tsgl";
+    const char* home = std::getenv("HOME");
+    if (home && *home)
+        return std::string(home) + "/.cache/tsgl";
+  #endif
+    return "";
+}
+
+// Creates a directory and any missing parents. Failures show up when the files are written.
+void makeDirectories(const std::string& path) {
+    for (size_t i = 1; i <= path.size(); ++i) {
+        if (i < path.size() && path[i] != '/' && path[i] != '\\')
+            continue;
+        const std::string prefix = path.substr(0, i);
+      #ifdef _WIN32
+        _mkdir(prefix.c_str());
+      #else
+        mkdir(prefix.c_str(), 0755);
+      #endif
+    }
+}
+
+std::string fileName(const std::string& directory, uint64_t key) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) key);
+    return directory + "/" + name;
+}
+
+// Reads a whole file, or returns an empty string if there is none.
+std::string readFile(const std::string& filename) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in)
+        return "";
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+// Writes a whole file through a temporary, so that readers never see it half written.
+void writeFile(const std::string& filename, const std::string& contents) {
+    std::ostringstream tmp;
+    tmp << filename << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+    {
+        std::ofstream out(tmp.str().c_str(), std::ios::binary);
+        if (!out)
+            return;
+        out.write(contents.data(), contents.size());
+        if (!out) {
+            out.close();
+            std::remove(tmp.str().c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.str().c_str(), filename.c_str()) != 0) {
+        std::remove(filename.c_str());      // Windows will not rename over an existing file
+        if (std::rename(tmp.str().c_str(), filename.c_str()) != 0)
+            std::remove(tmp.str().c_str());
+    }
+}
+
+// Names the driver that made a binary; a binary is only loaded on the same one.
+std::string driverName() {
+    std::string name;
+    const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (unsigned i = 0; i < 3; ++i) {
+        const GLubyte* s = glGetString(strings[i]);
+        if (s)
+            name += (const char*) s;
+        name += "\n";
+    }
+    return name;
+}
+
+bool binariesSupported() {
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// Makes a program from the contents of a cache file, or returns 0 if the file is missing, stale or refused.
+GLuint programFromFile(const std::string& file, const std::string& driver) {
+    const std::string header = MAGIC + driver;
+    if (file.size() <= header.size() + sizeof(GLenum) || file.compare(0, header.size(), header) != 0)
+        return 0;
+    GLenum format;
+    std::memcpy(&format, file.data() + header.size(), sizeof(GLenum));
+    const size_t offset = header.size() + sizeof(GLenum);
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, file.data() + offset, (GLsizei) (file.size() - offset));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Makes the contents of a cache file from a linked program, or returns an empty string if the driver won't.
+std::string fileFromProgram(GLuint program, const std::string& driver) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return "";
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, &binary[0]);
+    if (written <= 0)
+        return "";
+    std::string file = MAGIC + driver;
+    file.append((const char*) &format, sizeof(GLenum));
+    file.append(&binary[0], written);
+    return file;
+}
+
+}
+
+/*!
+ * \brief Makes a shader program, from a cached binary if there is a usable one.
+ * \details The calling thread must have a GL context current. If the program has to be compiled, and the
+ *   driver supports it, its binary is saved for next time.
+ *   \param vertexShader The source of the vertex shader.
+ *   \param fragmentShader The source of the fragment shader.
+ *   \param compiled If not 0, set to whether the program had to be compiled from source.
+ * \return A new Shader, which the caller owns.
+ */
+Shader* ShaderCache::load(const char* vertexShader, const char* fragmentShader, bool* compiled) {
+    if (compiled)
+        *compiled = true;
+    const std::string directory = getDirectory();
+    if (directory.empty() || !binariesSupported())
+        return new Shader(vertexShader, fragmentShader);
+
+    prefetch(vertexShader, fragmentShader);
+    const uint64_t key = programKey(vertexShader, fragmentShader);
+    CacheState& state = cache();
+    std::shared_future<std::string> file;
+    state.mutex.lock();
+    file = state.files[key];
+    state.mutex.unlock();
+
+    const std::string driver = driverName();
+    if (file.valid()) {
+        GLuint program = programFromFile(file.get(), driver);
+        if (program) {
+            if (compiled)
+                *compiled = false;
+            return new Shader(program);
+        }
+    }
+
+    Shader* shader = new Shader(vertexShader, fragmentShader, nullptr, true);
+    const std::string made = fileFromProgram(shader->ID, driver);
+    if (!made.empty()) {
+        makeDirectories(directory);
+        writeFile(fileName(directory, key), made);
+        std::promise<std::string> ready;
+        ready.set_value(made);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.files[key] = ready.get_future().share();
+    }
+    return shader;
+}
+
+/*!
+ * \brief Starts reading a program's cached binary from disk in the background.
+ * \details Returns at once. Does nothing if the binary has already been read, or the cache is off.
+ *   \param vertexShader The source of the vertex shader.
+ *   \param fragmentShader The source of the fragment shader.
+ */
+void ShaderCache::prefetch(const char* vertexShader, const char* fragmentShader) {
+    const std::string directory = getDirectory();
+    if (directory.empty())
+        return;
+    const uint64_t key = programKey(vertexShader, fragmentShader);
+    CacheState& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::shared_future<std::string>& file = state.files[key];
+    if (!file.valid())
+        file = std::async(std::launch::async, readFile, fileName(directory, key)).share();
+}
+
+/*!
+ * \brief Accessor for the directory the binaries are kept in, or an empty string if the cache is off.
+ */
+std::string ShaderCache::getDirectory() {
+    CacheState& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.located) {
+        state.directory = defaultDirectory();
+        state.located = true;
+    }
+    return state.directory;
+}
+
+/*!
+ * \brief Mutator for the directory the binaries are kept in.
+ * \details Binaries already read from the old directory are still used.
+ *   \param directory The new directory, which is created when the first binary is saved, or an empty string
+ *     to turn the cache off.
+ */
+void ShaderCache::setDirectory(const std::string& directory) {
+    CacheState& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.directory = directory;
+    state.located = true;
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * ShaderCache.h provides a cache on disk of linked shader programs, so that Canvases open without recompiling.
+ */
+
+#ifndef SHADERCACHE_H_
+#define SHADERCACHE_H_
+
+#include <string>
+
+class Shader;
+
+namespace tsgl {
+
+/*! \class ShaderCache
+ *  \brief Keeps the binaries of linked shader programs on disk, so that later runs skip compiling them.
+ *  \details Compiling and linking GLSL is most of the time it takes to open a Canvas. Where the driver can
+ *    hand back a linked program as a binary (OpenGL 4.1, or ARB_get_program_binary), load() saves it in the
+ *    cache directory, keyed by the program's source, and later runs load the binary instead of compiling.
+ *    - A binary is only used on the renderer and driver version that made it. If the driver refuses it anyway,
+ *      the program is compiled from source and the binary replaced.
+ *    - prefetch() reads a program's binary from disk in the background, so that the read overlaps the
+ *      creation of the window; Canvas prefetches its own shaders before creating its window.
+ *    - Binaries read or made once are kept in memory, so later Canvases in the same run do not read the disk.
+ *    .
+ *  \details The cache directory is, in order, the TSGL_SHADER_CACHE environment variable, a tsgl directory
+ *    under XDG_CACHE_HOME or LOCALAPPDATA, or ~/.cache/tsgl. An empty directory turns the cache off.
+ *    Writes go to a temporary file that is then renamed, so any number of processes may share the directory.
+ */
+class ShaderCache {
+ public:
+    static Shader* load(const char* vertexShader, const char* fragmentShader, bool* compiled = 0);
+
+    static void prefetch(const char* vertexShader, const char* fragmentShader);
+
+    static std::string getDirectory();
+
+    static void setDirectory(const std::string& directory);
+ private:
+    ShaderCache();
+    ~ShaderCache();
+    ShaderCache(const ShaderCache&);
+    ShaderCache& operator=(const ShaderCache&);
+};
+
+}
+
+#endif /* SHADERCACHE_H_ */
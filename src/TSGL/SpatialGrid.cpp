@@ -0,0 +1,87 @@
+#include "SpatialGrid.h"
+
+#include <cmath>
+#include <omp.h>
+
+namespace tsgl {
+
+/*!
+ * \brief Explicitly constructs a new, empty SpatialGrid.
+ * \details Points may lie outside of the given region, but they all share its edge cells, so queries near
+ *   them get slower.
+ *   \param minX The smallest x coordinate covered by the grid.
+ *   \param minY The smallest y coordinate covered by the grid.
+ *   \param maxX The largest x coordinate covered by the grid.
+ *   \param maxY The largest y coordinate covered by the grid.
+ *   \param cellSize The width and height of each cell. Usually the radius of the most common query.
+ * \return A new SpatialGrid containing no points.
+ */
+SpatialGrid::SpatialGrid(float minX, float minY, float maxX, float maxY, float cellSize) {
+    if (maxX < minX) { float tmp = minX; minX = maxX; maxX = tmp; }
+    if (maxY < minY) { float tmp = minY; minY = maxY; maxY = tmp; }
+    if (!(cellSize > 0))
+        cellSize = 1;
+    this->minX = minX;
+    this->minY = minY;
+    this->cellSize = cellSize;
+    invCellSize = 1.0f / cellSize;
+    cellsX = (int) std::floor((maxX - minX) * invCellSize) + 1;
+    cellsY = (int) std::floor((maxY - minY) * invCellSize) + 1;
+    cellStart.assign(cellsX * cellsY + 1, 0);
+}
+
+/*!
+ * \brief Replaces the contents of the grid with a new set of points.
+ * \details Sorts the points by cell with a counting sort split across OpenMP threads: each thread counts
+ *   the cells of its own contiguous share of the points, the counts are turned into offsets, and each thread
+ *   then scatters its share. Points keep their relative order within a cell, so the result does not depend on
+ *   the number of threads. Storage is reused from one build to the next, so rebuilding every step does not
+ *   allocate once the grid has grown to its working size.
+ *   \param n The number of points.
+ *   \param x Array of the points' x coordinates.
+ *   \param y Array of the points' y coordinates.
+ */
+void SpatialGrid::build(size_t n, const float* x, const float* y) {
+    const unsigned cells = cellsX * cellsY;
+    indices.resize(n);
+    sortedX.resize(n);
+    sortedY.resize(n);
+    pointCell.resize(n);
+    #pragma omp parallel
+    {
+        const unsigned tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        #pragma omp single
+        threadCounts.assign((size_t) nthreads * cells, 0);     // Implicit barrier
+        const size_t begin = n * tid / nthreads, end = n * (tid + 1) / nthreads;
+        unsigned* counts = &threadCounts[(size_t) tid * cells];
+        for (size_t i = begin; i < end; ++i) {
+            const unsigned c = cellY(y[i]) * cellsX + cellX(x[i]);
+            pointCell[i] = c;
+            ++counts[c];
+        }
+        #pragma omp barrier
+        #pragma omp single
+        {
+            // Turn the per-thread counts into each thread's first slot in each cell
+            unsigned running = 0;
+            for (unsigned c = 0; c < cells; ++c) {
+                cellStart[c] = running;
+                for (unsigned t = 0; t < nthreads; ++t) {
+                    unsigned& slot = threadCounts[(size_t) t * cells + c];
+                    const unsigned count = slot;
+                    slot = running;
+                    running += count;
+                }
+            }
+            cellStart[cells] = running;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            const unsigned k = counts[pointCell[i]]++;
+            indices[k] = i;
+            sortedX[k] = x[i];
+            sortedY[k] = y[i];
+        }
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * SpatialGrid.h provides a uniform-grid spatial hash for fast neighbor queries between moving points.
+ */
+
+#ifndef SPATIALGRID_H_
+#define SPATIALGRID_H_
+
+#include <cstddef>      // For size_t
+#include <vector>
+
+namespace tsgl {
+
+/*! \class SpatialGrid
+ *  \brief A uniform grid that buckets 2D points so that neighbors can be found without checking every pair.
+ *  \details The region between (minX, minY) and (maxX, maxY) is divided into square cells. build() sorts the
+ *    indices of a set of points by cell with a parallel counting sort, so every cell's points end up contiguous
+ *    in one array; points outside the region are placed in the nearest edge cell.
+ *  \details Queries never allocate: getCell() returns a Span of indices pointing into the grid's own storage,
+ *    and forEachWithin() / anyWithin() visit the points within a radius by walking only the cells that
+ *    overlap it. With a cell size close to the query radius this makes a neighbor query cost O(1) on average
+ *    instead of O(n), so an all-pairs check drops from O(n^2) to O(n).
+ *  \details The grid keeps its own copy of the coordinates, sorted in cell order, so distance checks run over
+ *    contiguous memory. It does not notice when the original points move; call build() again each step.
+ *  \details Any number of threads may query the grid at once, but not while build() is running.
+ */
+class SpatialGrid {
+ public:
+    /*! \brief A contiguous range of point indices, usable in a range-based for loop. */
+    struct Span {
+        const unsigned* first;
+        const unsigned* last;
+        const unsigned* begin() const { return first; }
+        const unsigned* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+ private:
+    float minX, minY, cellSize, invCellSize;
+    int cellsX, cellsY;
+    std::vector<unsigned> cellStart;    // cellsX * cellsY + 1 offsets into indices
+    std::vector<unsigned> indices;      // Point indices, grouped by cell
+    std::vector<float> sortedX, sortedY;
+    std::vector<unsigned> pointCell;
+    std::vector<unsigned> threadCounts;
+ public:
+    SpatialGrid(float minX, float minY, float maxX, float maxY, float cellSize);
+
+    void build(size_t n, const float* x, const float* y);
+
+    /*!
+     * \brief Accessor for the number of points in the grid.
+     */
+    size_t size() const { return indices.size(); }
+
+    /*!
+     * \brief Accessor for the width and height of a cell.
+     */
+    float getCellSize() const { return cellSize; }
+
+    /*!
+     * \brief Accessor for the number of columns of cells.
+     */
+    int getCellsX() const { return cellsX; }
+
+    /*!
+     * \brief Accessor for the number of rows of cells.
+     */
+    int getCellsY() const { return cellsY; }
+
+    /*!
+     * \brief Finds the column of cells containing an x coordinate, clamped to the grid.
+     */
+    inline int cellX(float x) const {
+        int c = (int) ((x - minX) * invCellSize);
+        return c < 0 ? 0 : (c >= cellsX ? cellsX - 1 : c);
+    }
+
+    /*!
+     * \brief Finds the row of cells containing a y coordinate, clamped to the grid.
+     */
+    inline int cellY(float y) const {
+        int c = (int) ((y - minY) * invCellSize);
+        return c < 0 ? 0 : (c >= cellsY ? cellsY - 1 : c);
+    }
+
+    /*!
+     * \brief Accessor for the indices of the points in one cell.
+     * \param cx Column of the cell.
+     * \param cy Row of the cell.
+     * \return A Span over the grid's storage; valid until the next build().
+     */
+    inline Span getCell(int cx, int cy) const {
+        const unsigned c = cy * cellsX + cx;
+        Span s = { indices.data() + cellStart[c], indices.data() + cellStart[c + 1] };
+        return s;
+    }
+
+    /*!
+     * \brief Visits every point within a radius of (x, y).
+     * \details Calls <code>visit(i)</code> with the index (as passed to build()) of every point whose distance
+     *   from (x, y) is at most <code>radius</code>, including a point at (x, y) itself.
+     * \param x The x coordinate of the query point.
+     * \param y The y coordinate of the query point.
+     * \param radius The query radius.
+     * \param visit A function or lambda taking an unsigned index.
+     */
+    template <typename Visitor>
+    void forEachWithin(float x, float y, float radius, Visitor visit) const {
+        anyWithin(x, y, radius, [&visit](unsigned i) -> bool { visit(i); return false; });
+    }
+
+    /*!
+     * \brief Tests whether any point within a radius of (x, y) satisfies a predicate.
+     * \details Like forEachWithin(), but stops as soon as <code>pred(i)</code> returns true.
+     * \param x The x coordinate of the query point.
+     * \param y The y coordinate of the query point.
+     * \param radius The query radius.
+     * \param pred A function or lambda taking an unsigned index and returning a bool.
+     * \return True if <code>pred</code> returned true for some point within the radius.
+     */
+    template <typename Predicate>
+    bool anyWithin(float x, float y, float radius, Predicate pred) const {
+        if (indices.empty())
+            return false;
+        const int x0 = cellX(x - radius), x1 = cellX(x + radius);
+        const int y0 = cellY(y - radius), y1 = cellY(y + radius);
+        const float r2 = radius * radius;
+        for (int cy = y0; cy <= y1; ++cy) {
+            const unsigned begin = cellStart[cy * cellsX + x0], end = cellStart[cy * cellsX + x1 + 1];
+            for (unsigned k = begin; k < end; ++k) {     // Cells x0..x1 of a row are contiguous
+                const float dx = sortedX[k] - x, dy = sortedY[k] - y;
+                if (dx * dx + dy * dy <= r2 && pred(indices[k]))
+                    return true;
+            }
+        }
+        return false;
+    }
+};
+
+}
+
+#endif /* SPATIALGRID_H_ */
@@ -0,0 +1,328 @@
+#include "StreamingPlot.h"
+
+#include <algorithm>
+
+namespace tsgl {
+
+ /*!
+  * \brief Explicitly constructs a new StreamingPlot.
+  * \details This is the explicit constructor for the StreamingPlot class.
+  *   \param x The x coordinate of the center of the StreamingPlot.
+  *   \param y The y coordinate of the center of the StreamingPlot.
+  *   \param z The z coordinate of the center of the StreamingPlot.
+  *   \param width The width of the StreamingPlot.
+  *   \param height The height of the StreamingPlot.
+  *   \param window The number of samples shown across the plot.
+  *   \param min The value drawn at the bottom of the plot.
+  *   \param max The value drawn at the top of the plot.
+  *   \param yaw The yaw orientation of the StreamingPlot.
+  *   \param pitch The pitch orientation of the StreamingPlot.
+  *   \param roll The roll orientation of the StreamingPlot.
+  *   \param color The color of the line (set to BLACK by default).
+  * \return A new, empty StreamingPlot, divided into one column per unit of width (one per pixel on a Canvas
+  *   with the default camera).
+  */
+StreamingPlot::StreamingPlot(float x, float y, float z, GLfloat width, GLfloat height, unsigned window, float min, float max,
+                             float yaw, float pitch, float roll, ColorFloat color) : Drawable(x,y,z,yaw,pitch,roll) {
+    mySlots = new Slot[SLOTS]();
+    myReserved = 0;
+    myDropped = 0;
+    myConsumed = myBins = myUploaded = 0;
+    myBinSamples = 1;
+    myBinCount = 0;
+    myBinMin = myBinMax = 0;
+    myUploadAll = true;
+    myBuffer = 0;
+    myBufferColumns = 0;
+    vertices = 0;
+    if (width <= 0 || height <= 0) {
+        TsglDebug("Cannot have a StreamingPlot with width or height less than or equal to 0.");
+        return;
+    }
+    if (window == 0) {
+        TsglDebug("Cannot have a StreamingPlot with a window of 0 samples.");
+        return;
+    }
+    if (min == max) {
+        TsglDebug("Cannot have a StreamingPlot range with min equal to max.");
+        return;
+    }
+    attribMutex.lock();
+    myWidth = width; myHeight = height;
+    myXScale = width; myYScale = height; myZScale = 1;
+    myMin = min; myMax = max;
+    myWindow = window;
+    myColumns = std::max(2, (int) width);
+    myColor = color;
+    myAlpha = color.A;
+    myReset = true;
+    myCleared = myColorChanged = false;
+    init = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Appends one sample to the stream.
+ * \details Safe to call from any thread at any time. It never blocks: the sample is written to a free slot of
+ *   the ring and picked up by the next draw.
+ *   \param value The sample.
+ */
+void StreamingPlot::append(float value) {
+    const uint64_t index = myReserved.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = mySlots[index & (SLOTS - 1)];
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.sequence.store((uint32_t) (index + 1), std::memory_order_release);
+}
+
+/*!
+ * \brief Appends a block of samples to the stream.
+ * \details The fast way to feed a plot: the slots for the whole block are claimed at once, so threads
+ *   appending blocks at the same time only touch a shared counter once per block.
+ *   \param values Array of the samples, oldest first.
+ *   \param count The number of samples.
+ */
+void StreamingPlot::append(const float* values, unsigned count) {
+    if (count == 0)
+        return;
+    const uint64_t first = myReserved.fetch_add(count, std::memory_order_relaxed);
+    const unsigned skip = (count > SLOTS) ? count - SLOTS : 0;     // Would be overwritten at once anyway
+    for (unsigned i = skip; i < count; ++i) {
+        Slot& slot = mySlots[(first + i) & (SLOTS - 1)];
+        slot.value.store(values[i], std::memory_order_relaxed);
+        slot.sequence.store((uint32_t) (first + i + 1), std::memory_order_release);
+    }
+}
+
+/*!
+ * \brief Writes the two vertices of one column into the CPU copy of the ring.
+ * \details Column 0 is also copied past the end of the ring, so that a plot that wraps around the end of the
+ *   ring can be drawn as two unbroken strips.
+ */
+void StreamingPlot::writeBin(unsigned slot, float lo, float hi) {
+    const GLfloat column[14] = {
+        (GLfloat) slot, lo, 0.0f,   myBinColor.R, myBinColor.G, myBinColor.B, myBinColor.A,
+        (GLfloat) slot, hi, 0.0f,   myBinColor.R, myBinColor.G, myBinColor.B, myBinColor.A
+    };
+    std::copy(column, column + 14, myBinVertices.begin() + slot * 14);
+    if (slot == 0) {
+        std::copy(column, column + 14, myBinVertices.begin() + myBufferColumns * 14);
+        myBinVertices[myBufferColumns * 14] = myBinVertices[myBufferColumns * 14 + 7] = (GLfloat) myBufferColumns;
+    }
+}
+
+ /*!
+  * \brief Draw the StreamingPlot.
+  * \details This function actually draws the StreamingPlot to the Canvas.
+  * \details Takes the samples appended since the last draw, folds them into columns, uploads the completed
+  *   columns to the plot's own vertex buffer, and draws the newest columns as one or two line strips.
+  *   \param shader The Canvas' shape shader.
+  */
+void StreamingPlot::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+
+    attribMutex.lock();
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(myRotationPointX, myRotationPointY, myRotationPointZ));
+    model = glm::rotate(model, glm::radians(myCurrentYaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::rotate(model, glm::radians(myCurrentPitch), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(myCurrentRoll), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::translate(model, glm::vec3(myCenterX - myRotationPointX, myCenterY - myRotationPointY, myCenterZ - myRotationPointZ));
+    model = glm::scale(model, glm::vec3(myXScale, myYScale, myZScale));
+    const float lo = myMin, hi = myMax;
+    const unsigned window = myWindow, columns = myColumns;
+    const bool reset = myReset, cleared = myCleared, colorChanged = myColorChanged;
+    myReset = myCleared = myColorChanged = false;
+    myBinColor = myColor;
+    attribMutex.unlock();
+
+    GLint previous = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previous);
+    if (!myBuffer)
+        glGenBuffers(1, &myBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myBuffer);
+
+    if (cleared)
+        myConsumed = myReserved.load(std::memory_order_acquire);
+    if (reset) {
+        myBins = myUploaded = 0;
+        myBinCount = 0;
+        myBinSamples = std::max(1u, (window + columns - 1) / columns);
+        myBufferColumns = (window + myBinSamples - 1) / myBinSamples;   // Fewer than columns if the window is short
+        myBinVertices.assign((size_t) (myBufferColumns + 1) * 14, 0.0f);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * myBinVertices.size(), NULL, GL_DYNAMIC_DRAW);
+        myUploadAll = true;
+    } else if (colorChanged) {
+        for (size_t i = 0; i < myBinVertices.size(); i += 7) {
+            myBinVertices[i+3] = myBinColor.R;
+            myBinVertices[i+4] = myBinColor.G;
+            myBinVertices[i+5] = myBinColor.B;
+            myBinVertices[i+6] = myBinColor.A;
+        }
+        myUploadAll = true;
+    }
+
+    // Take the samples written since the last draw, skipping any that were overwritten before we got to them
+    const uint64_t end = myReserved.load(std::memory_order_acquire);
+    if (end - myConsumed > SLOTS) {
+        myDropped += end - SLOTS - myConsumed;
+        myConsumed = end - SLOTS;
+    }
+    bool wroteFirst = false;
+    while (myConsumed < end) {
+        Slot& slot = mySlots[myConsumed & (SLOTS - 1)];
+        const uint32_t expected = (uint32_t) (myConsumed + 1);
+        const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != expected) {
+            if ((int32_t) (sequence - expected) < 0)
+                break;                  // Claimed but not written yet; take it next frame
+            ++myDropped;                // Overwritten by a later sample
+            ++myConsumed;
+            continue;
+        }
+        const float value = slot.value.load(std::memory_order_relaxed);
+        ++myConsumed;
+        if (myBinCount == 0) {
+            myBinMin = myBinMax = value;
+        } else {
+            myBinMin = std::min(myBinMin, value);
+            myBinMax = std::max(myBinMax, value);
+        }
+        if (++myBinCount == myBinSamples) {
+            const unsigned column = myBins % myBufferColumns;
+            writeBin(column, myBinMin, myBinMax);
+            wroteFirst = wroteFirst || column == 0;
+            ++myBins;
+            myBinCount = 0;
+        }
+    }
+
+    // Upload only the columns completed since the last upload
+    const unsigned cap = myBufferColumns;
+    const uint64_t fresh = myBins - myUploaded;
+    if (myUploadAll || fresh >= cap) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * myBinVertices.size(), &myBinVertices[0]);
+        myUploadAll = false;
+    } else if (fresh > 0) {
+        const unsigned first = myUploaded % cap;
+        const unsigned firstCount = std::min<uint64_t>(fresh, cap - first);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * first * 14, sizeof(GLfloat) * firstCount * 14, &myBinVertices[first * 14]);
+        if (firstCount < fresh)
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * (fresh - firstCount) * 14, &myBinVertices[0]);
+        if (wroteFirst)
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * cap * 14, sizeof(GLfloat) * 14, &myBinVertices[cap * 14]);
+    }
+    myUploaded = myBins;
+
+    // Draw the newest columns, newest on the right, in two strips if they wrap around the end of the ring
+    const GLint posAttrib = glGetAttribLocation(shader->ID, "aPos");
+    const GLint colAttrib = glGetAttribLocation(shader->ID, "aColor");
+    glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
+    glVertexAttribPointer(colAttrib, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
+    const unsigned visible = std::min<uint64_t>(myBins, cap);
+    if (visible > 0) {
+        const unsigned startSlot = (myBins - visible) % cap;
+        glm::mat4 plot = glm::translate(model, glm::vec3(-0.5f + 0.5f / cap, -0.5f - lo / (hi - lo), 0.0f));
+        plot = glm::scale(plot, glm::vec3(1.0f / cap, 1.0f / (hi - lo), 1.0f));
+        const GLint modelLoc = glGetUniformLocation(shader->ID, "model");
+        glm::mat4 part = glm::translate(plot, glm::vec3(-(float) startSlot, 0.0f, 0.0f));
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(part));
+        if (startSlot + visible <= cap) {
+            glDrawArrays(GL_LINE_STRIP, startSlot * 2, visible * 2);
+        } else {
+            glDrawArrays(GL_LINE_STRIP, startSlot * 2, (cap - startSlot + 1) * 2);
+            part = glm::translate(plot, glm::vec3((float) (cap - startSlot), 0.0f, 0.0f));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(part));
+            glDrawArrays(GL_LINE_STRIP, 0, (startSlot + visible - cap) * 2);
+        }
+    }
+
+    // Leave the Canvas' vertex buffer as the shape shader expects it
+    glBindBuffer(GL_ARRAY_BUFFER, previous);
+    glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
+    glVertexAttribPointer(colAttrib, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
+}
+
+/*!
+ * \brief Empties the plot. Samples appended before the next draw are discarded too.
+ */
+void StreamingPlot::clear() {
+    attribMutex.lock();
+    myReset = myCleared = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the range of values the plot spans, bottom to top.
+ * \details Takes effect for the whole plot at once, without uploading anything.
+ *   \param min The value drawn at the bottom of the plot.
+ *   \param max The value drawn at the top of the plot.
+ */
+void StreamingPlot::setRange(float min, float max) {
+    if (min == max) {
+        TsglDebug("Cannot have a StreamingPlot range with min equal to max.");
+        return;
+    }
+    attribMutex.lock();
+    myMin = min;
+    myMax = max;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the number of samples shown across the plot.
+ * \details The plot starts over, since the samples already drawn were grouped into columns for the old window.
+ *   \param samples The new window.
+ */
+void StreamingPlot::setWindow(unsigned samples) {
+    if (samples == 0) {
+        TsglDebug("Cannot have a StreamingPlot with a window of 0 samples.");
+        return;
+    }
+    attribMutex.lock();
+    myWindow = samples;
+    myReset = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the number of columns the plot is divided into.
+ * \details For the sharpest plot, use the plot's width in pixels; on a CartesianCanvas, whose units are not
+ *   pixels, the default of one column per unit of width is rarely right. The plot starts over.
+ *   \param columns The new number of columns, at least 2.
+ */
+void StreamingPlot::setColumns(unsigned columns) {
+    if (columns < 2) {
+        TsglDebug("Cannot have a StreamingPlot with fewer than 2 columns.");
+        return;
+    }
+    attribMutex.lock();
+    myColumns = columns;
+    myReset = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the color of the line, including the part already drawn.
+ *   \param color The new color.
+ */
+void StreamingPlot::setColor(ColorFloat color) {
+    attribMutex.lock();
+    myColor = color;
+    myAlpha = color.A;
+    myColorChanged = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Destroys the StreamingPlot, freeing its vertex buffer.
+ */
+StreamingPlot::~StreamingPlot() {
+    if (myBuffer)
+        glDeleteBuffers(1, &myBuffer);
+    delete [] mySlots;
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+ * StreamingPlot.h extends Drawable and provides a class for plotting a live stream of samples.
+ */
+
+#ifndef STREAMINGPLOT_H_
+#define STREAMINGPLOT_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "Drawable.h"           // For extending our Drawable object
+
+namespace tsgl {
+
+/*! \class StreamingPlot
+ *  \brief Plot a live stream of samples that scrolls across the Canvas.
+ *  \details StreamingPlot draws the most recent <code>window</code> samples of a stream as a line across a
+ *   rectangle, the newest on the right. Samples are appended with append() from any number of threads at
+ *   once; appending never takes a lock, and never waits for the Canvas to draw.
+ *  \details The rectangle is divided into a fixed number of columns (see setColumns()). When the window holds
+ *   more samples than there are columns, each column shows the minimum and maximum of the samples that fall
+ *   in it, so no spike is ever missed however many samples there are per pixel. When it holds fewer, the
+ *   plot uses one column per sample instead, so it always spans exactly the last <code>window</code> samples.
+ *  \details Columns are kept in a ring buffer on the GPU. Each draw adds the columns completed since the last
+ *   draw, and uploads only those, so the cost of a frame depends on how many samples arrived rather than on
+ *   the size of the window.
+ *  \details Appended samples wait in a ring of 2^20 slots until the next draw. If more than that arrive
+ *   between two draws, the oldest are dropped (see getDroppedSamples()).
+ */
+class StreamingPlot : public Drawable {
+ private:
+    struct Slot {
+        std::atomic<float> value;
+        std::atomic<uint32_t> sequence;         // Low 32 bits of the sample's index + 1, once it is written
+    };
+
+    static const unsigned SLOTS = 1 << 20;
+
+    Slot * mySlots;
+    std::atomic<uint64_t> myReserved;           // Number of samples appended, or being appended
+    std::atomic<uint64_t> myDropped;
+
+    GLfloat myWidth, myHeight;
+    float myMin, myMax;
+    unsigned myWindow, myColumns;
+    ColorFloat myColor;
+    bool myReset, myCleared, myColorChanged;
+
+    // Used only by the rendering thread
+    uint64_t myConsumed;                        // Samples taken from the ring so far
+    uint64_t myBins;                            // Columns completed since the last reset
+    unsigned myBinSamples, myBinCount;          // Samples per column, and in the column being filled
+    float myBinMin, myBinMax;
+    ColorFloat myBinColor;                      // myColor, as of the start of the draw
+    std::vector<GLfloat> myBinVertices;         // CPU copy of the GPU ring, two vertices per column
+    uint64_t myUploaded;                        // myBins as of the last upload
+    bool myUploadAll;
+    GLuint myBuffer;
+    unsigned myBufferColumns;
+
+    void writeBin(unsigned slot, float lo, float hi);
+ public:
+    StreamingPlot(float x, float y, float z, GLfloat width, GLfloat height, unsigned window, float min, float max,
+                  float yaw, float pitch, float roll, ColorFloat color = BLACK);
+
+    virtual void draw(Shader * shader);
+
+    void append(float value);
+
+    void append(const float* values, unsigned count);
+
+    void clear();
+
+    void setRange(float min, float max);
+
+    void setWindow(unsigned samples);
+
+    void setColumns(unsigned columns);
+
+    void setColor(ColorFloat color);
+
+    /*!
+     * \brief Accessor for the number of samples appended so far.
+     */
+    uint64_t getSampleCount() { return myReserved.load(); }
+
+    /*!
+     * \brief Accessor for the number of samples dropped because they were appended faster than they were drawn.
+     */
+    uint64_t getDroppedSamples() { return myDropped.load(); }
+
+    /*!
+     * \brief Accessor for the number of samples across the plot.
+     */
+    unsigned getWindow() { return myWindow; }
+
+    /*!
+     * \brief Accessor for the number of columns the plot is divided into.
+     */
+    unsigned getColumns() { return myColumns; }
+
+    /*!
+     * \brief Accessor for the value drawn at the bottom of the plot.
+     */
+    float getMin() { return myMin; }
+
+    /*!
+     * \brief Accessor for the value drawn at the top of the plot.
+     */
+    float getMax() { return myMax; }
+
+    /*!
+     * \brief Accessor for the plot's width.
+     */
+    GLfloat getWidth() { return myWidth; }
+
+    /*!
+     * \brief Accessor for the plot's height.
+     */
+    GLfloat getHeight() { return myHeight; }
+
+    virtual ~StreamingPlot();
+};
+
+}
+
+#endif /* STREAMINGPLOT_H_ */
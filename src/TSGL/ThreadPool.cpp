@@ -0,0 +1,245 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Error.h"
+
+namespace tsgl {
+
+// A worker's remaining chunks of the current loop, and what it has done.
+struct PoolWorker {
+    std::mutex mutex;                       // Protects next and end, which thieves change
+    long next, end;                         // Chunks not yet taken, [next, end)
+    double busy, idle;
+    unsigned long chunks, steals;
+    std::vector<ChunkRecord> records;       // Chunks run in the current loop
+
+    PoolWorker() : next(0), end(0), busy(0), idle(0), chunks(0), steals(0) {}
+};
+
+namespace {
+
+// The worker the calling thread is in a loop as, or -1 if none
+thread_local int currentWorker = -1;
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+/*!
+ * \brief Constructs a ThreadPool and starts its threads.
+ *   \param workers The number of workers, counting the thread that calls parallelFor(). 0 uses one per
+ *     hardware thread.
+ */
+ThreadPool::ThreadPool(unsigned workers)
+    : myGeneration(0), myBusyThreads(0), myStopping(false), myBody(0), myBegin(0), myEnd(0), myGrain(1),
+      myLoopStart(0) {
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    myWorkerCount = workers;
+    myWorkers.reset(new PoolWorker[workers]);
+    for (unsigned i = 1; i < workers; ++i)
+        myThreads.push_back(std::thread(&ThreadPool::threadMain, this, i));
+}
+
+/*!
+ * \brief Stops and joins the pool's threads.
+ */
+ThreadPool::~ThreadPool() {
+    myStateMutex.lock();
+    myStopping = true;
+    myStateMutex.unlock();
+    myLoopStarted.notify_all();
+    for (unsigned i = 0; i < myThreads.size(); ++i)
+        myThreads[i].join();
+}
+
+/*!
+ * \brief Runs a loop on the pool, a chunk at a time, and returns once it is done.
+ * \details See the class description for how the chunks are shared out.
+ *   \param begin The first index.
+ *   \param end One past the last index.
+ *   \param grain The number of indices in a chunk; the last chunk may be shorter.
+ *   \param body The function to run for each chunk, given its first index, one past its last, and the
+ *     worker running it.
+ */
+void ThreadPool::parallelFor(long begin, long end, long grain, const ChunkFunction& body) {
+    if (grain <= 0) {
+        TsglDebug("A parallel loop needs a positive grain.");
+        grain = 1;
+    }
+    if (end <= begin)
+        return;
+    if (currentWorker >= 0) {               // Nested in another loop's body, where the other workers are busy
+        body(begin, end, currentWorker);
+        return;
+    }
+
+    std::lock_guard<std::mutex> loopLock(myLoopMutex);
+    const long chunks = (end - begin + grain - 1) / grain;
+    for (unsigned w = 0; w < myWorkerCount; ++w) {   // Contiguous blocks of chunks, as even as they come
+        PoolWorker& worker = myWorkers[w];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.next = chunks * w / myWorkerCount;
+        worker.end = chunks * (w + 1) / myWorkerCount;
+        worker.records.clear();
+    }
+
+    std::unique_lock<std::mutex> lock(myStateMutex);
+    myBody = &body;
+    myBegin = begin;
+    myEnd = end;
+    myGrain = grain;
+    myLoopStart = now();
+    myBusyThreads = myThreads.size();
+    ++myGeneration;
+    lock.unlock();
+    myLoopStarted.notify_all();
+
+    work(0);
+
+    lock.lock();
+    while (myBusyThreads > 0)
+        myLoopFinished.wait(lock);
+    myBody = 0;
+    const double loopEnd = now();
+    myChunks.clear();
+    for (unsigned w = 0; w < myWorkerCount; ++w) {
+        PoolWorker& worker = myWorkers[w];
+        double busy = 0;
+        for (unsigned i = 0; i < worker.records.size(); ++i)
+            busy += worker.records[i].finish - worker.records[i].start;
+        worker.idle += std::max(0.0, loopEnd - myLoopStart - busy);
+        myChunks.insert(myChunks.end(), worker.records.begin(), worker.records.end());
+    }
+}
+
+/*!
+ * \brief Accessor for the chunks of the last loop, in the order each worker ran them, worker by worker.
+ */
+std::vector<ChunkRecord> ThreadPool::getChunks() {
+    std::lock_guard<std::mutex> loopLock(myLoopMutex);
+    return myChunks;
+}
+
+/*!
+ * \brief Accessor for how each worker has spent its time in loops since the pool started or resetStats().
+ * \return One WorkerStats per worker, indexed by worker.
+ */
+std::vector<WorkerStats> ThreadPool::getWorkerStats() {
+    std::lock_guard<std::mutex> loopLock(myLoopMutex);
+    std::vector<WorkerStats> stats(myWorkerCount);
+    for (unsigned w = 0; w < myWorkerCount; ++w) {
+        stats[w].busy = myWorkers[w].busy;
+        stats[w].idle = myWorkers[w].idle;
+        stats[w].chunks = myWorkers[w].chunks;
+        stats[w].steals = myWorkers[w].steals;
+    }
+    return stats;
+}
+
+/*!
+ * \brief Sets every worker's statistics back to zero.
+ */
+void ThreadPool::resetStats() {
+    std::lock_guard<std::mutex> loopLock(myLoopMutex);
+    for (unsigned w = 0; w < myWorkerCount; ++w) {
+        myWorkers[w].busy = myWorkers[w].idle = 0;
+        myWorkers[w].chunks = myWorkers[w].steals = 0;
+    }
+}
+
+/*!
+ * \brief Accessor for the pool parallel_for() uses, with one worker per hardware thread.
+ */
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/*!
+ * \brief Body of each of the pool's threads: works on each loop as it starts, until the pool is destroyed.
+ */
+void ThreadPool::threadMain(unsigned worker) {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(myStateMutex);
+    for (;;) {
+        while (!myStopping && myGeneration == seen)
+            myLoopStarted.wait(lock);
+        if (myStopping)
+            return;
+        seen = myGeneration;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if (--myBusyThreads == 0)
+            myLoopFinished.notify_one();
+    }
+}
+
+/*!
+ * \brief Runs chunks of the current loop, the worker's own and then stolen ones, until there are none left.
+ */
+void ThreadPool::work(unsigned worker) {
+    PoolWorker& self = myWorkers[worker];
+    currentWorker = worker;
+    long chunk;
+    while (takeOwn(worker, chunk) || steal(worker, chunk)) {
+        const long first = myBegin + chunk * myGrain;
+        const long last = std::min(myEnd, first + myGrain);
+        const double start = now();
+        (*myBody)(first, last, worker);
+        const double finish = now();
+        ChunkRecord record = { first, last, worker, start - myLoopStart, finish - myLoopStart };
+        self.records.push_back(record);
+        self.busy += finish - start;
+        ++self.chunks;
+    }
+    currentWorker = -1;
+}
+
+/*!
+ * \brief Takes the next chunk of the worker's own block, if any are left.
+ */
+bool ThreadPool::takeOwn(unsigned worker, long& chunk) {
+    PoolWorker& self = myWorkers[worker];
+    std::lock_guard<std::mutex> lock(self.mutex);
+    if (self.next >= self.end)
+        return false;
+    chunk = self.next++;
+    return true;
+}
+
+/*!
+ * \brief Takes the back half of another worker's remaining chunks, and the first of them to run now.
+ * \details Victims are tried in turn, starting after the thief. Taking from the back leaves the victim the
+ *   chunks next to the one it is running.
+ */
+bool ThreadPool::steal(unsigned worker, long& chunk) {
+    for (unsigned i = 1; i < myWorkerCount; ++i) {
+        PoolWorker& victim = myWorkers[(worker + i) % myWorkerCount];
+        long first, last;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            const long left = victim.end - victim.next;
+            if (left <= 0)
+                continue;
+            last = victim.end;
+            first = last - (left + 1) / 2;
+            victim.end = first;
+        }
+        PoolWorker& self = myWorkers[worker];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        chunk = first;
+        self.next = first + 1;
+        self.end = last;
+        ++self.steals;
+        return true;
+    }
+    return false;
+}
+
+}
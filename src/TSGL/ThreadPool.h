@@ -0,0 +1,121 @@
+/*
+ * ThreadPool.h provides a work-stealing pool of threads and parallel_for(), which reports who did each chunk.
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tsgl {
+
+/*!
+ * \brief A chunk of a parallel loop, and the worker that ran it. See ThreadPool::getChunks().
+ */
+struct ChunkRecord {
+    long begin, end;            //!< The indices the chunk covered, <code>[begin, end)</code>
+    unsigned worker;            //!< The worker that ran the chunk
+    double start, finish;       //!< When the chunk started and finished, in seconds from the start of the loop
+};
+
+/*!
+ * \brief How a worker of a ThreadPool has spent its time. See ThreadPool::getWorkerStats().
+ */
+struct WorkerStats {
+    double busy;                //!< Seconds spent running chunks
+    double idle;                //!< Seconds spent in loops without a chunk to run, waiting for the others to finish
+    unsigned long chunks;       //!< Number of chunks run
+    unsigned long steals;       //!< Number of times the worker took work from another worker
+};
+
+struct PoolWorker;              // A worker's range of chunks and statistics, defined in ThreadPool.cpp
+
+/*! \class ThreadPool
+ *  \brief A pool of threads that run the chunks of parallel loops, stealing work from each other to stay busy.
+ *  \details Splitting a loop evenly among threads, as <code>for (j = tid; j < size; j += nthreads)</code> does,
+ *    leaves threads idle when some parts of the work are slower than others, such as the rows of a Mandelbrot
+ *    set that cross the set itself. parallelFor() instead cuts the loop into chunks of <code>grain</code>
+ *    indices and gives each worker a contiguous block of them. A worker that runs out takes the back half of
+ *    the remaining block of another, so the work is spread to the end while each worker still mostly runs
+ *    neighboring chunks.
+ *  \details The body is told which worker runs each chunk, so output can be colored by its owner, as with
+ *    <code>Colors::highContrastColor(worker)</code>. getChunks() lists who ran what in the last loop, and
+ *    getWorkerStats() how busy and idle each worker has been, so imbalance can be seen and fixed.
+ *  \details The thread that calls parallelFor() works as worker 0, and returns once every chunk is done.
+ *    A parallelFor() called from inside a body runs on the calling worker alone, and loops started by
+ *    different threads at once take turns.
+ */
+class ThreadPool {
+ public:
+    typedef std::function<void(long begin, long end, unsigned worker)> ChunkFunction;
+
+    explicit ThreadPool(unsigned workers = 0);
+
+    ~ThreadPool();
+
+    void parallelFor(long begin, long end, long grain, const ChunkFunction& body);
+
+    /*!
+     * \brief Accessor for the number of workers, counting the thread that calls parallelFor().
+     */
+    unsigned getWorkerCount() const { return myWorkerCount; }
+
+    std::vector<ChunkRecord> getChunks();
+
+    std::vector<WorkerStats> getWorkerStats();
+
+    void resetStats();
+
+    static ThreadPool& global();
+ private:
+    unsigned myWorkerCount;
+    std::vector<std::thread> myThreads;
+    std::unique_ptr<PoolWorker[]> myWorkers;
+    std::mutex myLoopMutex;                     // Held for the whole of a loop, so loops take turns
+    std::mutex myStateMutex;                    // Protects what follows
+    std::condition_variable myLoopStarted, myLoopFinished;
+    unsigned long myGeneration;                 // Counts loops, so that workers know when a new one starts
+    unsigned myBusyThreads;                     // Threads still working on the current loop
+    bool myStopping;
+    const ChunkFunction* myBody;                // The current loop
+    long myBegin, myEnd, myGrain;
+    double myLoopStart;
+    std::vector<ChunkRecord> myChunks;
+
+    void threadMain(unsigned worker);
+    void work(unsigned worker);
+    bool takeOwn(unsigned worker, long& chunk);
+    bool steal(unsigned worker, long& chunk);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+/*!
+ * \brief Runs <code>body(i, worker)</code> for every <code>i</code> in <code>[begin, end)</code> on the global
+ *   ThreadPool.
+ * \details The loop is cut into chunks of <code>grain</code> indices, which the workers share out and steal
+ *   from each other (see ThreadPool). <code>worker</code> is the index of the worker running <code>i</code>,
+ *   from 0 to <code>ThreadPool::global().getWorkerCount() - 1</code>, for coloring output by its owner.
+ *   \param begin The first index.
+ *   \param end One past the last index.
+ *   \param grain The number of indices in a chunk. Larger chunks cost less to hand out, smaller ones balance
+ *     better; a chunk should take at least a few microseconds.
+ *   \param body The function to run for each index.
+ */
+template<typename Body>
+void parallel_for(long begin, long end, long grain, Body body) {
+    ThreadPool::global().parallelFor(begin, end, grain, [&body](long first, long last, unsigned worker) {
+        for (long i = first; i < last; ++i)
+            body(i, worker);
+    });
+}
+
+}
+
+#endif /* THREADPOOL_H_ */
@@ -0,0 +1,421 @@
+#include "ThreadTimeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "Error.h"
+
+namespace tsgl {
+
+namespace {
+
+// One span in a thread's ring. Every field is atomic so readers may read while the owner writes.
+struct TimelineSlot {
+    std::atomic<uint64_t> sequence;         // Index of the span + 1 once written, 0 while it is being written
+    std::atomic<uint64_t> begin, end;       // Nanoseconds since the timeline's epoch
+    std::atomic<const char*> label;
+    std::atomic<unsigned> depth;
+    std::atomic<unsigned> count;            // Spans merged into this one
+};
+
+// The ring of one thread. Only the thread itself writes to it.
+struct ThreadLog {
+    std::unique_ptr<TimelineSlot[]> slots;
+    uint64_t mask;
+    std::atomic<uint64_t> head;             // Number of spans written so far
+    std::atomic<uint64_t> cleared;          // Spans before this index were cleared
+    std::atomic<uint64_t> recorded;         // Number of spans recorded so far, counting merged ones
+    unsigned depth;                         // Spans open on the thread right now
+    std::string name;                       // Protected by the state's mutex
+
+    // The last span written, while more short spans may still be merged into it
+    const char* runLabel;                   // NULL if none may
+    unsigned runDepth, runCount;
+    uint64_t runBegin, runEnd;
+
+    explicit ThreadLog(unsigned capacity)
+        : slots(new TimelineSlot[capacity]()), mask(capacity - 1), head(0), cleared(0), recorded(0), depth(0),
+          runLabel(NULL), runDepth(0), runCount(0), runBegin(0), runEnd(0) {}
+};
+
+// Shared state of the timeline.
+struct TimelineState {
+    std::mutex mutex;                       // Protects logs and the threads' names
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+    std::atomic<bool> enabled;
+    std::atomic<unsigned> capacity;
+    std::atomic<uint64_t> resolution;       // Runs of spans shorter than this, in nanoseconds, are merged
+    const std::chrono::steady_clock::time_point epoch;
+
+    TimelineState()
+        : enabled(true), capacity(1 << 17), resolution(10000), epoch(std::chrono::steady_clock::now()) {}
+};
+
+TimelineState& timeline() {
+    static TimelineState state;
+    return state;
+}
+
+// The calling thread's ring, made and registered the first time it is needed
+thread_local ThreadLog* threadLog = 0;
+
+ThreadLog& ownLog() {
+    if (!threadLog) {
+        TimelineState& state = timeline();
+        threadLog = new ThreadLog(state.capacity.load());
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.logs.push_back(std::unique_ptr<ThreadLog>(threadLog));
+    }
+    return *threadLog;
+}
+
+uint64_t ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - timeline().epoch).count();
+}
+
+uint64_t toTicks(double seconds) {
+    return (seconds > 0) ? (uint64_t) (seconds * 1e9 + 0.5) : 0;
+}
+
+// Writes a span into the calling thread's ring, overwriting the oldest if it is full, or merges it into the last
+// span if both are part of a run of short spans with the same label and depth that is still short.
+// The slot's sequence is zeroed first, so that a reader can tell a slot that changed under it.
+void push(ThreadLog& log, const char* label, uint64_t begin, uint64_t end, unsigned depth) {
+    const uint64_t resolution = timeline().resolution.load(std::memory_order_relaxed);
+    const uint64_t index = log.head.load(std::memory_order_relaxed);
+    log.recorded.store(log.recorded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (label == log.runLabel && depth == log.runDepth && begin >= log.runEnd && end - log.runBegin < resolution
+          && index > log.cleared.load(std::memory_order_relaxed)) {
+        TimelineSlot& slot = log.slots[(index - 1) & log.mask];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.count.store(++log.runCount, std::memory_order_relaxed);
+        slot.sequence.store(index, std::memory_order_release);
+        log.runEnd = end;
+        return;
+    }
+    TimelineSlot& slot = log.slots[index & log.mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.label.store(label, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    slot.count.store(1, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    log.head.store(index + 1, std::memory_order_release);
+    log.runLabel = (end - begin < resolution) ? label : NULL;
+    log.runDepth = depth;
+    log.runCount = 1;
+    log.runBegin = begin;
+    log.runEnd = end;
+}
+
+// Reads span number index from a ring, failing if it was overwritten before or while it was read.
+// A span that short ones are merged into while it is read may come back with the end of one merge and the
+// count of the next; either is a state the span really went through, so it is not worth failing for.
+bool read(const ThreadLog& log, uint64_t index, uint64_t& begin, uint64_t& end, const char*& label, unsigned& depth,
+          unsigned& count) {
+    const TimelineSlot& slot = log.slots[index & log.mask];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        return false;
+    begin = slot.begin.load(std::memory_order_relaxed);
+    end = slot.end.load(std::memory_order_relaxed);
+    label = slot.label.load(std::memory_order_relaxed);
+    depth = slot.depth.load(std::memory_order_relaxed);
+    count = slot.count.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+// Writes a string as a JSON string literal
+void writeJson(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (unsigned i = 0; i < text.size(); ++i) {
+        const unsigned char c = text[i];
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (c < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (unsigned) c << std::dec << std::setfill(' ');
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+}
+
+/*!
+ * \brief Begins a span on the calling thread, unless the timeline is off.
+ *   \param label What the thread is about to do. It is not copied, so it must outlive the timeline.
+ */
+ThreadTimeline::Scope::Scope(const char * label) : myLabel(NULL), myBegin(0), myDepth(0) {
+    if (!timeline().enabled.load(std::memory_order_relaxed))
+        return;
+    ThreadLog& log = ownLog();
+    myLabel = label;
+    myDepth = log.depth++;
+    myBegin = ticks();
+}
+
+/*!
+ * \brief Ends the span and records it in the calling thread's ring.
+ */
+ThreadTimeline::Scope::~Scope() {
+    if (!myLabel)
+        return;
+    const uint64_t end = ticks();
+    ThreadLog& log = *threadLog;
+    --log.depth;
+    push(log, myLabel, myBegin, end, myDepth);
+}
+
+/*!
+ * \brief Records a span that was timed some other way on the calling thread, such as one read from a GPU query.
+ * \details The span is recorded at the depth of the Scopes open on the thread.
+ *   \param label What the thread did. It is not copied, so it must outlive the timeline.
+ *   \param begin When the span began, in seconds on now()'s clock.
+ *   \param end When the span ended, in seconds on now()'s clock.
+ */
+void ThreadTimeline::record(const char * label, double begin, double end) {
+    if (!timeline().enabled.load(std::memory_order_relaxed))
+        return;
+    if (end < begin) {
+        TsglDebug("A span cannot end before it begins.");
+        return;
+    }
+    ThreadLog& log = ownLog();
+    push(log, label, toTicks(begin), toTicks(end), log.depth);
+}
+
+/*!
+ * \brief Accessor for the timeline's clock.
+ * \return Seconds since the timeline was first used, on a steady clock.
+ */
+double ThreadTimeline::now() {
+    return ticks() * 1e-9;
+}
+
+/*!
+ * \brief Turns recording on or off for every thread.
+ * \details While the timeline is off, a Scope costs a single load of a flag. Spans already recorded are kept.
+ *   \param on Whether new spans should be recorded. The timeline starts on.
+ */
+void ThreadTimeline::setEnabled(bool on) {
+    timeline().enabled.store(on);
+}
+
+/*!
+ * \brief Accessor for whether new spans are being recorded.
+ */
+bool ThreadTimeline::isEnabled() {
+    return timeline().enabled.load();
+}
+
+/*!
+ * \brief Mutates the number of spans the ring of each thread holds.
+ * \details Takes effect for threads that record their first span afterward, so it is best called before
+ *   starting any. The default is 131072 spans, about 5 MB per thread.
+ * \details The ring is all the history a thread has: to look back <code>t</code> seconds, it must hold the
+ *   spans the thread records in that time, after short ones are merged (see setResolution()).
+ *   \param spans The number of spans, rounded up to a power of 2.
+ */
+void ThreadTimeline::setCapacity(unsigned spans) {
+    if (spans == 0 || spans > (1u << 30)) {
+        TsglDebug("A timeline ring must hold between 1 and 2^30 spans.");
+        return;
+    }
+    unsigned capacity = 1;
+    while (capacity < spans)
+        capacity <<= 1;
+    timeline().capacity.store(capacity);
+}
+
+/*!
+ * \brief Accessor for the number of spans the ring of a thread that starts recording now will hold.
+ */
+unsigned ThreadTimeline::getCapacity() {
+    return timeline().capacity.load();
+}
+
+/*!
+ * \brief Mutates how short spans must be to be merged as they are recorded.
+ * \details A span shorter than <code>seconds</code> that follows one with the same label at the same depth on
+ *   the same thread is merged into it, as long as the merged span stays shorter than <code>seconds</code>; the
+ *   merged span covers the whole run, gaps included, and counts the spans in it. Set it to about the time a
+ *   column of a TimelineView covers, so that nothing narrower than a pixel takes a slot of its own. The default
+ *   is 10 microseconds.
+ *   \param seconds The resolution, 0 to never merge spans.
+ */
+void ThreadTimeline::setResolution(double seconds) {
+    if (seconds < 0) {
+        TsglDebug("A timeline's resolution cannot be negative.");
+        return;
+    }
+    timeline().resolution.store(toTicks(seconds));
+}
+
+/*!
+ * \brief Accessor for how short spans must be to be merged as they are recorded.
+ */
+double ThreadTimeline::getResolution() {
+    return timeline().resolution.load() * 1e-9;
+}
+
+/*!
+ * \brief Names the calling thread in charts and traces.
+ * \details Threads that are not named are called "thread 0", "thread 1", and so on.
+ *   \param name The thread's name.
+ */
+void ThreadTimeline::setThreadName(const std::string& name) {
+    ThreadLog& log = ownLog();
+    TimelineState& state = timeline();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    log.name = name;
+}
+
+/*!
+ * \brief Accessor for the number of threads that have recorded spans or been named.
+ */
+unsigned ThreadTimeline::getThreadCount() {
+    TimelineState& state = timeline();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.logs.size();
+}
+
+/*!
+ * \brief Accessor for the name of a thread.
+ *   \param thread The thread, counting threads in the order they first recorded.
+ */
+std::string ThreadTimeline::getThreadName(unsigned thread) {
+    TimelineState& state = timeline();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (thread >= state.logs.size()) {
+        TsglDebug("No such thread in the timeline.");
+        return "";
+    }
+    if (!state.logs[thread]->name.empty())
+        return state.logs[thread]->name;
+    std::stringstream name;
+    name << "thread " << thread;
+    return name.str();
+}
+
+/*!
+ * \brief Copies the spans of one thread that overlap a stretch of time.
+ * \details Spans are appended newest first, by when they ended, which is the order they were recorded in.
+ *   Since a thread's spans are stored in that order, only the spans that are copied are read, however many
+ *   the ring holds.
+ *   \param thread The thread, counting threads in the order they first recorded.
+ *   \param from The start of the stretch, in seconds on now()'s clock.
+ *   \param to The end of the stretch, in seconds on now()'s clock.
+ *   \param spans The vector to append the spans to.
+ */
+void ThreadTimeline::getSpans(unsigned thread, double from, double to, std::vector<TimelineSpan>& spans) {
+    TimelineState& state = timeline();
+    ThreadLog* log;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (thread >= state.logs.size()) {
+            TsglDebug("No such thread in the timeline.");
+            return;
+        }
+        log = state.logs[thread].get();         // Logs are never freed, so it is safe to read without the lock
+    }
+    const uint64_t first = toTicks(from), last = (to >= 1e9) ? UINT64_MAX : toTicks(to);
+    const uint64_t head = log->head.load(std::memory_order_acquire);
+    const uint64_t capacity = log->mask + 1;
+    const uint64_t oldest = std::max(log->cleared.load(), (head > capacity) ? head - capacity : 0);
+    for (uint64_t i = head; i > oldest; --i) {
+        uint64_t begin, end;
+        const char* label;
+        unsigned depth, count;
+        if (!read(*log, i - 1, begin, end, label, depth, count))
+            break;                              // Overwritten, as is everything older
+        if (end < first)
+            break;
+        if (begin > last)
+            continue;
+        TimelineSpan span = { thread, depth, begin * 1e-9, end * 1e-9, label, count };
+        spans.push_back(span);
+    }
+}
+
+/*!
+ * \brief Accessor for the number of spans recorded by every thread so far, including any merged, overwritten or
+ *   cleared.
+ */
+uint64_t ThreadTimeline::getSpanCount() {
+    TimelineState& state = timeline();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    uint64_t count = 0;
+    for (unsigned i = 0; i < state.logs.size(); ++i)
+        count += state.logs[i]->recorded.load();
+    return count;
+}
+
+/*!
+ * \brief Forgets every span recorded so far. Threads keep their rings and names.
+ */
+void ThreadTimeline::clear() {
+    TimelineState& state = timeline();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (unsigned i = 0; i < state.logs.size(); ++i)
+        state.logs[i]->cleared.store(state.logs[i]->head.load());
+}
+
+/*!
+ * \brief Writes every span the rings hold to a file in the Chrome trace event format.
+ * \details The file can be opened in chrome://tracing or in Perfetto. Each thread is a track, named after it,
+ *   and each span a complete ("X") event, timed in microseconds. A span that short ones were merged into has
+ *   their number as its "count" argument.
+ *   \param filename The file to write.
+ * \return Whether the file was written.
+ */
+bool ThreadTimeline::exportChromeTrace(const std::string& filename) {
+    std::ofstream out(filename.c_str());
+    if (!out) {
+        TsglErr("Could not open " + filename + " to write the timeline.");
+        return false;
+    }
+    out << "{\"traceEvents\":[";
+    const unsigned threads = getThreadCount();
+    std::vector<TimelineSpan> spans;
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    for (unsigned t = 0; t < threads; ++t) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":";
+        writeJson(out, getThreadName(t));
+        out << "}}";
+        first = false;
+        spans.clear();
+        getSpans(t, 0, 1e9, spans);
+        for (std::vector<TimelineSpan>::reverse_iterator s = spans.rbegin(); s != spans.rend(); ++s) {
+            out << ",\n{\"name\":";
+            writeJson(out, s->label ? s->label : "");
+            out << ",\"cat\":\"tsgl\",\"ph\":\"X\",\"ts\":" << s->begin * 1e6 << ",\"dur\":"
+                << (s->end - s->begin) * 1e6 << ",\"pid\":1,\"tid\":" << t;
+            if (s->count > 1)
+                out << ",\"args\":{\"count\":" << s->count << "}";
+            out << "}";
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    out.close();
+    if (!out) {
+        TsglErr("Could not write the timeline to " + filename + ".");
+        return false;
+    }
+    return true;
+}
+
+}
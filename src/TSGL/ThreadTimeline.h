@@ -0,0 +1,104 @@
+/*
+ * ThreadTimeline.h provides a low-overhead recorder of what each thread is doing, span by span.
+ */
+
+#ifndef THREADTIMELINE_H_
+#define THREADTIMELINE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tsgl {
+
+/*!
+ * \brief A span of time one thread spent on something. See ThreadTimeline::getSpans().
+ */
+struct TimelineSpan {
+    unsigned thread;            //!< The thread that recorded the span, counting threads in the order they first did
+    unsigned depth;             //!< How many spans of the same thread were open around it
+    double begin, end;          //!< When the span began and ended, in seconds on ThreadTimeline::now()'s clock
+    const char * label;         //!< What the thread was doing
+    unsigned count;             //!< How many recorded spans it stands for; more than 1 for a run of short ones
+};
+
+/*! \class ThreadTimeline
+ *  \brief Records spans of time that threads spend on labeled pieces of work, for a Gantt chart or a trace.
+ *  \details A span is recorded by putting a Scope on the stack:
+ *  \code
+ *    for (int row = myid; row < height; row += nthreads) {
+ *        ThreadTimeline::Scope span("row");
+ *        computeRow(row);
+ *    }
+ *  \endcode
+ *  \details Each thread records into a ring of its own, made the first time it records, so recording takes no
+ *    locks and shares no cache lines with other threads: a span costs two reads of the clock and a few stores.
+ *    When a ring is full, a thread's newest spans overwrite its oldest. Readers (getSpans(), TimelineView,
+ *    exportChromeTrace()) may read while threads record, and skip any span that is overwritten as they read it.
+ *  \details How far back the timeline reaches is set by the size of the rings, not by what is reading them: a
+ *    TimelineView showing the last 2 seconds shows less if the rings filled up in less. To stretch the rings,
+ *    a run of spans shorter than setResolution() with the same label and depth is merged into one span as it
+ *    is recorded, as long as the run stays that short. A thread that records millions of tiny spans per second
+ *    then fills a slot per resolution instead of one per span.
+ *  \details Labels are not copied, so they must outlive the timeline; string literals are the usual choice.
+ *  \details Rings are kept after their threads exit, so the spans of finished threads can still be drawn and
+ *    exported. Each takes setCapacity() times 40 bytes.
+ */
+class ThreadTimeline {
+ public:
+    /*! \class Scope
+     *  \brief Records a span from its construction to its destruction on the calling thread.
+     */
+    class Scope {
+     public:
+        explicit Scope(const char * label);
+
+        ~Scope();
+     private:
+        const char * myLabel;           // NULL if the timeline was off when the span began
+        uint64_t myBegin;
+        unsigned myDepth;
+
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    static void record(const char * label, double begin, double end);
+
+    static double now();
+
+    static void setEnabled(bool on);
+
+    static bool isEnabled();
+
+    static void setCapacity(unsigned spans);
+
+    static unsigned getCapacity();
+
+    static void setResolution(double seconds);
+
+    static double getResolution();
+
+    static void setThreadName(const std::string& name);
+
+    static unsigned getThreadCount();
+
+    static std::string getThreadName(unsigned thread);
+
+    static void getSpans(unsigned thread, double from, double to, std::vector<TimelineSpan>& spans);
+
+    static uint64_t getSpanCount();
+
+    static void clear();
+
+    static bool exportChromeTrace(const std::string& filename);
+ private:
+    ThreadTimeline();
+    ThreadTimeline(const ThreadTimeline&);
+    ThreadTimeline& operator=(const ThreadTimeline&);
+    ~ThreadTimeline();
+};
+
+}
+
+#endif /* THREADTIMELINE_H_ */
@@ -0,0 +1,602 @@
+#include "TiledImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <stb/stb_image.h>
+
+namespace tsgl {
+
+// Layout of a pyramid file, in the machine's byte order: this header, padded to HEADER_BYTES, then every tile
+// of level 0 (full size) a row of tiles at a time from the top, then every tile of level 1, and so on.
+// Each tile is tileSize x tileSize RGBA8 pixels with row 0 at the top. Tiles on the right and bottom edges
+// are padded to full size by repeating their last column and row.
+static const char PYRAMID_MAGIC[8] = { 'T', 'S', 'G', 'L', 'T', 'I', 'L', 'E' };
+static const uint32_t PYRAMID_VERSION = 1;
+static const int MAX_LEVELS = 32;
+static const size_t HEADER_BYTES = 4096;   // Keeps the tiles page-aligned
+
+struct PyramidHeader {
+    char magic[8];
+    uint32_t version, width, height, tileSize, levels;
+    uint64_t levelOffset[MAX_LEVELS];
+};
+
+// Moves to a byte offset in a file, which may be past what a long can hold
+static bool seekTo(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (__int64) offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+// Fills in the sizes of each level of a pyramid, halving (and rounding up) until the image fits in one tile
+static int pyramidLevels(int w, int h, int tileSize, std::vector<int>& widths, std::vector<int>& heights) {
+    widths.assign(1, w);
+    heights.assign(1, h);
+    while ((widths.back() > tileSize || heights.back() > tileSize) && (int) widths.size() < MAX_LEVELS) {
+        widths.push_back((widths.back() + 1) / 2);
+        heights.push_back((heights.back() + 1) / 2);
+    }
+    return widths.size();
+}
+
+// Repeats the last valid column and row of a tile into its padding
+static void padTile(uint8_t* tile, int tileSize, int w, int h) {
+    const int stride = tileSize * 4;
+    for (int y = 0; y < h; ++y) {
+        uint32_t edge;
+        memcpy(&edge, tile + y * stride + (w - 1) * 4, 4);
+        for (int x = w; x < tileSize; ++x)
+            memcpy(tile + y * stride + x * 4, &edge, 4);
+    }
+    for (int y = h; y < tileSize; ++y)
+        memcpy(tile + y * stride, tile + (h - 1) * stride, stride);
+}
+
+ /*!
+  * \brief Explicitly constructs a new TiledImage.
+  * \details This is the explicit constructor for the TiledImage class.
+  *   \param x The x coordinate of the center of the TiledImage.
+  *   \param y The y coordinate of the center of the TiledImage.
+  *   \param z The z coordinate of the center of the TiledImage.
+  *   \param filename The pyramid file to draw, made by createPyramid().
+  *   \param width The width of the TiledImage.
+  *   \param height The height of the TiledImage.
+  *   \param yaw The yaw orientation of the TiledImage.
+  *   \param pitch The pitch orientation of the TiledImage.
+  *   \param roll The roll orientation of the TiledImage.
+  *   \param alpha The alpha of the TiledImage.
+  * \return A new TiledImage. No pixels are read until it is drawn.
+  * \note If the file is missing or is not a pyramid file, an error is printed and the TiledImage draws nothing.
+  */
+TiledImage::TiledImage(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha) : Drawable(x,y,z,yaw,pitch,roll) {
+    myPixelWidth = myPixelHeight = myTileSize = myLevels = 0;
+    myFrame = 0;
+    myUploads = 0;
+    myTextureBudget = myFrameBudget = 64 << 20;
+    myTextureBytes = 0;
+    myUploadsPerFrame = myFrameUploadLimit = 8;
+    vertices = 0;
+    if (width <= 0 || height <= 0) {
+        TsglDebug("Cannot have a TiledImage with width or height less than or equal to 0.");
+        return;
+    }
+    if (alpha < 0.0 || alpha > 1.0) {
+        TsglDebug("Cannot have a TiledImage with alpha not between 0.0 and 1.0.");
+        return;
+    }
+    attribMutex.lock();
+    shaderType = TEXTURE_SHADER_TYPE;
+    myFile = filename;
+    myWidth = width; myHeight = height;
+    myXScale = width; myYScale = height; myZScale = 1;
+    myAlpha = alpha;
+    init = openPyramid();
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Maps the pyramid file into memory and reads its header.
+ * \return Whether the file is a complete pyramid file.
+ */
+bool TiledImage::openPyramid() {
+    if (!myMap.open(myFile))
+        return false;
+
+    PyramidHeader header;
+    if (myMap.size() < HEADER_BYTES) {
+        TsglErr(myFile + " is not a pyramid file.");
+        return false;
+    }
+    memcpy(&header, myMap.data(), sizeof(header));
+    if (memcmp(header.magic, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC)) != 0 || header.version != PYRAMID_VERSION ||
+        header.width == 0 || header.height == 0 || header.tileSize == 0) {
+        TsglErr(myFile + " is not a pyramid file.");
+        return false;
+    }
+    myPixelWidth = header.width;
+    myPixelHeight = header.height;
+    myTileSize = header.tileSize;
+    myLevels = pyramidLevels(myPixelWidth, myPixelHeight, myTileSize, levelWidth, levelHeight);
+    if ((uint32_t) myLevels != header.levels) {
+        TsglErr(myFile + " is not a pyramid file.");
+        return false;
+    }
+    const uint64_t tileBytes = (uint64_t) myTileSize * myTileSize * 4;
+    for (int i = 0; i < myLevels; ++i) {
+        levelColumns.push_back((levelWidth[i] + myTileSize - 1) / myTileSize);
+        levelRows.push_back((levelHeight[i] + myTileSize - 1) / myTileSize);
+        levelOffset.push_back(header.levelOffset[i]);
+        if (header.levelOffset[i] + tileBytes * levelColumns[i] * levelRows[i] > myMap.size()) {
+            TsglErr("The pyramid file " + myFile + " is incomplete.");
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Writes a pyramid file from an image file, for drawing with a TiledImage.
+ * \details The image is decoded into memory once, so this is meant to be run ahead of time rather than
+ *   while drawing. For images too large to decode at all, use the other version of createPyramid().
+ *   \param imageFile The image file to cut into tiles (.png, .bmp or .jpg).
+ *   \param pyramidFile The pyramid file to write. It is overwritten if it exists.
+ *   \param tileSize The width and height of each tile in pixels (set to 256 by default).
+ * \return Whether the pyramid file was written.
+ */
+bool TiledImage::createPyramid(const std::string& imageFile, const std::string& pyramidFile, int tileSize) {
+    int w = 0, h = 0;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char * pixels = stbi_load(imageFile.c_str(), &w, &h, 0, 4);
+    if (!pixels) {
+        TsglErr("Could not load the image file " + imageFile + ".");
+        return false;
+    }
+    // stb_image's rows run from the bottom up, pyramid rows from the top down
+    bool written = createPyramid(pyramidFile, w, h, [pixels, w, h](int x, int y, int tw, int th, uint8_t* rgba, int stride) {
+        for (int row = 0; row < th; ++row)
+            memcpy(rgba + row * stride, pixels + ((size_t) (h - 1 - y - row) * w + x) * 4, tw * 4);
+    }, tileSize);
+    stbi_image_free(pixels);
+    return written;
+}
+
+/*!
+ * \brief Writes a pyramid file from pixels supplied a tile at a time, for drawing with a TiledImage.
+ * \details Only a tile's worth of the full-size image is ever in memory, so the image may be far larger
+ *   than the computer's memory: <code>source</code> can compute the pixels, or read them from any format.
+ *   The smaller levels are then made from the file itself, two rows of tiles at a time, by averaging
+ *   each square of four pixels.
+ *   \param pyramidFile The pyramid file to write. It is overwritten if it exists.
+ *   \param pixelWidth The width of the full-size image in pixels.
+ *   \param pixelHeight The height of the full-size image in pixels.
+ *   \param source Function that writes the RGBA8 pixels of the block <code>w</code> pixels wide and
+ *     <code>h</code> pixels tall whose top left corner is at (<code>x</code>, <code>y</code>), row 0 being the
+ *     top of the image, into <code>rgba</code>, whose rows are <code>stride</code> bytes apart. It is called
+ *     once for each tile, from the top left tile across and down.
+ *   \param tileSize The width and height of each tile in pixels (set to 256 by default).
+ * \return Whether the pyramid file was written.
+ */
+bool TiledImage::createPyramid(const std::string& pyramidFile, int pixelWidth, int pixelHeight,
+                               std::function<void(int x, int y, int w, int h, uint8_t* rgba, int stride)> source,
+                               int tileSize) {
+    if (pixelWidth <= 0 || pixelHeight <= 0) {
+        TsglDebug("Cannot make a pyramid of an image with width or height less than or equal to 0.");
+        return false;
+    }
+    if (tileSize < 16 || tileSize > 4096) {
+        TsglDebug("Cannot make a pyramid with tiles smaller than 16 or larger than 4096 pixels.");
+        return false;
+    }
+    std::vector<int> widths, heights, columns, rows;
+    const int levels = pyramidLevels(pixelWidth, pixelHeight, tileSize, widths, heights);
+    const size_t tileBytes = (size_t) tileSize * tileSize * 4;
+    const int stride = tileSize * 4;
+
+    std::vector<uint8_t> headerBytes(HEADER_BYTES, 0);
+    PyramidHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC));
+    header.version = PYRAMID_VERSION;
+    header.width = pixelWidth;
+    header.height = pixelHeight;
+    header.tileSize = tileSize;
+    header.levels = levels;
+    uint64_t offset = HEADER_BYTES;
+    for (int i = 0; i < levels; ++i) {
+        columns.push_back((widths[i] + tileSize - 1) / tileSize);
+        rows.push_back((heights[i] + tileSize - 1) / tileSize);
+        header.levelOffset[i] = offset;
+        offset += (uint64_t) tileBytes * columns[i] * rows[i];
+    }
+    memcpy(&headerBytes[0], &header, sizeof(header));
+
+    FILE * file = fopen(pyramidFile.c_str(), "w+b");
+    if (!file) {
+        TsglErr("Could not open the pyramid file " + pyramidFile + " for writing.");
+        return false;
+    }
+    bool ok = fwrite(&headerBytes[0], 1, HEADER_BYTES, file) == HEADER_BYTES;
+
+    // Level 0, straight from the source
+    std::vector<uint8_t> tile(tileBytes);
+    for (int ty = 0; ok && ty < rows[0]; ++ty) {
+        for (int tx = 0; ok && tx < columns[0]; ++tx) {
+            const int x = tx * tileSize, y = ty * tileSize;
+            const int tw = std::min(tileSize, pixelWidth - x), th = std::min(tileSize, pixelHeight - y);
+            source(x, y, tw, th, &tile[0], stride);
+            padTile(&tile[0], tileSize, tw, th);
+            ok = fwrite(&tile[0], 1, tileBytes, file) == tileBytes;
+        }
+    }
+
+    // Every other level, from the two rows of tiles of the level above that cover each of its rows
+    std::vector<uint8_t> above;
+    for (int level = 1; ok && level < levels; ++level) {
+        const int aw = widths[level-1], ah = heights[level-1], aColumns = columns[level-1];
+        const size_t aboveRowBytes = tileBytes * aColumns;
+        above.resize(aboveRowBytes * 2);
+        for (int ty = 0; ok && ty < rows[level]; ++ty) {
+            const int aboveRows = std::min(2, rows[level-1] - 2 * ty);
+            ok = seekTo(file, header.levelOffset[level-1] + (uint64_t) aboveRowBytes * 2 * ty) &&
+                 fread(&above[0], 1, aboveRowBytes * aboveRows, file) == aboveRowBytes * aboveRows &&
+                 seekTo(file, header.levelOffset[level] + (uint64_t) tileBytes * columns[level] * ty);
+            for (int tx = 0; ok && tx < columns[level]; ++tx) {
+                const int x0 = tx * tileSize, y0 = ty * tileSize;
+                const int tw = std::min(tileSize, widths[level] - x0), th = std::min(tileSize, heights[level] - y0);
+                for (int y = 0; y < th; ++y) {
+                    // Rows of the level above, relative to the first row in the buffer
+                    const int sy0 = 2 * y, sy1 = std::min(2 * (y0 + y) + 1, ah - 1) - 2 * y0;
+                    for (int x = 0; x < tw; ++x) {
+                        const int sx0 = 2 * (x0 + x), sx1 = std::min(sx0 + 1, aw - 1);
+                        const uint8_t * p[4];
+                        const int sx[2] = { sx0, sx1 }, sy[2] = { sy0, sy1 };
+                        for (int i = 0; i < 4; ++i) {
+                            const int px = sx[i & 1], py = sy[i >> 1];
+                            p[i] = &above[(py / tileSize) * aboveRowBytes + (px / tileSize) * tileBytes +
+                                          (py % tileSize) * stride + (px % tileSize) * 4];
+                        }
+                        uint8_t * out = &tile[y * stride + x * 4];
+                        for (int c = 0; c < 4; ++c)
+                            out[c] = (p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4;
+                    }
+                }
+                padTile(&tile[0], tileSize, tw, th);
+                ok = fwrite(&tile[0], 1, tileBytes, file) == tileBytes;
+            }
+        }
+    }
+
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        TsglErr("Could not write the pyramid file " + pyramidFile + ".");
+    return ok;
+}
+
+/*!
+ * \brief Finds a tile's pixels in the mapped file.
+ */
+const uint8_t * TiledImage::tileData(int level, int column, int row) const {
+    return myMap.data() + levelOffset[level] + ((uint64_t) row * levelColumns[level] + column) * myTileSize * myTileSize * 4;
+}
+
+/*!
+ * \brief Adds the tiles needed to cover a tile's area at the current zoom to the visible list.
+ * \details A tile that is off screen is skipped. A tile that covers more screen pixels than it has texels is
+ *   replaced by its four children at the next larger level, and so on down to full size, so a tilted image
+ *   uses large tiles near the camera and small ones far from it.
+ *   \param mvp The product of the projection, view and model matrices.
+ *   \param viewport The viewport, as returned by <code>glGetIntegerv(GL_VIEWPORT)</code>.
+ */
+void TiledImage::selectTiles(const glm::mat4& mvp, const GLint viewport[4], int level, int column, int row) {
+    const float lw = levelWidth[level], lh = levelHeight[level];
+    const int x0 = column * myTileSize, y0 = row * myTileSize;
+    const int x1 = std::min(x0 + myTileSize, levelWidth[level]), y1 = std::min(y0 + myTileSize, levelHeight[level]);
+    const glm::vec4 corners[4] = {
+        mvp * glm::vec4(x0 / lw - 0.5f, 0.5f - y0 / lh, 0.0f, 1.0f),
+        mvp * glm::vec4(x1 / lw - 0.5f, 0.5f - y0 / lh, 0.0f, 1.0f),
+        mvp * glm::vec4(x1 / lw - 0.5f, 0.5f - y1 / lh, 0.0f, 1.0f),
+        mvp * glm::vec4(x0 / lw - 0.5f, 0.5f - y1 / lh, 0.0f, 1.0f)
+    };
+
+    // Skip the tile if all of its corners are outside the same side of the view
+    for (int axis = 0; axis < 3; ++axis) {
+        bool allBelow = true, allAbove = true;
+        for (int i = 0; i < 4; ++i) {
+            allBelow = allBelow && corners[i][axis] < -corners[i].w;
+            allAbove = allAbove && corners[i][axis] > corners[i].w;
+        }
+        if (allBelow || allAbove)
+            return;
+    }
+
+    bool refine = false;
+    if (level > 0) {
+        bool behind = false;
+        glm::vec2 screen[4];
+        for (int i = 0; i < 4; ++i) {
+            behind = behind || corners[i].w <= 0;
+            screen[i] = glm::vec2((corners[i].x / corners[i].w + 1.0f) * 0.5f * viewport[2],
+                                  (corners[i].y / corners[i].w + 1.0f) * 0.5f * viewport[3]);
+        }
+        if (behind) {
+            refine = true;              // Part of the tile is behind the camera, so it is close to it
+        } else {
+            const float across = std::max(glm::length(screen[1] - screen[0]), glm::length(screen[2] - screen[3]));
+            const float down = std::max(glm::length(screen[3] - screen[0]), glm::length(screen[2] - screen[1]));
+            refine = across > (x1 - x0) || down > (y1 - y0);
+        }
+    }
+    if (!refine) {
+        TileRef t = { level, column, row };
+        myVisible.push_back(t);
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        const int c = 2 * column + (i & 1), r = 2 * row + (i >> 1);
+        if (c < levelColumns[level-1] && r < levelRows[level-1])
+            selectTiles(mvp, viewport, level - 1, c, r);
+    }
+}
+
+/*!
+ * \brief Finds a tile on the GPU, marking it as used this frame.
+ * \return The tile, or 0 if it is not on the GPU.
+ */
+TiledImage::Tile * TiledImage::findTile(int level, int column, int row) {
+    std::map<uint64_t, Tile>::iterator it = myTiles.find(key(level, column, row));
+    if (it == myTiles.end())
+        return 0;
+    it->second.lastUsed = myFrame;
+    return &it->second;
+}
+
+/*!
+ * \brief Uploads a tile to the GPU, reusing the texture of the least recently drawn tile if the budget is full.
+ * \details The budget is only exceeded when the tiles drawn this frame alone need more.
+ *   \param force Whether to upload the tile even if this frame's uploads are used up, or it is not in memory
+ *     yet and would have to be read from disk first.
+ * \return The tile, or 0 if this frame's uploads are used up or the tile is not in memory yet.
+ */
+TiledImage::Tile * TiledImage::uploadTile(int level, int column, int row, bool force) {
+    if (!force && (myUploads >= myFrameUploadLimit || !tileResident(level, column, row)))
+        return 0;
+    ++myUploads;
+
+    const size_t tileBytes = (size_t) myTileSize * myTileSize * 4;
+    GLuint texture = 0;
+    if ((myTiles.size() + 1) * tileBytes > myFrameBudget) {
+        std::map<uint64_t, Tile>::iterator oldest = myTiles.end();
+        for (std::map<uint64_t, Tile>::iterator it = myTiles.begin(); it != myTiles.end(); ++it) {
+            if (it->second.lastUsed < myFrame && (oldest == myTiles.end() || it->second.lastUsed < oldest->second.lastUsed))
+                oldest = it;
+        }
+        if (oldest != myTiles.end()) {
+            texture = oldest->second.texture;
+            myTiles.erase(oldest);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (texture) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, myTileSize, myTileSize, GL_RGBA, GL_UNSIGNED_BYTE, tileData(level, column, row));
+    } else {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, myTileSize, myTileSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, tileData(level, column, row));
+    }
+    Tile& t = myTiles[key(level, column, row)];
+    t.texture = texture;
+    t.lastUsed = myFrame;
+    return &t;
+}
+
+/*!
+ * \brief Asks the operating system to start reading a tile from disk, so that it is in memory by the time
+ *   it is uploaded.
+ */
+void TiledImage::prefetchTile(int level, int column, int row) {
+    myMap.prefetch(tileData(level, column, row) - myMap.data(), (size_t) myTileSize * myTileSize * 4);
+}
+
+/*!
+ * \brief Tells whether a tile is in memory, so that uploading it will not wait for the disk.
+ */
+bool TiledImage::tileResident(int level, int column, int row) const {
+    return myMap.isResident(tileData(level, column, row) - myMap.data(), (size_t) myTileSize * myTileSize * 4);
+}
+
+ /*!
+  * \brief Draw the TiledImage.
+  * \details This function actually draws the TiledImage to the Canvas.
+  * \details Picks the tiles that cover the window at the current zoom, and asks for every missing one to be
+  *   read from disk in the background. Up to setUploadsPerFrame() of the missing tiles that are already in
+  *   memory are uploaded; the rest are drawn from the nearest coarser tile already on the GPU until a later
+  *   frame, so the rendering thread never waits for the disk. The coarsest tile, which covers the whole image,
+  *   is always uploaded on the first draw, so there is always something to show.
+  *   \param shader The Canvas' texture shader.
+  */
+void TiledImage::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+
+    glm::mat4 model = glm::mat4(1.0f);
+    attribMutex.lock();
+    model = glm::translate(model, glm::vec3(myRotationPointX, myRotationPointY, myRotationPointZ));
+    model = glm::rotate(model, glm::radians(myCurrentYaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::rotate(model, glm::radians(myCurrentPitch), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(myCurrentRoll), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::translate(model, glm::vec3(myCenterX - myRotationPointX, myCenterY - myRotationPointY, myCenterZ - myRotationPointZ));
+    model = glm::scale(model, glm::vec3(myXScale, myYScale, myZScale));
+    const float alpha = myAlpha;
+    myFrameBudget = myTextureBudget;
+    myFrameUploadLimit = myUploadsPerFrame;
+    attribMutex.unlock();
+
+    glm::mat4 projection, view;
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "projection"), glm::value_ptr(projection));
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "view"), glm::value_ptr(view));
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUniformMatrix4fv(glGetUniformLocation(shader->ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniform1f(glGetUniformLocation(shader->ID, "alpha"), alpha);
+
+    ++myFrame;
+    myUploads = 0;
+    myVisible.clear();
+    selectTiles(projection * view * model, viewport, myLevels - 1, 0, 0);
+
+    // Start reading every missing tile before uploading any, so the reads overlap each other and this frame
+    for (unsigned i = 0; i < myVisible.size(); ++i) {
+        const TileRef& t = myVisible[i];
+        if (!findTile(t.level, t.column, t.row))
+            prefetchTile(t.level, t.column, t.row);
+    }
+
+    // One quad per visible tile, textured by the tile itself or by the part of a coarser tile it covers
+    std::vector<GLuint> textures;
+    myQuads.clear();
+    for (unsigned i = 0; i < myVisible.size(); ++i) {
+        const TileRef& t = myVisible[i];
+        int level = t.level, column = t.column, row = t.row;
+        Tile * found = findTile(level, column, row);
+        if (!found)
+            found = uploadTile(level, column, row, level == myLevels - 1);
+        while (!found) {
+            ++level; column /= 2; row /= 2;
+            found = findTile(level, column, row);
+            if (!found && level == myLevels - 1)
+                found = uploadTile(level, column, row, true);
+        }
+        textures.push_back(found->texture);
+
+        // The quad's corners as fractions of the image, then as texture coordinates of the tile drawn
+        const float lw = levelWidth[t.level], lh = levelHeight[t.level];
+        const float u0 = t.column * myTileSize / lw, v0 = t.row * myTileSize / lh;
+        const float u1 = std::min((t.column + 1) * myTileSize, levelWidth[t.level]) / lw;
+        const float v1 = std::min((t.row + 1) * myTileSize, levelHeight[t.level]) / lh;
+        const float s0 = u0 * levelWidth[level] / myTileSize - column, s1 = u1 * levelWidth[level] / myTileSize - column;
+        const float t0 = v0 * levelHeight[level] / myTileSize - row, t1 = v1 * levelHeight[level] / myTileSize - row;
+        const GLfloat quad[30] = {
+            u1 - 0.5f, 0.5f - v0, 0.0f,   s1, t0, // top right
+            u1 - 0.5f, 0.5f - v1, 0.0f,   s1, t1, // bottom right
+            u0 - 0.5f, 0.5f - v1, 0.0f,   s0, t1, // bottom left
+            u1 - 0.5f, 0.5f - v0, 0.0f,   s1, t0, // top right
+            u0 - 0.5f, 0.5f - v1, 0.0f,   s0, t1, // bottom left
+            u0 - 0.5f, 0.5f - v0, 0.0f,   s0, t0  // top left
+        };
+        myQuads.insert(myQuads.end(), quad, quad + 30);
+    }
+    attribMutex.lock();
+    myTextureBytes = myTiles.size() * myTileSize * myTileSize * 4;
+    attribMutex.unlock();
+    if (textures.empty())
+        return;
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * myQuads.size(), &myQuads[0], GL_DYNAMIC_DRAW);
+    for (unsigned i = 0; i < textures.size(); ++i) {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glDrawArrays(GL_TRIANGLES, 6 * i, 6);
+    }
+}
+
+/**
+ * \brief Mutates the distance from the left side of the TiledImage to its right side.
+ * \param width The TiledImage's new width.
+ */
+void TiledImage::setWidth(GLfloat width) {
+    if (width <= 0) {
+        TsglDebug("Cannot have a TiledImage with width less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    myWidth = width;
+    myXScale = width;
+    attribMutex.unlock();
+}
+
+/**
+ * \brief Mutates the distance from the top side of the TiledImage to its bottom side.
+ * \param height The TiledImage's new height.
+ */
+void TiledImage::setHeight(GLfloat height) {
+    if (height <= 0) {
+        TsglDebug("Cannot have a TiledImage with height less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    myHeight = height;
+    myYScale = height;
+    attribMutex.unlock();
+}
+
+/**
+ *  \brief Alters the TiledImage's transparency.
+ *  \param alpha The TiledImage's new alpha value.
+ *  \note If parameter not 0.0 <= alpha <= 1.0 then this method will have no effect.
+ */
+void TiledImage::setAlpha(float alpha) {
+    if (alpha < 0.0 || alpha > 1.0) {
+        TsglDebug("Cannot have a TiledImage with alpha not 0.0 <= alpha <= 1.0.");
+        return;
+    }
+    attribMutex.lock();
+    myAlpha = alpha;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for the most GPU memory the TiledImage keeps tiles in.
+ * \details Once the budget is full, each new tile replaces the least recently drawn one. Tiles that were
+ *   dropped are simply uploaded again, from the mapped file, if they come back into view.
+ *   \param bytes The new budget in bytes (64 MB, or 256 tiles of 256 x 256 pixels, by default).
+ */
+void TiledImage::setTextureBudget(size_t bytes) {
+    attribMutex.lock();
+    myTextureBudget = bytes;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for the most tiles uploaded to the GPU in one frame.
+ * \details Lower values keep the frame rate steadier while zooming quickly; higher values fill in detail sooner.
+ *   \param tiles The new limit (8 by default). The coarsest tile is uploaded regardless.
+ */
+void TiledImage::setUploadsPerFrame(unsigned tiles) {
+    attribMutex.lock();
+    myUploadsPerFrame = tiles;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Accessor for the GPU memory taken by the tiles uploaded so far, in bytes, as of the last draw.
+ */
+size_t TiledImage::getTextureBytes() {
+    attribMutex.lock();
+    size_t bytes = myTextureBytes;
+    attribMutex.unlock();
+    return bytes;
+}
+
+/*!
+ * \brief Destroys the TiledImage, freeing its textures and unmapping its file.
+ */
+TiledImage::~TiledImage() {
+    for (std::map<uint64_t, Tile>::iterator it = myTiles.begin(); it != myTiles.end(); ++it)
+        glDeleteTextures(1, &it->second.texture);
+}
+
+}
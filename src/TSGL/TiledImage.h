@@ -0,0 +1,133 @@
+/*
+ * TiledImage.h extends Drawable and provides a class for drawing images too large to load as one texture.
+ */
+
+#ifndef TILEDIMAGE_H_
+#define TILEDIMAGE_H_
+
+#include <functional>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Drawable.h"           // For extending our Drawable object
+#include "MappedFile.h"         // For reading the pyramid file
+
+namespace tsgl {
+
+/*! \class TiledImage
+ *  \brief Draw an arbitrarily large image to the Canvas, loading only the parts that are on screen.
+ *  \details An Image decodes its whole file into memory and uploads it as one texture, which fails for images
+ *   larger than the GPU's maximum texture size and takes seconds for very large files. A TiledImage instead
+ *   draws a <i>tile pyramid</i>: a file, made once with createPyramid(), holding the image cut into square
+ *   tiles at full size, then at half size, quarter size and so on down to a single tile.
+ *  \details The pyramid file is memory-mapped rather than read, so opening it is instant and only the tiles that
+ *   are drawn are ever read from disk. Each frame, the TiledImage works out from the Canvas' camera which tiles
+ *   cover the window, and at which size each one is closest to one texel per screen pixel. Missing tiles are
+ *   read ahead by the operating system in the background, and uploaded a few per frame (see
+ *   setUploadsPerFrame()) once they are in memory; until a tile arrives, the area it covers is drawn from a
+ *   coarser tile that is already on the GPU, so panning and zooming do not stall on disk reads. Only the first
+ *   draw waits for the disk, to read the coarsest tile. (On Windows, which TSGL cannot ask which parts of a
+ *   file are in memory, tiles are uploaded as soon as they are missing, and may be read from disk as they are.)
+ *  \details Uploaded tiles stay on the GPU until the texture budget (see setTextureBudget()) is full, after
+ *   which the least recently drawn tiles are replaced first.
+ *  \note <B>IMPORTANT</B>: The pyramid file must not be changed or deleted while a TiledImage is drawing it.
+ */
+class TiledImage : public Drawable {
+ private:
+    struct Tile {
+        GLuint texture;
+        unsigned long lastUsed;         // Frame the tile was last drawn in
+    };
+
+    struct TileRef {
+        int level, column, row;
+    };
+
+    std::string myFile;
+    GLfloat myWidth, myHeight;
+    MappedFile myMap;
+    int myPixelWidth, myPixelHeight, myTileSize, myLevels;
+    std::vector<int> levelWidth, levelHeight, levelColumns, levelRows;
+    std::vector<uint64_t> levelOffset;
+
+    // Used only by the rendering thread
+    std::map<uint64_t, Tile> myTiles;   // Tiles on the GPU, by key()
+    unsigned long myFrame;
+    unsigned myUploads;                 // Tiles uploaded so far this frame
+    std::vector<TileRef> myVisible;
+    std::vector<GLfloat> myQuads;
+    size_t myFrameBudget;               // Copies of the settings below, taken at the start of each frame
+    unsigned myFrameUploadLimit;
+
+    size_t myTextureBudget, myTextureBytes;
+    unsigned myUploadsPerFrame;
+
+    bool openPyramid();
+    uint64_t key(int level, int column, int row) const { return ((uint64_t) level << 48) | ((uint64_t) row << 24) | column; }
+    const uint8_t * tileData(int level, int column, int row) const;
+    void selectTiles(const glm::mat4& mvp, const GLint viewport[4], int level, int column, int row);
+    Tile * findTile(int level, int column, int row);
+    Tile * uploadTile(int level, int column, int row, bool force);
+    void prefetchTile(int level, int column, int row);
+    bool tileResident(int level, int column, int row) const;
+ public:
+    TiledImage(float x, float y, float z, std::string filename, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha = 1.0f);
+
+    virtual void draw(Shader * shader);
+
+    static bool createPyramid(const std::string& imageFile, const std::string& pyramidFile, int tileSize = 256);
+
+    static bool createPyramid(const std::string& pyramidFile, int pixelWidth, int pixelHeight,
+                              std::function<void(int x, int y, int w, int h, uint8_t* rgba, int stride)> source,
+                              int tileSize = 256);
+
+    void setWidth(GLfloat width);
+
+    void setHeight(GLfloat height);
+
+    void setAlpha(float alpha);
+
+    void setTextureBudget(size_t bytes);
+
+    void setUploadsPerFrame(unsigned tiles);
+
+    /*!
+     * \brief Accessor for the TiledImage's width.
+     */
+    GLfloat getWidth() { return myWidth; }
+
+    /*!
+     * \brief Accessor for the TiledImage's height.
+     */
+    GLfloat getHeight() { return myHeight; }
+
+    /*!
+     * \brief Accessor for the width of the full-size image in pixels.
+     */
+    int getPixelWidth() { return myPixelWidth; }
+
+    /*!
+     * \brief Accessor for the height of the full-size image in pixels.
+     */
+    int getPixelHeight() { return myPixelHeight; }
+
+    /*!
+     * \brief Accessor for the number of sizes the pyramid stores the image at, including full size.
+     */
+    int getLevels() { return myLevels; }
+
+    /*!
+     * \brief Accessor for the most GPU memory the TiledImage keeps tiles in, in bytes.
+     */
+    size_t getTextureBudget() { return myTextureBudget; }
+
+    size_t getTextureBytes();
+
+    virtual ~TiledImage();
+};
+
+}
+
+#endif /* TILEDIMAGE_H_ */
@@ -0,0 +1,320 @@
+#include "TimelineView.h"
+
+#include <algorithm>
+
+namespace tsgl {
+
+// One quad per instance: each instance is a span's rectangle (left, right, bottom, top) and color
+static const GLchar* timelineVertexShader =
+  "#version 330 core\n"
+  "layout (location = 0) in vec2 aCorner;"
+  "layout (location = 1) in vec4 aRect;"
+  "layout (location = 2) in vec4 aColor;"
+  "out vec4 color;"
+  "uniform mat4 projection;"
+  "uniform mat4 view;"
+  "uniform mat4 model;"
+  "void main() {"
+  "vec2 pos = vec2(mix(aRect.x, aRect.y, aCorner.x), mix(aRect.z, aRect.w, aCorner.y));"
+  "gl_Position = projection * view * model * vec4(pos, 0.0, 1.0);"
+  "color = aColor;"
+  "}";
+
+static const GLchar* timelineFragmentShader =
+  "#version 330 core\n"
+  "out vec4 FragColor;"
+  "in vec4 color;"
+  "void main() {"
+  "FragColor = color;"
+  "}";
+
+static const unsigned INSTANCE_FLOATS = 8;
+
+ /*!
+  * \brief Explicitly constructs a new TimelineView.
+  * \details This is the explicit constructor for the TimelineView class.
+  *   \param x The x coordinate of the center of the TimelineView.
+  *   \param y The y coordinate of the center of the TimelineView.
+  *   \param z The z coordinate of the center of the TimelineView.
+  *   \param width The width of the TimelineView.
+  *   \param height The height of the TimelineView.
+  *   \param window The number of seconds shown across the chart.
+  *   \param yaw The yaw orientation of the TimelineView.
+  *   \param pitch The pitch orientation of the TimelineView.
+  *   \param roll The roll orientation of the TimelineView.
+  * \return A new TimelineView, divided into one column per unit of width (one per pixel on a Canvas with the
+  *   default camera), that shows nested spans in 4 bands.
+  */
+TimelineView::TimelineView(float x, float y, float z, GLfloat width, GLfloat height, double window,
+                           float yaw, float pitch, float roll) : Drawable(x,y,z,yaw,pitch,roll) {
+    myDrawnSpans = 0;
+    myShader = NULL;
+    myVertexArray = myQuadBuffer = myInstanceBuffer = 0;
+    myInstanceCapacity = 0;
+    vertices = 0;
+    if (width <= 0 || height <= 0) {
+        TsglDebug("Cannot have a TimelineView with width or height less than or equal to 0.");
+        return;
+    }
+    if (window <= 0) {
+        TsglDebug("Cannot have a TimelineView with a window of 0 seconds or less.");
+        return;
+    }
+    attribMutex.lock();
+    myWidth = width; myHeight = height;
+    myXScale = width; myYScale = height; myZScale = 1;
+    myWindow = window;
+    myPaused = false;
+    myPausedAt = 0;
+    myColorsChanged = false;
+    myColumns = std::max(2, (int) width);
+    myDepthLevels = 4;
+    myAlpha = 1.0f;
+    init = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Creates the chart's shader program, and its vertex array with the quad and the instance buffer.
+ */
+void TimelineView::initGL() {
+    myShader = new Shader(timelineVertexShader, timelineFragmentShader);
+    GLint previousArray = 0, previousBuffer = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousArray);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+
+    glGenVertexArrays(1, &myVertexArray);
+    glBindVertexArray(myVertexArray);
+    const GLfloat corners[] = { 0,0,  1,0,  0,1,  1,1 };
+    glGenBuffers(1, &myQuadBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myQuadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+    glGenBuffers(1, &myInstanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myInstanceBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, INSTANCE_FLOATS * sizeof(float), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, INSTANCE_FLOATS * sizeof(float), (void*)(4 * sizeof(float)));
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(previousArray);
+    glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+}
+
+/*!
+ * \brief Picks the color of a label: the one given with setColor(), or one hashed from its text.
+ * \details Colors are cached by the label's address, so the text of each label is only looked at once.
+ */
+ColorFloat TimelineView::labelColor(const char* label) {
+    std::unordered_map<const char*, ColorFloat>::iterator cached = myColorCache.find(label);
+    if (cached != myColorCache.end())
+        return cached->second;
+    const std::string text = label ? label : "";
+    ColorFloat color;
+    attribMutex.lock();
+    std::map<std::string, ColorFloat>::iterator given = myLabelColors.find(text);
+    const bool found = given != myLabelColors.end();
+    if (found)
+        color = given->second;
+    attribMutex.unlock();
+    if (!found) {
+        uint32_t hash = 2166136261u;            // FNV-1a, so equal labels get equal colors
+        for (unsigned i = 0; i < text.size(); ++i)
+            hash = (hash ^ (unsigned char) text[i]) * 16777619u;
+        color = Colors::highContrastColor(hash % 255);
+    }
+    myColorCache[label] = color;
+    return color;
+}
+
+ /*!
+  * \brief Draw the TimelineView.
+  * \details This function actually draws the TimelineView to the Canvas.
+  * \details Reads the spans of each thread that end in the window, newest first, stopping at the first that
+  *   ended before it, so a frame costs about as much as the spans in view. Narrow spans are merged, and the
+  *   bars are uploaded to the chart's instance buffer and drawn with one instanced draw call.
+  *   \param shader The Canvas' shape shader, whose camera matrices are copied into the chart's own shader.
+  */
+void TimelineView::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+    if (!myShader)
+        initGL();
+
+    attribMutex.lock();
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(myRotationPointX, myRotationPointY, myRotationPointZ));
+    model = glm::rotate(model, glm::radians(myCurrentYaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::rotate(model, glm::radians(myCurrentPitch), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(myCurrentRoll), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::translate(model, glm::vec3(myCenterX - myRotationPointX, myCenterY - myRotationPointY, myCenterZ - myRotationPointZ));
+    model = glm::scale(model, glm::vec3(myXScale, myYScale, myZScale));
+    const double window = myWindow;
+    const double now = myPaused ? myPausedAt : ThreadTimeline::now();
+    const unsigned columns = myColumns, levels = myDepthLevels;
+    const bool colorsChanged = myColorsChanged;
+    myColorsChanged = false;
+    attribMutex.unlock();
+    if (colorsChanged)
+        myColorCache.clear();
+
+    // Lay out the bars: a row per thread, first at the top, and a band per level of nesting within each row
+    const double from = now - window;
+    const float column = 1.0f / columns;
+    const unsigned threads = ThreadTimeline::getThreadCount();
+    const float rowHeight = threads ? 1.0f / threads : 1.0f;
+    const float bandHeight = rowHeight * 0.9f / levels;
+    myInstances.clear();
+    std::vector<int> lastBar(levels);
+    std::vector<bool> lastNarrow(levels);
+    for (unsigned t = 0; t < threads; ++t) {
+        mySpans.clear();
+        ThreadTimeline::getSpans(t, from, now, mySpans);
+        std::fill(lastBar.begin(), lastBar.end(), -1);
+        const float rowTop = 0.5f - t * rowHeight - rowHeight * 0.05f;
+        for (unsigned i = 0; i < mySpans.size(); ++i) {         // Newest first, so bars are added right to left
+            const TimelineSpan& span = mySpans[i];
+            const float left = (float) ((std::max(span.begin, from) - from) / window) - 0.5f;
+            const float right = (float) ((std::min(span.end, now) - from) / window) - 0.5f;
+            const bool narrow = right - left < column;
+            const unsigned band = std::min(span.depth, levels - 1);
+            const int last = lastBar[band];
+            if (narrow && last >= 0 && lastNarrow[band] && myInstances[last * INSTANCE_FLOATS] - right < column) {
+                myInstances[last * INSTANCE_FLOATS] = left;     // Widen the bar to take in this span
+                continue;
+            }
+            const ColorFloat color = labelColor(span.label);
+            const float top = rowTop - band * bandHeight;
+            const GLfloat bar[INSTANCE_FLOATS] = {
+                left, std::max(right, left + column), top - bandHeight * 0.9f, top,
+                color.R, color.G, color.B, color.A
+            };
+            lastBar[band] = myInstances.size() / INSTANCE_FLOATS;
+            lastNarrow[band] = narrow;
+            myInstances.insert(myInstances.end(), bar, bar + INSTANCE_FLOATS);
+        }
+    }
+    myDrawnSpans = myInstances.size() / INSTANCE_FLOATS;
+    if (myDrawnSpans == 0)
+        return;
+
+    GLint previousArray = 0, previousBuffer = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousArray);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+    glBindVertexArray(myVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, myInstanceBuffer);
+    if (myDrawnSpans > myInstanceCapacity) {
+        myInstanceCapacity = std::max<size_t>(myDrawnSpans, myInstanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * INSTANCE_FLOATS * myInstanceCapacity, NULL, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * myInstances.size(), &myInstances[0]);
+
+    // Use the Canvas' camera for our own program
+    glm::mat4 projection, view;
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "projection"), glm::value_ptr(projection));
+    glGetUniformfv(shader->ID, glGetUniformLocation(shader->ID, "view"), glm::value_ptr(view));
+    myShader->use();
+    myShader->setMat4("projection", projection);
+    myShader->setMat4("view", view);
+    myShader->setMat4("model", model);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, myDrawnSpans);
+
+    // Leave the Canvas' vertex array and program as they were
+    glBindVertexArray(previousArray);
+    glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+    shader->use();
+}
+
+/*!
+ * \brief Mutates the number of seconds shown across the chart.
+ * \details A longer window may need a coarser ThreadTimeline::setResolution(), or a larger
+ *   ThreadTimeline::setCapacity(), for the rings to reach back that far.
+ *   \param seconds The new window.
+ */
+void TimelineView::setWindow(double seconds) {
+    if (seconds <= 0) {
+        TsglDebug("Cannot have a TimelineView with a window of 0 seconds or less.");
+        return;
+    }
+    attribMutex.lock();
+    myWindow = seconds;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the number of columns the chart is divided into.
+ * \details Spans narrower than a column are drawn a column wide, and runs of them are merged into one bar.
+ *   For the sharpest chart, use the chart's width in pixels.
+ *   \param columns The new number of columns, at least 2.
+ */
+void TimelineView::setColumns(unsigned columns) {
+    if (columns < 2) {
+        TsglDebug("Cannot have a TimelineView with fewer than 2 columns.");
+        return;
+    }
+    attribMutex.lock();
+    myColumns = columns;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the number of bands each thread's row is divided into for nested spans.
+ * \details Spans nested deeper than the last band are drawn in the last band.
+ *   \param levels The new number of bands, at least 1.
+ */
+void TimelineView::setDepthLevels(unsigned levels) {
+    if (levels == 0) {
+        TsglDebug("Cannot have a TimelineView with 0 depth levels.");
+        return;
+    }
+    attribMutex.lock();
+    myDepthLevels = levels;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Stops or restarts the chart's scrolling.
+ * \details While paused, the chart keeps showing the window that ended when it was paused, as long as the
+ *   threads' rings still hold those spans.
+ *   \param paused Whether the chart should stop scrolling.
+ */
+void TimelineView::setPaused(bool paused) {
+    attribMutex.lock();
+    if (paused && !myPaused)
+        myPausedAt = ThreadTimeline::now();
+    myPaused = paused;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutates the color of the spans with a label, including those already drawn.
+ *   \param label The text of the label.
+ *   \param color The new color.
+ */
+void TimelineView::setColor(const std::string& label, ColorFloat color) {
+    attribMutex.lock();
+    myLabelColors[label] = color;
+    myColorsChanged = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Destroys the TimelineView, freeing its shader program and buffers.
+ */
+TimelineView::~TimelineView() {
+    if (myInstanceBuffer)
+        glDeleteBuffers(1, &myInstanceBuffer);
+    if (myQuadBuffer)
+        glDeleteBuffers(1, &myQuadBuffer);
+    if (myVertexArray)
+        glDeleteVertexArrays(1, &myVertexArray);
+    delete myShader;
+}
+
+}
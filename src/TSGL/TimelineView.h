@@ -0,0 +1,108 @@
+/*
+ * TimelineView.h extends Drawable and provides a class for drawing a live Gantt chart of the ThreadTimeline.
+ */
+
+#ifndef TIMELINEVIEW_H_
+#define TIMELINEVIEW_H_
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Drawable.h"           // For extending our Drawable object
+#include "ThreadTimeline.h"     // For the spans we draw
+
+namespace tsgl {
+
+/*! \class TimelineView
+ *  \brief Draw the spans recorded by the ThreadTimeline as a Gantt chart that scrolls across the Canvas.
+ *  \details TimelineView shows the last <code>window</code> seconds of the ThreadTimeline, with the present at
+ *   the right edge. Each thread that has recorded gets a row, the first at the top; spans nested inside other
+ *   spans are drawn in bands below their parents, down to setDepthLevels() levels.
+ *  \details Each span is colored after its label, with a high contrast color picked from the text of the label
+ *   unless one is given with setColor().
+ *  \details Every span is one instance of a single quad, so a frame takes one upload and one draw call however
+ *   many spans are in view. Runs of spans that are each narrower than a column and closer than a column to each
+ *   other are drawn as one bar, so the number of instances stays near the number of columns per band even when
+ *   threads record millions of spans per second.
+ *  \details The chart can only show what the ThreadTimeline's rings still hold, which may be less than the window
+ *   if threads record quickly; see ThreadTimeline::setResolution() and ThreadTimeline::setCapacity().
+ *  \note The Canvas draws a TimelineView with its own shader program, which it creates the first time it draws.
+ */
+class TimelineView : public Drawable {
+ private:
+    GLfloat myWidth, myHeight;
+    double myWindow, myPausedAt;
+    bool myPaused, myColorsChanged;
+    unsigned myColumns, myDepthLevels;
+    std::map<std::string, ColorFloat> myLabelColors;
+
+    // Used only by the rendering thread
+    std::unordered_map<const char*, ColorFloat> myColorCache;
+    std::vector<TimelineSpan> mySpans;
+    std::vector<GLfloat> myInstances;
+    unsigned myDrawnSpans;
+    Shader* myShader;
+    GLuint myVertexArray, myQuadBuffer, myInstanceBuffer;
+    size_t myInstanceCapacity;
+
+    void initGL();
+    ColorFloat labelColor(const char* label);
+ public:
+    TimelineView(float x, float y, float z, GLfloat width, GLfloat height, double window,
+                 float yaw, float pitch, float roll);
+
+    virtual void draw(Shader * shader);
+
+    void setWindow(double seconds);
+
+    void setColumns(unsigned columns);
+
+    void setDepthLevels(unsigned levels);
+
+    void setPaused(bool paused);
+
+    void setColor(const std::string& label, ColorFloat color);
+
+    /*!
+     * \brief Accessor for the number of seconds shown across the chart.
+     */
+    double getWindow() { return myWindow; }
+
+    /*!
+     * \brief Accessor for the number of columns the chart merges narrow spans into.
+     */
+    unsigned getColumns() { return myColumns; }
+
+    /*!
+     * \brief Accessor for the number of bands nested spans are drawn in.
+     */
+    unsigned getDepthLevels() { return myDepthLevels; }
+
+    /*!
+     * \brief Accessor for whether the chart has stopped scrolling.
+     */
+    bool isPaused() { return myPaused; }
+
+    /*!
+     * \brief Accessor for the number of bars drawn in the last frame, after narrow spans were merged.
+     */
+    unsigned getDrawnSpans() { return myDrawnSpans; }
+
+    /*!
+     * \brief Accessor for the chart's width.
+     */
+    GLfloat getWidth() { return myWidth; }
+
+    /*!
+     * \brief Accessor for the chart's height.
+     */
+    GLfloat getHeight() { return myHeight; }
+
+    virtual ~TimelineView();
+};
+
+}
+
+#endif /* TIMELINEVIEW_H_ */
@@ -1,15 +1,60 @@
 #include "Timer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <vector>
+
 namespace tsgl {
 
+struct VirtualClock {
+    std::mutex mutex;
+    std::condition_variable advanced;       // Signaled when the clock moves on a frame, or stops
+    std::condition_variable settled;        // Signaled when the last thread woken for a frame sleeps again
+    bool running;                           // Whether the Timer is on virtual time
+    bool released;                          // Whether sleeping threads have stopped waiting for frames for good
+    unsigned generation;                    // Counts the times the clock was started, to tell stale memberships
+    double base;                            // The time of frame 0, in seconds
+    uint64_t frame;
+    unsigned participants, awake;           // Threads that sleep on the clock, and how many of them are not asleep
+};
+
+// The virtual clocks the calling thread sleeps on, which it leaves when it exits
+struct VirtualClockMemberships {
+    struct Membership {
+        std::shared_ptr<VirtualClock> clock;
+        unsigned generation;
+    };
+    std::vector<Membership> clocks;
+
+    static void leave(Membership& m) {
+        std::unique_lock<std::mutex> lock(m.clock->mutex);
+        if (m.generation != m.clock->generation)
+            return;
+        --m.clock->participants;
+        if (m.clock->awake > 0 && --m.clock->awake == 0)
+            m.clock->settled.notify_all();
+    }
+
+    ~VirtualClockMemberships() {
+        for (unsigned i = 0; i < clocks.size(); ++i)
+            leave(clocks[i]);
+    }
+};
+
+static thread_local VirtualClockMemberships memberships;
+
 /*!
  * \brief Default Timer constructor method.
  * \details This is the default constructor for the Timer class.
  *   \param period Time in seconds specifying the maximum amount of time to sleep.
  * \return A new Timer with the specified period.
  */
-Timer::Timer(double period) {
+Timer::Timer(double period) : virtual_clock(new VirtualClock()) {
+    pacing = PACE_TIMER;
+    spin_time = duration_d(0.002);
     reset(period);
+    time_between_sleeps = period_.count();
 }
 
 /*!
@@ -26,30 +71,117 @@ Timer::~Timer() {
  * \return The number of times the <code>period</period> has elapsed since the Timer has been started.
  */
 unsigned int Timer::getReps() const {
-    return std::chrono::duration_cast<duration_d>(highResClock::now() - start_time).count() / period_.count();
+    return getTime() / period_.count();
 }
 
 // Get the time since start
 /*!
  * \brief Gets the elapsed time since starting the timer
- * \return The time in seconds since starting the Timer.
+ * \return The time in seconds since starting the Timer. On virtual time, the time when virtual time was
+ *   turned on, plus one period for each frame since.
  */
 double Timer::getTime() const {
+    {
+        std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+        if (virtual_clock->running)
+            return virtual_clock->base + virtual_clock->frame * period_.count();
+    }
     return std::chrono::duration_cast<duration_d>(highResClock::now() - start_time).count();
 }
 
 // Get the time between the two last sleeps
 /*!
  * \brief Get the elapsed time between sleeps
- * \details This function returns the time in seconds between returning from the last two calls to sleep().
- *   This should be the same as <code>period</code> in cases where the Timer is allowed to sleep. If the
- *   Timer has yet to sleep twice, getTimeBetweenSleeps() is undefined, but will most likely be less than 0.
+ * \details This function returns the time in seconds between returning from the last two calls to sleep()
+ *   that updated the Timer. This should be the same as <code>period</code> in cases where the Timer is
+ *   allowed to sleep.
  * \return The time in seconds between the last two sleeps.
+ * \see getFrameStats(), for statistics over more than one frame.
  */
 double Timer::getTimeBetweenSleeps() const {
     return time_between_sleeps;
 }
 
+/*!
+ * \brief Gets how long until the thread that updates the Timer is due to start its next frame.
+ * \details For a thread that updates the Timer with tick() instead of sleep(), such as one that draws several
+ *   Canvases: the frame is due when this reaches 0. On virtual time, with threads sleeping on the Timer, a frame
+ *   is due as soon as every thread woken for the last one has slept again; until then, there is no telling when.
+ * \return The time in seconds, 0 if the frame is due, or HUGE_VAL while waiting for threads on virtual time.
+ */
+double Timer::getTimeToFrame() {
+    {
+        std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+        if (virtual_clock->running && (virtual_clock->released || virtual_clock->participants > 0))
+            return (virtual_clock->released || virtual_clock->awake == 0) ? 0 : HUGE_VAL;
+    }
+    mutexLock sleepLock(sleep_);
+    if (pacing != PACE_TIMER)
+        return 0;
+    return std::max(0.0, std::chrono::duration_cast<duration_d>(last_time + period_ - highResClock::now()).count());
+}
+
+/*!
+ * \brief Gets statistics of the time between recent frames.
+ * \details A frame is the time between returning from two calls to sleep() that updated the Timer. The
+ *   statistics cover up to the last 120 frames. A frame is counted as missed if it took more than one and a
+ *   half periods; frames are never counted as missed when the pacing is PACE_UNCAPPED.
+ * \return The statistics, all 0 if no frame has finished since the Timer was last reset.
+ */
+FrameStats Timer::getFrameStats() {
+    mutexLock sleepLock(sleep_);
+    FrameStats stats = { 0, 0, 0, 0, (unsigned) frame_times.size() };
+    if (frame_times.empty())
+        return stats;
+    const double late = (pacing == PACE_UNCAPPED) ? HUGE_VAL : 1.5 * period_.count();
+    for (unsigned i = 0; i < frame_times.size(); ++i) {
+        stats.mean += frame_times[i];
+        stats.max = std::max(stats.max, frame_times[i]);
+        if (frame_times[i] > late)
+            ++stats.missed;
+    }
+    stats.mean /= frame_times.size();
+    for (unsigned i = 0; i < frame_times.size(); ++i)
+        stats.stddev += (frame_times[i] - stats.mean) * (frame_times[i] - stats.mean);
+    stats.stddev = sqrt(stats.stddev / frame_times.size());
+    return stats;
+}
+
+/*!
+ * \brief Accessor for how the Timer paces the thread that updates it.
+ * \return The current PacingMode.
+ */
+PacingMode Timer::getPacing() {
+    mutexLock sleepLock(sleep_);
+    return pacing;
+}
+
+/*!
+ * \brief Accessor for whether the Timer is on virtual time.
+ * \see setVirtual()
+ */
+bool Timer::isVirtual() const {
+    std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+    return virtual_clock->running;
+}
+
+/*!
+ * \brief Stops the calling thread from being waited for by the virtual clock.
+ * \details On virtual time, the thread that updates the Timer waits for every thread that has slept on the
+ *   Timer to sleep again before it moves on to the next frame. Call this from a thread that has slept on the
+ *   Timer and will not sleep on it again, so that it is not waited for. Threads that exit leave on their own.
+ */
+void Timer::leave() {
+    std::vector<VirtualClockMemberships::Membership>& clocks = memberships.clocks;
+    for (unsigned i = 0; i < clocks.size(); ++i) {
+        if (clocks[i].clock == virtual_clock) {
+            VirtualClockMemberships::leave(clocks[i]);
+            clocks.erase(clocks.begin() + i);
+            return;
+        }
+    }
+}
+
 // Check if the timer has elapsed past the point when it last past the period
 /*!
  * \brief Check if the Timer's period has elapsed.
@@ -73,39 +205,222 @@ bool Timer::pastPeriod() {
  *     the current period.
  */
 void Timer::reset(double period) {
-    start_time = last_time = highResClock::now();
+    mutexLock sleepLock(sleep_);
+    start_time = last_time = last_wake = highResClock::now();
     if (period > 0) period_ = duration_d(period);
     last_rep = 0;
+    frame_times.clear();
+    std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+    virtual_clock->base = 0;
+    virtual_clock->frame = 0;
+}
+
+/*!
+ * \brief Lets every thread sleeping on the virtual clock go, for good.
+ * \details Called when the thread that updates the Timer stops, so that threads sleeping on the Timer do not
+ *   wait for a frame that will never come. From then on, sleep() returns at once on virtual time.
+ */
+void Timer::release() {
+    std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+    virtual_clock->released = true;
+    virtual_clock->advanced.notify_all();
+    virtual_clock->settled.notify_all();
+}
+
+/*!
+ * \brief Mutates how the Timer paces the thread that updates it.
+ * \details With PACE_TIMER, the default, sleep() waits for the start of the next period. With PACE_VSYNC, the
+ *   thread that updates the Timer does not wait in sleep(), on the understanding that it waits for the
+ *   display instead; other threads still wait for the start of the next period. With PACE_UNCAPPED, no
+ *   thread waits in sleep().
+ *   \param mode The new PacingMode.
+ */
+void Timer::setPacing(PacingMode mode) {
+    mutexLock sleepLock(sleep_);
+    pacing = mode;
+}
+
+/*!
+ * \brief Mutates how long before the start of a period sleep() stops sleeping and starts spinning.
+ * \details The operating system may wake a sleeping thread a millisecond or more late. To wake on time,
+ *   sleep() sleeps until <code>seconds</code> before the period starts and then spins, yielding the processor,
+ *   until it does. Longer spins are more precise but cost more processor time. The default is 2 milliseconds.
+ *   \param seconds The new spin time, 0 to never spin.
+ */
+void Timer::setSpinTime(double seconds) {
+    mutexLock sleepLock(sleep_);
+    spin_time = duration_d(std::max(0.0, seconds));
+}
+
+/*!
+ * \brief Puts the Timer on or off virtual time.
+ * \details On virtual time, no thread really sleeps. Instead, each call to sleep() that updates the Timer
+ *   is a frame, and moves the time on by exactly one period:
+ *   - It first waits for every thread that has slept on the Timer since virtual time was turned on to
+ *     finish its work and sleep again, so no frame ever catches a thread halfway through a step.
+ *   - Then it moves on to the next frame. getTime() and getReps() advance by one period, and the sleeping
+ *     threads are woken for it.
+ *   .
+ *   So a simulation that steps once per sleep() computes the same frames however fast or slow the machine,
+ *   and a recorded animation renders as fast as the machine can go instead of in real time.
+ * \details Until some thread sleeps on the Timer, the updating thread sleeps for a real period per frame
+ *   and the virtual time does not move.
+ *   \param on Whether to use virtual time. Virtual time starts from getTime() at the moment it is turned on.
+ *     Turning it off lets every sleeping thread go, and getTime() goes back to real time.
+ * \see leave(), for a thread that stops sleeping on the Timer.
+ */
+void Timer::setVirtual(bool on) {
+    const double now = getTime();
+    std::unique_lock<std::mutex> lock(virtual_clock->mutex);
+    if (on == virtual_clock->running)
+        return;
+    if (on) {
+        virtual_clock->base = now;
+        virtual_clock->frame = 0;
+        virtual_clock->participants = virtual_clock->awake = 0;
+        virtual_clock->released = false;
+        ++virtual_clock->generation;
+    }
+    virtual_clock->running = on;
+    virtual_clock->advanced.notify_all();
+    virtual_clock->settled.notify_all();
+}
+
+/*!
+ * \brief Sleeps on virtual time, if the Timer is on it.
+ * \details The updating thread moves the clock on a frame, then waits for the threads it wakes to sleep again.
+ *   Other threads join the clock the first time they sleep on it, and wait for the next frame.
+ *   \param update Whether the calling thread updates the Timer.
+ *   \param wait Whether the updating thread should wait: for a real period while no thread sleeps on the clock,
+ *     and otherwise for the threads it wakes to sleep again.
+ * \return Whether the Timer was on virtual time, and the frame was taken care of.
+ */
+bool Timer::sleepVirtual(bool update, bool wait) {
+    VirtualClock& clock = *virtual_clock;
+    std::unique_lock<std::mutex> lock(clock.mutex);
+    if (!clock.running)
+        return false;
+    if (clock.released)
+        return true;
+
+    if (update) {
+        if (clock.participants == 0) {
+            if (!wait)
+                return false;               // Let the caller pace the frame in real time
+            lock.unlock();
+            threadSleepFor(period_.count());     // Nothing to step yet, so keep the time where it is
+            return true;
+        }
+        ++clock.frame;
+        clock.awake = clock.participants;
+        clock.advanced.notify_all();
+        if (!wait)
+            return true;                    // The caller checks getTimeToFrame() instead
+        clock.settled.wait(lock, [&clock]() { return clock.awake == 0 || !clock.running || clock.released; });
+        return true;
+    }
+
+    std::vector<VirtualClockMemberships::Membership>& clocks = memberships.clocks;
+    unsigned i = 0;
+    while (i < clocks.size() && clocks[i].clock != virtual_clock)
+        ++i;
+    if (i < clocks.size() && clocks[i].generation == clock.generation) {
+        if (clock.awake > 0 && --clock.awake == 0)
+            clock.settled.notify_all();
+    } else {
+        if (i == clocks.size()) {
+            VirtualClockMemberships::Membership m = { virtual_clock, 0 };
+            clocks.push_back(m);
+        }
+        clocks[i].generation = clock.generation;
+        ++clock.participants;
+    }
+    const uint64_t next = clock.frame + 1;
+    clock.advanced.wait(lock, [&clock, next]() { return clock.frame >= next || !clock.running || clock.released; });
+    return true;
+}
+
+/*!
+ * \brief Records the time since the updating thread last returned from sleep() as a frame.
+ */
+void Timer::recordFrame() {
+    const timepoint_d woke = highResClock::now();
+    mutexLock sleepLock(sleep_);
+    time_between_sleeps = std::chrono::duration_cast<duration_d>(woke - last_wake).count();
+    last_wake = woke;
+    frame_times.push_back(time_between_sleeps);
+    if (frame_times.size() > STATS_FRAMES)
+      frame_times.pop_front();
 }
 
 // Sleep the thread until the period has passed
 /*!
  * \brief Sleeps the Timer's current thread until its period elapses.
  * \details This function tells the currently executing thread to sleep until the rest of the Timer
- *   instance's remaining period expires.
+ *   instance's remaining period expires. The thread sleeps until shortly before then, and spins for the
+ *   rest (see setSpinTime()), so that it wakes on time rather than whenever the operating system gets to it.
  * \details If the Timer's period has elapsed since last call, the thread will continue execution
  *   normally until the next call to sleep().
- *   \param update Whether to update the timer's last_rep status or not.
- * \note This function does not guarantee the thread will resume immediately after the time expires.
- *   Depending on your OS, the thread may sleep for longer.
+ * \details How long the thread that updates the Timer sleeps depends on its PacingMode (see setPacing()).
+ *   On virtual time, no thread really sleeps (see setVirtual()).
+ *   \param update Whether to update the timer's last_rep status or not. Only one thread (the Canvas' rendering
+ *     thread) should update a Timer; the time between its calls is what getFrameStats() reports.
  * \see getTimeBetweenSleeps(), to get the actual elapsed time between sleeps.
  */
 void Timer::sleep(bool update) {
+    if (sleepVirtual(update)) {
+      if (update)
+        recordFrame();
+      return;
+    }
+
     mutexLock sleepLock(sleep_);
-    timepoint_d sleep_time = last_time;
-    while (sleep_time < highResClock::now()) {
-      sleep_time = sleep_time + period_;
+    const timepoint_d now = highResClock::now();
+    timepoint_d wake_time = now;
+    if (update && pacing == PACE_TIMER) {
+        // The first start of a period that is still to come, skipping any that were missed
+        wake_time = last_time + period_;
+        if (wake_time < now)
+            wake_time = last_time + period_ * (floor((now - last_time) / period_) + 1);
+    } else if (!update && pacing != PACE_UNCAPPED) {
+        // The first start of a period at or after now; the updating thread may already have moved last_time to it
+        if (last_time < now)
+            wake_time = last_time + period_ * ceil((now - last_time) / period_);
+        else
+            wake_time = last_time;
     }
+    if (update)
+      last_time = wake_time;
+    const timepoint_d spin_from = wake_time - spin_time;
     sleepLock.unlock();
 
-    if (update)
-      last_time = sleep_time;
+    const double coarse = std::chrono::duration_cast<duration_d>(spin_from - highResClock::now()).count();
+    if (coarse > 0)
+      std::this_thread::sleep_for(std::chrono::nanoseconds((long long) (coarse * 1000000000)));
+    while (highResClock::now() < wake_time)
+      std::this_thread::yield();
 
-    long double nano = std::chrono::duration_cast<duration_d>(sleep_time - highResClock::now()).count();
-    std::this_thread::sleep_for(std::chrono::nanoseconds((long long) (nano * 1000000000)));
+    if (update)
+      recordFrame();
+}
 
-    time_between_sleeps = std::chrono::duration_cast<duration_d>(highResClock::now() - sleep_time).count()
-        + period_.count();
+/*!
+ * \brief Counts a frame for the thread that updates the Timer, without sleeping or waiting.
+ * \details Call this in place of sleep() after each frame, which should only be started once getTimeToFrame()
+ *   has reached 0. The Timer moves on to the latest start of a period that has passed, as if sleep() had woken
+ *   for it, so a frame that was late does not make the next ones early. On virtual time, it moves the clock on a
+ *   frame and wakes the threads sleeping on it, but leaves waiting for them to getTimeToFrame().
+ */
+void Timer::tick() {
+    if (!sleepVirtual(true, false)) {
+        mutexLock sleepLock(sleep_);
+        const timepoint_d now = highResClock::now();
+        if (pacing == PACE_TIMER && now >= last_time + period_)
+            last_time += period_ * floor((now - last_time) / period_);
+        else if (pacing != PACE_TIMER)
+            last_time = now;
+    }
+    recordFrame();
 }
 
 // Sleep the thread for a specified duration
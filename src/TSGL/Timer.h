@@ -6,6 +6,8 @@
 #define TIMER_H_
 
 #include <chrono>        // For timing
+#include <deque>         // For the window of recent frame times
+#include <memory>        // For sharing the virtual clock with the threads sleeping on it
 #include <mutex>         // Needed for locking for thread-safety
 #include <thread>        // For sleeping
 #include <iostream>
@@ -16,20 +18,53 @@ typedef std::chrono::time_point<highResClock, duration_d> timepoint_d;
 
 namespace tsgl {
 
+/*!
+ * \brief How a Timer paces the thread that sleeps on it with <code>update</code> set (see Timer::sleep()).
+ */
+enum PacingMode {
+    PACE_TIMER,         //!< Sleep until the next period starts, then spin for the last moment to wake on time
+    PACE_VSYNC,         //!< Do not sleep; the buffer swap waits for the display's vertical refresh
+    PACE_UNCAPPED       //!< Do not sleep at all, as for benchmarks
+};
+
+/*!
+ * \brief Statistics of the time between recent frames, in seconds. See Timer::getFrameStats().
+ */
+struct FrameStats {
+    double mean;        //!< Average time between frames
+    double stddev;      //!< Standard deviation of the time between frames
+    double max;         //!< Longest time between frames
+    unsigned missed;    //!< Number of frames that took more than one and a half periods
+    unsigned frames;    //!< Number of frames the statistics are taken over
+};
+
+struct VirtualClock;    // The state of a Timer's virtual clock, defined in Timer.cpp
+
 /*! \class Timer
  *  \brief A class for various timing operations.
  *  \details Timer provides a simple timer for timing, sleeping threads, and keeping track of the
  *    current rendering frame.
+ *  \details A Timer can also run on virtual time (see setVirtual()), in which each frame takes exactly one
+ *    period, however long it really takes.
  */
 class Timer {
  private:
     typedef std::unique_lock<std::mutex> mutexLock;
 
+    static const unsigned STATS_FRAMES = 120;      // Number of recent frames getFrameStats() covers
+
     unsigned int last_rep;
     duration_d period_;
-    timepoint_d start_time, last_time;
+    duration_d spin_time;
+    timepoint_d start_time, last_time, last_wake;
     std::mutex sleep_;
     double time_between_sleeps;
+    PacingMode pacing;
+    std::deque<double> frame_times;
+    std::shared_ptr<VirtualClock> virtual_clock;
+
+    bool sleepVirtual(bool update, bool wait = true);
+    void recordFrame();
  public:
     Timer(double period);
 
@@ -41,12 +76,32 @@ class Timer {
 
     double getTimeBetweenSleeps() const;
 
+    double getTimeToFrame();
+
+    FrameStats getFrameStats();
+
+    PacingMode getPacing();
+
+    bool isVirtual() const;
+
+    void leave();
+
     bool pastPeriod();
 
+    void release();
+
     void reset(double period = 0);
 
+    void setPacing(PacingMode mode);
+
+    void setSpinTime(double seconds);
+
+    void setVirtual(bool on);
+
     void sleep(bool update = true);
 
+    void tick();
+
     static void threadSleepFor(double duration);    // Sleep the thread for a specified duration
 };
 
@@ -6,8 +6,10 @@
 #define SRC_TSGL_UTIL_H_
 
 #include <cmath>  //To determine M_PI and is also used for math operations
-#include <omp.h> //Used for multithreaded capabilities of saferand()
-#include <random> //Used to generate random numbers in saferand()
+#include <omp.h> //Used for multithreaded capabilities
+#include <random> //Kept for code that relies on it through this header
+
+#include "Random.h" //Per-thread random streams used by saferand() and randfloat()
 
 namespace tsgl {
 
@@ -147,29 +149,23 @@ inline bool fileExists (const std::string& name) {
  * Repeated calls will result in uniformly distributed random variables.
  * \param min Minimum integer value that can be generated by the method, inclusive.
  * \param max Maximum integer value that can be generated by the method, inclusive.
+ * \note Draws from the calling thread's Random::local() stream, so results are reproducible
+ *   once a seed has been set with Random::setSeed().
  * \note Thanks to Rani Hod of Tel Aviv University for this function. Modified by Ian Adams of Calvin University to add min, max.
  */
 inline int saferand(int min, int max)
 {
-    static std::mt19937* generator = nullptr;   
-    #pragma omp threadprivate(generator)
-    std::uniform_int_distribution<int> dis(min, max);
-    if (!generator) {
-        unsigned seed = clock() + omp_get_thread_num();
-        generator = new std::mt19937(seed);
-    }
-    int val = dis(*generator);
-    return val;
-    // return (*generator)();
+    return Random::local().uniformInt(min, max);
 }
 
  /*!
   * \brief Thread safe random float generator
   * \details Calculates a random float to return.
   * \param divisor Divisor used to calculate the random float.
+  * \note For bulk random data, Random::fillUniform() is considerably faster.
   */
 inline float randfloat(int divisor = 10000) { 
-    return (float) saferand(0, divisor) / divisor;
+    return Random::local().uniformInt(0, divisor) * (1.0f / divisor);
 }
 
 /*!
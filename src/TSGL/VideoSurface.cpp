@@ -0,0 +1,632 @@
+#include "VideoSurface.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <dirent.h>
+  #include <sys/stat.h>
+#endif
+
+#include <stb/stb_image.h>
+#include "Canvas.h"             // For timing playback against the Canvas
+
+namespace tsgl {
+
+static const int READ_AHEAD = 4;            // Frames decoded ahead of the one on screen
+static const unsigned PIXEL_BUFFERS = 3;    // Size of the ring of pixel buffer objects
+
+// Lists the image files in a directory, sorted by name
+static bool listImages(const std::string& directory, std::vector<std::string>& files) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+    do {
+        names.push_back(entry.cFileName);
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR * dir = opendir(directory.c_str());
+    if (!dir)
+        return false;
+    while (struct dirent * entry = readdir(dir))
+        names.push_back(entry->d_name);
+    closedir(dir);
+#endif
+    std::sort(names.begin(), names.end());
+    for (unsigned i = 0; i < names.size(); ++i) {
+        std::string extension = names[i].substr(names[i].find_last_of('.') + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp")
+            files.push_back(directory + "/" + names[i]);
+    }
+    return true;
+}
+
+// Converts one BT.601 (studio range) YUV pixel to RGBA
+static inline void yuvToRGBA(int y, int u, int v, uint8_t* rgba) {
+    const int c = 298 * (y - 16), d = u - 128, e = v - 128;
+    const int r = (c + 409 * e + 128) >> 8, g = (c - 100 * d - 208 * e + 128) >> 8, b = (c + 516 * d + 128) >> 8;
+    rgba[0] = (uint8_t) std::max(0, std::min(255, r));
+    rgba[1] = (uint8_t) std::max(0, std::min(255, g));
+    rgba[2] = (uint8_t) std::max(0, std::min(255, b));
+    rgba[3] = 255;
+}
+
+/*!
+ * \brief Constructs a VideoSurface with no source, for the public constructor and openRaw() to fill in.
+ */
+VideoSurface::VideoSurface(float x, float y, float z, float yaw, float pitch, float roll) : Drawable(x,y,z,yaw,pitch,roll) {
+    mySource = RAW_VIDEO;
+    myPixelWidth = myPixelHeight = myFrameCount = 0;
+    myChromaHalved = false;
+    myWidth = myHeight = 0;
+    myWantedFrame = 0;
+    myDecodeLooping = myStopping = false;
+    myCanvas = 0;
+    myFrameRate = 30;
+    myStartTime = 0;
+    myStartFrame = myCurrentFrame = 0;
+    myPlaying = myLooping = false;
+    myDroppedFrames = 0;
+    myTexture = 0;
+    myPixelBuffers[0] = myPixelBuffers[1] = myPixelBuffers[2] = 0;
+    myNextPixelBuffer = 0;
+    myShownFrame = -1;
+    vertices = 0;
+}
+
+ /*!
+  * \brief Explicitly constructs a new VideoSurface.
+  * \details This is the explicit constructor for the VideoSurface class.
+  *   \param x The x coordinate of the center of the VideoSurface.
+  *   \param y The y coordinate of the center of the VideoSurface.
+  *   \param z The z coordinate of the center of the VideoSurface.
+  *   \param source A .y4m file, or a directory of .png, .jpg or .bmp images.
+  *   \param width The width of the VideoSurface.
+  *   \param height The height of the VideoSurface.
+  *   \param yaw The yaw orientation of the VideoSurface.
+  *   \param pitch The pitch orientation of the VideoSurface.
+  *   \param roll The roll orientation of the VideoSurface.
+  *   \param alpha The alpha of the VideoSurface.
+  * \return A new VideoSurface, paused on its first frame. Image sequences play at 30 frames per second
+  *   unless setFrameRate() is called.
+  * \note If the source cannot be read, an error is printed and the VideoSurface draws nothing.
+  */
+VideoSurface::VideoSurface(float x, float y, float z, std::string source, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha)
+  : VideoSurface(x, y, z, yaw, pitch, roll) {
+    myFile = source;
+    bool opened;
+    std::string extension = source.substr(source.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == "y4m") {
+        mySource = Y4M_VIDEO;
+        opened = openY4M();
+    } else {
+        mySource = IMAGE_SEQUENCE;
+        opened = openSequence();
+    }
+    if (opened)
+        setup(width, height, alpha);
+}
+
+/*!
+ * \brief Creates a VideoSurface that plays a raw file of RGBA8 frames.
+ * \details Raw files have no header: every <code>4 * pixelWidth * pixelHeight</code> bytes is one frame, with
+ *   row 0 at the top, as written by <code>ffmpeg -i in.mp4 -f rawvideo -pix_fmt rgba out.rgba</code>
+ *   or by saving the pixels of a Canvas frame after frame.
+ *   \param x The x coordinate of the center of the VideoSurface.
+ *   \param y The y coordinate of the center of the VideoSurface.
+ *   \param z The z coordinate of the center of the VideoSurface.
+ *   \param filename The raw file.
+ *   \param pixelWidth The width of a frame in pixels.
+ *   \param pixelHeight The height of a frame in pixels.
+ *   \param frameRate The number of frames to play per second.
+ *   \param width The width of the VideoSurface.
+ *   \param height The height of the VideoSurface.
+ *   \param yaw The yaw orientation of the VideoSurface.
+ *   \param pitch The pitch orientation of the VideoSurface.
+ *   \param roll The roll orientation of the VideoSurface.
+ *   \param alpha The alpha of the VideoSurface.
+ * \return A new VideoSurface, paused on its first frame, to be deleted by the caller.
+ */
+VideoSurface * VideoSurface::openRaw(float x, float y, float z, std::string filename, int pixelWidth, int pixelHeight, double frameRate,
+                                     GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha) {
+    VideoSurface * video = new VideoSurface(x, y, z, yaw, pitch, roll);
+    video->myFile = filename;
+    video->mySource = RAW_VIDEO;
+    if (pixelWidth <= 0 || pixelHeight <= 0) {
+        TsglDebug("Cannot have a video with frame width or height less than or equal to 0.");
+        return video;
+    }
+    if (!video->myMap.open(filename))
+        return video;
+    const size_t frameBytes = (size_t) pixelWidth * pixelHeight * 4;
+    video->myPixelWidth = pixelWidth;
+    video->myPixelHeight = pixelHeight;
+    video->myFrameCount = video->myMap.size() / frameBytes;
+    for (int i = 0; i < video->myFrameCount; ++i)
+        video->myFrameOffsets.push_back(i * frameBytes);
+    if (video->myFrameCount == 0) {
+        TsglErr(filename + " is smaller than one frame.");
+        return video;
+    }
+    video->setFrameRate(frameRate);
+    video->setup(width, height, alpha);
+    return video;
+}
+
+/*!
+ * \brief Finishes constructing a VideoSurface whose source has been opened, and starts its decoding thread.
+ */
+void VideoSurface::setup(GLfloat width, GLfloat height, float alpha) {
+    if (width <= 0 || height <= 0) {
+        TsglDebug("Cannot have a VideoSurface with width or height less than or equal to 0.");
+        return;
+    }
+    if (alpha < 0.0 || alpha > 1.0) {
+        TsglDebug("Cannot have a VideoSurface with alpha not between 0.0 and 1.0.");
+        return;
+    }
+    attribMutex.lock();
+    shaderType = TEXTURE_SHADER_TYPE;
+    myWidth = width; myHeight = height;
+    myXScale = width; myYScale = height; myZScale = 1;
+    myAlpha = alpha;
+
+    // positions (x,y,z)    texture coords, with row 0 of the texture at the top
+    const GLfloat quad[30] = {
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, // top right
+         0.5f, -0.5f, 0.0f,   1.0f, 1.0f, // bottom right
+        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f, // bottom left
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, // top right
+        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f, // bottom left
+        -0.5f,  0.5f, 0.0f,   0.0f, 0.0f  // top left
+    };
+    vertices = new GLfloat[30];
+    memcpy(vertices, quad, sizeof(quad));
+
+    myFrames.resize(READ_AHEAD);
+    for (int i = 0; i < READ_AHEAD; ++i) {
+        myFrames[i].index = -1;
+        myFrames[i].pixels.resize((size_t) myPixelWidth * myPixelHeight * 4);
+    }
+    myDecoder = std::thread(&VideoSurface::decodeLoop, this);
+    init = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Maps a .y4m file and finds where each of its frames starts.
+ * \return Whether the file is a YUV4MPEG2 file this class can play.
+ */
+bool VideoSurface::openY4M() {
+    if (!myMap.open(myFile))
+        return false;
+    const char * data = (const char *) myMap.data();
+    const size_t size = myMap.size();
+    const char * headerEnd = (const char *) memchr(data, '\n', size);
+    if (size < 10 || memcmp(data, "YUV4MPEG2 ", 10) != 0 || !headerEnd) {
+        TsglErr(myFile + " is not a YUV4MPEG2 file.");
+        return false;
+    }
+
+    // Header parameters are separated by spaces, each a letter followed by its value
+    std::string chroma = "420jpeg";
+    std::string header(data + 10, headerEnd);
+    size_t start = 0;
+    while (start < header.size()) {
+        size_t end = header.find(' ', start);
+        if (end == std::string::npos)
+            end = header.size();
+        const std::string param = header.substr(start, end - start);
+        if (!param.empty()) {
+            if (param[0] == 'W') {
+                myPixelWidth = atoi(param.c_str() + 1);
+            } else if (param[0] == 'H') {
+                myPixelHeight = atoi(param.c_str() + 1);
+            } else if (param[0] == 'C') {
+                chroma = param.substr(1);
+            } else if (param[0] == 'F') {
+                const int numerator = atoi(param.c_str() + 1);
+                const size_t colon = param.find(':');
+                const int denominator = (colon == std::string::npos) ? 1 : atoi(param.c_str() + colon + 1);
+                if (numerator > 0 && denominator > 0)
+                    myFrameRate = (double) numerator / denominator;
+            }
+        }
+        start = end + 1;
+    }
+    if (chroma.compare(0, 3, "420") == 0) {
+        myChromaHalved = true;
+    } else if (chroma == "444") {
+        myChromaHalved = false;
+    } else {
+        TsglErr(myFile + " has " + chroma + " chroma; only 4:2:0 and 4:4:4 can be played.");
+        return false;
+    }
+    if (myPixelWidth <= 0 || myPixelHeight <= 0) {
+        TsglErr(myFile + " has no frame size.");
+        return false;
+    }
+
+    // Each frame is "FRAME", optional parameters and a newline, then the Y, U and V planes
+    const size_t chromaBytes = myChromaHalved ? (size_t) ((myPixelWidth + 1) / 2) * ((myPixelHeight + 1) / 2)
+                                              : (size_t) myPixelWidth * myPixelHeight;
+    const size_t frameBytes = (size_t) myPixelWidth * myPixelHeight + 2 * chromaBytes;
+    size_t offset = headerEnd - data + 1;
+    while (offset + 5 < size && memcmp(data + offset, "FRAME", 5) == 0) {
+        const char * lineEnd = (const char *) memchr(data + offset, '\n', size - offset);
+        if (!lineEnd)
+            break;
+        offset = lineEnd - data + 1;
+        if (offset + frameBytes > size)
+            break;
+        myFrameOffsets.push_back(offset);
+        offset += frameBytes;
+    }
+    myFrameCount = myFrameOffsets.size();
+    if (myFrameCount == 0) {
+        TsglErr(myFile + " has no complete frames.");
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Lists the images of an image sequence and reads the size of the first one.
+ * \return Whether the directory holds any images.
+ */
+bool VideoSurface::openSequence() {
+    if (!listImages(myFile, myFrameFiles)) {
+        TsglErr("Could not read the directory " + myFile + ".");
+        return false;
+    }
+    if (myFrameFiles.empty() || !stbi_info(myFrameFiles[0].c_str(), &myPixelWidth, &myPixelHeight, 0)) {
+        TsglErr(myFile + " holds no images that can be read.");
+        return false;
+    }
+    myFrameCount = myFrameFiles.size();
+    return true;
+}
+
+/*!
+ * \brief Decodes one frame into an RGBA8 buffer with row 0 at the top. Called by the decoding thread.
+ */
+void VideoSurface::decode(int frame, uint8_t* rgba) {
+    const int w = myPixelWidth, h = myPixelHeight;
+    if (mySource == RAW_VIDEO) {
+        memcpy(rgba, myMap.data() + myFrameOffsets[frame], (size_t) w * h * 4);
+    } else if (mySource == Y4M_VIDEO) {
+        const uint8_t * yPlane = myMap.data() + myFrameOffsets[frame];
+        const int cw = myChromaHalved ? (w + 1) / 2 : w, ch = myChromaHalved ? (h + 1) / 2 : h;
+        const uint8_t * uPlane = yPlane + (size_t) w * h;
+        const uint8_t * vPlane = uPlane + (size_t) cw * ch;
+        const int shift = myChromaHalved ? 1 : 0;
+        for (int row = 0; row < h; ++row) {
+            const uint8_t * ys = yPlane + (size_t) row * w;
+            const uint8_t * us = uPlane + (size_t) (row >> shift) * cw;
+            const uint8_t * vs = vPlane + (size_t) (row >> shift) * cw;
+            uint8_t * out = rgba + (size_t) row * w * 4;
+            for (int col = 0; col < w; ++col)
+                yuvToRGBA(ys[col], us[col >> shift], vs[col >> shift], out + col * 4);
+        }
+    } else {
+        int fw = 0, fh = 0;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char * pixels = stbi_load(myFrameFiles[frame].c_str(), &fw, &fh, 0, 4);
+        if (!pixels || fw != w || fh != h) {
+            TsglErr("Could not load " + myFrameFiles[frame] + " as a " + to_string(w) + "x" + to_string(h) + " frame.");
+            memset(rgba, 0, (size_t) w * h * 4);
+        } else {
+            for (int row = 0; row < h; ++row)   // stb_image's rows run from the bottom up
+                memcpy(rgba + (size_t) row * w * 4, pixels + (size_t) (h - 1 - row) * w * 4, (size_t) w * 4);
+        }
+        if (pixels)
+            stbi_image_free(pixels);
+    }
+}
+
+/*!
+ * \brief Body of the decoding thread: keeps the READ_AHEAD frames from the wanted frame on decoded.
+ * \details Each free slot is filled with the earliest frame of that window that is not decoded yet, so when
+ *   playback jumps ahead, the decoder starts over at the new position rather than finishing stale frames.
+ */
+void VideoSurface::decodeLoop() {
+    std::unique_lock<std::mutex> lock(frameMutex);
+    while (!myStopping) {
+        const int wanted = myWantedFrame;
+        int target = -1;
+        for (int k = 0; k < READ_AHEAD && target < 0; ++k) {
+            int frame = wanted + k;
+            if (frame >= myFrameCount) {
+                if (!myDecodeLooping)
+                    break;
+                frame %= myFrameCount;
+            }
+            bool held = false;
+            for (int i = 0; i < READ_AHEAD; ++i)
+                held = held || myFrames[i].index == frame;
+            if (!held)
+                target = frame;
+        }
+        // Reuse a slot holding a frame that is not wanted any more
+        int slot = -1;
+        for (int i = 0; i < READ_AHEAD && target >= 0 && slot < 0; ++i) {
+            const int behind = framesBehind(myFrames[i].index, wanted, myDecodeLooping);
+            if (myFrames[i].index < 0 || behind > 0 || behind < -READ_AHEAD)
+                slot = i;
+        }
+        if (slot < 0) {
+            frameWanted.wait(lock);
+            continue;
+        }
+        myFrames[slot].index = -1;
+        lock.unlock();
+        decode(target, &myFrames[slot].pixels[0]);
+        lock.lock();
+        myFrames[slot].index = target;
+    }
+}
+
+/*!
+ * \brief Counts how many frames one frame comes before another in playback order.
+ * \details Negative when <code>frame</code> comes after <code>current</code>. When looping, frames in the
+ *   first half of the video after <code>current</code> count as ahead of it, and the rest as behind it.
+ */
+int VideoSurface::framesBehind(int frame, int current, bool looping) {
+    int behind = current - frame;
+    if (looping && myFrameCount > 0) {
+        behind = ((behind % myFrameCount) + myFrameCount) % myFrameCount;
+        if (behind > myFrameCount / 2)
+            behind -= myFrameCount;
+    }
+    return behind;
+}
+
+/*!
+ * \brief Copies a frame into the next pixel buffer of the ring and has the GPU copy it into the texture.
+ */
+void VideoSurface::upload(const uint8_t* rgba) {
+    const size_t bytes = (size_t) myPixelWidth * myPixelHeight * 4;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myPixelBuffers[myNextPixelBuffer]);
+    myNextPixelBuffer = (myNextPixelBuffer + 1) % PIXEL_BUFFERS;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);   // Orphan the buffer's old contents
+    void * mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (mapped) {
+        memcpy(mapped, rgba, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindTexture(GL_TEXTURE_2D, myTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, myPixelWidth, myPixelHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+ /*!
+  * \brief Draw the VideoSurface.
+  * \details This function actually draws the VideoSurface to the Canvas.
+  * \details Works out which frame is due from the Canvas' clock, then shows the latest decoded frame that is
+  *   not past it. Frames between the one shown before and the one shown now are counted as dropped.
+  *   \param shader The Canvas' texture shader.
+  */
+void VideoSurface::draw(Shader * shader) {
+    if (!init) {
+        TsglDebug("Vertex buffer is not full.");
+        return;
+    }
+    if (!myTexture) {
+        glGenTextures(1, &myTexture);
+        glBindTexture(GL_TEXTURE_2D, myTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, myPixelWidth, myPixelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glGenBuffers(PIXEL_BUFFERS, myPixelBuffers);
+    }
+
+    // Find the frame that is due
+    attribMutex.lock();
+    int current = myCurrentFrame;
+    if (myPlaying && myCanvas) {
+        current = myStartFrame + (int) floor((myCanvas->getTime() - myStartTime) * myFrameRate);
+        if (current >= myFrameCount) {
+            if (myLooping) {
+                current %= myFrameCount;
+            } else {
+                current = myFrameCount - 1;
+                myPlaying = false;
+            }
+        }
+        myCurrentFrame = current;
+    }
+    const bool looping = myLooping;
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(myRotationPointX, myRotationPointY, myRotationPointZ));
+    model = glm::rotate(model, glm::radians(myCurrentYaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::rotate(model, glm::radians(myCurrentPitch), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(myCurrentRoll), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::translate(model, glm::vec3(myCenterX - myRotationPointX, myCenterY - myRotationPointY, myCenterZ - myRotationPointZ));
+    model = glm::scale(model, glm::vec3(myXScale, myYScale, myZScale));
+    const float alpha = myAlpha;
+    attribMutex.unlock();
+
+    // Show the newest decoded frame that is not past it, and point the decoder at what comes next
+    frameMutex.lock();
+    if (myWantedFrame != current || myDecodeLooping != looping) {
+        myWantedFrame = current;
+        myDecodeLooping = looping;
+        frameWanted.notify_one();
+    }
+    int best = -1, bestBehind = 0;
+    const int shownBehind = (myShownFrame < 0) ? myFrameCount : framesBehind(myShownFrame, current, looping);
+    for (int i = 0; i < READ_AHEAD; ++i) {
+        if (myFrames[i].index < 0)
+            continue;
+        const int behind = framesBehind(myFrames[i].index, current, looping);
+        if (behind >= 0 && behind < shownBehind && (best < 0 || behind < bestBehind)) {
+            best = i;
+            bestBehind = behind;
+        }
+    }
+    if (best >= 0) {
+        upload(&myFrames[best].pixels[0]);
+        if (myShownFrame >= 0) {
+            attribMutex.lock();
+            myDroppedFrames += shownBehind - bestBehind - 1;
+            attribMutex.unlock();
+        }
+        myShownFrame = myFrames[best].index;
+        frameWanted.notify_one();       // Its slot can be refilled once it falls behind
+    }
+    frameMutex.unlock();
+
+    glUniformMatrix4fv(glGetUniformLocation(shader->ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniform1f(glGetUniformLocation(shader->ID, "alpha"), alpha);
+    glBindTexture(GL_TEXTURE_2D, myTexture);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 5, vertices, GL_DYNAMIC_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+/*!
+ * \brief Starts or resumes playback from the current frame.
+ * \details From now on, the frame shown follows the Canvas' clock (Canvas::getTime()), so playback keeps
+ *   time however often the Canvas draws.
+ *   \param can The Canvas the VideoSurface is drawn on.
+ */
+void VideoSurface::play(Canvas& can) {
+    attribMutex.lock();
+    myCanvas = &can;
+    myStartTime = can.getTime();
+    myStartFrame = myCurrentFrame;
+    myPlaying = true;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Stops playback on the current frame.
+ */
+void VideoSurface::pause() {
+    attribMutex.lock();
+    myPlaying = false;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Jumps to a frame, without changing whether the video is playing.
+ *   \param frame The frame to jump to, from 0 to getFrameCount() - 1.
+ */
+void VideoSurface::seek(int frame) {
+    if (frame < 0 || frame >= myFrameCount) {
+        TsglDebug("Cannot seek to a frame outside of the video.");
+        return;
+    }
+    attribMutex.lock();
+    myCurrentFrame = myStartFrame = frame;
+    if (myCanvas)
+        myStartTime = myCanvas->getTime();
+    attribMutex.unlock();
+    frameMutex.lock();
+    myShownFrame = -1;                  // So that the frame is shown even if it is behind the last one
+    frameMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for whether playback starts over after the last frame, or stops on it.
+ *   \param looping Whether to loop (false by default).
+ */
+void VideoSurface::setLooping(bool looping) {
+    attribMutex.lock();
+    myLooping = looping;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Mutator for the number of frames played per second.
+ *   \param frameRate The new frame rate.
+ */
+void VideoSurface::setFrameRate(double frameRate) {
+    if (frameRate <= 0) {
+        TsglDebug("Cannot have a frame rate less than or equal to 0.");
+        return;
+    }
+    attribMutex.lock();
+    if (myCanvas) {                     // Carry on from the current frame at the new rate
+        myStartTime = myCanvas->getTime();
+        myStartFrame = myCurrentFrame;
+    }
+    myFrameRate = frameRate;
+    attribMutex.unlock();
+}
+
+/**
+ *  \brief Alters the VideoSurface's transparency.
+ *  \param alpha The VideoSurface's new alpha value.
+ *  \note If parameter not 0.0 <= alpha <= 1.0 then this method will have no effect.
+ */
+void VideoSurface::setAlpha(float alpha) {
+    if (alpha < 0.0 || alpha > 1.0) {
+        TsglDebug("Cannot have a VideoSurface with alpha not 0.0 <= alpha <= 1.0.");
+        return;
+    }
+    attribMutex.lock();
+    myAlpha = alpha;
+    attribMutex.unlock();
+}
+
+/*!
+ * \brief Accessor for the frame that is due, as of the last draw.
+ */
+int VideoSurface::getFrame() {
+    attribMutex.lock();
+    int frame = myCurrentFrame;
+    attribMutex.unlock();
+    return frame;
+}
+
+/*!
+ * \brief Accessor for the number of frames skipped so far because they were not decoded or drawn in time.
+ */
+unsigned VideoSurface::getDroppedFrames() {
+    attribMutex.lock();
+    unsigned dropped = myDroppedFrames;
+    attribMutex.unlock();
+    return dropped;
+}
+
+/*!
+ * \brief Accessor for whether the video is playing.
+ * \details A video that does not loop stops playing on its last frame.
+ */
+bool VideoSurface::isPlaying() {
+    attribMutex.lock();
+    bool playing = myPlaying;
+    attribMutex.unlock();
+    return playing;
+}
+
+/*!
+ * \brief Destroys the VideoSurface, stopping its decoding thread and freeing its texture and buffers.
+ */
+VideoSurface::~VideoSurface() {
+    frameMutex.lock();
+    myStopping = true;
+    frameMutex.unlock();
+    frameWanted.notify_all();
+    if (myDecoder.joinable())
+        myDecoder.join();
+    if (myTexture) {
+        glDeleteTextures(1, &myTexture);
+        glDeleteBuffers(PIXEL_BUFFERS, myPixelBuffers);
+    }
+}
+
+}
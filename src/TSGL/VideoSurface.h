@@ -0,0 +1,146 @@
+/*
+ * VideoSurface.h extends Drawable and provides a class for playing pre-rendered frames on a Canvas.
+ */
+
+#ifndef VIDEOSURFACE_H_
+#define VIDEOSURFACE_H_
+
+#include <condition_variable>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Drawable.h"           // For extending our Drawable object
+#include "MappedFile.h"         // For reading video files
+
+namespace tsgl {
+
+class Canvas;
+
+/*! \class VideoSurface
+ *  \brief Play a video or a sequence of images on the Canvas.
+ *  \details VideoSurface draws a rectangle whose texture is replaced by the frames of a video as it plays.
+ *   It reads three kinds of source:
+ *   - A YUV4MPEG2 (<code>.y4m</code>) file, with 4:2:0 or 4:4:4 chroma, as written by
+ *     <code>ffmpeg -i in.mp4 out.y4m</code>. The frame rate is read from the file.
+ *   - A directory of .png, .jpg or .bmp images of the same size, played in order of file name.
+ *   - A raw file of RGBA8 frames, one after the other with row 0 at the top, opened with openRaw().
+ *   .
+ *  \details Video files are memory-mapped. A background thread decodes the next few frames ahead of the one
+ *   on screen, so the thread rendering the Canvas only has to copy a finished frame into a pixel buffer
+ *   object, from which the GPU uploads it without stalling the draw. A ring of pixel buffer objects lets one
+ *   upload proceed while the next is being filled.
+ *  \details Playback is timed against the Canvas' clock (see play()), not counted in draws: if frames cannot be
+ *   decoded or drawn fast enough, frames are skipped so that the video keeps time (see getDroppedFrames()).
+ *  \details Row 0 of a frame is the top of the rectangle.
+ */
+class VideoSurface : public Drawable {
+ private:
+    enum SourceType { RAW_VIDEO, Y4M_VIDEO, IMAGE_SEQUENCE };
+
+    struct Frame {
+        int index;                      // The frame held, or -1 if none (or while it is being decoded)
+        std::vector<uint8_t> pixels;
+    };
+
+    SourceType mySource;
+    std::string myFile;
+    MappedFile myMap;
+    std::vector<size_t> myFrameOffsets;         // Where each frame's pixels start in a video file
+    std::vector<std::string> myFrameFiles;      // The images of an image sequence
+    int myPixelWidth, myPixelHeight, myFrameCount;
+    bool myChromaHalved;                        // Whether a .y4m file has 4:2:0 rather than 4:4:4 chroma
+    GLfloat myWidth, myHeight;
+
+    // Decoding thread, protected by frameMutex
+    std::thread myDecoder;
+    std::mutex frameMutex;
+    std::condition_variable frameWanted;
+    std::vector<Frame> myFrames;
+    int myWantedFrame;                          // The decoder keeps the frames from here on ready
+    bool myDecodeLooping, myStopping;
+
+    // Playback, protected by attribMutex
+    Canvas * myCanvas;
+    double myFrameRate, myStartTime;
+    int myStartFrame, myCurrentFrame;
+    bool myPlaying, myLooping;
+    unsigned myDroppedFrames;
+
+    // Used only by the rendering thread
+    GLuint myTexture;
+    GLuint myPixelBuffers[3];
+    unsigned myNextPixelBuffer;
+    int myShownFrame;
+
+    VideoSurface(float x, float y, float z, float yaw, float pitch, float roll);
+    void setup(GLfloat width, GLfloat height, float alpha);
+    bool openY4M();
+    bool openSequence();
+    int framesBehind(int frame, int current, bool looping);
+    void decode(int frame, uint8_t* rgba);
+    void decodeLoop();
+    void upload(const uint8_t* rgba);
+ public:
+    VideoSurface(float x, float y, float z, std::string source, GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha = 1.0f);
+
+    static VideoSurface * openRaw(float x, float y, float z, std::string filename, int pixelWidth, int pixelHeight, double frameRate,
+                                  GLfloat width, GLfloat height, float yaw, float pitch, float roll, float alpha = 1.0f);
+
+    virtual void draw(Shader * shader);
+
+    void play(Canvas& can);
+
+    void pause();
+
+    void seek(int frame);
+
+    void setLooping(bool looping);
+
+    void setFrameRate(double frameRate);
+
+    void setAlpha(float alpha);
+
+    int getFrame();
+
+    unsigned getDroppedFrames();
+
+    bool isPlaying();
+
+    /*!
+     * \brief Accessor for the number of frames in the video.
+     */
+    int getFrameCount() { return myFrameCount; }
+
+    /*!
+     * \brief Accessor for the number of frames played per second.
+     */
+    double getFrameRate() { return myFrameRate; }
+
+    /*!
+     * \brief Accessor for the width of a frame in pixels.
+     */
+    int getPixelWidth() { return myPixelWidth; }
+
+    /*!
+     * \brief Accessor for the height of a frame in pixels.
+     */
+    int getPixelHeight() { return myPixelHeight; }
+
+    /*!
+     * \brief Accessor for the VideoSurface's width.
+     */
+    GLfloat getWidth() { return myWidth; }
+
+    /*!
+     * \brief Accessor for the VideoSurface's height.
+     */
+    GLfloat getHeight() { return myHeight; }
+
+    virtual ~VideoSurface();
+};
+
+}
+
+#endif /* VIDEOSURFACE_H_ */
@@ -1,10 +1,10 @@
 /*
  * testBallroom.cpp
  *
- * Usage: ./testBallroom <width> <height>
+ * Usage: ./testBallroom <width> <height> <numBalls>
  */
 
-#include <list>
+#include <vector>
 #include <cmath>
 #include <tsgl.h>
 
@@ -180,30 +180,46 @@ public:
 
 class BallRoom {
 private:
+  static const unsigned MAX_UNGRIDDED = 256;   // Balls that may be added before the grid is rebuilt
   int width, height;
   float friction, gravity;
   bool attract;
-  std::list<BouncingBall*> balls;
-  std::list<BouncingBall*>::const_iterator it, jt;
+  int maxRad;
+  std::vector<BouncingBall*> balls;
+  std::vector<float> ballX, ballY;
+  SpatialGrid grid;                            // Positions of the first griddedBalls balls
+  unsigned griddedBalls;
   Circle * mouseCircle;
   Canvas * can;
+
+  void rebuildGrid() {
+    ballX.resize(balls.size());
+    ballY.resize(balls.size());
+    #pragma omp parallel for
+    for (unsigned i = 0; i < balls.size(); ++i) {
+      ballX[i] = balls[i]->pos.x;
+      ballY[i] = balls[i]->pos.y;
+    }
+    grid.build(balls.size(), ballX.data(), ballY.data());
+    griddedBalls = balls.size();
+  }
 public:
-  BallRoom(int w, int h, Canvas * canvas) {
+  BallRoom(int w, int h, Canvas * canvas) : grid(-w/2, -h/2, w/2, h/2, 20) {
     width = w;
     height = h;
     friction = 0.99f;
     gravity = 0.1f;
     attract = true;
+    maxRad = 0;
+    griddedBalls = 0;
     can = canvas;
     mouseCircle = new Circle(0,0,0,20,0,0,0,ColorFloat(1.0,0.5,0.5,0.5));
     can->add(mouseCircle);
   }
   ~BallRoom() {
-    while (!balls.empty()) {
-      BouncingBall* b = balls.front();
-      balls.pop_front();
-      delete b;
-    }
+    for (unsigned i = 0; i < balls.size(); ++i)
+      delete balls[i];
+    balls.clear();
     delete mouseCircle;
   }
   void addBall(int x, int y, int r,  ColorFloat c = WHITE) {
@@ -211,18 +227,21 @@ public:
   }
   void addBall(int x, int y, int vx, int vy, int r, ColorFloat c = WHITE) {
     BouncingBall* b = new BouncingBall(x,y,vx,vy,r,width,height,c, can);
-    const int MAXFAIL = 1000;
-    int fails = 0;
-    for (it = balls.begin(); it != balls.end(); ++it) {
-      while (b->collides((*it))) {
-        ++fails;
-        if (fails == MAXFAIL) {
-          delete b;
-          return;
-        }
-      }
+    // Discard the ball if it lands on top of another one
+    if (balls.size() - griddedBalls > MAX_UNGRIDDED)
+      rebuildGrid();
+    bool collides = grid.anyWithin(b->pos.x, b->pos.y, r + maxRad, [&](unsigned j) -> bool {
+      return b->collides(balls[j]);
+    });
+    for (unsigned j = griddedBalls; j < balls.size() && !collides; ++j)
+      collides = b->collides(balls[j]);
+    if (collides) {
+      delete b;
+      return;
     }
     balls.push_back(b);
+    if (r > maxRad)
+      maxRad = r;
   }
   void step(Canvas* c) {
     int mx = c->getMouseX(), my = c->getMouseY();
@@ -233,8 +252,8 @@ public:
     } else {
       mouseCircle->setColor(ColorFloat(1.0,0.5,0.5,0.5));
     }
-    for (it = balls.begin(); it != balls.end(); ++it) {
-      BouncingBall *b = (*it);
+    for (unsigned i = 0; i < balls.size(); ++i) {
+      BouncingBall *b = balls[i];
 
       float mdir;
       if (attract)
@@ -245,13 +264,16 @@ public:
       b->vel *= friction;
 
       b->step();
-      for (jt = balls.begin(); jt != balls.end(); ++jt) {
-        if (jt == it)
-          continue;
-        b->bounce(*jt);
-        if (b->bounced)
-          break;
-      }
+    }
+    // Only balls in nearby cells of the grid can be touching
+    rebuildGrid();
+    for (unsigned i = 0; i < balls.size(); ++i) {
+      BouncingBall *b = balls[i];
+      grid.anyWithin(b->pos.x, b->pos.y, b->rad + maxRad, [&](unsigned j) -> bool {
+        if (j != i)
+          b->bounce(balls[j]);
+        return b->bounced;
+      });
     }
     c->pauseDrawing();
     c->resumeDrawing();
@@ -267,7 +289,7 @@ public:
  * - It is drawn in this way:
  * - Get the window width and height for convenience of use.
  * - Create the area for the balls based off of the window width and height.
- * - For each ball:
+ * - For each of the \b numBalls balls:
  *   - Set its speed to 5.
  *   - Randomize its initial direction.
  *   - Add it to the area created with the calculated speed and direction as well as with a random color.
@@ -277,16 +299,19 @@ public:
  *   to the mouse).
  * - While the Canvas is open:
  *   - Sleep the internal timer until the next draw cycle.
- *   - Animate the balls and have them bounce off of one another.
+ *   - Animate the balls.
+ *   - Sort the balls into a SpatialGrid, and have each one bounce off of the first ball it touches in a
+ *     nearby cell, rather than checking it against every other ball.
  *   .
  * .
  * \param can Reference to the Canvas to draw on.
+ * \param numBalls Number of balls to try to add.
  */
-void ballroomFunction(Canvas& can) {
+void ballroomFunction(Canvas& can, int numBalls) {
     const int WW = can.getWindowWidth(),    // Window width
               WH = can.getWindowHeight();   // Window height
     BallRoom b(WW,WH, &can);
-    for (int i = 0; i < 100; ++ i) {
+    for (int i = 0; i < numBalls; ++ i) {
       float speed = 5.0f;
       float dir  = 2 * PI * saferand(0,100) / 100.0f;
       ColorInt c = ColorInt(64 + saferand(0,191),64 + saferand(0,191),64 + saferand(0,191),255);
@@ -310,6 +335,9 @@ int main(int argc, char* argv[]) {
     int h = (argc > 2) ? atoi(argv[2]) : w;
     if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
       w = h = 960;            //If not, set the width and height to a default value
+    int n = (argc > 3) ? atoi(argv[3]) : 100;
+    if (n <= 0)
+      n = 100;
     Canvas c(-1, -1, w, h, "The Ballroom", BLACK);
-    c.run(ballroomFunction);
+    c.run(ballroomFunction, n);
 }
@@ -0,0 +1,199 @@
+/*
+ * BitLife.cpp
+ */
+
+#include "BitLife.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tsgl.h>
+
+using namespace tsgl;
+
+// Sums three one-bit-per-cell words: sum holds the ones bit of each cell's count, carry the twos bit.
+static inline void add3(uint64_t x, uint64_t y, uint64_t z, uint64_t& sum, uint64_t& carry) {
+  uint64_t t = x ^ y;
+  sum = t ^ z;
+  carry = (x & y) | (t & z);
+}
+
+BitLife::BitLife(int w, int h) {
+  wordsPerRow = (w + 63) / 64;
+  width = wordsPerRow * 64;
+  height = h;
+  tileRows = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+  tileCols = (wordsPerRow + TILE_WORDS - 1) / TILE_WORDS;
+  current = new uint64_t[wordsPerRow * height]();
+  next = new uint64_t[wordsPerRow * height]();
+  changed = new unsigned char[tileRows * tileCols];
+  nextChanged = new unsigned char[tileRows * tileCols];
+  memset(changed, 1, tileRows * tileCols);
+  memset(nextChanged, 1, tileRows * tileCols);
+  tiling = true;
+  generation = 0;
+}
+
+BitLife::~BitLife() {
+  delete[] current;
+  delete[] next;
+  delete[] changed;
+  delete[] nextChanged;
+}
+
+bool BitLife::getCell(int x, int y) const {
+  x = ((x % width) + width) % width;
+  y = ((y % height) + height) % height;
+  return (current[y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void BitLife::setCell(int x, int y, bool alive) {
+  x = ((x % width) + width) % width;
+  y = ((y % height) + height) % height;
+  uint64_t& word = current[y * wordsPerRow + (x >> 6)];
+  uint64_t bit = 1ull << (x & 63);
+  word = alive ? (word | bit) : (word & ~bit);
+  changed[(y / TILE_HEIGHT) * tileCols + (x >> 6) / TILE_WORDS] = 1;
+}
+
+void BitLife::clear() {
+  memset(current, 0, sizeof(uint64_t) * wordsPerRow * height);
+  memset(changed, 1, tileRows * tileCols);
+}
+
+void BitLife::randomize(float density) {
+  #pragma omp parallel for
+  for (int row = 0; row < height; ++row) {
+    Random rng = Random::forStream(row);
+    for (int i = 0; i < wordsPerRow; ++i) {
+      uint64_t word = 0;
+      for (int bit = 0; bit < 64; ++bit)
+        if (rng.uniformFloat() < density)
+          word |= 1ull << bit;
+      current[row * wordsPerRow + i] = word;
+    }
+  }
+  memset(changed, 1, tileRows * tileCols);
+}
+
+void BitLife::addGliderGun(int x, int y) {
+  // Rows of the Gosper glider gun, as column offsets from the gun's left edge
+  static const int ROWS[][9] = {
+    { 24, -1 },
+    { 22, 24, -1 },
+    { 12, 13, 20, 21, 34, 35, -1 },
+    { 11, 15, 20, 21, 34, 35, -1 },
+    { 0, 1, 10, 16, 20, 21, -1 },
+    { 0, 1, 10, 14, 16, 17, 22, 24, -1 },
+    { 10, 16, 24, -1 },
+    { 11, 15, -1 },
+    { 12, 13, -1 }
+  };
+  for (int row = 0; row < 9; ++row)
+    for (int i = 0; ROWS[row][i] >= 0; ++i)
+      setCell(x + ROWS[row][i], y + row, true);
+}
+
+void BitLife::setTiling(bool b) {
+  tiling = b;
+  memset(changed, 1, tileRows * tileCols);
+}
+
+bool BitLife::neighborhoodChanged(int tr, int tc) const {
+  for (int dr = -1; dr <= 1; ++dr) {
+    int r = (tr + dr + tileRows) % tileRows;
+    for (int dc = -1; dc <= 1; ++dc) {
+      int c = (tc + dc + tileCols) % tileCols;
+      if (changed[r * tileCols + c])
+        return true;
+    }
+  }
+  return false;
+}
+
+bool BitLife::updateTile(int tr, int tc) {
+  const int r0 = tr * TILE_HEIGHT, r1 = std::min(height, r0 + TILE_HEIGHT);
+  const int w0 = tc * TILE_WORDS, w1 = std::min(wordsPerRow, w0 + TILE_WORDS);
+  uint64_t diff = 0;
+  for (int r = r0; r < r1; ++r) {
+    const uint64_t* up = current + ((r + height - 1) % height) * wordsPerRow;
+    const uint64_t* mid = current + r * wordsPerRow;
+    const uint64_t* down = current + ((r + 1) % height) * wordsPerRow;
+    uint64_t* out = next + r * wordsPerRow;
+    for (int i = w0; i < w1; ++i) {
+      const int il = (i > 0) ? i - 1 : wordsPerRow - 1;
+      const int ir = (i < wordsPerRow - 1) ? i + 1 : 0;
+      // Bit k of a word is column 64*i + k, so the west neighbor comes from a left shift
+      const uint64_t a = up[i],   aw = (a << 1) | (up[il] >> 63),   ae = (a >> 1) | (up[ir] << 63);
+      const uint64_t b = mid[i],  bw = (b << 1) | (mid[il] >> 63),  be = (b >> 1) | (mid[ir] << 63);
+      const uint64_t c = down[i], cw = (c << 1) | (down[il] >> 63), ce = (c >> 1) | (down[ir] << 63);
+      uint64_t sa, ca, sc, cc, ones, cOnes, twos1, fours1;
+      add3(aw, a, ae, sa, ca);
+      add3(cw, c, ce, sc, cc);
+      const uint64_t sb = bw ^ be, cb = bw & be;
+      add3(sa, sb, sc, ones, cOnes);
+      add3(ca, cb, cc, twos1, fours1);
+      const uint64_t twos = twos1 ^ cOnes, fours = fours1 | (twos1 & cOnes);
+      // Alive next generation with exactly 3 neighbors, or with 2 if already alive
+      const uint64_t result = twos & ~fours & (ones | b);
+      diff |= result ^ b;
+      out[i] = result;
+    }
+  }
+  return diff != 0;
+}
+
+void BitLife::step() {
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int tr = 0; tr < tileRows; ++tr) {
+    for (int tc = 0; tc < tileCols; ++tc) {
+      // A tile whose neighborhood did not change last generation is stable, and the
+      // buffer we are about to write already holds that same (previous) state.
+      if (tiling && !neighborhoodChanged(tr, tc))
+        nextChanged[tr * tileCols + tc] = 0;
+      else
+        nextChanged[tr * tileCols + tc] = updateTile(tr, tc);
+    }
+  }
+  std::swap(current, next);
+  std::swap(changed, nextChanged);
+  ++generation;
+}
+
+void BitLife::render(uint32_t* rgba, int outW, int outH, int viewX, int viewY, float zoom,
+                     uint32_t liveColor, uint32_t deadColor) const {
+  const int pixelsPerCell = (zoom >= 1.0f) ? (int) zoom : 1;
+  const int cellsPerPixel = (zoom >= 1.0f) ? 1 : (int) (1.0f / zoom + 0.5f);
+  #pragma omp parallel
+  {
+    uint64_t* merged = new uint64_t[wordsPerRow];
+    #pragma omp for
+    for (int py = 0; py < outH; ++py) {
+      uint32_t* out = rgba + py * outW;
+      const int y0 = viewY + (py / pixelsPerCell) * cellsPerPixel;
+      if (y0 < 0 || y0 >= height) {
+        std::fill(out, out + outW, deadColor);
+        continue;
+      }
+      // OR together every board row covered by this pixel row
+      const uint64_t* row = current + y0 * wordsPerRow;
+      if (cellsPerPixel > 1) {
+        memcpy(merged, row, sizeof(uint64_t) * wordsPerRow);
+        for (int y = y0 + 1; y < std::min(height, y0 + cellsPerPixel); ++y)
+          for (int i = 0; i < wordsPerRow; ++i)
+            merged[i] |= current[y * wordsPerRow + i];
+        row = merged;
+      }
+      for (int px = 0; px < outW; ++px) {
+        const int x0 = viewX + (px / pixelsPerCell) * cellsPerPixel;
+        bool alive = false;
+        if (x0 >= 0 && x0 < width) {
+          const int x1 = std::min(width, x0 + cellsPerPixel);
+          for (int x = x0; x < x1 && !alive; ++x)
+            alive = (row[x >> 6] >> (x & 63)) & 1;
+        }
+        out[px] = alive ? liveColor : deadColor;
+      }
+    }
+    delete[] merged;
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ * BitLife.h
+ */
+
+#ifndef BITLIFE_H_
+#define BITLIFE_H_
+
+#include <stdint.h>
+#include <omp.h>
+
+/*!
+ * \class BitLife
+ * \brief A bit-packed, multithreaded engine for Conway's Game of Life.
+ * \details Stores the board as rows of 64-bit words, one bit per cell, and computes a whole word of cells
+ *   (64 at a time) with bitwise full-adders instead of counting neighbors cell by cell.
+ * \details Rows are updated in parallel across OpenMP threads. The board is also split into tiles of
+ *   TILE_HEIGHT rows by TILE_WORDS words; a tile is only recomputed when it, or one of its eight neighbors,
+ *   changed in the previous generation, so still lifes and empty space cost nothing.
+ * \details The board wraps around at its edges (it is a torus).
+ * \details see https://en.wikipedia.org/wiki/Conway's_Game_of_Life for more details on what Conway's Game of Life is.
+ */
+class BitLife {
+private:
+    int width, height, wordsPerRow;
+    int tileRows, tileCols;
+    uint64_t *current, *next;
+    unsigned char *changed, *nextChanged;
+    bool tiling;
+    unsigned long long generation;
+
+    bool neighborhoodChanged(int tr, int tc) const;
+    bool updateTile(int tr, int tc);
+public:
+    static const int TILE_HEIGHT = 64;  ///< Number of rows in a tile
+    static const int TILE_WORDS = 4;    ///< Number of 64-cell words across a tile
+
+    /*!
+     * \brief Explicitly constructs a BitLife board.
+     * \details Explicit constructor for the BitLife class. All cells start out dead.
+     * \param w The width of the board in cells. Rounded up to a multiple of 64.
+     * \param h The height of the board in cells.
+     */
+    BitLife(int w, int h);
+
+    /*!
+     * \brief Destroy a BitLife object.
+     * \details Destructor for the BitLife class.
+     * \return Frees up any allocated memory to a BitLife object.
+     */
+    ~BitLife();
+
+    /*!
+     * \brief Accessor for the width of the board in cells.
+     */
+    int getWidth() const { return width; }
+
+    /*!
+     * \brief Accessor for the height of the board in cells.
+     */
+    int getHeight() const { return height; }
+
+    /*!
+     * \brief Accessor for the number of generations computed so far.
+     */
+    unsigned long long getGeneration() const { return generation; }
+
+    /*!
+     * \brief Accessor for a cell's state.
+     * \param x The column of the cell (wraps around the board).
+     * \param y The row of the cell (wraps around the board).
+     * \return True if the cell is alive.
+     */
+    bool getCell(int x, int y) const;
+
+    /*!
+     * \brief Mutator for a cell's state.
+     * \details Also marks the cell's tile as changed so that the next step() looks at it.
+     * \param x The column of the cell (wraps around the board).
+     * \param y The row of the cell (wraps around the board).
+     * \param alive Whether the cell should be alive.
+     * \warning Do not call this while step() is running on another thread.
+     */
+    void setCell(int x, int y, bool alive);
+
+    /*!
+     * \brief Kills every cell on the board.
+     */
+    void clear();
+
+    /*!
+     * \brief Fills the board with random cells.
+     * \details Each row draws from its own Random stream, so a board is reproducible for a given seed.
+     * \param density Probability that any given cell is alive.
+     */
+    void randomize(float density = 0.5f);
+
+    /*!
+     * \brief Places a Gosper glider gun on the board.
+     * \param x The column of the gun's left edge.
+     * \param y The row of the gun's top edge.
+     */
+    void addGliderGun(int x, int y);
+
+    /*!
+     * \brief Turns tiling (skipping of stable regions) on or off.
+     * \param b Whether step() may skip tiles whose neighborhood did not change.
+     */
+    void setTiling(bool b);
+
+    /*!
+     * \brief Advances the board by one generation.
+     * \details Tiles are distributed dynamically across OpenMP threads, since skipped tiles make the work uneven.
+     */
+    void step();
+
+    /*!
+     * \brief Expands a view of the board into an RGBA8 frame.
+     * \details Produces one 32-bit RGBA pixel per output pixel, ready to be handed to Background::drawPixels().
+     *   Rows are written top to bottom, in parallel.
+     * \param rgba Output buffer of at least <code>outW * outH</code> pixels.
+     * \param outW Width of the output frame in pixels.
+     * \param outH Height of the output frame in pixels.
+     * \param viewX The column of the board shown at the left edge of the frame.
+     * \param viewY The row of the board shown at the top edge of the frame.
+     * \param zoom Pixels per cell. Values below 1 show several cells per pixel, which are lit if any of them is alive.
+     * \param liveColor Packed RGBA8 color of living cells.
+     * \param deadColor Packed RGBA8 color of dead cells, and of anything outside the board.
+     */
+    void render(uint32_t* rgba, int outW, int outH, int viewX, int viewY, float zoom,
+                uint32_t liveColor, uint32_t deadColor) const;
+};
+
+#endif /* BITLIFE_H_ */
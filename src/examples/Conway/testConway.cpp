@@ -1,11 +1,11 @@
 /*
  * testConway.cpp
  *
- * Usage: ./testConway <width> <height>
+ * Usage: ./testConway <width> <height> <boardWidth> <boardHeight>
  */
 
 #include <tsgl.h>
-#include "LifeFarm.h"
+#include "BitLife.h"
 
 using namespace tsgl;
 
@@ -13,43 +13,44 @@ using namespace tsgl;
  * \brief Simulates Conway's Game of Life! (Now interactive!)
  * \note See https://en.wikipedia.org/wiki/Conway's_Game_of_Life
  * \details It is drawn in this way:
- * - Get the iterations per frame, window width and window height and store them.
- * - Create a LifeFarm object to hold the objects (ants) that move around on the screen.
- * - Set the ability to draw ants that have "died" in the game to true.
+ * - Get the window width and height, and the board width and height, and store them.
+ * - Create a BitLife board to hold the cells. A board the size of the window starts with a glider gun;
+ *   a larger one is filled randomly.
  * - Set boolean flags that determine when the animation has been paused and when the left mouse button
  *   has been clicked.
  * - Bind the spacebar so that when it is pressed a screenshot is taken of the current frame.
  *   Also, set the paused boolean flag to true.
  * - Bind the left mouse button so that when it is clicked the boolean flag for keeping track of the mouse's
  *   state is set to true. When it is released, set that flag to false.
+ * - Bind the mouse wheel to zoom in and out of the board, and the arrow keys to pan around it.
  * - While the Canvas has not been closed:
  *    - Sleep the internal timer until the next draw cycle.
- *    - If the paused boolean flag is not set:
- *      - Clear the Canvas.
- *      - For 0 to the number of iterations:
- *        - If the mouse has been clicked:
- *          - Add an ant to the LifeFarm object.
- *          - Draw it on the Canvas.
- *          .
- *        - Move the ants in the LifeFarm object.
- *        .
- *      .
- *    - If the mouse has been clicked while the Canvas has been paused,
- *      add an ant to the LifeFarm object and draw it to the Canvas.
+ *    - If the mouse has been clicked, bring the cell under it to life.
+ *    - If the paused boolean flag is not set, advance the board by the number of generations per frame.
+ *    - Expand the visible part of the board into an RGBA frame and upload it to the Background in one call.
  *    .
  * .
  * \param can Reference to the Canvas to draw to.
+ * \param boardW Width of the board in cells.
+ * \param boardH Height of the board in cells.
  */
-void conwayFunction(Canvas& can) {
+void conwayFunction(Canvas& can, int boardW, int boardH) {
   Background * bg = can.getBackground();
-  const int IPF = 100,                   // Iterations per frame
-            WW = can.getWindowWidth(),    // Window width
+  const int WW = can.getWindowWidth(),    // Window width
             WH = can.getWindowHeight();   // Window height
-  LifeFarm farm(WW,WH,&can,false);    //Change the false to true for something awesome!
-  farm.setDrawdead(true);
+  BitLife board(boardW, boardH);
+  const bool bigBoard = board.getWidth() > WW || board.getHeight() > WH;
+  const int IPF = bigBoard ? 1 : 100;     // Iterations per frame
+  if (bigBoard)
+    board.randomize(0.35f);
+  else
+    board.addGliderGun(WW/2, WH/2);      //Try board.randomize() for something awesome!
+  const uint32_t LIVE = Colors::packRgba8(255,255,255), DEAD = Colors::packRgba8(0,0,0);
+  uint32_t* frame = new uint32_t[WW * WH];
+  float zoom = 1.0f;
+  int viewX = (board.getWidth() - WW) / 2, viewY = (board.getHeight() - WH) / 2;
   bool paused = false;
   bool mouseDown = false;
-  // can.drawRectangle(1,1,can.getWindowWidth()-2,can.getWindowHeight()-2,GREEN,false,PI/4);
 
   can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&can, &paused]() {
     paused = !paused;
@@ -63,28 +64,41 @@ void conwayFunction(Canvas& can) {
     mouseDown = false;
   });
 
+  // Zoom around the center of the window, by powers of two
+  can.bindToScroll([&](double dx, double dy) {
+    float cellsAcross = WW / zoom, cellsDown = WH / zoom;
+    float centerX = viewX + cellsAcross / 2, centerY = viewY + cellsDown / 2;
+    if (dy > 0 && zoom < 32.0f) zoom *= 2;
+    else if (dy < 0 && zoom > 1.0f / 16) zoom /= 2;
+    viewX = centerX - WW / zoom / 2;
+    viewY = centerY - WH / zoom / 2;
+  });
+  can.bindToButton(TSGL_LEFT, TSGL_PRESS, [&]() { viewX -= WW / zoom / 4; });
+  can.bindToButton(TSGL_RIGHT, TSGL_PRESS, [&]() { viewX += WW / zoom / 4; });
+  can.bindToButton(TSGL_UP, TSGL_PRESS, [&]() { viewY -= WH / zoom / 4; });
+  can.bindToButton(TSGL_DOWN, TSGL_PRESS, [&]() { viewY += WH / zoom / 4; });
+
   while (can.isOpen()) {
     can.sleep();
-    if(!paused) {
-      for (int i = 0; i < IPF; i++) {
-        if(mouseDown) {
-          farm.addAnt(can.getMouseX() + WW/2, can.getMouseY() + WH/2);
-          bg->drawPixel(can.getMouseX(), can.getMouseY(), ColorInt(255,255,255,255));
-        }
-        farm.moveAnts();
-      }
-    }
-    if(mouseDown) {
-      farm.addAnt(can.getMouseX() + WW/2, can.getMouseY() + WH/2);
-      bg->drawPixel(can.getMouseX(), can.getMouseY(), ColorInt(255,255,255,255));
+    if (mouseDown) {
+      float px = can.getMouseX() + WW/2, py = WH/2 - can.getMouseY();
+      board.setCell(viewX + px / zoom, viewY + py / zoom, true);
     }
+    if (!paused)
+      for (int i = 0; i < IPF; i++)
+        board.step();
+    board.render(frame, WW, WH, viewX, viewY, zoom, LIVE, DEAD);
+    bg->drawPixels(-WW/2, WH/2 - 1, WW, WH, (uint8_t*) frame);
   }
+  delete[] frame;
 }
 
-//Take command-line arguments for the width and height of the Canvas
+//Take command-line arguments for the width and height of the Canvas, and of the board
 int main(int argc, char* argv[]) {
   int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
   int h = (argc > 2) ? atoi(argv[2]) : w;
+  int bw = (argc > 3) ? atoi(argv[3]) : w;
+  int bh = (argc > 4) ? atoi(argv[4]) : h;
   Canvas c(-1, -1, w, h, "Conway's Game of Life", BLACK);
-  c.run(conwayFunction);
+  c.run(conwayFunction, bw, bh);
 }
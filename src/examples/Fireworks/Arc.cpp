@@ -57,6 +57,19 @@ bool Arc::onBlackPixel() {
   return !(col.R<LET && col.G<LET && col.B<LET);
 }
 
+/*!
+ * \brief Accessor for if another Arc's head is touching this one's.
+ * \details Two heads can reach the same spot in the same step, before either has drawn its pixel there,
+ *   which onBlackPixel() cannot see. Only the Arcs in nearby cells of the grid are checked.
+ * \param heads A SpatialGrid of the heads of all of the Arcs, or NULL to skip the check.
+ * \param self This Arc's index in the grid.
+ */
+bool Arc::hitsOtherArc(const SpatialGrid* heads, int self) {
+  if (heads == NULL)
+    return false;
+  return heads->anyWithin(myX, myY, 2.0f, [self](unsigned i) -> bool { return (int) i != self; });
+}
+
 /*!
  * \brief Computes the Arc's steps size based on myRad and myAngle.
  */
@@ -84,8 +97,12 @@ void Arc::relocate() {
 
 /*!
  * \brief Makes the Arc take a step.
+ * \details The Arc explodes into a Firework when it leaves the window, runs into a drawn pixel, or
+ *   runs into another Arc.
+ * \param heads A SpatialGrid of the heads of all of the Arcs (defaults to NULL, which skips that check).
+ * \param self This Arc's index in the grid.
  */
-void Arc::step() {
+void Arc::step(const SpatialGrid* heads, int self) {
   if (f != NULL)
     f->step();
   if (saferand(0,99) < 2) {
@@ -95,7 +112,7 @@ void Arc::step() {
   myAngle += myStepSize;
   myX += cos(myAngle);
   myY += sin(myAngle);
-  if (outOfBounds() || onBlackPixel()) {
+  if (outOfBounds() || onBlackPixel() || hitsOtherArc(heads, self)) {
     if (f != NULL)
       delete f;
     f = new Firework(*myCan,myX,myY);
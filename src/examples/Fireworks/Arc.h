@@ -29,12 +29,15 @@ public:
   bool outOfBounds();
 
   bool onBlackPixel();
+  bool hitsOtherArc(const SpatialGrid* heads, int self);
 
   void computeStepSize();
 
   void relocate();
 
-  void step();
+  void step(const SpatialGrid* heads = NULL, int self = -1);
+  float getX() { return myX; }
+  float getY() { return myY; }
 };
 
 #endif /* ARC_H_ */
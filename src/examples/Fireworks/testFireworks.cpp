@@ -12,6 +12,8 @@ using namespace tsgl;
 /*!
  * \brief Creates a bunch of fireworks.
  * \details Creates a bunch of Arcs, which explode into new arcs 
+ *  when they hit a pixel that has already been drawn or the head of another Arc. After every step the
+ *  heads are sorted into a SpatialGrid, so each Arc only checks the Arcs near it.
  *  \param can Canvas reference to which the fireworks will be drawn.
  *  \param threads Number of threads to use to draw the fireworks.
  *  \param numFireworks Number of fireworks to draw.
@@ -26,6 +28,9 @@ void fireworkFunction(Canvas& can, int threads, int numFireworks, int speed) {
   ColorFloat col = can.getBackgroundColor();
   col.A = 0.04f;
   const int CWW = can.getWindowWidth(), CWH = can.getWindowHeight();
+  // Where the head of every Arc was at the end of the last step
+  std::vector<float> headX(numFireworks), headY(numFireworks);
+  SpatialGrid heads(-CWW/2, -CWH/2, CWW/2, CWH/2, 8);
   #pragma omp parallel num_threads(threads)
   {
     while(can.isOpen()) {
@@ -34,10 +39,17 @@ void fireworkFunction(Canvas& can, int threads, int numFireworks, int speed) {
       int nthreads = omp_get_num_threads();
       for (int n = 0; n < speed; ++n) {
         for (int i = tid; i < numFireworks; i += nthreads)
-          arcs[i]->step();
+          arcs[i]->step(&heads, i);
         if (tid == 0)
           bg->drawRectangle(0,0,0,CWW,CWH,0,0,0,col);
         #pragma omp barrier
+        for (int i = tid; i < numFireworks; i += nthreads) {
+          headX[i] = arcs[i]->getX();
+          headY[i] = arcs[i]->getY();
+        }
+        #pragma omp barrier
+        #pragma omp single
+        heads.build(numFireworks, headX.data(), headY.data());
       }
     }
   }
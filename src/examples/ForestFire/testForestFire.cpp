@@ -13,7 +13,7 @@ using namespace tsgl;
  * \details
  * - Store the Canvas's dimensions for ease of use.
  * - Set the fire's life, strength, and maximum spread distance to some predetermined numbers.
- * - Seed the random number generator.
+ * - Grab this thread's random number stream.
  * - Allocate arrays for storing each pixel's onFire status and flammability.
  * - For each pixel:
  *   - Get its distance from the center of the Canvas.
@@ -43,26 +43,27 @@ void forestFireFunction(Canvas& can) {
     const float LIFE = 10,
                 STRENGTH = 0.03,
                 MAXDIST = sqrt(WINDOW_W * WINDOW_W + WINDOW_H * WINDOW_H) / 2;
-    // srand(time(NULL));  // Seed the random number generator
+    Random& rng = Random::local();  // This thread's random stream (set TSGL_SEED for repeatable fires)
     bool* onFire = new bool[WINDOW_W * WINDOW_H]();
     float* flammability = new float[WINDOW_W * WINDOW_H]();
+    rng.fillUniform(flammability, WINDOW_W * WINDOW_H);  // One batch of random numbers for the whole forest
     //Setting each pixel's flammablity
     for (int i = 0; i < WINDOW_W; i++) {  // For each individual point
         for (int j = 0; j < WINDOW_H; j++) {
             float xi = std::abs(WINDOW_W / 2 - i);
             float yi = std::abs(WINDOW_H / 2 - j);
             float tdist = (MAXDIST - sqrt(xi * xi + yi * yi)) / MAXDIST;
-            float f = 0.01 + (i * j % 100) / 100.0 * randfloat(100) / 2 * tdist;
+            float f = 0.01 + (i * j % 100) / 100.0 * flammability[i * WINDOW_H + j] / 2 * tdist;
             flammability[i * WINDOW_H + j] = f;
             bg->drawPixel(i - WINDOW_W/2, WINDOW_H/2 - j, ColorFloat(0.0f, f, 0.0f, 1.0f));
         }
     }
     //"Lakes"
     for (int reps = 0; reps < 32; reps++) {
-        int x = saferand(-WINDOW_W/2, WINDOW_W/2);
-        int y = saferand(-WINDOW_H/2, WINDOW_H/2);
-        int w = saferand(0, WINDOW_W/2 - abs(x)) * 2;
-        int h = saferand(0, WINDOW_H/2 - abs(y)) * 2;
+        int x = rng.uniformInt(-WINDOW_W/2, WINDOW_W/2);
+        int y = rng.uniformInt(-WINDOW_H/2, WINDOW_H/2);
+        int w = rng.uniformInt(0, WINDOW_W/2 - abs(x)) * 2;
+        int h = rng.uniformInt(0, WINDOW_H/2 - abs(y)) * 2;
         if (w > 32) w = 32;
         if (h > 32) h = 32;
         for (int i = -w/2; i < w/2; i++) {
@@ -94,26 +95,26 @@ void forestFireFunction(Canvas& can) {
             fires.pop();
             if (--f.life > 0) fires.push(f);
             int myCell = f.x * WINDOW_H + f.y;
-            if (f.x > 0 && !onFire[myCell - WINDOW_H] && randfloat() < flammability[myCell - WINDOW_H]) {
+            if (f.x > 0 && !onFire[myCell - WINDOW_H] && rng.uniformFloat() < flammability[myCell - WINDOW_H]) {
                 firePoint fire = { f.x - 1, f.y, LIFE, f.strength };
                 fires.push(fire);
                 onFire[myCell - WINDOW_H] = true;
                 bg->drawPixel(f.x - WINDOW_W/2 - 1, f.y - WINDOW_H/2, ColorFloat(f.life / LIFE, 0.0f, 0.0f, f.life / LIFE));
             }
             if (f.x < WINDOW_W - 1 && !onFire[myCell + WINDOW_H]
-                && randfloat() < flammability[myCell + WINDOW_H]) {
+                && rng.uniformFloat() < flammability[myCell + WINDOW_H]) {
                 firePoint fire = { f.x + 1, f.y, LIFE, f.strength };
                 fires.push(fire);
                 onFire[myCell + WINDOW_H] = true;
                 bg->drawPixel(f.x - WINDOW_W/2 + 1, f.y - WINDOW_H/2, ColorFloat(f.life / LIFE, 0.0f, 0.0f, f.life / LIFE));
             }
-            if (f.y > 0 && !onFire[myCell - 1] && randfloat() < flammability[myCell - 1]) {
+            if (f.y > 0 && !onFire[myCell - 1] && rng.uniformFloat() < flammability[myCell - 1]) {
                 firePoint fire = { f.x, f.y - 1, LIFE, f.strength };
                 fires.push(fire);
                 onFire[myCell - 1] = true;
                 bg->drawPixel(f.x - WINDOW_W/2, f.y - WINDOW_H/2 - 1, ColorFloat(f.life / LIFE, 0.0f, 0.0f, f.life / LIFE));
             }
-            if (f.y < WINDOW_H && !onFire[myCell + 1] && randfloat() < flammability[myCell + 1]) {
+            if (f.y < WINDOW_H && !onFire[myCell + 1] && rng.uniformFloat() < flammability[myCell + 1]) {
                 firePoint fire = { f.x, f.y + 1, LIFE, f.strength };
                 fires.push(fire);
                 onFire[myCell + 1] = true;
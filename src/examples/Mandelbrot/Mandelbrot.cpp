@@ -14,54 +14,31 @@ Mandelbrot::Mandelbrot(unsigned threads, unsigned depth) {
 void Mandelbrot::manhattanShading(CartesianCanvas& can) {
   int cww = can.getWindowWidth(), cwh = can.getWindowHeight();
   CartesianBackground * bg = can.getBackground();
-  int** canPoints = new int*[cwh];
-  for (int i = 0; i < cwh; ++i) {
-    canPoints[i] = new int[cww];
-    for (int j = 0; j < cww; ++j) {
-      ColorInt c = bg->Background::getPixel(j - cww/2,i - cwh/2);
-      canPoints[i][j] = ((c.R == c.G) && (c.G == c.B) && (c.B == 0)) ? 0 : -1;
-    }
-  }
-  bool done = false;
-  int loop;
-  for (loop = 0; !done; ++loop) {
-    done = true;
-    #pragma omp parallel for
-    for (int i = 0; i < cwh; ++i) {
-      for (int j = 0; j < cww; ++j) {
-        if (canPoints[i][j] != loop)
-          continue;
-        if (i > 0 && canPoints[i-1][j] == -1)
-          canPoints[i-1][j] = loop+1, done = false;
-        if (j > 0 && canPoints[i][j-1] == -1)
-          canPoints[i][j-1] = loop+1, done = false;
-        if (i < cwh-1 && canPoints[i+1][j] == -1)
-          canPoints[i+1][j] = loop+1, done = false;
-        if (j < cww-1 && canPoints[i][j+1] == -1)
-          canPoints[i][j+1] = loop+1, done = false;
-      }
-    }
-  }
+  std::vector<uint8_t> pixels;
+  ImageOps::snapshot(bg, pixels);
+
+  // Distance from every pixel to the nearest black pixel (a point in the set)
+  std::vector<uint8_t> black(cww*cwh);
+  for (int i = 0; i < cww*cwh; ++i)
+    black[i] = (pixels[4*i] | pixels[4*i+1] | pixels[4*i+2]) == 0;
+  std::vector<int> distance(cww*cwh);
+  int maxDistance = ImageOps::distanceTransform(&black[0], cww, cwh, &distance[0]);
+  if (maxDistance < 0)
+    return;
 
-  int sum = 0;
-  for (int i = 0; i < cwh; ++i)
-    for (int j = 0; j < cww; ++j)
-      sum += canPoints[i][j];
+  long sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (int i = 0; i < cww*cwh; ++i)
+    sum += distance[i];
   float avg = (((float)sum)/cww)/cwh;
 
   #pragma omp parallel for
-  for (int i = 0; i < cwh; ++i) {
-    for (int j = 0; j < cww; ++j) {
-      float mult = sqrt(avg*((float)canPoints[i][j])/loop);
-      ColorFloat c = bg->Background::getPixel(j - cww/2,i - cwh/2);
-      bg->Background::drawPixel(j - cww/2,i - cwh/2,c*mult);
-    }
+  for (int i = 0; i < cww*cwh; ++i) {
+    float mult = sqrt(avg*((float)distance[i])/(maxDistance+1));
+    for (int c = 0; c < 3; ++c)
+      pixels[4*i+c] = std::min(pixels[4*i+c]*mult, 255.0f);
   }
-
-  for (int i = 0; i < can.getWindowHeight(); ++i)
-    delete [] canPoints[i];
-  delete [] canPoints;
-  canPoints = NULL;
+  ImageOps::upload(bg, &pixels[0]);
 }
 
 void Mandelbrot::bindings(Cart& can) {
@@ -136,6 +113,13 @@ void Mandelbrot::draw(Cart& can) {
       unsigned tid = omp_get_thread_num();
       unsigned nthreads = omp_get_num_threads();
       ColorFloat tcolor = Colors::highContrastColor(tid);
+      // Precompute this thread's shades once, instead of blending for every pixel
+      Colormap shades = Colormap::fromFunction([&tcolor](float mult) {
+        return Colors::blend(tcolor,WHITE,0.25f+0.5f*mult)*mult;
+      }, std::min(myDepth + 1, 4096u));
+      const uint32_t black = Colors::packRgba8(0,0,0);
+      const int CW = can.getWindowWidth();
+      std::vector<uint32_t> row(CW);
       double blocksize = can.getCartHeight() / nthreads;
       double blockheight = CH / nthreads;
       pb->update(blockheight*tid);
@@ -143,7 +127,8 @@ void Mandelbrot::draw(Cart& can) {
       for(unsigned int k = 0; k <= blockheight && can.isOpen(); k++) {  // As long as we aren't trying to render off of the screen...
         pb->update(k+(CH*tid)/nthreads);
         long double y = startrow + can.getPixelHeight() * k;
-        for(long double x = bg->getMinX(); x <= bg->getMaxX(); x += can.getPixelWidth()) {
+        for(int j = 0; j < CW; ++j) {
+          long double x = bg->getMinX() + can.getPixelWidth() * j;
           complex originalComplex(x, y);
           complex c(x, y);
           unsigned iterations = 0;
@@ -151,16 +136,17 @@ void Mandelbrot::draw(Cart& can) {
             iterations++;
             c = c * c + originalComplex;
           }
-          if(iterations == myDepth) { // If the point never escaped, draw it black
-            if (y < can.getMaxY())
-              bg->drawPixel(x, y, ColorFloat(0,0,0,1));
-          } else { // Otherwise, draw it with color based on how long it took
-            float mult = iterations/(float)myDepth;
-            if (y < can.getMaxY())
-              bg->drawPixel(x, y, Colors::blend(tcolor,WHITE,0.25f+0.5f*mult)*mult);
-          }
+          if(iterations == myDepth) // If the point never escaped, draw it black
+            row[j] = black;
+          else                      // Otherwise, draw it with color based on how long it took
+            row[j] = shades.map(iterations/(float)myDepth);
           if (myRedraw) break;
         }
+        if (myRedraw) break;
+        if (y < can.getMaxY()) {    // Upload the whole row at once
+          int screenY = (y - can.getMinY() - can.getCartHeight()/2) * CH / can.getCartHeight();
+          bg->Background::drawPixels(-CW/2, screenY, CW, 1, (const uint8_t*) row.data());
+        }
         can.handleIO();
         if (myRedraw) break;
       }
@@ -0,0 +1,187 @@
+#include "PandemicModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+/*!
+ * \brief Resizes every array of a State to hold n people.
+ */
+void PandemicModel::State::resize(int n) {
+    x.resize(n); y.resize(n);
+    status.resize(n);
+    daysInfected.resize(n);
+    willDie.resize(n);
+    daysTillDead.resize(n);
+}
+
+/*!
+ * \brief Explicitly constructs a new PandemicModel.
+ * \details Scatters the people randomly within the bounds, with the first
+ *      <code>params.numInitiallyInfected</code> of them infected and the rest susceptible.
+ *      \param params The parameters of the simulation.
+ *      \param numWorkers The number of workers (and OpenMP threads) to split each day between.
+ * \return A new PandemicModel on day 0.
+ */
+PandemicModel::PandemicModel(const PandemicParams& params, int numWorkers)
+  : grid(-params.maxX, -params.maxY, params.maxX, params.maxY, params.infectionRadius + params.personRadius) {
+    myParams = params;
+    myNumWorkers = std::max(1, std::min(numWorkers, params.numPersons));
+    myDay = 0;
+    const int n = params.numPersons;
+    current.resize(n);
+    previous.resize(n);
+    contagious.resize(n);
+    for (int w = 0; w < myNumWorkers; ++w) {
+        workers.push_back(Worker(w + 1));   // Stream 0 is used for the initial placement
+    }
+
+    Random rng = Random::forStream(0);
+    for (int i = 0; i < n; ++i) {
+        current.x[i] = rng.uniformInt(-(int) params.maxX, (int) params.maxX);
+        current.y[i] = rng.uniformInt(-(int) params.maxY, (int) params.maxY);
+        current.daysInfected[i] = 0;
+        current.willDie[i] = false;
+        current.daysTillDead[i] = 0;
+        if (i < params.numInitiallyInfected) {
+            current.status[i] = infected;
+            // Determine if the initially infected will die
+            if (rng.uniformInt(1, 100) <= params.mortalityFactor) {
+                current.willDie[i] = true;
+                current.daysTillDead[i] = rng.uniformInt(1, params.sickDuration);
+            }
+        } else {
+            current.status[i] = susceptible;
+        }
+    }
+    previous = current;
+
+    numInfected = std::min(params.numInitiallyInfected, n);
+    numSusceptible = n - numInfected;
+    totalInfections = totalInfectionAttempts = numInfected;
+    totalDeaths = totalRecoveries = 0;
+}
+
+/*!
+ * \brief Finds the contiguous range of people handled by a worker.
+ */
+void PandemicModel::getRange(int worker, int& begin, int& end) const {
+    begin = (long long) myParams.numPersons * worker / myNumWorkers;
+    end = (long long) myParams.numPersons * (worker + 1) / myNumWorkers;
+}
+
+/*!
+ * \brief Simulates one day.
+ * \details The day runs in two passes over the people, each split between the workers:
+ *      - Everyone who is alive takes a random step, and infected people either die, recover, or stay sick
+ *        for another day. Whoever is still infected afterwards is contagious for the rest of the day.
+ *      - Everyone is sorted into a SpatialGrid by their new position, and each susceptible person who is
+ *        within the infection radius of a contagious person may become infected.
+ *      .
+ *      Each worker counts what happened in its own range, and the counts are added up at the end.
+ * \return What happened during the day.
+ */
+DayStats PandemicModel::step() {
+    const PandemicParams& p = myParams;
+    const State& today = current;
+    State& tomorrow = previous;                 // Overwrite the older buffer
+    ++myDay;
+    for (int w = 0; w < myNumWorkers; ++w) {
+        DayStats zero = { 0, 0, 0, 0 };
+        workers[w].stats = zero;
+    }
+
+    // MOVE, DIE, OR RECOVER //
+    #pragma omp parallel num_threads(myNumWorkers)
+    {
+        // The runtime may hand us fewer threads than asked for, so threads take workers round-robin
+        for (int w = omp_get_thread_num(); w < myNumWorkers; w += omp_get_num_threads()) {
+            Random& rng = workers[w].rng;
+            DayStats& stats = workers[w].stats;
+            int begin, end;
+            getRange(w, begin, end);
+            for (int i = begin; i < end; ++i) {
+                char status = today.status[i];
+                float x = today.x[i], y = today.y[i];
+                int daysInfected = today.daysInfected[i];
+                if (status != dead) {
+                    // Move, if the move keeps the person within the bounds
+                    const int dx = rng.uniformInt(-p.maxMove, p.maxMove), dy = rng.uniformInt(-p.maxMove, p.maxMove);
+                    if (x + dx > -p.maxX && x + dx < p.maxX && y + dy > -p.maxY && y + dy < p.maxY) {
+                        x += dx; y += dy;
+                    }
+                    if (status == infected) {
+                        if (today.willDie[i] && today.daysTillDead[i] == daysInfected) {
+                            status = dead;
+                            ++stats.deaths;
+                        } else if (!today.willDie[i] && daysInfected >= p.sickDuration) {
+                            status = immune;
+                            ++stats.recoveries;
+                        } else {
+                            ++daysInfected;
+                        }
+                    }
+                }
+                tomorrow.x[i] = x; tomorrow.y[i] = y;
+                tomorrow.status[i] = status;
+                tomorrow.daysInfected[i] = daysInfected;
+                tomorrow.willDie[i] = today.willDie[i];
+                tomorrow.daysTillDead[i] = today.daysTillDead[i];
+                contagious[i] = (status == infected);
+            }
+        }
+    }
+
+    grid.build(p.numPersons, tomorrow.x.data(), tomorrow.y.data());
+
+    // INFECT //
+    #pragma omp parallel num_threads(myNumWorkers)
+    {
+        for (int w = omp_get_thread_num(); w < myNumWorkers; w += omp_get_num_threads()) {
+            Random& rng = workers[w].rng;
+            DayStats& stats = workers[w].stats;
+            int begin, end;
+            getRange(w, begin, end);
+            for (int i = begin; i < end; ++i) {
+                if (tomorrow.status[i] != susceptible)
+                    continue;
+                const float x = tomorrow.x[i], y = tomorrow.y[i];
+                bool atRisk = grid.anyWithin(x, y, p.infectionRadius + p.personRadius, [&](unsigned j) -> bool {
+                    if (!contagious[j])
+                        return false;
+                    unsigned distance = sqrt( pow(x - tomorrow.x[j], 2) + pow(y - tomorrow.y[j], 2) );
+                    return distance < p.infectionRadius + p.personRadius;
+                });
+                if (!atRisk)
+                    continue;
+                ++stats.infectionAttempts;
+                if (rng.uniformInt(1, 100) <= p.contagiousFactor) {
+                    // Only susceptible people are written here, and only contagious people are read
+                    tomorrow.status[i] = infected;
+                    ++stats.infections;
+                    if (rng.uniformInt(1, 100) <= p.mortalityFactor) {
+                        tomorrow.willDie[i] = true;
+                        tomorrow.daysTillDead[i] = rng.uniformInt(1, p.sickDuration);
+                    }
+                }
+            }
+        }
+    }
+
+    DayStats day = { 0, 0, 0, 0 };
+    for (int w = 0; w < myNumWorkers; ++w) {
+        day.deaths += workers[w].stats.deaths;
+        day.recoveries += workers[w].stats.recoveries;
+        day.infections += workers[w].stats.infections;
+        day.infectionAttempts += workers[w].stats.infectionAttempts;
+    }
+    numInfected += day.infections - day.deaths - day.recoveries;
+    numSusceptible -= day.infections;
+    totalInfections += day.infections;
+    totalInfectionAttempts += day.infectionAttempts;
+    totalDeaths += day.deaths;
+    totalRecoveries += day.recoveries;
+
+    std::swap(current, previous);
+    return day;
+}
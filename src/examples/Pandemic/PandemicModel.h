@@ -0,0 +1,126 @@
+#ifndef PANDEMICMODEL_H_
+#define PANDEMICMODEL_H_
+
+#include <vector>
+#include <tsgl.h>
+#include "statusEnums.h"
+
+using namespace tsgl;
+
+/*! \brief Parameters of a PandemicModel.
+ */
+struct PandemicParams {
+    int numPersons;             // Number of people in the model
+    int numInitiallyInfected;   // How many of them start out infected
+    float personRadius;         // Radius of each person
+    float infectionRadius;      // Radius around an infected person within which others are at risk
+    int sickDuration;           // Days until an infected person recovers
+    int contagiousFactor;       // Chance (0-100) of catching the disease when at risk
+    int mortalityFactor;        // Chance (0-100) of dying from the disease
+    float maxX, maxY;           // People stay within [-maxX, maxX] x [-maxY, maxY]
+    int maxMove;                // Largest step a person takes in x or y each day
+};
+
+/*! \brief Counts of what happened during one simulated day.
+ */
+struct DayStats {
+    int deaths;
+    int recoveries;
+    int infections;
+    int infectionAttempts;
+};
+
+/*!
+ * \class PandemicModel
+ * \brief The state and rules of the Pandemic simulation, without any drawing.
+ * \details Every person's position and health is stored in flat arrays. Each day is computed from the
+ *   current arrays into a second set, and the two are swapped at the end of step(), so a day never reads
+ *   values that were written during that same day.
+ * \details The people are split into one contiguous range per worker, and a fixed team of OpenMP threads
+ *   (one per worker) works through those ranges. Each worker has its own Random stream and its own
+ *   DayStats, which are added together once the day is over, so the workers share nothing they write to.
+ * \details Finding out who is near an infected person goes through a SpatialGrid, so a day costs O(n).
+ */
+class PandemicModel {
+public:
+    /*! \brief The people's state, one entry per person in each array.
+     */
+    struct State {
+        std::vector<float> x, y;
+        std::vector<char> status;
+        std::vector<int> daysInfected;
+        std::vector<unsigned char> willDie;
+        std::vector<int> daysTillDead;
+
+        void resize(int n);
+    };
+private:
+    // Workers are padded out to a cache line so that their counters do not share one
+    struct Worker {
+        Random rng;
+        DayStats stats;
+        char padding[64];
+        Worker(uint64_t stream) : rng(Random::forStream(stream)) { }
+    };
+
+    PandemicParams myParams;
+    int myNumWorkers;
+    State current, previous;
+    std::vector<unsigned char> contagious;     // Whether each person can infect others today
+    std::vector<Worker> workers;
+    SpatialGrid grid;
+    int myDay;
+    int numSusceptible, numInfected;
+    int totalInfections, totalInfectionAttempts, totalDeaths, totalRecoveries;
+
+    void getRange(int worker, int& begin, int& end) const;
+public:
+    PandemicModel(const PandemicParams& params, int numWorkers);
+
+    DayStats step();
+
+    /*!
+     * \brief Accessor for everyone's state as of the end of the last day.
+     */
+    const State& getState() const { return current; }
+
+    /*!
+     * \brief Accessor for everyone's state as of the start of the last day.
+     */
+    const State& getPreviousState() const { return previous; }
+
+    /*!
+     * \brief Accessor for the parameters of the model.
+     */
+    const PandemicParams& getParams() const { return myParams; }
+
+    /*!
+     * \brief Accessor for the number of workers each day is split between.
+     */
+    int getNumWorkers() const { return myNumWorkers; }
+
+    /*!
+     * \brief Accessor for the number of days simulated so far.
+     */
+    int getDay() const { return myDay; }
+
+    /*!
+     * \brief Accessor for the number of people who have never been infected.
+     */
+    int getNumSusceptible() const { return numSusceptible; }
+
+    /*!
+     * \brief Accessor for the number of people who are currently infected.
+     */
+    int getNumInfected() const { return numInfected; }
+
+    int getTotalInfections() const { return totalInfections; }
+
+    int getTotalInfectionAttempts() const { return totalInfectionAttempts; }
+
+    int getTotalDeaths() const { return totalDeaths; }
+
+    int getTotalRecoveries() const { return totalRecoveries; }
+};
+
+#endif /* PANDEMICMODEL_H_ */
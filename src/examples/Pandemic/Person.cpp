@@ -150,26 +150,40 @@ void Person::moveBy(float x, float y, float max_x, float max_y){
     }
 }
 
+/**
+ * \brief Moves the Person to a new location.
+ * \param x The new x-coordinate of the Person.
+ * \param y The new y-coordinate of the Person.
+ */
+void Person::moveTo(float x, float y){
+    myCircle->setCenter(x, y, 0);
+    if(hasInfectionRadius){
+        myInfectionCircle->setCenter(x, y, 0);
+    }
+    myX = x; myY = y;
+}
+
 /**
  * \brief Checks if the Person's x and y is within the infection radius of another Person.
+ * \details Only the people near this Person are checked, by querying a SpatialGrid of everyone's positions.
+ *          Assumes all people share the same infection radius.
  * \param personVec The vector containing all Person instances.
+ * \param grid A SpatialGrid built from the positions of personVec, in the same order.
  * \return true if the Person is within another's infection radius, false otherwise.
  */
-bool Person::checkIfInfectedNearby(std::vector<Person*> personVec){
-    unsigned distance;
-    for(unsigned i = 0; i < personVec.size(); ++i){
+bool Person::checkIfInfectedNearby(const std::vector<Person*>& personVec, const SpatialGrid& grid){
+    bool found = grid.anyWithin(myX, myY, myInfectionRadius + myCircleRadius, [&](unsigned i) -> bool {
         // Search for all people who are infected
-        if(personVec[i]->getStatus() == infected){
-            // Check if susceptible person is in infection radius
-            distance = sqrt( pow(myX - personVec[i]->getX(), 2) + pow(myY - personVec[i]->getY(), 2) );
-            if(distance < personVec[i]->getInfectionRadius() + myCircleRadius)
-            {
-                ++numInfectedNearby;
-                return true;
-            }
-        }
+        if(personVec[i]->getStatus() != infected)
+            return false;
+        // Check if susceptible person is in infection radius
+        unsigned distance = sqrt( pow(myX - personVec[i]->getX(), 2) + pow(myY - personVec[i]->getY(), 2) );
+        return distance < personVec[i]->getInfectionRadius() + myCircleRadius;
+    });
+    if(found){
+        ++numInfectedNearby;
     }
-    return false;
+    return found;
 }
 
 /**
@@ -183,18 +197,27 @@ bool Person::checkIfInfectedNearby(std::vector<Person*> personVec){
  */
 bool Person::determineIfInfected(Canvas& can, int contagiousFactor, int randNum){
     if(numInfectedNearby >= 1 && randNum <= contagiousFactor){
-        myStatus = infected;
-        myCircle->setColor(ColorFloat(1,0,0,1));    // red
-        if(hasInfectionRadius){
-            myInfectionCircle->setColor(ColorFloat(1,0.5,0,0.5));   // orange
-            can.add(myInfectionCircle);
-        }
-        numInfectedNearby = 0;
+        infect(can);
         return true;
     }
     return false;
 }
 
+/**
+ * \brief Infects a Person; sets the Person's status to infected, shows the Person's infection circle, and
+ *          changes the Person's color to red.
+ * \param can The Canvas on which the Person's infection circle is to be drawn.
+ */
+void Person::infect(Canvas& can){
+    myStatus = infected;
+    myCircle->setColor(ColorFloat(1,0,0,1));    // red
+    if(hasInfectionRadius){
+        myInfectionCircle->setColor(ColorFloat(1,0.5,0,0.5));   // orange
+        can.add(myInfectionCircle);
+    }
+    numInfectedNearby = 0;
+}
+
 /**
  * \brief Determines whether or not a Person is to die from the infection.
  * \param deadlinessFactor The probability of a Person dying.
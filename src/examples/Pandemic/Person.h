@@ -66,14 +66,18 @@ public:
 
     void moveBy(float x, float y, float max_x, float max_y);
 
+    void moveTo(float x, float y);
+
     // Checking/updating functions //
 
-    bool checkIfInfectedNearby(std::vector<Person*> personVec);
+    bool checkIfInfectedNearby(const std::vector<Person*>& personVec, const SpatialGrid& grid);
 
     void increaseNumDaysInfected() { numDaysInfected += 1; }
 
     bool determineIfInfected(Canvas& can, int contagiousFactor, int randNum);
 
+    void infect(Canvas& can);
+
     void determineIsToDie(int deadlinessFactor, int randNum, int daysTillDead);
 
     void die(Canvas& can);
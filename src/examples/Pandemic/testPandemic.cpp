@@ -1,16 +1,15 @@
 /*
  * testPandemic.cpp
  *
- * Usage: ./testPandemic [numPersons] [contagiousFactor]
-            1 <= numPersons <= 200, defaults to 50
-            0 <= contagiousFactor <= 100, defaults to 50
+ * Usage: ./testPandemic [options], see ./testPandemic --help
  */
 
 #include <tsgl.h>
+#include <chrono>
 #include <cmath>
-#include <random>
 #include <vector>
 #include "Person.h"
+#include "PandemicModel.h"
 #include <cxxopts.hpp>
 
 // disease constants
@@ -18,6 +17,9 @@
 // text constants
 #define FONT_SIZE 20                                // font size for all text
 #define TEXT_COLOR ColorFloat(0.2,1,1,1)            // color for all text (light blue)
+// window constants
+#define WINDOW_SIZE 620         // width and height of the window
+#define DEFAULT_PERSONS 100     // number of people the window is sized for
 
 using namespace tsgl;
 
@@ -37,9 +39,13 @@ cxxopts::ParseResult parse(int argc, char* argv[]) {
             ("c, contagiousness" , "the contagiousness factor of the disease (0-100)", cxxopts::value<int>()->default_value("50"))
             ("r, infect-radius", "the infection radius of the disease (1-200)", cxxopts::value<int>()->default_value("35"))
             ("m, mortality", "the mortality factor of the disease (0-100)", cxxopts::value<int>()->default_value("2"))
-            ("s, show-radius", "include to display the infection radius around each person", 
+            ("w, workers", "the number of worker threads (defaults to the number of processors)",
+                cxxopts::value<int>()->default_value("0"))
+            ("b, benchmark", "simulate this many days without a window and print person-days per second",
+                cxxopts::value<int>()->default_value("0"))
+            ("s, show-radius", "include to display the infection radius around each person",
                 cxxopts::value<bool>()->default_value("false"))
-            ("a, attendance", "include to print out the thread attendance (to see if all threads are running)",
+            ("a, attendance", "include to print out the worker attendance (to see if all workers are running)",
                 cxxopts::value<bool>()->default_value("false"));
 
         auto results = options.parse(argc, argv);
@@ -58,111 +64,133 @@ cxxopts::ParseResult parse(int argc, char* argv[]) {
     }
 }
 
-void pandemicFunction(Canvas& can, int argc, char* argv[]) {
-    // INITIALIZE VARIABLES //
-    int numPersons = 100;
-    float personRadius = 5.0;
-    float infectionRadius = 35;
-    bool showInfectionRadius;
-    bool takeAttendance;
-    // time
-    int numDays = 0;
-    int sickDuration = 21;
-    // counters
-    int num_initially_infected = 1;
-    int num_currently_infected;
-    int num_susceptible;
-    // pandemic factors
-    int contagiousFactor = 50;
-    int mortalityFactor = 2;
-    // ending stats/counters
-    int total_num_infections;
-    int total_num_infection_attempts = 0;
-    int total_num_deaths = 0;
-    // int total_num_death_attempts = 0;
-    int total_num_recoveries = 0;
-    float true_contagiousness = 0.0;
-    float true_mortality = 0.0;
-    float avgInfectionLength;
-    // Parse command line
-    auto result = parse(argc, argv);
+// Fills in the simulation parameters from the command line, for people moving within [-max_x, max_x] x [-max_y, max_y]
+PandemicParams getParams(cxxopts::ParseResult& result, float max_x, float max_y) {
+    PandemicParams params;
+    params.numPersons = 100;
+    params.numInitiallyInfected = 1;
+    params.personRadius = 5.0;
+    params.infectionRadius = 35;
+    params.sickDuration = 21;
+    params.contagiousFactor = 50;
+    params.mortalityFactor = 2;
+    params.maxMove = 20;
 
-    // SET OPTIONS //
     if (result["num"].as<int>() > 0) {
-        numPersons = result["num"].as<int>();
+        params.numPersons = result["num"].as<int>();
     }
-    if (result["initial"].as<int>() > 0 and result["initial"].as<int>() <= numPersons) {
-        num_initially_infected = result["initial"].as<int>();
+    if (result["initial"].as<int>() > 0 and result["initial"].as<int>() <= params.numPersons) {
+        params.numInitiallyInfected = result["initial"].as<int>();
     }
     if (result["person-radius"].as<float>() > 0.0 and result["person-radius"].as<float>() <= 30) {
-        personRadius = result["person-radius"].as<float>();
+        params.personRadius = result["person-radius"].as<float>();
     }
     if (result["sick-for"].as<int>() > 0) {
-        sickDuration = result["sick-for"].as<int>();
+        params.sickDuration = result["sick-for"].as<int>();
     }
     if (result["contagiousness"].as<int>() >= 0 and result["contagiousness"].as<int>() <= 100) {
-        contagiousFactor = result["contagiousness"].as<int>();
+        params.contagiousFactor = result["contagiousness"].as<int>();
     }
     if (result["infect-radius"].as<int>() > 0 and result["infect-radius"].as<int>() <= 200) {
-        infectionRadius = result["infect-radius"].as<int>();
+        params.infectionRadius = result["infect-radius"].as<int>();
     }
     if (result["mortality"].as<int>() >= 0 and result["mortality"].as<int>() <= 100) {
-        mortalityFactor = result["mortality"].as<int>();
+        params.mortalityFactor = result["mortality"].as<int>();
     }
-
-    // boolean switches
-    showInfectionRadius = result["show-radius"].as<bool>();
-    takeAttendance = result["attendance"].as<bool>();
-
-    // counters
-    num_currently_infected = num_initially_infected;
-    num_susceptible = numPersons - num_initially_infected;
-    total_num_infections = num_initially_infected;
-    total_num_infection_attempts = num_initially_infected;
     // movement bounds
-    float max_x = can.getWindowWidth()/2 - personRadius;
-    float max_y = can.getWindowHeight()/2 - personRadius - FONT_SIZE;
-
-    // random number generator, seed, and distributions
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::default_random_engine generator(seed);
-    std::uniform_int_distribution<int> init_x_distr(-max_x, max_x);
-    std::uniform_int_distribution<int> init_y_distr(-max_y, max_y);
-    std::uniform_int_distribution<int> move_distr(-20, 20);
-    std::uniform_int_distribution<int> sick_distr(1, sickDuration);
-    std::uniform_int_distribution<int> chance_distr(1, 100);
-
-    // Create arrays
-    std::vector<Person*> personVec;
-    std::vector<int> threadAttendance;
+    params.maxX = max_x - params.personRadius;
+    params.maxY = max_y - params.personRadius;
+    return params;
+}
 
-    // Insert infected into array
-    for(int i = 0; i < num_initially_infected; ++i){
-        personVec.push_back(new Person(init_x_distr(generator), init_y_distr(generator),
-                                    personRadius, infectionRadius, infected, showInfectionRadius));
-        personVec[i]->draw(can);
+int getNumWorkers(cxxopts::ParseResult& result) {
+    return (result["workers"].as<int>() > 0) ? result["workers"].as<int>() : omp_get_num_procs();
+}
+
+// Prints the statistics at the end of a simulation
+void printStats(const PandemicModel& model) {
+    float true_contagiousness = 0.0;
+    float true_mortality = 0.0;
+    if(model.getTotalInfectionAttempts() != 0){  // To avoid a divide-by-zero error (in case there were no infection attempts)
+        true_contagiousness = (model.getTotalInfections()/static_cast<float>(model.getTotalInfectionAttempts())) * 100.0;
     }
-    // Determine if the initially infected will die
-    #pragma omp parallel num_threads(num_initially_infected)
-    {
-        int id = omp_get_thread_num();
-        personVec[id]->determineIsToDie(mortalityFactor, chance_distr(generator), sick_distr(generator));
+    if(model.getTotalInfections() != 0){  // To avoid a divide-by-zero error (in case there were no infection attempts)
+        true_mortality = (model.getTotalDeaths()/static_cast<float>(model.getTotalInfections())) * 100.0;
     }
 
-    // Insert susceptible into array
-    for(int i = num_initially_infected; i < numPersons; ++i){
-        personVec.push_back(new Person(init_x_distr(generator), init_y_distr(generator),
-                                    personRadius, infectionRadius, susceptible, showInfectionRadius));
-        personVec[i]->draw(can);
+    printf("\n***********************\
+            \n* Statistics and data *\
+            \n***********************\
+            \n\
+            \n*** Herd immunity achieved in %d days ***\
+            \nSusceptible: %d\
+            \nImmune: %d\
+            \nDead: %d\
+            \n", model.getDay(), model.getNumSusceptible(),
+                 model.getTotalRecoveries(), model.getTotalDeaths());
+    printf("\n*** Statistics ***\
+            \nTotal number of infections: %d\
+            \nTotal number of deaths: %d\
+            \nTotal number of recoveries: %d\
+            \nTrue contagiousness: %.2f%%\
+            \nTrue mortality rate: %.2f%%\
+            \n", model.getTotalInfections(), model.getTotalDeaths(), model.getTotalRecoveries(),
+                    true_contagiousness, true_mortality);
+}
+
+/*!
+ * \brief Runs the simulation without a window, as fast as possible, and reports its speed.
+ * \details The people move within a square that is scaled with their number so that the crowd is as dense as
+ *      DEFAULT_PERSONS people in the default window. Every day is simulated, even after the disease has died out,
+ *      so that runs of the same length are comparable.
+ * \param result The parsed command line.
+ */
+void pandemicBenchmark(cxxopts::ParseResult& result) {
+    const int days = result["benchmark"].as<int>();
+    int numPersons = (result["num"].as<int>() > 0) ? result["num"].as<int>() : DEFAULT_PERSONS;
+    float half = WINDOW_SIZE / 2 * sqrt(numPersons / (float) DEFAULT_PERSONS);
+    PandemicParams params = getParams(result, half, half);
+    PandemicModel model(params, getNumWorkers(result));
+
+    printf("Benchmarking %d people for %d days with %d workers (seed %llu)...\n",
+           params.numPersons, days, model.getNumWorkers(), (unsigned long long) Random::getSeed());
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int day = 0; day < days; ++day){
+        model.step();
     }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    printStats(model);
+    printf("\n*** Benchmark ***\
+            \nElapsed time: %.3f s\
+            \nPerson-days per second: %.0f\
+            \n", seconds, (double) params.numPersons * days / seconds);
+}
 
-    // Set up thread "attendance sheet"
+void pandemicFunction(Canvas& can, int argc, char* argv[]) {
+    // Parse command line
+    auto result = parse(argc, argv);
+
+    // SET OPTIONS //
+    PandemicParams params = getParams(result, can.getWindowWidth()/2, can.getWindowHeight()/2 - FONT_SIZE);
+    const int numPersons = params.numPersons;
+    const bool showInfectionRadius = result["show-radius"].as<bool>();
+    const bool takeAttendance = result["attendance"].as<bool>();
+
+    PandemicModel model(params, getNumWorkers(result));
+    const int numWorkers = model.getNumWorkers();
+
+    // Create the people, where and as the model placed them
+    const PandemicModel::State& start = model.getState();
+    std::vector<Person*> personVec;
     for(int i = 0; i < numPersons; ++i){
-        threadAttendance.push_back(-1);
+        personVec.push_back(new Person(start.x[i], start.y[i], params.personRadius, params.infectionRadius,
+                                       start.status[i], showInfectionRadius));
+        personVec[i]->draw(can);
     }
 
-    // Create background
-    Background * bg = can.getBackground();
+    // Set up worker "attendance sheet"
+    std::vector<int> workerAttendance(numWorkers, -1);
 
     // Create text to display the current day
     Text * dayText = new Text(0, 300, 0, L"Day 1", FONT, FONT_SIZE, 0, 0, 0, TEXT_COLOR);
@@ -191,139 +219,62 @@ void pandemicFunction(Canvas& can, int argc, char* argv[]) {
             \n\
             \nStarting number of people infected: %d\
             \nTotal number of people: %d\
-            \n\n", infectionRadius, contagiousFactor, mortalityFactor, 
-                    num_initially_infected, numPersons);
+            \nNumber of workers: %d\
+            \n\n", params.infectionRadius, params.contagiousFactor, params.mortalityFactor,
+                    params.numInitiallyInfected, numPersons, numWorkers);
 
     bool complete = false;  // ensures simulation only runs once
-    bool printInfo = true; // ensures information is only printed once
 
     // RUN SIMULATION //
     while (can.isOpen()) {
         if(!complete){
             // Runs until there are no more infections
-            while(num_currently_infected != 0){
-                // Increment number of days for pandemic
-                ++numDays;
-                // Update day number
-                dayText->setText(L"Day " + std::to_wstring(numDays));
+            while(model.getNumInfected() != 0 && can.isOpen()){
+                // Simulate the next day
+                model.step();
+                dayText->setText(L"Day " + std::to_wstring(model.getDay()));
                 can.sleepFor(sleepTime);
 
                 //------------------------------------- Parallel Block ------------------------------------------
-                #pragma omp parallel num_threads(numPersons)
-                {
-                    int id = omp_get_thread_num();
-                    
-                    // Ensure there is one thread running per person (take attendance for threads)
-                    if(numDays == 1){
-                        threadAttendance[id] = id;
+                // Bring each Person's circle up to date with the model, one chunk of people per worker
+                const PandemicModel::State& before = model.getPreviousState();
+                const PandemicModel::State& after = model.getState();
+                #pragma omp parallel for num_threads(numWorkers) schedule(static)
+                for(int i = 0; i < numPersons; ++i){
+                    if(model.getDay() == 1){
+                        workerAttendance[omp_get_thread_num()] = omp_get_thread_num();
                     }
-
-                    // No actions apply to people who are dead
-                    if(personVec[id]->getStatus() != dead){
-                        // Move people
-                        personVec[id]->moveBy(move_distr(generator), move_distr(generator), max_x, max_y);
-                        // #ifdef _WIN32
-                       	// can.sleepFor(sleepTime);
-						// #elif __CYGWIN__
-                        // can.sleepFor(sleepTime);
-                    
-                        // INFECTED
-                        if(personVec[id]->getStatus() == infected){
-                            // DEATH: check if the person has died
-                            if(personVec[id]->willDie() and 
-                               personVec[id]->getNumDaysTillDead() == personVec[id]->getNumDaysInfected()){
-                                #pragma omp atomic update
-                                --num_currently_infected;
-                                #pragma omp atomic update
-                                ++total_num_deaths;
-                                personVec[id]->die(can);
-                            }
-                            // RECOVERY: check if person has been infected for the duration of the disease
-                            else if( !personVec[id]->willDie() and personVec[id]->getNumDaysInfected() >= sickDuration){
-                                #pragma omp atomic update
-                                --num_currently_infected;
-                                #pragma omp atomic update
-                                ++total_num_recoveries;
-                                personVec[id]->recover(can);
-                            }
-                            // STILL INFECTED: if not dead or recovered, increase number of days infected by 1
-                            else{
-                                personVec[id]->increaseNumDaysInfected();
-                            }
-                        }
-
-                        // SUSCEPTIBLE
-                        if(personVec[id]->getStatus() == susceptible){
-                            // Check if the person is within an infected radius
-                            if(personVec[id]->checkIfInfectedNearby(personVec)){
-                                #pragma omp atomic update
-                                ++total_num_infection_attempts;
-                                // Determine if the person has been infected
-                                if(personVec[id]->determineIfInfected(can, contagiousFactor, chance_distr(generator))){
-                                    #pragma omp atomic update
-                                    --num_susceptible;
-                                    #pragma omp atomic update
-                                    ++num_currently_infected;
-                                    #pragma omp atomic update
-                                    ++total_num_infections;
-                                    personVec[id]->determineIsToDie(mortalityFactor, chance_distr(generator), sick_distr(generator));
-                                }
-                            }
+                    if(after.x[i] != before.x[i] || after.y[i] != before.y[i]){
+                        personVec[i]->moveTo(after.x[i], after.y[i]);
+                    }
+                    if(after.status[i] != before.status[i]){
+                        switch(after.status[i]){
+                            case infected : personVec[i]->infect(can); break;
+                            case immune : personVec[i]->recover(can); break;
+                            case dead : personVec[i]->die(can); break;
+                            default: personVec[i]->setStatus(after.status[i]);
                         }
                     }
-                } // end main parallel block
+                }
                 //------------------------------------- Parallel Block End ---------------------------------------
 
             }   // end simulation while loop
             complete = true;
-            if(printInfo){
-                // CALCULATIONS //
-                if(total_num_infection_attempts != 0){  // To avoid a divide-by-zero error (in case there were no infection attempts)
-                    true_contagiousness = (total_num_infections/static_cast<float>(total_num_infection_attempts)) * 100.0;
-                }
-                if(total_num_infections != 0){  // To avoid a divide-by-zero error (in case there were no infection attempts)
-                    true_mortality = (total_num_deaths/static_cast<float>(total_num_infections)) * 100.0;
-                }
-                for(unsigned i = 0; i < personVec.size(); ++i){
-                    avgInfectionLength += personVec[i]->getNumDaysInfected();
-                }
-                avgInfectionLength /= total_num_infections;
-
-
-                // OUTPUT //
-                printf("\n***********************\
-                        \n* Statistics and data *\
-                        \n***********************\
-                        \n\
-                        \n*** Herd immunity achieved in %d days ***\
-                        \nSusceptible: %d\
-                        \nImmune: %d\
-                        \nDead: %d\
-                        \n", numDays, num_susceptible, 
-                             total_num_recoveries, total_num_deaths);
-                printf("\n*** Statistics ***\
-                        \nTotal number of infections: %d\
-                        \nTotal number of deaths: %d\
-                        \nTotal number of recoveries: %d\
-                        \nTrue contagiousness: %.2f%%\
-                        \nTrue mortality rate: %.2f%%\
-                        \n", total_num_infections, total_num_deaths, total_num_recoveries,
-                                true_contagiousness, true_mortality);
-
-                // Print thread attendance
-                if(takeAttendance){
-                    printf("\n*** Thread Attendance (-1 if absent) ***");
-                    for(unsigned i = 0; i < threadAttendance.size(); ++i){
-                        if(i%10 == 0){
-                            printf("\n");
-                        }
-                        printf("%5d", threadAttendance[i]);
+
+            // OUTPUT //
+            printStats(model);
+
+            // Print worker attendance
+            if(takeAttendance){
+                printf("\n*** Worker Attendance (-1 if absent) ***");
+                for(unsigned i = 0; i < workerAttendance.size(); ++i){
+                    if(i%10 == 0){
+                        printf("\n");
                     }
-                    printf("\n");
+                    printf("%5d", workerAttendance[i]);
                 }
-
-                printInfo = false;
-            }   // end output
+                printf("\n");
+            }
 
         }	// end "complete" if
 
@@ -337,11 +288,20 @@ void pandemicFunction(Canvas& can, int argc, char* argv[]) {
     }
     delete dayText;
     personVec.clear();
-    threadAttendance.clear();
 
 }
 
 int main(int argc, char* argv[]){
-    Canvas c(0, -1, 620, 620, "Pandemic Simulation", BLACK);
+    // Parse a copy of the arguments, since the parser may rearrange them
+    std::vector<char*> args(argv, argv + argc);
+    int argCount = argc;
+    char** argCopy = args.data();
+    auto result = parse(argCount, argCopy);
+    if(result["benchmark"].as<int>() > 0){
+        pandemicBenchmark(result);
+        return 0;
+    }
+
+    Canvas c(0, -1, WINDOW_SIZE, WINDOW_SIZE, "Pandemic Simulation", BLACK);
     c.run(pandemicFunction, argc, argv);
 }
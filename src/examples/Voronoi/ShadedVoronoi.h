@@ -16,17 +16,16 @@
  * \see Voronoi class.
  */
 class ShadedVoronoi : public Voronoi {
-private:
-  int * myKValue2;
 public:
 
   /*!
    * \brief Explicitly construct a ShadedVoronoi object.
    * \details Explicit constructor for a ShadedVoronoi object.
    * \param can Reference to the Canvas to draw to.
+   * \param points Number of control points (defaults to 400).
    * \return The constructed ShadedVoronoi object.
    */
-  ShadedVoronoi(Canvas& can);
+  ShadedVoronoi(Canvas& can, int points = MY_POINTS);
 
   /*!
    * \brief Draw the ShadedVoronoi object.
@@ -6,63 +6,60 @@
 
 using namespace tsgl;
 
-Voronoi::Voronoi(Canvas& can) {
+Voronoi::Voronoi(Canvas& can, int points) : myGrid(can.getWindowWidth(), can.getWindowHeight(), points) {
   const int WW = can.getWindowWidth(),      // Set the screen sizes
         WH = can.getWindowHeight();
-  // srand(time(NULL));
-  myX = new int[MY_POINTS]();
-  myY = new int[MY_POINTS]();
-  myKValue = new int[WW * WH]();
-  for (int i = 0; i < MY_POINTS; i++) {              // Randomize the control points
-    myX[i] = saferand(-WW/2, WW/2);
-    myY[i] = saferand(-WH/2, WH/2);
-  }
-  // srand(time(NULL));
+  myWidth = WW;
+  myHeight = WH;
+  myPoints = points;
+  myFrame.resize(WW * WH);
+  for (int i = 0; i < myPoints; i++)                 // Randomize the control points
+    myGrid.addSite(saferand(0, WW - 1), saferand(0, WH - 1));
   myTC = Colors::randomColor(1.0f);                            // Randomize the axis colors
   myRC = Colors::randomColor(1.0f);
   myLC = Colors::randomColor(1.0f);
   myBC = Colors::randomColor(1.0f);
-  for (int j = 0; j < MY_POINTS; j++) {              // For each control point...
-    float xx = (float) myX[j] / WW + 0.5;         // Calculate an value from 0:1 based on x coord
-    float yy = (float) myY[j] / WH + 0.5;         // Do the same for y
+  for (int j = 0; j < myPoints; j++) {               // For each control point...
+    float xx = myGrid.getSiteX(j) / WW;              // Calculate an value from 0:1 based on x coord
+    float yy = myGrid.getSiteY(j) / WH;              // Do the same for y
     myXC = Colors::blend(myLC, myRC, xx);              // Interpolate between the left and right colors
     myYC = Colors::blend(myTC, myBC, yy);              // Do the same for top and bottom
-    myColor[j] = Colors::blend(myXC, myYC, 0.5f);      // Complete the 4-way interpolation
+    myColor.push_back(Colors::packRgba8(Colors::blend(myXC, myYC, 0.5f)));  // Complete the 4-way interpolation
   }
+}
 
+void Voronoi::upload(Canvas& can, int x0, int y0, int x1, int y1) {
+  const uint32_t* topLeft = &myFrame[(myHeight - y1) * myWidth + x0];
+  can.getBackground()->drawPixels(x0 - myWidth/2, y1 - 1 - myHeight/2, x1 - x0, y1 - y0,
+                                  (const uint8_t*) topLeft, myWidth * 4);
 }
 
 void Voronoi::draw(Canvas& can) {
-  const int WW = can.getWindowWidth(),      // Set the screen sizes
-        WH = can.getWindowHeight();
-  Background * bg = can.getBackground();
-  int myBestK = 0;                                  // Keep track of the current best k-value
-  float myBDist, myDist, myXD, myYD;                      // Keep track of the closes matches and current distances
-  #pragma omp parallel for private(myBDist, myXD, myYD, myDist, myBestK)
-  for (int i = -WW/2; i < WW/2; i++) {            // For each individual point...
-    myBestK = 0;
-    for (int j = -WH/2; j < WH/2; j++) {
-      myBDist = 9999;                           // Reset the best distance
-      for (int k = 0; k < MY_POINTS; k++) {      // Find the closest control point
-        myXD = i - myX[k];                      // Calculate the distance from each control point
-        myYD = j - myY[k];
-        myDist = sqrt(myXD * myXD + myYD * myYD);
-        if (myDist < myBDist) {                 // If it's the closest one
-          myBDist = myDist;                   // Update the best distance and control point
-          myBestK = k;
-        }
-      }
-      myKValue[(i + WW/2) * WH + (j + WH/2)] = myBestK;
-      bg->drawPixel(i, j, myColor[myBestK]);      // Draw the point with the closest control's color
-      if (!can.isOpen()) break;
-    }
+  myGrid.compute();
+  int x0, y0, x1, y1;
+  myGrid.takeDirtyRect(x0, y0, x1, y1);
+  const int* owners = myGrid.getOwners();
+  #pragma omp parallel for
+  for (int y = 0; y < myHeight; y++) {              // Color each pixel with its closest control point's color
+    uint32_t* row = &myFrame[(myHeight - 1 - y) * myWidth];
+    for (int x = 0; x < myWidth; x++)
+      row[x] = myColor[owners[y * myWidth + x]];
   }
+  upload(can, 0, 0, myWidth, myHeight);
 }
 
-Voronoi::~Voronoi() {
-  delete [] myX;
-  delete [] myY;
-  delete [] myKValue;
-  myX = myY = myKValue = NULL;
+void Voronoi::moveSite(Canvas& can, int k, float x, float y) {
+  myGrid.moveSite(k, x, y);
+  int x0, y0, x1, y1;
+  if (!myGrid.takeDirtyRect(x0, y0, x1, y1))
+    return;
+  const int* owners = myGrid.getOwners();
+  for (int py = y0; py < y1; py++) {
+    uint32_t* row = &myFrame[(myHeight - 1 - py) * myWidth];
+    for (int px = x0; px < x1; px++)
+      row[px] = myColor[owners[py * myWidth + px]];
+  }
+  upload(can, x0, y0, x1, y1);
 }
 
+Voronoi::~Voronoi() { }
@@ -9,8 +9,10 @@
 #include <iostream>
 #include <omp.h>
 #include <queue>
+#include <vector>
 #include <tsgl.h>
 #include "Util.h"
+#include "VoronoiGrid.h"
 
 using namespace tsgl;
 
@@ -18,25 +20,39 @@ using namespace tsgl;
  * \class Voronoi
  * \brief A Voronoi diagram.
  * \details Creates a Voronoi diagram to be drawn onto a Canvas.
+ * \details The nearest control point of every pixel is found with a VoronoiGrid, and the whole diagram is
+ *   uploaded to the Background as one RGBA frame rather than pixel by pixel.
  * \see http://en.wikipedia.org/wiki/Voronoi_diagram.
  */
 class Voronoi {
 protected:
   static const int MY_POINTS = 100 * 4;
-  int * myX;
-  int * myY;
-  int * myKValue;
-  ColorFloat myColor[MY_POINTS];                 // And for an array of colors
+  int myPoints;                                  // Number of control points
+  VoronoiGrid myGrid;                            // Control points and the nearest one to each pixel
+  std::vector<uint32_t> myColor;                 // Packed RGBA8 color of each control point
+  std::vector<uint32_t> myFrame;                 // RGBA8 frame, top row first
   ColorFloat myTC, myRC, myLC, myBC, myXC, myYC; // Color for the top, right, left, bottom, x-average, and y-average
+  int myWidth, myHeight;
+
+  /*!
+   * \brief Uploads part of the frame to the Canvas.
+   * \param can Reference to the Canvas to draw to.
+   * \param x0 Leftmost column to upload.
+   * \param y0 Lowest row to upload (0 is the bottom of the window).
+   * \param x1 One past the rightmost column to upload.
+   * \param y1 One past the highest row to upload.
+   */
+  void upload(Canvas& can, int x0, int y0, int x1, int y1);
 public:
 
   /*!
    * \brief Explicitly construct a Voronoi object.
    * \details Explicit constructor for a Voronoi object.
    * \param can Reference to the Canvas to draw to.
+   * \param points Number of control points (defaults to 400).
    * \return The constructed Voronoi object.
    */
-  Voronoi(Canvas& can);
+  Voronoi(Canvas& can, int points = MY_POINTS);
 
   /*!
    * \brief Draw the Voronoi object.
@@ -45,6 +61,27 @@ public:
    */
   void draw(Canvas& can);
 
+  /*!
+   * \brief Move one control point and redraw only what changed.
+   * \details Lets the VoronoiGrid update just the affected cells, then uploads the rectangle it reports as dirty.
+   * \param can Reference to the Canvas to draw to.
+   * \param k Index of the control point to move.
+   * \param x New x coordinate, in pixels from the left of the window.
+   * \param y New y coordinate, in pixels from the bottom of the window.
+   * \note draw() must have been called first.
+   */
+  void moveSite(Canvas& can, int k, float x, float y);
+
+  /*!
+   * \brief Accessor for the number of control points.
+   */
+  int getPoints() const { return myPoints; }
+
+  /*!
+   * \brief Accessor for the underlying VoronoiGrid.
+   */
+  const VoronoiGrid& getGrid() const { return myGrid; }
+
   /*!
    * \brief Destroy a Voronoi object.
    * \details Destructor for a Voronoi object.
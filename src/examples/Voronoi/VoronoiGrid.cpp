@@ -0,0 +1,227 @@
+/*
+ * VoronoiGrid.cpp
+ */
+
+#include "VoronoiGrid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <omp.h>
+
+VoronoiGrid::VoronoiGrid(int w, int h, int expectedSites) {
+  width = w;
+  height = h;
+  if (expectedSites < 1) expectedSites = 1;
+  bucketSize = std::max(1.0f, sqrtf(2.0f * w * h / expectedSites));   // About two sites per bucket
+  bucketsX = (int) (w / bucketSize) + 1;
+  bucketsY = (int) (h / bucketSize) + 1;
+  buckets.resize(bucketsX * bucketsY);
+  owners.assign(w * h, -1);
+  visited.assign(w * h, 0);
+  visitStamp = 0;
+  dirtyX0 = dirtyY0 = 0;
+  dirtyX1 = dirtyY1 = 0;
+}
+
+int VoronoiGrid::bucketOf(float x, float y) const {
+  int bx = std::min(bucketsX - 1, std::max(0, (int) (x / bucketSize)));
+  int by = std::min(bucketsY - 1, std::max(0, (int) (y / bucketSize)));
+  return by * bucketsX + bx;
+}
+
+int VoronoiGrid::addSite(float x, float y) {
+  x = std::min((float) width - 1, std::max(0.0f, x));
+  y = std::min((float) height - 1, std::max(0.0f, y));
+  int k = siteX.size();
+  siteX.push_back(x);
+  siteY.push_back(y);
+  buckets[bucketOf(x, y)].push_back(k);
+  boxes.push_back(width); boxes.push_back(height);    // Empty box
+  boxes.push_back(-1);    boxes.push_back(-1);
+  return k;
+}
+
+void VoronoiGrid::grow(int k, int x, int y) {
+  int* box = &boxes[4 * k];
+  if (x < box[0]) box[0] = x;
+  if (y < box[1]) box[1] = y;
+  if (x > box[2]) box[2] = x;
+  if (y > box[3]) box[3] = y;
+}
+
+void VoronoiGrid::markDirty(int x0, int y0, int x1, int y1) {
+  if (x0 >= x1 || y0 >= y1) return;
+  if (dirtyX0 >= dirtyX1 || dirtyY0 >= dirtyY1) {
+    dirtyX0 = x0; dirtyY0 = y0; dirtyX1 = x1; dirtyY1 = y1;
+  } else {
+    dirtyX0 = std::min(dirtyX0, x0); dirtyY0 = std::min(dirtyY0, y0);
+    dirtyX1 = std::max(dirtyX1, x1); dirtyY1 = std::max(dirtyY1, y1);
+  }
+}
+
+bool VoronoiGrid::takeDirtyRect(int& x0, int& y0, int& x1, int& y1) {
+  x0 = dirtyX0; y0 = dirtyY0; x1 = dirtyX1; y1 = dirtyY1;
+  dirtyX0 = dirtyY0 = dirtyX1 = dirtyY1 = 0;
+  return x0 < x1 && y0 < y1;
+}
+
+int VoronoiGrid::nearest(float x, float y) const {
+  int first, second;
+  nearestTwo(x, y, first, second);
+  return first;
+}
+
+void VoronoiGrid::nearestTwo(float x, float y, int& first, int& second) const {
+  const int home = bucketOf(x, y), bx = home % bucketsX, by = home / bucketsX;
+  const int maxRing = std::max(bucketsX, bucketsY);
+  float best = FLT_MAX, next = FLT_MAX;
+  first = second = -1;
+  for (int r = 0; r <= maxRing; ++r) {
+    // Every bucket in ring r is at least (r - 1) buckets away, so stop once both matches are closer than that
+    float reach = (r - 1) * bucketSize;
+    if (r > 0 && reach > 0 && next <= reach * reach)
+      break;
+    for (int j = by - r; j <= by + r; ++j) {
+      if (j < 0 || j >= bucketsY) continue;
+      const bool edgeRow = (j == by - r || j == by + r);
+      for (int i = bx - r; i <= bx + r; i += (edgeRow ? 1 : 2 * r)) {
+        if (i >= 0 && i < bucketsX) {
+          const std::vector<int>& bucket = buckets[j * bucketsX + i];
+          for (unsigned n = 0; n < bucket.size(); ++n) {
+            const int k = bucket[n];
+            const float dx = x - siteX[k], dy = y - siteY[k];
+            const float d = dx * dx + dy * dy;
+            if (d < best) {
+              next = best; second = first;
+              best = d; first = k;
+            } else if (d < next) {
+              next = d; second = k;
+            }
+          }
+        }
+        if (r == 0) break;
+      }
+    }
+  }
+}
+
+void VoronoiGrid::compute() {
+  const int tilesX = (width + TILE - 1) / TILE, tilesY = (height + TILE - 1) / TILE;
+  #pragma omp parallel
+  {
+    std::vector<int> candidates;
+    std::vector<float> candX, candY;
+    #pragma omp for schedule(dynamic)
+    for (int t = 0; t < tilesX * tilesY; ++t) {
+      const int x0 = (t % tilesX) * TILE, y0 = (t / tilesX) * TILE;
+      const int x1 = std::min(width, x0 + TILE), y1 = std::min(height, y0 + TILE);
+      // Only sites within (distance from the tile's center to its nearest site + one tile diagonal)
+      // of the center can be nearest to any pixel of the tile
+      const float cx = (x0 + x1 - 1) * 0.5f, cy = (y0 + y1 - 1) * 0.5f;
+      const int n = nearest(cx, cy);
+      if (n < 0) continue;
+      const float diagonal = sqrtf((float) (x1 - x0) * (x1 - x0) + (float) (y1 - y0) * (y1 - y0));
+      const float reach = sqrtf((cx - siteX[n]) * (cx - siteX[n]) + (cy - siteY[n]) * (cy - siteY[n])) + diagonal;
+      const int b0 = bucketOf(cx - reach, cy - reach), b1 = bucketOf(cx + reach, cy + reach);
+      candidates.clear(); candX.clear(); candY.clear();
+      for (int j = b0 / bucketsX; j <= b1 / bucketsX; ++j)
+        for (int i = b0 % bucketsX; i <= b1 % bucketsX; ++i) {
+          const std::vector<int>& bucket = buckets[j * bucketsX + i];
+          for (unsigned m = 0; m < bucket.size(); ++m) {
+            const int k = bucket[m];
+            const float dx = cx - siteX[k], dy = cy - siteY[k];
+            if (dx * dx + dy * dy <= reach * reach) {
+              candidates.push_back(k);
+              candX.push_back(siteX[k]);
+              candY.push_back(siteY[k]);
+            }
+          }
+        }
+      const int count = candidates.size();
+      for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x) {
+          float best = FLT_MAX;
+          int bestIndex = 0;
+          for (int c = 0; c < count; ++c) {
+            const float dx = x - candX[c], dy = y - candY[c];
+            const float d = dx * dx + dy * dy;
+            if (d < best) { best = d; bestIndex = c; }
+          }
+          owners[y * width + x] = candidates[bestIndex];
+        }
+    }
+  }
+  for (unsigned k = 0; k < siteX.size(); ++k) {
+    boxes[4 * k] = width; boxes[4 * k + 1] = height;
+    boxes[4 * k + 2] = boxes[4 * k + 3] = -1;
+  }
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      if (owners[y * width + x] >= 0)
+        grow(owners[y * width + x], x, y);
+  markDirty(0, 0, width, height);
+}
+
+void VoronoiGrid::moveSite(int k, float x, float y) {
+  x = std::min((float) width - 1, std::max(0.0f, x));
+  y = std::min((float) height - 1, std::max(0.0f, y));
+  std::vector<int>& oldBucket = buckets[bucketOf(siteX[k], siteY[k])];
+  oldBucket.erase(std::find(oldBucket.begin(), oldBucket.end(), k));
+  siteX[k] = x; siteY[k] = y;
+  buckets[bucketOf(x, y)].push_back(k);
+
+  // Give the pixels the site used to own to whichever site is now nearest (possibly still k)
+  int* box = &boxes[4 * k];
+  const int ox0 = box[0], oy0 = box[1], ox1 = box[2], oy1 = box[3];
+  box[0] = width; box[1] = height; box[2] = box[3] = -1;
+  for (int py = oy0; py <= oy1; ++py)
+    for (int px = ox0; px <= ox1; ++px)
+      if (owners[py * width + px] == k) {
+        int n = nearest(px, py);
+        owners[py * width + px] = n;
+        grow(n, px, py);
+      }
+  markDirty(ox0, oy0, ox1 + 1, oy1 + 1);
+
+  // Flood outward from the new position, claiming every pixel that is now closer to k. Voronoi cells are convex, but
+  // the pixels inside a thin one need not touch each other, so the flood also passes through (without claiming)
+  // pixels within half a pixel diagonal of k's side of the bisector with their owner: the pixels whose squares meet
+  // the cell always touch. It is seeded with every pixel around the site, not just the one the site rounds to,
+  // since a neighbouring site may be nearer to that one.
+  if (++visitStamp == 0) {
+    std::fill(visited.begin(), visited.end(), 0);
+    visitStamp = 1;
+  }
+  queue.clear();
+  const int sx = (int) x, sy = (int) y;
+  for (int py = std::max(0, sy - 1); py <= std::min(height - 1, sy + 2); ++py)
+    for (int px = std::max(0, sx - 1); px <= std::min(width - 1, sx + 2); ++px) {
+      visited[py * width + px] = visitStamp;
+      queue.push_back(py * width + px);
+    }
+  for (unsigned head = 0; head < queue.size(); ++head) {
+    const int p = queue[head], px = p % width, py = p / width;
+    const int o = owners[p];
+    if (o != k && o >= 0) {
+      const float dx = px - x, dy = py - y;
+      const float ox = px - siteX[o], oy = py - siteY[o];
+      const float margin = ox * ox + oy * oy - (dx * dx + dy * dy);    // Twice the distance past the bisector,
+      if (margin > 0) {                                                 // times the distance between the sites
+        owners[p] = k;
+        grow(k, px, py);
+      } else if (margin <= -1.4142135f * hypotf(siteX[o] - x, siteY[o] - y)) {
+        continue;
+      }
+    } else {
+      grow(k, px, py);
+    }
+    for (int ny = std::max(0, py - 1); ny <= std::min(height - 1, py + 1); ++ny)
+      for (int nx = std::max(0, px - 1); nx <= std::min(width - 1, px + 1); ++nx)
+        if (visited[ny * width + nx] != visitStamp) {
+          visited[ny * width + nx] = visitStamp;
+          queue.push_back(ny * width + nx);
+        }
+  }
+  markDirty(box[0], box[1], box[2] + 1, box[3] + 1);
+}
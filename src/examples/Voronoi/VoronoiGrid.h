@@ -0,0 +1,128 @@
+/*
+ * VoronoiGrid.h
+ */
+
+#ifndef VORONOIGRID_H_
+#define VORONOIGRID_H_
+
+#include <vector>
+
+/*!
+ * \class VoronoiGrid
+ * \brief Computes which site is nearest to every pixel of a W x H image.
+ * \details Sites are bucketed into a uniform grid sized so that each bucket holds about two sites. A nearest-site
+ *   query then only visits the rings of buckets around the query point that could still hold something closer,
+ *   comparing squared distances, so a full image costs about O(W*H) instead of O(W*H*K) for K sites.
+ * \details compute() splits the image into square tiles that are processed in parallel with OpenMP. Each tile first
+ *   gathers the few sites that could possibly be nearest to any of its pixels, then scans just those for every pixel.
+ * \details Moving a single site with moveSite() only recomputes the pixels it used to own and flood-fills the
+ *   pixels it now claims, and reports the rectangle that changed so that only that part needs to be redrawn.
+ * \details Pixel (x, y) is stored at index <code>y * width + x</code> and sampled at the point (x, y).
+ */
+class VoronoiGrid {
+private:
+  static const int TILE = 32;
+
+  int width, height;
+  float bucketSize;
+  int bucketsX, bucketsY;
+  std::vector<float> siteX, siteY;
+  std::vector< std::vector<int> > buckets;
+  std::vector<int> owners;
+  std::vector<int> boxes;               // Conservative bounding box of every site's pixels: minX, minY, maxX, maxY
+  std::vector<unsigned> visited;
+  std::vector<int> queue;
+  unsigned visitStamp;
+  int dirtyX0, dirtyY0, dirtyX1, dirtyY1;
+
+  int bucketOf(float x, float y) const;
+  void grow(int k, int x, int y);
+  void markDirty(int x0, int y0, int x1, int y1);
+public:
+
+  /*!
+   * \brief Explicitly constructs a VoronoiGrid.
+   * \param w Width of the image in pixels.
+   * \param h Height of the image in pixels.
+   * \param expectedSites About how many sites will be added; used to size the buckets.
+   */
+  VoronoiGrid(int w, int h, int expectedSites);
+
+  /*!
+   * \brief Adds a site.
+   * \details The site does not own any pixels until the next compute().
+   * \param x The x coordinate of the site, clamped to the image.
+   * \param y The y coordinate of the site, clamped to the image.
+   * \return The index of the new site.
+   */
+  int addSite(float x, float y);
+
+  /*!
+   * \brief Accessor for the number of sites.
+   */
+  int getSiteCount() const { return siteX.size(); }
+
+  /*!
+   * \brief Accessor for a site's x coordinate.
+   */
+  float getSiteX(int k) const { return siteX[k]; }
+
+  /*!
+   * \brief Accessor for a site's y coordinate.
+   */
+  float getSiteY(int k) const { return siteY[k]; }
+
+  /*!
+   * \brief Recomputes the nearest site of every pixel.
+   * \details Tiles of the image are distributed across OpenMP threads. The whole image is marked dirty.
+   */
+  void compute();
+
+  /*!
+   * \brief Moves a site and incrementally updates the pixels that changed owner.
+   * \details Pixels the site used to own are searched again, and the pixels it now claims are found by flood-filling
+   *   outward from its new position, so the cost is proportional to the size of its old and new cells.
+   * \param k Index of the site to move.
+   * \param x The new x coordinate of the site, clamped to the image.
+   * \param y The new y coordinate of the site, clamped to the image.
+   * \note Requires a prior call to compute().
+   */
+  void moveSite(int k, float x, float y);
+
+  /*!
+   * \brief Finds the site nearest to a point.
+   * \return The index of the nearest site, or -1 if there are no sites.
+   */
+  int nearest(float x, float y) const;
+
+  /*!
+   * \brief Finds the two sites nearest to a point.
+   * \param x The x coordinate of the point.
+   * \param y The y coordinate of the point.
+   * \param first Set to the index of the nearest site (or -1).
+   * \param second Set to the index of the second nearest site (or -1).
+   */
+  void nearestTwo(float x, float y, int& first, int& second) const;
+
+  /*!
+   * \brief Accessor for the nearest site of a pixel, as of the last compute() or moveSite().
+   */
+  int getOwner(int x, int y) const { return owners[y * width + x]; }
+
+  /*!
+   * \brief Accessor for the whole owner map, <code>width * height</code> site indices in row-major order.
+   */
+  const int* getOwners() const { return &owners[0]; }
+
+  /*!
+   * \brief Reports and resets the rectangle of pixels whose owner may have changed.
+   * \param x0 Set to the leftmost dirty column.
+   * \param y0 Set to the lowest dirty row.
+   * \param x1 Set to one past the rightmost dirty column.
+   * \param y1 Set to one past the highest dirty row.
+   * \return False if nothing has changed since the last call.
+   */
+  bool takeDirtyRect(int& x0, int& y0, int& x1, int& y1);
+};
+
+#endif /* VORONOIGRID_H_ */
@@ -1,32 +1,27 @@
 /*
  * testVoronoi.cpp
  *
- * Usage: ./testVoronoi <width> <height>
+ * Usage: ./testVoronoi <width> <height> <points>
  */
 
 /* testVoronoi.cpp contains multiple functions that display a Voronoi diagram in similar fashions. */
 
+#include <cfloat>
+
 #include "Voronoi.h"
 #include "ShadedVoronoi.h"
 
 using namespace tsgl;
 
 /*!
- * \brief Draws a randomly generated Voronoi diagram, using OMP and private variables
+ * \brief Draws a randomly generated Voronoi diagram, using OMP
  * ( see http://en.wikipedia.org/wiki/Voronoi_diagram ).
  * \details
  * - The data and methods for drawing are stored in a class.
  * - When you create an instance of the class:
  *    - The Canvas's dimensions are stored in local constants.
- *    - The number of control points are predetermined and stored a protected class instance variable.
- *    - We seed the random number generator with the time.
- *    - We allocate arrays for x and y coordinates for each of the points.
- *    - We allocate an array of k-values for each pixel on the Canvas.
- *    - For each control point:
- *      - Fill the x-coordinate and y-coordinate arrays with random values (thereby randomizing the locations
- *        of the control points).
- *      .
- *    - Seed the random number generator again with the time.
+ *    - The number of control points defaults to a protected class constant.
+ *    - The control points are added at random locations to a VoronoiGrid, which buckets them by position.
  *    - We initialize variables for the top, right, left, and bottom corner colors.
  *    - For each control point:
  *      - We get its x coordinate and y coordinate.
@@ -36,22 +31,11 @@ using namespace tsgl;
  *      .
  *   .
  * - When you draw:
- *    - The best k-value is initially set to 0.
- *    - We initialize variables keeping track of the best and current distances.
- *    - We start a parallel OMP block, allowing the system to determine the best means of parallelization.
- *    - For each column, we set the best k to 0. Then:
- *      - For each row:
- *        - Reset the best distance to a large value.
- *        - For each control point:
- *          - We calculate the distance from row,col to the control point.
- *          - If this distance is less than the best distance, we update the best distance and best-k
- *            (best point).
- *          - We set the k-value for row,col to the best-k.
- *          - We draw a pixel at row,col with the best-k's point color.
- *          - If we closed the Canvas, break.
- *          .
- *        .
- *      .
+ *    - The VoronoiGrid splits the window into tiles and handles them in parallel with OMP.
+ *    - For each tile, it gathers the few control points that could be closest to any pixel in it
+ *      (by looking only at nearby buckets), then finds the closest of those for each pixel.
+ *    - Each pixel of an RGBA frame is set to its closest control point's color.
+ *    - The whole frame is handed to the Background in a single drawPixels() call.
  *    .
  * .
  * \param can Reference to the Canvas being drawn to.
@@ -65,15 +49,12 @@ void voronoiFunction(Canvas& can) {
  * \brief Draws a randomly generated Voronoi diagram with fancy shading.
  * \details Same principle as voronoiFunction(). Also has a class.
  * - Key differences:
- * - We keep track of the second best distance to each point in \b nbdist.
- * - We keep track of the kvalues of each 2nd best point in the array \b kvalue2.
- * - In a second post-processing loop through the screen:
- *   - Find the closest and 2nd closest control points to each pixel.
+ * - For each pixel (rows in parallel):
+ *   - Ask the VoronoiGrid for the closest and 2nd closest control points to the pixel.
  *   - Find the distance from the pixel to the closest control point and store it in: \b d1.
  *   - Find the distance from the closest to the 2nd closest control point and store it in: \b kd.
- *   - Set \b shading to ( \b d1 / \b kd ).
- *   - Bind \b shading between 0 and 1, and shade the pixel with \b shading.
- *   - Break if the Canvas is closed.
+ *   - Set \b shading to sqrt( \b d1 / \b kd ).
+ *   - Bind \b shading between 0 and 1, and darken the closest control point's color by \b shading.
  *   .
  * .
  * \param can Reference to the Canvas being drawn to.
@@ -83,12 +64,94 @@ void shadedVoronoiFunction(Canvas& can) {
   s1.draw(can);
 }
 
+/*!
+ * \brief Animates a Voronoi diagram with thousands of control points, a few of which wander around.
+ * \details
+ * - Create a Voronoi object with \b points control points and draw it once.
+ * - Give the first few control points random velocities.
+ * - While the Canvas is open:
+ *   - Sleep the internal timer until the next draw cycle.
+ *   - Move each wandering control point, bouncing it off the edges of the window.
+ *   - The VoronoiGrid only recomputes the cells around the moved point, and only the rectangle that
+ *     changed is uploaded to the Background.
+ *   .
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param points Number of control points.
+ */
+void animatedVoronoiFunction(Canvas& can, int points) {
+  const int WW = can.getWindowWidth(), WH = can.getWindowHeight();
+  const int WANDERERS = 16;
+  Voronoi v(can, points);
+  v.draw(can);
+  Random& rng = Random::local();
+  float vx[WANDERERS], vy[WANDERERS];
+  for (int i = 0; i < WANDERERS; i++) {
+    vx[i] = rng.uniformFloat(-4, 4);
+    vy[i] = rng.uniformFloat(-4, 4);
+  }
+  while (can.isOpen()) {
+    can.sleep();
+    for (int i = 0; i < WANDERERS && i < v.getPoints(); i++) {
+      float x = v.getGrid().getSiteX(i) + vx[i], y = v.getGrid().getSiteY(i) + vy[i];
+      if (x < 0 || x > WW - 1) vx[i] = -vx[i];
+      if (y < 0 || y > WH - 1) vy[i] = -vy[i];
+      v.moveSite(can, i, x, y);
+    }
+  }
+}
+
+/*!
+ * \brief Checks the VoronoiGrid against a brute-force search, after computing it and after moving sites.
+ * \details
+ * - Scatter \b points sites at random fractional positions over a \b width x \b height grid and compute it.
+ * - Move random sites by random fractional amounts of up to 4 pixels, as animatedVoronoiFunction() does, \b moves
+ *   times.
+ * - For every pixel, compare the distance to the site the grid says owns it with the distance to the nearest of all
+ *   the sites. Ties may go either way, so only a farther owner counts as wrong.
+ * .
+ * \param width Width of the grid.
+ * \param height Height of the grid.
+ * \param points Number of sites.
+ * \param moves Number of sites to move.
+ * \return The number of pixels owned by a site that is not the nearest.
+ */
+int checkVoronoiGrid(int width, int height, int points, int moves) {
+  Random& rng = Random::local();
+  VoronoiGrid grid(width, height, points);
+  for (int i = 0; i < points; i++)
+    grid.addSite(rng.uniformFloat(0, width - 1), rng.uniformFloat(0, height - 1));
+  grid.compute();
+  for (int i = 0; i < moves; i++) {
+    const int k = rng.uniformInt(0, points - 1);
+    grid.moveSite(k, grid.getSiteX(k) + rng.uniformFloat(-4, 4), grid.getSiteY(k) + rng.uniformFloat(-4, 4));
+  }
+  int wrong = 0;
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++) {
+      float best = FLT_MAX;
+      for (int k = 0; k < points; k++) {
+        const float dx = x - grid.getSiteX(k), dy = y - grid.getSiteY(k);
+        best = std::min(best, dx * dx + dy * dy);
+      }
+      const int o = grid.getOwner(x, y);
+      const float dx = x - grid.getSiteX(o), dy = y - grid.getSiteY(o);
+      if (dx * dx + dy * dy > best)
+        wrong++;
+    }
+  return wrong;
+}
+
 //Takes command line arguments for the width and height of the window
 int main(int argc, char* argv[]) {
   int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
   int h = (argc > 2) ? atoi(argv[2]) : w;
   if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
     w = h = 960;            //If not, set the width and height to a default value
+  //Check the incremental updates the animation relies on
+  const int wrong = checkVoronoiGrid(400, 300, 2000, 200);
+  std::cout << "VoronoiGrid check: " << wrong << " pixels not owned by their nearest site" << std::endl;
+
   //Normal Voronoi
   std::cout << "Regular Voronoi" << std::endl;
   Canvas c1(-1, -1, w, h, "Voronoi");
@@ -98,4 +161,11 @@ int main(int argc, char* argv[]) {
   std::cout << "Special Voronoi" << std::endl;
   Canvas c2(-1, -1, w, h, "Shaded Voronoi");
   c2.run(shadedVoronoiFunction);
+
+  //Animated Voronoi
+  int points = (argc > 3) ? atoi(argv[3]) : 5000;
+  if (points <= 0) points = 5000;
+  std::cout << "Animated Voronoi" << std::endl;
+  Canvas c3(-1, -1, w, h, "Animated Voronoi");
+  c3.run(animatedVoronoiFunction, points);
 }
@@ -2,6 +2,8 @@
  * testBlurImage.cpp
  *
  * Usage: ./testBlurImage <numThreads> <imagePath>
+ *
+ * Once the image is split, press G for a Gaussian blur, B for a box blur, or E to find edges.
  */
 
 #include <omp.h>
@@ -16,41 +18,75 @@ int depthtest(int xmin, int ymin, int xmax, int ymax) {
   return ((xd > yd) ? xd : yd);
 }
 
-bool blur(Background * bg, int xmin, int ymin, int xmax, int ymax, int&numdrawn, int depth) {
+bool blur(uint8_t* pixels, int width, int xmin, int ymin, int xmax, int ymax, int depth) {
   if (xmin > xmax || ymin > ymax)
 	  return false;
   if (depth > 0) {
     int xmid = (xmin+xmax)/2, ymid = (ymin+ymax)/2;
-    blur(bg,xmin,  ymin,  xmid,ymid,numdrawn, depth-1);
-    blur(bg,xmid+1,ymin,  xmax,ymid,numdrawn, depth-1);
-    blur(bg,xmin,  ymid+1,xmid,ymax,numdrawn, depth-1);
-    blur(bg,xmid+1,ymid+1,xmax,ymax,numdrawn, depth-1);
+    blur(pixels,width,xmin,  ymin,  xmid,ymid, depth-1);
+    blur(pixels,width,xmid+1,ymin,  xmax,ymid, depth-1);
+    blur(pixels,width,xmin,  ymid+1,xmid,ymax, depth-1);
+    blur(pixels,width,xmid+1,ymid+1,xmax,ymax, depth-1);
     return false;
   }
-  ColorFloat top = Colors::blend(bg->getPixel(xmin,ymin),bg->getPixel(xmax,ymin));
-  ColorFloat bot = Colors::blend(bg->getPixel(xmin,ymax),bg->getPixel(xmax,ymax));
+  const uint8_t *tl = &pixels[4*(ymin*width+xmin)], *tr = &pixels[4*(ymin*width+xmax)];
+  const uint8_t *bl = &pixels[4*(ymax*width+xmin)], *br = &pixels[4*(ymax*width+xmax)];
+  uint8_t color[3];
+  for (int c = 0; c < 3; ++c)
+    color[c] = (tl[c] + tr[c] + bl[c] + br[c]) / 4;
   for (int j = ymin; j <= ymax; ++j)
     for (int i = xmin; i <= xmax; ++i)
-      bg->drawPixel(i,j,Colors::blend(top,bot));
+      for (int c = 0; c < 3; ++c)
+        pixels[4*(j*width+i)+c] = color[c];
   return true;
 }
 
+//Filters the whole Background with the given ImageOps filter
+void filterBackground(Background * bg, std::function<void(uint8_t*,int,int)> filter) {
+  std::vector<uint8_t> pixels;
+  ImageOps::snapshot(bg, pixels);
+  filter(&pixels[0], bg->getWidth(), bg->getHeight());
+  ImageOps::upload(bg, &pixels[0]);
+}
+
 void blurImageFunction(Canvas& can, std::string fpath, int threads) {
   Background * bg = can.getBackground();
   int cww = can.getWindowWidth(), cwh = can.getWindowHeight();
   bg->drawImage(0,0,0,fpath,cww,cwh,0,0,0,1.0);
   int side = sqrt(threads);  //Square root of the number of threads, rounded down
+
+  can.bindToButton(TSGL_G, TSGL_PRESS, [bg]() {
+    filterBackground(bg, [](uint8_t* p, int w, int h) { ImageOps::gaussianBlur(p, w, h, 3.0f); });
+  });
+  can.bindToButton(TSGL_B, TSGL_PRESS, [bg]() {
+    filterBackground(bg, [](uint8_t* p, int w, int h) { ImageOps::boxBlur(p, w, h, 5); });
+  });
+  can.bindToButton(TSGL_E, TSGL_PRESS, [bg]() {
+    static const float edges[9] = { -1, -1, -1, -1, 8, -1, -1, -1, -1 };
+    filterBackground(bg, [](uint8_t* p, int w, int h) { ImageOps::convolve(p, w, h, edges, 3, 3); });
+  });
+
   can.sleepFor(0.5f);
+  std::vector<uint8_t> pixels;
+  ImageOps::snapshot(bg, pixels);
   #pragma omp parallel num_threads (side*side) //Make sure the actual number of threads is a square
   {
-	side=sqrt(omp_get_num_threads());  //Verify we actually have a workable number of threads
+    int tside = sqrt(omp_get_num_threads());  //Verify we actually have a workable number of threads
     int tid = omp_get_thread_num();
-    int ndrawn = 0, xblock = cww/side, yblock = cwh/side;
-    int xmin = (tid%side)*xblock - cww/2, ymin = (tid/side)*yblock - cwh/2;
-    int xmax = xmin+xblock; clamp(xmax,0,cww-1);
-    int ymax = ymin+yblock; clamp(ymax,0,cwh-1);
-    int depth = depthtest(xmin, ymin, xmin+xblock, ymin+yblock);
-    for (bool d = false; !d && can.isOpen(); d = blur(bg, xmin, ymin, xmax, ymax, ndrawn, depth--));
+    if (tid < tside*tside) {
+      int xblock = cww/tside, yblock = cwh/tside;
+      int xmin = (tid%tside)*xblock, ymin = (tid/tside)*yblock;
+      int xmax = (tid%tside == tside-1) ? cww-1 : xmin+xblock-1;
+      int ymax = (tid/tside == tside-1) ? cwh-1 : ymin+yblock-1;
+      int depth = depthtest(xmin, ymin, xmax+1, ymax+1);
+      //Each thread blurs its own block of the array, and draws the whole block once per pass
+      for (bool d = false; !d && can.isOpen(); ) {
+        d = blur(&pixels[0], cww, xmin, ymin, xmax, ymax, depth--);
+        bg->drawPixels(xmin - cww/2, cwh-1 - cwh/2 - ymin, xmax-xmin+1, ymax-ymin+1,
+                       &pixels[4*(ymin*cww+xmin)], 4*cww);
+        can.sleep();
+      }
+    }
   }
 }
 
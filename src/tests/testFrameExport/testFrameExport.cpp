@@ -0,0 +1,90 @@
+/*
+ * testFrameExport.cpp
+ *
+ * Usage: ./testFrameExport <width> <height>
+ *        ./testFrameExport read
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+const std::string EXPORT_NAME = "tsgl-test-frames";
+
+/*!
+ * \brief Draws a moving pattern and publishes every frame to shared memory.
+ * \details
+ * - Export the Canvas' frames under the name <code>tsgl-test-frames</code>.
+ * - While the Canvas is open, sleep the internal timer and move a ring of circles.
+ * - Run <code>./testFrameExport read</code> in another terminal to watch the frames arrive.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ */
+void frameExportFunction(Canvas& can) {
+    if (!can.exportFrames(EXPORT_NAME))
+        return;
+    const int CIRCLES = 12;
+    const float R = can.getWindowHeight() / 3;
+    std::vector<Circle*> circles;
+    for (int i = 0; i < CIRCLES; ++i) {
+        circles.push_back(new Circle(0, 0, 0, R / 6, 0, 0, 0, Colors::highContrastColor(i)));
+        can.add(circles.back());
+    }
+    while (can.isOpen()) {
+        can.sleep();
+        const float t = can.getTime();
+        for (int i = 0; i < CIRCLES; ++i) {
+            const float a = t + i * 2 * PI / CIRCLES;
+            circles[i]->setCenter(R * cos(a), R * sin(a), 0);
+        }
+    }
+    can.stopExport();
+    for (int i = 0; i < CIRCLES; ++i)
+        delete circles[i];
+}
+
+/*!
+ * \brief Reads the frames another process exports, as an encoder or monitor would.
+ * \details Reports once a second how many frames arrived, how many were skipped or overwritten while being
+ *   read, and the average brightness of the last frame, until the exporting Canvas closes.
+ */
+void frameReaderFunction() {
+    FrameReader reader;
+    if (!reader.open(EXPORT_NAME))
+        return;
+    ExportedFrame frame;
+    unsigned frames = 0, torn = 0;
+    double lastReport = -1;
+    while (reader.next(frame)) {
+        uint64_t sum = 0;
+        const size_t bytes = (size_t) frame.width * frame.height * 4;
+        for (size_t i = 0; i < bytes; i += 4)
+            sum += frame.pixels[i] + frame.pixels[i + 1] + frame.pixels[i + 2];
+        if (!reader.isValid(frame)) {
+            ++torn;
+            continue;
+        }
+        ++frames;
+        if (frame.time - lastReport >= 1) {
+            std::cout << "frame " << frame.sequence << " at " << frame.time << " s: " << frames << " read, "
+                      << reader.getSkipped() << " skipped, " << torn << " overwritten while read, brightness "
+                      << sum / (3.0 * frame.width * frame.height) << std::endl;
+            lastReport = frame.time;
+        }
+    }
+    std::cout << "The Canvas stopped exporting" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the window, or "read" to read another's frames
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "read") {
+      frameReaderFunction();
+      return 0;
+    }
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    Canvas c(-1, -1, w, h, "Frame Export", BLACK);
+    c.run(frameExportFunction);
+}
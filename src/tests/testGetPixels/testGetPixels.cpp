@@ -20,15 +20,12 @@ using namespace tsgl;
  * - Determine a block size for each thread based on the Canvas' height and the number
  *   of spawned threads.
  * - Determine a starting row for each thread based on \b blocksize and the thread's id.
+ * - Allocate a buffer for each thread's block of rows.
  * - While the Canvas is open:
- *   - For each row:
- *     - For each column:
- *       - Over each old pixel, draw a new pixel with each of the RGB components incremented
- *         and wrapped.
- *       .
- *     .
  *   - Sleep until the Canvas is ready to draw again.
- *   - Print the time between sleeps of the Canvas' internal timer.
+ *   - Copy the thread's block of the last frame into its buffer with one call to getPixels().
+ *   - Increment and wrap each of the RGB components of every pixel in the buffer.
+ *   - Draw the whole buffer back over the old block with one call to drawPixels().
  *   .
  * .
  *
@@ -44,14 +41,16 @@ void getPixelsFunction(Canvas& can, int threads) {
   {
     int blocksize = (double)height / omp_get_num_threads();
     int row = blocksize * omp_get_thread_num() - can.getWindowHeight()/2;
+    int top = row + blocksize - 1;
+    std::vector<uint8_t> block(4 * width * blocksize);
     while (can.isOpen()) {
       can.sleep();  //Removed the timer and replaced it with an internal timer in the Canvas class
-      for (int y = row; y < row + blocksize; y++) {
-        for (int x = -(width/2); x < width/2; x++) {
-          ColorInt c = bg->getPixel(x,y);
-          bg->drawPixel(x, y, ColorInt((1+c.R) % NUM_COLORS, (1+c.G) % NUM_COLORS, (1+c.B) % NUM_COLORS));
-        }
+      bg->getPixels(-(width/2), top, width, blocksize, &block[0]);
+      for (unsigned i = 0; i < block.size(); i++) {
+        if (i % 4 != 3)
+          block[i] = (1+block[i]) % NUM_COLORS;
       }
+      bg->drawPixels(-(width/2), top, width, blocksize, &block[0]);
     }
   }
 }
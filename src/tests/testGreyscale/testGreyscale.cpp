@@ -22,19 +22,15 @@ using namespace tsgl;
  * - Store the Canvas' dimensions for ease of use.
  * - Stretch a fancy image over the Canvas.
  * - Tell the internal timer to manually sleep for a quarter of a second (to assure the draw buffer is filled).
- * - Initialize a pointer to the Canvas' screen buffer.
+ * - Copy the whole image into an array of pixels with ImageOps::snapshot().
  * - Set up a parallel OMP block with \b threads threads.
  * - Get the actual number of spawned threads and store it in: \b nthreads.
  * - Compute the \b blocksize based on the Canvas height and \b nthreads.
  * - Compute the current thread's row based on \b blocksize and the thread's id.
  * - Generate a nice color based on the thread's id.
- * - Set a grayscale color variable to 0.
  * - For each row:
- *   - For each column:
- *     - Get the pixel color of a point of the Canvas.
- *     - Set a gray color variable to the average of the RGB components.
- *     - Draw the grayed point over the old point, and increment the index by one pixel.
- *     .
+ *   - Set every pixel of the row in the array to the average of its RGB components with ImageOps::greyscale().
+ *   - Draw the grayed row over the old row with a single call to drawPixels().
  *   - Break if the Canvas was closed.
  *   - Sleep until the Canvas is ready to render again.
  *   .
@@ -52,6 +48,8 @@ void greyScaleFunction(Canvas& can, int numberOfThreads) {
   const int WW = can.getWindowWidth(),WH = can.getWindowHeight();
   background->drawImage(0,0,0,"pics/colorful_cars.jpg", WW, WH, 0,0,0);
   can.sleepFor(0.25f);
+  std::vector<uint8_t> pixels;
+  ImageOps::snapshot(background, pixels);
   #pragma omp parallel num_threads(threads)
   {
     int nthreads = omp_get_num_threads();
@@ -60,11 +58,9 @@ void greyScaleFunction(Canvas& can, int numberOfThreads) {
     ColorFloat color = Colors::highContrastColor(omp_get_thread_num());
     color.A = 0.6;
     for (int y = row; y < row + blocksize; y++) {
-      for (int x = -WW / 2; x < WW / 2; x++) {
-		    ColorInt pixelColor = background->getPixel(x, y);
-        int gray = (pixelColor.R + pixelColor.G + pixelColor.B) / 3;
-        background->drawPixel(x, y, ColorInt(gray, gray, gray));
-      }
+      uint8_t* line = &pixels[4 * WW * (WH - 1 - WH / 2 - y)];   //Row 0 of the array is the top row
+      ImageOps::greyscale(line, WW, 1, 0, 1);
+      background->drawPixels(-WW / 2, y, WW, 1, line);
       if (! can.isOpen()) break;
       can.sleep();
     }
@@ -15,8 +15,8 @@ using namespace tsgl;
  * - Set Local variables to track the internal timer's repetitions, and the Canvas' dimensions.
  * - While the Canvas is open:
  *   - Set \b reps to the timer's current number of repetitions.
- *   - Compute the blue component of the current color based on reps.
- *   - Attempt to draw every pixel with the current 1.0,1.0,blue.
+ *   - Look up the thread's current hue (based on reps) in a precomputed Colormap.
+ *   - Fill the thread's block of pixels with that color and upload it with one drawPixels() call.
  *   - Sleep the timer until the Canvas is ready to draw again.
  *   .
  * .
@@ -34,11 +34,13 @@ void highData(Canvas& can, unsigned threads) {
     int bstart = tid*(width/nthreads) - width/2;
     int bend = (tid==nthreads) ? width-1 : bstart + width/nthreads;
     ColorHSV tcol= Colors::highContrastColor(tid);
+    // Entry m of the table has hue HVAL * m
+    Colormap hues = Colormap::hsvRamp(0, HVAL * (MAX_COLOR-1), tcol.S, tcol.V, tcol.A, MAX_COLOR);
+    const int bwidth = bend - bstart + 1;
+    std::vector<uint32_t> block(bwidth * height);
     while (can.isOpen()) {
-      tcol.H = HVAL * ((can.getReps() + offset) % MAX_COLOR);
-      for (int i = bstart; i <= bend; i++)
-        for (int j = -height/2; j < height/2; j++)
-          background->drawPixel(i, j, tcol);
+      std::fill(block.begin(), block.end(), hues[(can.getReps() + offset) % MAX_COLOR]);
+      background->drawPixels(bstart, height/2 - 1, bwidth, height, (const uint8_t*) block.data());
       can.handleIO();
     }
   }
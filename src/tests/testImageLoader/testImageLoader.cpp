@@ -0,0 +1,71 @@
+/*
+ * testImageLoader.cpp
+ *
+ * Usage: ./testImageLoader <width> <height>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Shows a slideshow of images that are decoded in the background.
+ * \details
+ * - Prefetch every slide, so that the decoding threads start on them while the window opens.
+ * - Create the first slide with Image::loadAsync(), which draws a grey placeholder until its file is ready.
+ * - Bind the left and right arrow keys to switch slides. The files are already cached by then, so
+ *   Image::changeFile() only uploads a new texture instead of decoding the file again.
+ * - Draw four small thumbnails of the same files along the bottom; they share the cached pixels with the slide.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ */
+void imageLoaderFunction(Canvas& can) {
+    const int WW = can.getWindowWidth(), WH = can.getWindowHeight();
+    const int SLIDES = 4;
+    std::vector<std::string> files;
+    files.push_back("../testImage/pics/sky_main.jpg");
+    files.push_back("../testImage/pics/colorfulKeyboard.jpg");
+    files.push_back("../testImage/pics/cow.jpg");
+    files.push_back("../testImage/pics/ball.png");
+    ImageLoader::prefetch(files);
+
+    Image * slide = Image::loadAsync(0, WH/8, 0, files[0], WW * 0.8f, WH * 0.6f, 0, 0, 0);
+    can.add(slide);
+    Image * thumbnails[SLIDES];
+    for (int i = 0; i < SLIDES; ++i) {
+        thumbnails[i] = Image::loadAsync((i - 1.5f) * WW / SLIDES, -WH * 0.35f, 0, files[i],
+                                         WW / SLIDES - 10, WH / 5, 0, 0, 0, 0.5f);
+        can.add(thumbnails[i]);
+    }
+
+    int current = 0;
+    can.bindToButton(TSGL_RIGHT, TSGL_PRESS, [&]() {
+        thumbnails[current]->setAlpha(0.5f);
+        current = (current + 1) % SLIDES;
+        slide->changeFile(files[current]);
+        thumbnails[current]->setAlpha(1.0f);
+    });
+    can.bindToButton(TSGL_LEFT, TSGL_PRESS, [&]() {
+        thumbnails[current]->setAlpha(0.5f);
+        current = (current + SLIDES - 1) % SLIDES;
+        slide->changeFile(files[current]);
+        thumbnails[current]->setAlpha(1.0f);
+    });
+    thumbnails[0]->setAlpha(1.0f);
+
+    can.wait();
+
+    delete slide;
+    for (int i = 0; i < SLIDES; ++i)
+        delete thumbnails[i];
+}
+
+//Takes command-line arguments for the width and height of the window
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    Canvas c(-1, -1, w, h, "Image Loader (left and right to switch slides)");
+    c.run(imageLoaderFunction);
+}
@@ -0,0 +1,59 @@
+/*
+ * testInputEvents.cpp
+ *
+ * Usage: ./testInputEvents <width> <height>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Shows that input handlers run off the rendering thread, and how late they run.
+ * \details
+ * - A circle follows the mouse through bindToMouseMove(). Mouse moves are coalesced, so however slow a
+ *   handler is, the circle goes straight to the latest position.
+ * - A square spins once per frame, so any stall in drawing shows as a hitch in its rotation.
+ * - Clicking runs a deliberately slow handler that takes half a second. It runs on the Canvas' input thread,
+ *   so the square keeps spinning; the mouse moves that arrive meanwhile are merged into one.
+ * - Every event is timestamped when the operating system reports it. A handler bound with bindToEvents()
+ *   prints how long each button or scroll event waited before it was handled.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ */
+void inputEventsFunction(Canvas& can) {
+    Circle cursor(0, 0, 1, 20, 0, 0, 0, ColorFloat(1, 0.5f, 0, 1));
+    Square spinner(0, 0, 0, can.getWindowHeight() / 3, 0, 0, 0, ColorFloat(0.2f, 0.4f, 0.8f, 1));
+    can.add(&spinner);
+    can.add(&cursor);
+
+    can.bindToMouseMove([&cursor](double x, double y) {
+        cursor.setCenter(x, y, 1);
+    });
+    can.bindToButton(TSGL_MOUSE_LEFT, TSGL_PRESS, [&cursor]() {
+        cursor.setColor(ColorFloat(1, 0, 0, 1));
+        Timer::threadSleepFor(0.5);                 // A slow handler; drawing carries on regardless
+        cursor.setColor(ColorFloat(1, 0.5f, 0, 1));
+    });
+    can.bindToEvents([](const InputEvent& event) {
+        if (event.type == BUTTON_EVENT || event.type == SCROLL_EVENT)
+            std::cout << (event.type == BUTTON_EVENT ? "button " : "scroll ") << "handled after "
+                      << (glfwGetTime() - event.time) * 1000 << " ms" << std::endl;
+    });
+
+    while (can.isOpen()) {
+        can.sleep();
+        spinner.changeYawBy(2);
+    }
+    std::cout << can.getDroppedEvents() << " events dropped" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the window
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    Canvas c(-1, -1, w, h, "Input Events (click for a slow handler)");
+    c.run(inputEventsFunction);
+}
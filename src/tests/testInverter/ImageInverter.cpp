@@ -24,23 +24,18 @@ void ImageInverter::run(unsigned numThreads) {
 void ImageInverter::invertImage(unsigned numThreads) {
   Background * background1 = myCanvas1.getBackground();
   Background * background2 = myCanvas2.getBackground();
-  // background2->drawSquare(0,0,0,50,0,0,0,RED);
-  ColorInt pixelColor;
-  // #pragma omp parallel for num_threads(numThreads)
   const int WW = myCanvas1.getWindowWidth(),WH = myCanvas1.getWindowHeight();
+  std::vector<uint8_t> pixels;
+  ImageOps::snapshot(background1, pixels);
   #pragma omp parallel num_threads(numThreads) 
   {
     int nthreads = omp_get_num_threads();
     int blocksize = WW / nthreads;
-    int row = blocksize * omp_get_thread_num() - WW/2;
-    for (int x = row; x < row + blocksize; x++) {
-      for (int y = -WH/2; y < WH/2; y++) {
-        pixelColor = background1->getPixel(x, y);
-        int invertedR = 255 - pixelColor.R;
-        int invertedG = 255 - pixelColor.G;
-        int invertedB = 255 - pixelColor.B;
-        background2->drawPixel(x, y, ColorInt(invertedR,invertedG,invertedB) );
-      }
+    int column = blocksize * omp_get_thread_num();
+    for (int x = column; x < column + blocksize; x++) {
+      // Each column is one pixel wide, and a whole row of the image apart from the next pixel down
+      ImageOps::invert(&pixels[4 * x], 1, WH, 4 * WW, 1);
+      background2->drawPixels(x - WW/2, WH - 1 - WH/2, 1, WH, &pixels[4 * x], 4 * WW);
       myCanvas1.sleep();
       myCanvas2.sleep();
     }
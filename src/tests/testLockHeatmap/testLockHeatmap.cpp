@@ -0,0 +1,125 @@
+/*
+ * testLockHeatmap.cpp
+ *
+ * Usage: ./testLockHeatmap <width> <height>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+// Busy work that takes roughly the given number of microseconds
+static void spin(double micros) {
+    const double until = ThreadTimeline::now() + micros * 1e-6;
+    while (ThreadTimeline::now() < until) {}
+}
+
+/*!
+ * \brief Profiles a few locks under changing loads, and the Canvas' own, and draws them with a LockHeatmap.
+ * \details
+ * - Three threads move money between accounts under the "bank" mutex. Every few seconds the work done while
+ *   holding it switches between long and short, so its row turns hot and cools down again.
+ * - Two threads read a "table" ProfiledSharedMutex, which one thread writes now and then.
+ * - A thread writes a "log" mutex rarely, and scatters pixels on the Background while reading them back,
+ *   so the Canvas' and Background's own locks show up too.
+ * - Each row is labeled with its lock's name once the lock is first profiled.
+ * - Press M to cycle between wait time, hold time and the fraction of contended acquisitions.
+ * - The totals for each lock are printed when the window is closed.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ */
+void lockHeatmapFunction(Canvas& can) {
+    const int W = can.getWindowWidth(), H = can.getWindowHeight();
+    const int ROWS = 12;
+    LockProfiler::setEnabled(true);
+    LockHeatmap heatmap(W * 0.15f, 0, 0, 200, ROWS, W * 0.7f, H * 0.9f, 0, 0, 0);
+    can.add(&heatmap);
+    const LockHeatmapMetric metrics[] = { LOCK_WAIT_TIME, LOCK_HOLD_TIME, LOCK_CONTENTION };
+    const char* metricNames[] = { "wait time", "hold time", "contended fraction" };
+    int metric = 0;
+    can.bindToButton(TSGL_M, TSGL_PRESS, [&]() {
+        metric = (metric + 1) % 3;
+        heatmap.setMetric(metrics[metric]);
+        std::cout << "Showing " << metricNames[metric] << std::endl;
+    });
+
+    ProfiledMutex bank("bank"), log("log");
+    ProfiledSharedMutex table("table");
+    std::vector<long> accounts(16, 100);
+    std::vector<int> rows(64, 0);
+    std::vector<Text*> labels;
+
+    #pragma omp parallel num_threads(7)
+    {
+        const int tid = omp_get_thread_num();
+        unsigned seed = tid;
+        while (can.isOpen()) {
+            if (tid == 0) {                                 // Label rows as locks are first profiled
+                for (int r = labels.size(); r < ROWS; ++r) {
+                    const std::string name = heatmap.getLockName(r);
+                    if (name.empty())
+                        break;
+                    const float y = H * 0.45f - H * 0.9f * (r + 0.5f) / ROWS;
+                    labels.push_back(new Text(-W * 0.35f, y, 0, std::wstring(name.begin(), name.end()), FONT,
+                                              std::min(20.0f, H * 0.5f / ROWS), 0, 0, 0, BLACK));
+                    can.add(labels.back());
+                }
+                can.sleep();
+            } else if (tid <= 3) {                          // Bank tellers
+                const bool slow = ((int) can.getTime() / 4) % 2 == 0;
+                const int from = rand_r(&seed) % accounts.size(), to = rand_r(&seed) % accounts.size();
+                bank.lock();
+                accounts[from] -= 1;
+                accounts[to] += 1;
+                spin(slow ? 200 : 5);
+                bank.unlock();
+                spin(50);
+            } else if (tid <= 5) {                          // Table readers
+                table.lock_shared();
+                long sum = 0;
+                for (unsigned i = 0; i < rows.size(); ++i)
+                    sum += rows[i];
+                spin(100);
+                table.unlock_shared();
+                if (sum < 0)
+                    std::cout << sum << std::endl;
+                spin(20);
+            } else {                                        // Table writer, logger and painter
+                table.lock();
+                rows[rand_r(&seed) % rows.size()]++;
+                spin(300);
+                table.unlock();
+                if (rand_r(&seed) % 20 == 0) {
+                    log.lock();
+                    spin(10);
+                    log.unlock();
+                }
+                const int x = -W / 2 + rand_r(&seed) % (W / 4), y = -H / 2 + rand_r(&seed) % (H / 8);
+                can.getBackground()->drawPixel(x, y, Colors::highContrastColor(rand_r(&seed) % 8));
+                can.getBackground()->getPixel(x, y);
+                spin(1000);
+            }
+        }
+    }
+
+    const std::vector<LockStats> stats = LockProfiler::getStats();
+    for (unsigned i = 0; i < stats.size(); ++i) {
+        const LockStats& s = stats[i];
+        std::cout << s.name << ": " << s.acquisitions << " exclusive and " << s.sharedAcquisitions << " shared, "
+                  << s.contended << " contended, " << s.ownerChanges << " owner changes, waited "
+                  << s.waitTime * 1000 << " ms (longest " << s.maxWait * 1000 << " ms), held "
+                  << s.holdTime * 1000 << " ms (longest " << s.maxHold * 1000 << " ms)" << std::endl;
+    }
+    for (unsigned i = 0; i < labels.size(); ++i)
+        delete labels[i];
+}
+
+//Takes command-line arguments for the width and height of the window
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w * 0.6;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = 960, h = 576;       //If not, set the width and height to a default value
+    Canvas c(-1, -1, w, h, "Lock Contention Heatmap", WHITE);
+    c.run(lockHeatmapFunction);
+}
@@ -0,0 +1,90 @@
+/*
+ * testParallelFor.cpp
+ *
+ * Usage: ./testParallelFor <width> <height> <depth>
+ */
+
+#include <tsgl.h>
+#include <complex>
+
+using namespace tsgl;
+
+/*!
+ * \brief Draws the Mandelbrot set with parallel_for(), coloring each row by the worker that computed it.
+ * \details
+ * - Rows near the middle cross the set and take far longer than the others, so the work is uneven.
+ * - With a grain of one row, idle workers steal rows from busy ones and every worker finishes at nearly the
+ *   same time. With a grain of a whole share of rows, there is nothing to steal and each worker keeps its band,
+ *   as with static partitioning.
+ * - Below the set, a bar for each worker shows its busy time in its color and its idle time in gray.
+ * - Press the spacebar to switch between the two grains and draw the set again.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param depth The number of iterations before a point is taken to be in the set.
+ */
+void parallelForFunction(Canvas& can, unsigned depth) {
+    const int W = can.getWindowWidth(), H = can.getWindowHeight();
+    const int BARS = 100, ROWS = H - BARS;
+    const unsigned workers = ThreadPool::global().getWorkerCount();
+    Background * bg = can.getBackground();
+    bool balanced = true, redraw = true;
+    can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&balanced, &redraw]() {
+        balanced = !balanced;
+        redraw = true;
+    });
+
+    while (can.isOpen()) {
+        can.sleep();
+        if (!redraw)
+            continue;
+        redraw = false;
+        const long grain = balanced ? 1 : (ROWS + workers - 1) / workers;
+        ThreadPool::global().resetStats();
+        parallel_for(0, ROWS, grain, [&](long row, unsigned worker) {
+            ColorFloat tint = Colors::highContrastColor(worker);
+            std::vector<uint32_t> pixels(W);
+            const double y = 1.2 - 2.4 * row / ROWS;
+            for (int j = 0; j < W; ++j) {
+                const std::complex<double> c(-2.2 + 3.2 * j / W, y);
+                std::complex<double> z = c;
+                unsigned i = 0;
+                while (std::norm(z) < 4 && i < depth) {
+                    z = z * z + c;
+                    ++i;
+                }
+                pixels[j] = (i == depth) ? Colors::packRgba8(0, 0, 0) : Colors::packRgba8(tint * (0.3f + 0.7f * i / depth));
+            }
+            bg->drawPixels(-W/2, H/2 - row, W, 1, (const uint8_t*) pixels.data());
+        });
+
+        // One bar per worker: busy time in the worker's color, then idle time in gray
+        const std::vector<WorkerStats> stats = ThreadPool::global().getWorkerStats();
+        const double total = stats[0].busy + stats[0].idle;
+        std::vector<uint32_t> bars(W * BARS, Colors::packRgba8(WHITE));
+        const int barHeight = BARS / workers;
+        for (unsigned w = 0; w < workers; ++w) {
+            const int busy = W * stats[w].busy / total, idle = W * stats[w].idle / total;
+            for (int r = w * barHeight + 1; r < (int) (w + 1) * barHeight; ++r)
+                for (int x = 0; x < busy + idle && x < W; ++x)
+                    bars[r * W + x] = Colors::packRgba8(x < busy ? Colors::highContrastColor(w) : GRAY);
+        }
+        bg->drawPixels(-W/2, H/2 - ROWS, W, BARS, (const uint8_t*) bars.data());
+        std::cout << (balanced ? "Grain of 1 row: " : "Grain of a whole share: ") << total * 1000 << " ms" << std::endl;
+        for (unsigned w = 0; w < workers; ++w)
+            std::cout << "  worker " << w << ": busy " << stats[w].busy * 1000 << " ms, idle " << stats[w].idle * 1000
+                      << " ms, " << stats[w].chunks << " chunks, " << stats[w].steals << " steals" << std::endl;
+    }
+}
+
+//Takes command-line arguments for the width and height of the window, and the iteration depth
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 200)   //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    unsigned depth = (argc > 3) ? atoi(argv[3]) : 1000;
+    if (depth == 0)
+      depth = 1000;
+    Canvas c(-1, -1, w, h, "Work-Stealing parallel_for", WHITE);
+    c.run(parallelForFunction, depth);
+}
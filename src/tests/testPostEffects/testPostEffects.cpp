@@ -0,0 +1,85 @@
+/*
+ * testPostEffects.cpp
+ *
+ * Usage: ./testPostEffects <width> <height>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Bounces colored circles around the Background and runs a chain of post effects over it.
+ * \details
+ * - Bind the keys 1 to 6 to add an effect to the end of the chain, so effects can be stacked.
+ * - Bind the key 0 to remove every effect.
+ * - Bind the up and down arrows to widen and narrow the blur, if there is one.
+ * - While the Canvas is open:
+ *   - Sleep the internal timer until the Canvas is ready to draw.
+ *   - Clear the Background and draw each circle at its new position.
+ *   .
+ * - The effects run on the graphics card as the Background is shown, so the drawing loop never changes.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ */
+void postEffectsFunction(Canvas& can) {
+    Background * bg = can.getBackground();
+    const int WW = can.getWindowWidth(), WH = can.getWindowHeight();
+    const char* effects[6] = { PostEffects::BLUR, PostEffects::BLOOM, PostEffects::EDGES,
+                               PostEffects::GREYSCALE, PostEffects::INVERT, PostEffects::SEPIA };
+    const Key keys[6] = { TSGL_1, TSGL_2, TSGL_3, TSGL_4, TSGL_5, TSGL_6 };
+    int blurIndex = -1;
+    float spread = 1.0f;
+    for (int i = 0; i < 6; ++i) {
+        can.bindToButton(keys[i], TSGL_PRESS, [&, i]() {
+            unsigned index = bg->addPostEffect(effects[i]);
+            if (i == 0) {
+                blurIndex = index;
+                bg->setPostEffectUniform(index, "spread", spread);
+            }
+        });
+    }
+    can.bindToButton(TSGL_0, TSGL_PRESS, [&]() {
+        bg->clearPostEffects();
+        blurIndex = -1;
+    });
+    can.bindToButton(TSGL_UP, TSGL_PRESS, [&]() {
+        spread *= 1.5f;
+        if (blurIndex >= 0) bg->setPostEffectUniform(blurIndex, "spread", spread);
+    });
+    can.bindToButton(TSGL_DOWN, TSGL_PRESS, [&]() {
+        spread = std::max(1.0f, spread / 1.5f);
+        if (blurIndex >= 0) bg->setPostEffectUniform(blurIndex, "spread", spread);
+    });
+
+    const int CIRCLES = 24;
+    float x[CIRCLES], y[CIRCLES], dx[CIRCLES], dy[CIRCLES];
+    Random& rng = Random::local();
+    for (int i = 0; i < CIRCLES; ++i) {
+        x[i] = rng.uniformFloat(-WW/2, WW/2);
+        y[i] = rng.uniformFloat(-WH/2, WH/2);
+        dx[i] = rng.uniformFloat(-4, 4);
+        dy[i] = rng.uniformFloat(-4, 4);
+    }
+    while (can.isOpen()) {
+        can.sleep();
+        bg->clear();
+        for (int i = 0; i < CIRCLES; ++i) {
+            x[i] += dx[i];
+            y[i] += dy[i];
+            if (x[i] < -WW/2 || x[i] > WW/2) dx[i] = -dx[i];
+            if (y[i] < -WH/2 || y[i] > WH/2) dy[i] = -dy[i];
+            bg->drawCircle(x[i], y[i], 0, 20 + 2 * (i % 10), 0, 0, 0, Colors::highContrastColor(i));
+        }
+    }
+}
+
+//Takes command-line arguments for the width and height of the window
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    Canvas c(-1, -1, w, h, "Post Effects (1-6 to add, 0 to clear, arrows to change the blur)", BLACK);
+    c.run(postEffectsFunction);
+}
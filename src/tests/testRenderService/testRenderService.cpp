@@ -0,0 +1,69 @@
+/*
+ * testRenderService.cpp
+ *
+ * Usage: ./testRenderService <numCanvases> <size>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Spins a star and a caption on one of several Canvases that share a rendering thread.
+ * \details
+ * - Each Canvas has its own frame rate, and the rendering thread draws each one whenever its frame is due.
+ * - Every Canvas draws its caption in the same font, with the same shaders, from resources shared by all
+ *   the windows.
+ * - While the Canvas is open, sleep the internal timer and turn the star a little.
+ * - When the window closes, report the frame rate the Canvas managed, and whether it came within a tenth of
+ *   the one it asked for, however slow the other Canvases are.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param index Which of the Canvases it is.
+ * \param fps The frame rate the Canvas was created with.
+ */
+void renderServiceFunction(Canvas& can, int index, int fps) {
+    const float size = can.getWindowWidth();
+    Star star(0, 0, 0, size / 3, 5 + index, 0, 0, 0, Colors::highContrastColor(index));
+    Text caption(0, -size * 0.42f, 0, L"Canvas " + std::to_wstring(index + 1), FONT, size / 16, 0, 0, 0, WHITE);
+    can.add(&star);
+    can.add(&caption);
+    while (can.isOpen()) {
+        can.sleep();
+        star.changeYawBy(1 + index);
+    }
+    const float drawn = can.getFPS();
+    std::cout << "Canvas " << index + 1 << " drew at " << drawn << " of " << fps << " frames per second"
+              << ((drawn > fps * 0.9f && drawn < fps * 1.1f) ? "" : ", which is off by more than a tenth") << std::endl;
+}
+
+//The frame rate of each Canvas: 30, 60 and 90 frames per second, in turn
+static int fps(int index) {
+    return 30 * (index % 3 + 1);
+}
+
+//Takes command-line arguments for the number of Canvases and the size of each
+int main(int argc, char* argv[]) {
+    int canvases = (argc > 1) ? atoi(argv[1]) : 3;
+    if (canvases <= 0)
+      canvases = 3;
+    int size = (argc > 2) ? atoi(argv[2]) : 0.3*Canvas::getDisplayHeight();
+    if (size <= 0)            //Checked the passed size if it is valid
+      size = 320;             //If not, set the size to a default value
+
+    RenderService::enable();  //Every Canvas from here on is drawn by one thread
+    std::vector<Canvas*> cans;
+    for (int i = 0; i < canvases; ++i) {
+      const double period = 1.0 / fps(i);
+      cans.push_back(new Canvas((i % 4) * (size + 20), (i / 4) * (size + 40), size, size, "Shared Rendering", BLACK, nullptr, period));
+      cans.back()->start();
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < canvases; ++i)
+      threads.push_back(std::thread(renderServiceFunction, std::ref(*cans[i]), i, fps(i)));
+    for (int i = 0; i < canvases; ++i) {
+      threads[i].join();
+      cans[i]->wait();
+      delete cans[i];
+    }
+}
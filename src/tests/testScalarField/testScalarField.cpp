@@ -0,0 +1,113 @@
+/*
+ * testScalarField.cpp
+ *
+ * Usage: ./testScalarField <width> <height> <columns> <rows> <numThreads>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Simulates heat spreading across a plate, drawn with a ScalarField.
+ * \details
+ * - Create a ScalarField with one cell per point of the plate, covering the whole Canvas.
+ * - Create a few Colormaps to switch between.
+ * - Scatter some hot spots that stay at a constant temperature.
+ * - Bind the left mouse button to heat the plate under the mouse, 'S' to toggle smoothing,
+ *   and 'C' to switch Colormaps.
+ * - While the Canvas is open:
+ *   - Sleep the internal timer until the Canvas is ready to draw.
+ *   - In parallel, each thread computes the new temperature of its band of rows from the old temperatures,
+ *     and writes the whole band into the field with one setValues() call.
+ *   - Swap the old and new temperatures.
+ *   .
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param columns Number of columns of the plate.
+ * \param rows Number of rows of the plate.
+ * \param threads Number of threads to use.
+ */
+void scalarFieldFunction(Canvas& can, int columns, int rows, int threads) {
+    const int WW = can.getWindowWidth(), WH = can.getWindowHeight();
+    ScalarField * field = new ScalarField(0, 0, 0, columns, rows, WW, WH, 0, 0, 0);
+    can.add(field);
+
+    ColorFloat fireStops[4] = { BLACK, RED, YELLOW, WHITE };
+    Colormap colormaps[3] = {
+        Colormap(fireStops, 4),
+        Colormap::hsvRamp(4.0f, 0.0f),
+        Colormap::gradient(BLACK, WHITE)
+    };
+    unsigned current = 0;
+    field->setColormap(colormaps[current]);
+
+    std::vector<float> heat(columns * rows, 0.0f), next(columns * rows, 0.0f);
+    std::vector<unsigned char> fixed(columns * rows, 0);
+    Random& rng = Random::local();
+    for (int k = 0; k < 12; ++k) {
+        int cx = rng.uniformInt(0, columns - 1), cy = rng.uniformInt(0, rows - 1);
+        int r = std::max(1, std::min(columns, rows) / 40);
+        for (int y = std::max(0, cy - r); y < std::min(rows, cy + r); ++y)
+            for (int x = std::max(0, cx - r); x < std::min(columns, cx + r); ++x) {
+                heat[y * columns + x] = 1.0f;
+                fixed[y * columns + x] = 1;
+            }
+    }
+
+    bool mouseDown = false;
+    can.bindToButton(TSGL_MOUSE_LEFT, TSGL_PRESS, [&mouseDown]() { mouseDown = true; });
+    can.bindToButton(TSGL_MOUSE_LEFT, TSGL_RELEASE, [&mouseDown]() { mouseDown = false; });
+    can.bindToButton(TSGL_S, TSGL_PRESS, [&field]() { field->setSmoothing(!field->getSmoothing()); });
+    can.bindToButton(TSGL_C, TSGL_PRESS, [&]() {
+        current = (current + 1) % 3;
+        field->setColormap(colormaps[current]);
+    });
+
+    while (can.isOpen()) {
+        can.sleep();
+        if (mouseDown) {
+            int x = (can.getMouseX() + WW/2) * columns / WW, y = (WH/2 - can.getMouseY()) * rows / WH;
+            if (x >= 0 && x < columns && y >= 0 && y < rows)
+                heat[y * columns + x] = 1.0f;
+        }
+        #pragma omp parallel num_threads(threads)
+        {
+            int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+            int first = rows * tid / nthreads, last = rows * (tid + 1) / nthreads;
+            for (int y = first; y < last; ++y) {
+                for (int x = 0; x < columns; ++x) {
+                    int i = y * columns + x;
+                    if (fixed[i]) {
+                        next[i] = heat[i];
+                        continue;
+                    }
+                    float sum = heat[i] * 4;
+                    sum += (x > 0) ? heat[i - 1] : heat[i];
+                    sum += (x < columns - 1) ? heat[i + 1] : heat[i];
+                    sum += (y > 0) ? heat[i - columns] : heat[i];
+                    sum += (y < rows - 1) ? heat[i + columns] : heat[i];
+                    next[i] = sum / 8 * 0.9995f;
+                }
+            }
+            field->setValues(0, first, columns, last - first, &next[first * columns]);
+        }
+        heat.swap(next);
+    }
+    delete field;
+}
+
+//Takes command-line arguments for the size of the window and the plate, and the number of threads
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    int cols = (argc > 3) ? atoi(argv[3]) : w / 4;
+    int rows = (argc > 4) ? atoi(argv[4]) : h / 4;
+    if (cols <= 0 || rows <= 0)
+      cols = w / 4, rows = h / 4;
+    int t = (argc > 5) ? atoi(argv[5]) : omp_get_num_procs();
+    Canvas c(-1, -1, w, h, "Heat Diffusion on a ScalarField");
+    c.run(scalarFieldFunction, cols, rows, t);
+}
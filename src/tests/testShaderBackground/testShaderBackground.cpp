@@ -0,0 +1,125 @@
+/*
+ * testShaderBackground.cpp
+ *
+ * Usage: ./testShaderBackground <width> <height>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+// An animated color wheel centered on the window
+static const char* wheelSource =
+    "vec3 hsv2rgb(vec3 c) {\n"
+    "    vec3 p = abs(fract(c.xxx + vec3(1.0, 2.0/3.0, 1.0/3.0)) * 6.0 - 3.0);\n"
+    "    return c.z * mix(vec3(1.0), clamp(p - 1.0, 0.0, 1.0), c.y);\n"
+    "}\n"
+    "vec4 shade(vec2 position) {\n"
+    "    float hue = atan(position.y, position.x) / 6.2831853 + time * 0.1;\n"
+    "    float r = length(position) / (0.5 * min(resolution.x, resolution.y));\n"
+    "    return vec4(hsv2rgb(vec3(hue, clamp(r, 0.0, 1.0), r < 1.0 ? 1.0 : 0.0)), 1.0);\n"
+    "}\n";
+
+// The Mandelbrot set, in whatever region the bounds cover
+static const char* mandelbrotSource =
+    "uniform float depth;\n"
+    "vec4 shade(vec2 position) {\n"
+    "    vec2 z = vec2(0.0);\n"
+    "    int i;\n"
+    "    for (i = 0; i < int(depth); ++i) {\n"
+    "        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + position;\n"
+    "        if (dot(z, z) > 4.0) break;\n"
+    "    }\n"
+    "    if (i == int(depth)) return vec4(0.0, 0.0, 0.0, 1.0);\n"
+    "    float m = float(i) / depth;\n"
+    "    return vec4(vec3(0.25 + 0.5 * m) * m + vec3(0.0, 0.0, m), 1.0);\n"
+    "}\n";
+
+// Colors every pixel by its nearest site, and darkens it near the border with the second-nearest
+static const char* voronoiSource =
+    "const int SITES = 32;\n"
+    "uniform vec2 sites[SITES];\n"
+    "uniform vec4 colors[SITES];\n"
+    "vec4 shade(vec2 position) {\n"
+    "    float best = 1e20, second = 1e20;\n"
+    "    int nearest = 0;\n"
+    "    for (int i = 0; i < SITES; ++i) {\n"
+    "        float d = distance(position, sites[i]);\n"
+    "        if (d < best) { second = best; best = d; nearest = i; }\n"
+    "        else if (d < second) second = d;\n"
+    "    }\n"
+    "    return colors[nearest] * smoothstep(0.0, 3.0, second - best);\n"
+    "}\n";
+
+/*!
+ * \brief Draws three procedural Backgrounds with a ShaderBackground, one per press of the space bar.
+ * \details
+ * - Bind the space bar to switch to the next shader.
+ * - Bind the scroll wheel to zoom the Mandelbrot set in or out around the mouse, by changing the bounds.
+ * - Pick 32 random Voronoi sites and colors, and pass them to the shader as uniform arrays.
+ * - While the Canvas is open, sleep the internal timer and move the Voronoi sites a little each frame.
+ *   Every pixel is recomputed on the GPU each frame, so the demo uses no drawing threads at all.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param bg Reference to the Canvas' ShaderBackground.
+ */
+void shaderBackgroundFunction(Canvas& can, ShaderBackground& bg) {
+    const int WW = can.getWindowWidth(), WH = can.getWindowHeight();
+    const int SITES = 32;
+    const char* sources[3] = { wheelSource, mandelbrotSource, voronoiSource };
+    int mode = 0;
+
+    can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&]() {
+        mode = (mode + 1) % 3;
+        bg.setShader(sources[mode]);
+        if (mode == 1)
+            bg.setBounds(-2.0f, -1.5f, 1.0f, 1.5f);
+        else
+            bg.setBounds(-WW/2, -WH/2, WW/2, WH/2);
+    });
+    can.bindToScroll([&](double, double dy) {
+        if (mode != 1) return;
+        float scale = (dy > 0) ? 0.8f : 1.25f;
+        float mx = bg.getMinX() + (can.getMouseX() + WW/2) / WW * (bg.getMaxX() - bg.getMinX());
+        float my = bg.getMinY() + (WH/2 - can.getMouseY()) / WH * (bg.getMaxY() - bg.getMinY());
+        bg.setBounds(mx + (bg.getMinX() - mx) * scale, my + (bg.getMinY() - my) * scale,
+                     mx + (bg.getMaxX() - mx) * scale, my + (bg.getMaxY() - my) * scale);
+    });
+
+    bg.setUniform("depth", 255.0f);
+    float sites[SITES * 2], velocities[SITES * 2], colors[SITES * 4];
+    Random& rng = Random::local();
+    for (int i = 0; i < SITES; ++i) {
+        sites[2*i] = rng.uniformFloat(-WW/2, WW/2);
+        sites[2*i+1] = rng.uniformFloat(-WH/2, WH/2);
+        velocities[2*i] = rng.uniformFloat(-2, 2);
+        velocities[2*i+1] = rng.uniformFloat(-2, 2);
+        ColorFloat c = Colors::highContrastColor(i);
+        colors[4*i] = c.R; colors[4*i+1] = c.G; colors[4*i+2] = c.B; colors[4*i+3] = 1.0f;
+    }
+    bg.setUniformArray("colors", colors, SITES, 4);
+
+    while (can.isOpen()) {
+        can.sleep();
+        for (int i = 0; i < SITES; ++i) {
+            sites[2*i] += velocities[2*i];
+            sites[2*i+1] += velocities[2*i+1];
+            if (sites[2*i] < -WW/2 || sites[2*i] > WW/2) velocities[2*i] = -velocities[2*i];
+            if (sites[2*i+1] < -WH/2 || sites[2*i+1] > WH/2) velocities[2*i+1] = -velocities[2*i+1];
+        }
+        bg.setUniformArray("sites", sites, SITES, 2);
+    }
+}
+
+//Takes command-line arguments for the width and height of the window
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    ShaderBackground bg(w, h, wheelSource);
+    Canvas c(-1, -1, w, h, "ShaderBackground (space to switch, scroll to zoom)", BLACK, &bg);
+    c.start();
+    shaderBackgroundFunction(c, bg);
+    c.wait();
+}
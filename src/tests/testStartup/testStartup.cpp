@@ -0,0 +1,51 @@
+/*
+ * testStartup.cpp
+ *
+ * Usage: ./testStartup <width> <height> <numCanvases>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Opens and closes a string of short-lived Canvases, reporting how long each took to start.
+ * \details
+ * - Open a Canvas, let it draw a few frames, then close it and open the next.
+ * - Report how long each took to make its window, shaders and Background, and to draw its first frame.
+ * - The first Canvas of the first run compiles its shaders; later ones load them from the ShaderCache, so
+ *   their shader times should drop to a fraction of a millisecond. Run it twice to see the cache on disk.
+ * .
+ * \param w The width of each Canvas.
+ * \param h The height of each Canvas.
+ * \param canvases The number of Canvases to open.
+ */
+void startupFunction(int w, int h, int canvases) {
+    std::cout << "Shader cache: " << (ShaderCache::getDirectory().empty() ? "off" : ShaderCache::getDirectory()) << std::endl;
+    double total = 0;
+    for (int i = 0; i < canvases; ++i) {
+        Canvas can(-1, -1, w, h, "Startup " + std::to_string(i + 1), Colors::highContrastColor(i));
+        can.start();
+        while (can.isOpen() && can.getFrameNumber() < 5)
+            can.sleep();
+        can.stop();
+        const StartupTimes t = can.getStartupTimes();
+        std::cout << "Canvas " << i + 1 << ": first frame after " << t.firstFrame * 1000 << " ms (window "
+                  << t.window * 1000 << " ms, shaders " << t.shaders * 1000 << " ms with " << t.compiledShaders
+                  << " compiled, background " << t.background * 1000 << " ms)" << std::endl;
+        total += t.firstFrame;
+    }
+    std::cout << "Average startup " << total / canvases * 1000 << " ms" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the windows, and how many to open
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.5*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 480;            //If not, set the width and height to a default value
+    int canvases = (argc > 3) ? atoi(argv[3]) : 5;
+    if (canvases <= 0)
+      canvases = 5;
+    startupFunction(w, h, canvases);
+}
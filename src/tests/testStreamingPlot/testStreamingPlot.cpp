@@ -0,0 +1,83 @@
+/*
+ * testStreamingPlot.cpp
+ *
+ * Usage: ./testStreamingPlot <width> <height> <numProducers>
+ */
+
+#include <tsgl.h>
+#include <cstdlib>
+
+using namespace tsgl;
+
+/*!
+ * \brief Plots signals that are produced much faster than the Canvas draws.
+ * \details
+ * - Start \b producers threads that each append blocks of a noisy sine wave to the bottom plot as fast as they
+ *   can, and a thread that appends one sample of a slower signal to the top plot every millisecond.
+ * - The bottom plot's window of a million samples is folded into a few hundred columns; the occasional spike
+ *   in the noise still shows, since each column keeps the minimum and maximum of its samples.
+ * - While the Canvas is open, sleep the internal timer. The producers never wait for it.
+ * - Report how many samples were appended, and how many were dropped, when the window closes.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param slow Reference to the StreamingPlot of the slow signal.
+ * \param fast Reference to the StreamingPlot of the fast signals.
+ * \param producers The number of threads appending to the fast plot.
+ */
+void streamingPlotFunction(Canvas& can, StreamingPlot& slow, StreamingPlot& fast, int producers) {
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&can, &fast, p]() {
+            const unsigned BLOCK = 4096;
+            float block[BLOCK];
+            uint32_t seed = p + 1;      // A bare LCG, cheap enough to run once per sample in the loop
+            double phase = 0;
+            while (can.isOpen()) {
+                for (unsigned i = 0; i < BLOCK; ++i) {
+                    phase += 0.00002;
+                    seed = seed * 1664525u + 1013904223u;
+                    const float noise = (seed >> 22) / 5120.0f - 0.1f;
+                    const float spike = ((seed >> 8) % 200000 == 0) ? 0.8f : 0.0f;
+                    block[i] = 0.6f * sin(phase * (p + 1)) + noise + spike;
+                }
+                fast.append(block, BLOCK);
+            }
+        }));
+    }
+    threads.push_back(std::thread([&can, &slow]() {
+        const double start = can.getTime();
+        while (can.isOpen()) {
+            const double t = can.getTime() - start;
+            slow.append(sin(t * 3) * cos(t * 0.7));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+
+    while (can.isOpen())
+        can.sleep();
+    for (unsigned i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    std::cout << fast.getSampleCount() << " samples appended to the fast plot in " << can.getTime() << " seconds, "
+              << fast.getDroppedSamples() << " dropped" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the window, and the number of producer threads
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    int producers = (argc > 3) ? atoi(argv[3]) : 2;
+    if (producers <= 0)
+      producers = 2;
+
+    Canvas c(-1, -1, w, h, "Streaming Plot");
+    c.setBackgroundColor(WHITE);
+    StreamingPlot slow(0, h/4, 0, w*0.9f, h*0.4f, 5000, -1, 1, 0, 0, 0, BLUE);
+    StreamingPlot fast(0, -h/4, 0, w*0.9f, h*0.4f, 1000000, -1, 1, 0, 0, 0, RED);
+    c.add(&slow);
+    c.add(&fast);
+    c.start();
+    streamingPlotFunction(c, slow, fast, producers);
+    c.wait();
+}
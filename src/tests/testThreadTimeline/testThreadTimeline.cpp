@@ -0,0 +1,89 @@
+/*
+ * testThreadTimeline.cpp
+ *
+ * Usage: ./testThreadTimeline <width> <height> <numThreads>
+ */
+
+#include <tsgl.h>
+#include <cmath>
+
+using namespace tsgl;
+
+// Busy work that takes roughly the given number of microseconds
+static double spin(double micros) {
+    const double until = ThreadTimeline::now() + micros * 1e-6;
+    double x = 0;
+    while (ThreadTimeline::now() < until)
+        x += std::sqrt(x + 1.0);
+    return x;
+}
+
+/*!
+ * \brief Records what a team of threads is doing with ThreadTimeline, and draws it live with a TimelineView.
+ * \details
+ * - Each thread repeatedly works on a "task" span that holds a "load" and a "compute" span, and then a burst
+ *   of tiny "tick" spans, recording millions of spans per second between them.
+ * - Threads with higher ids get longer tasks, so the chart shows the imbalance.
+ * - The chart scrolls to show the last two seconds, one row per thread. Runs of ticks shorter than a column of
+ *   the chart are merged as they are recorded, so the rings hold all two seconds however fast the ticks come.
+ * - Press the spacebar to pause or resume scrolling.
+ * - Press E to write everything the rings hold to timeline.json, which opens in chrome://tracing or Perfetto.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param threads The number of threads to record.
+ */
+void threadTimelineFunction(Canvas& can, int threads) {
+    const int W = can.getWindowWidth(), H = can.getWindowHeight();
+    const double WINDOW = 2.0;
+    ThreadTimeline::setResolution(WINDOW / W);  // Nothing narrower than a column needs a slot of its own
+    TimelineView view(0, 0, 0, W, H, WINDOW, 0, 0, 0);
+    view.setColor("tick", GRAY);
+    can.add(&view);
+    can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&view]() {
+        view.setPaused(!view.isPaused());
+    });
+    can.bindToButton(TSGL_E, TSGL_PRESS, []() {
+        if (ThreadTimeline::exportChromeTrace("timeline.json"))
+            std::cout << "Wrote timeline.json" << std::endl;
+    });
+
+    #pragma omp parallel num_threads(threads)
+    {
+        const int tid = omp_get_thread_num();
+        std::stringstream name;
+        name << "worker " << tid;
+        ThreadTimeline::setThreadName(name.str());
+        double sink = 0;
+        while (can.isOpen()) {
+            {
+                ThreadTimeline::Scope task("task");
+                {
+                    ThreadTimeline::Scope load("load");
+                    sink += spin(500 + 100 * tid);
+                }
+                ThreadTimeline::Scope compute("compute");
+                sink += spin(2000 + 1500 * tid);
+            }
+            for (int i = 0; i < 20000; ++i) {
+                ThreadTimeline::Scope tick("tick");
+                sink += i;
+            }
+        }
+        if (sink < 0)                       // Keep the busy work from being optimized away
+            std::cout << sink << std::endl;
+    }
+    std::cout << ThreadTimeline::getSpanCount() << " spans recorded" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the window, and the number of threads
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayWidth();
+    int h = (argc > 2) ? atoi(argv[2]) : 0.5*Canvas::getDisplayHeight();
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    int t = (argc > 3) ? atoi(argv[3]) : omp_get_num_procs();
+    if (t <= 0)
+      t = 4;
+    Canvas c(-1, -1, w, h, "Thread Timeline", WHITE);
+    c.run(threadTimelineFunction, t);
+}
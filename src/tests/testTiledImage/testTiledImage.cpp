@@ -0,0 +1,97 @@
+/*
+ * testTiledImage.cpp
+ *
+ * Usage: ./testTiledImage <width> <height> <image or pyramid file>
+ */
+
+#include <tsgl.h>
+#include <fstream>
+
+using namespace tsgl;
+
+// Writes a pyramid of the Mandelbrot set, sized pixels across, a tile at a time
+static bool createMandelbrotPyramid(const std::string& filename, int size) {
+    std::cout << "Writing " << filename << " (" << size << " x " << size << " pixels)..." << std::endl;
+    return TiledImage::createPyramid(filename, size, size, [size](int x, int y, int w, int h, uint8_t* rgba, int stride) {
+        const int DEPTH = 255;
+        #pragma omp parallel for
+        for (int row = 0; row < h; ++row) {
+            for (int col = 0; col < w; ++col) {
+                const double cr = -2.0 + 2.5 * (x + col) / size, ci = -1.25 + 2.5 * (y + row) / size;
+                double zr = 0, zi = 0;
+                int i = 0;
+                while (i < DEPTH && zr * zr + zi * zi < 4.0) {
+                    const double t = zr * zr - zi * zi + cr;
+                    zi = 2 * zr * zi + ci;
+                    zr = t;
+                    ++i;
+                }
+                ColorInt c = (i == DEPTH) ? ColorInt(0, 0, 0) : ColorInt(ColorHSV((float) i / DEPTH * 6.0f, 1.0f, 1.0f));
+                uint8_t * p = rgba + row * stride + col * 4;
+                p[0] = c.R; p[1] = c.G; p[2] = c.B; p[3] = 255;
+            }
+        }
+    });
+}
+
+/*!
+ * \brief Pans and zooms around an image far larger than the window with a TiledImage.
+ * \details
+ * - Draw the TiledImage so that it just fits in the window.
+ * - Bind the scroll wheel to move the camera toward or away from the image, and the arrow keys to move it across.
+ *   Only the tiles in view are read from the pyramid file and uploaded, finer ones the closer the camera gets.
+ * - Bind the space bar to print how much GPU memory the tiles use, which never grows much beyond the budget
+ *   however far the image is explored.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param image Reference to the TiledImage.
+ */
+void tiledImageFunction(Canvas& can, TiledImage& image) {
+    Camera * camera = can.getCamera();
+    const float startZ = camera->getPositionZ();
+
+    can.bindToScroll([&](double, double dy) {
+        float z = camera->getPositionZ() * ((dy > 0) ? 0.8f : 1.25f);
+        camera->setPositionZ(std::max(1.0f, std::min(z, 4 * startZ)));
+    });
+    can.bindToButton(TSGL_LEFT, TSGL_PRESS, [&]() { camera->changeXBy(-0.1f * camera->getPositionZ()); });
+    can.bindToButton(TSGL_RIGHT, TSGL_PRESS, [&]() { camera->changeXBy(0.1f * camera->getPositionZ()); });
+    can.bindToButton(TSGL_UP, TSGL_PRESS, [&]() { camera->changeYBy(0.1f * camera->getPositionZ()); });
+    can.bindToButton(TSGL_DOWN, TSGL_PRESS, [&]() { camera->changeYBy(-0.1f * camera->getPositionZ()); });
+    can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&]() {
+        std::cout << (image.getTextureBytes() >> 20) << " MB of tiles on the GPU" << std::endl;
+    });
+
+    while (can.isOpen())
+        can.sleep();
+}
+
+//Takes command-line arguments for the width and height of the window, and the file to show
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    std::string file = (argc > 3) ? argv[3] : "mandelbrot.tiles";
+
+    // Make a pyramid from an image file, or a Mandelbrot set of 8192 x 8192 pixels if there is none yet
+    const std::string suffix = ".tiles";
+    bool isPyramid = file.size() > suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0;
+    if (!isPyramid) {
+        std::string pyramid = file + suffix;
+        if (!TiledImage::createPyramid(file, pyramid))
+            return 1;
+        file = pyramid;
+    } else if (!std::ifstream(file.c_str()) && !createMandelbrotPyramid(file, 8192)) {
+        return 1;
+    }
+
+    Canvas c(-1, -1, w, h, "Tiled Image (scroll to zoom, arrows to pan)");
+    TiledImage image(0, 0, 0, file, std::min(w, h), std::min(w, h), 0, 0, 0);
+    std::cout << image.getPixelWidth() << " x " << image.getPixelHeight() << " pixels, "
+              << image.getLevels() << " levels" << std::endl;
+    c.add(&image);
+    c.start();
+    tiledImageFunction(c, image);
+    c.wait();
+}
@@ -0,0 +1,64 @@
+/*
+ * testUpdate.cpp
+ *
+ * Usage: ./testUpdate <width> <height> <numThreads>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Inverts a checkerboard every frame from several threads, without the Canvas ever showing it half done.
+ * \details
+ * - Fill the Canvas with a checkerboard of Squares, split into one band of rows per thread.
+ * - Each frame, begin an Update, have \b threads std::threads each invert the colors of their band, and commit
+ *   the Update once they have all finished.
+ * - Since the Canvas does not draw while the Update is open, every frame shows a whole checkerboard, never
+ *   one with some bands inverted and others not.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param threads The number of threads to update the checkerboard with.
+ */
+void updateFunction(Canvas& can, int threads) {
+    const int CELLS = 32;
+    const float SIDE = (float) std::min(can.getWindowWidth(), can.getWindowHeight()) / CELLS;
+    std::vector<Square*> squares;
+    for (int row = 0; row < CELLS; ++row)
+        for (int col = 0; col < CELLS; ++col) {
+            squares.push_back(new Square((col - CELLS/2 + 0.5f) * SIDE, (row - CELLS/2 + 0.5f) * SIDE, 0, SIDE,
+                                         0, 0, 0, ((row + col) % 2) ? WHITE : BLACK));
+            can.add(squares.back());
+        }
+
+    bool inverted = false;
+    while (can.isOpen()) {
+        can.sleep();
+        inverted = !inverted;
+        Canvas::Update update = can.beginUpdate();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.push_back(std::thread([&, t]() {
+                for (int row = t * CELLS / threads; row < (t + 1) * CELLS / threads; ++row)
+                    for (int col = 0; col < CELLS; ++col)
+                        squares[row * CELLS + col]->setColor((((row + col) % 2) != inverted) ? WHITE : BLACK);
+            }));
+        }
+        for (unsigned i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        update.commit();
+    }
+}
+
+//Takes command-line arguments for the width and height of the window, and the number of threads
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    int t = (argc > 3) ? atoi(argv[3]) : omp_get_num_procs();
+    if (t <= 0)
+      t = 4;
+    Canvas c(-1, -1, w, h, "Frame Updates");
+    c.run(updateFunction, t);
+}
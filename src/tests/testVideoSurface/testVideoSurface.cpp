@@ -0,0 +1,97 @@
+/*
+ * testVideoSurface.cpp
+ *
+ * Usage: ./testVideoSurface <width> <height> <.y4m file or directory of images>
+ */
+
+#include <tsgl.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace tsgl;
+
+// Writes a looping plasma animation as a raw file of RGBA8 frames
+static bool createPlasmaVideo(const std::string& filename, int w, int h, int frames) {
+    FILE * file = fopen(filename.c_str(), "wb");
+    if (!file)
+        return false;
+    std::cout << "Writing " << frames << " frames to " << filename << "..." << std::endl;
+    std::vector<uint8_t> frame((size_t) w * h * 4);
+    for (int f = 0; f < frames; ++f) {
+        const float t = 6.2831853f * f / frames;
+        #pragma omp parallel for
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                const float v = sin(x * 0.03f + t) + sin(y * 0.04f - t) + sin((x + y) * 0.02f + 2 * t);
+                uint8_t * p = &frame[((size_t) y * w + x) * 4];
+                p[0] = 128 + 127 * sin(v * 1.5f);
+                p[1] = 128 + 127 * sin(v * 1.5f + 2.0f);
+                p[2] = 128 + 127 * sin(v * 1.5f + 4.0f);
+                p[3] = 255;
+            }
+        }
+        fwrite(&frame[0], 1, frame.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+/*!
+ * \brief Plays a video on a VideoSurface.
+ * \details
+ * - Start the video looping, timed against the Canvas' clock.
+ * - Bind the space bar to pause and resume playback, and the left and right arrow keys to jump back or
+ *   forward a second.
+ * - While the Canvas is open, sleep the internal timer. Nothing else needs to be done each frame: the
+ *   VideoSurface picks the frame that is due and uploads it from its read-ahead buffers when it is drawn.
+ * - Report the number of frames that could not be shown in time when the window closes.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param video Reference to the VideoSurface.
+ */
+void videoSurfaceFunction(Canvas& can, VideoSurface& video) {
+    can.bindToButton(TSGL_SPACE, TSGL_PRESS, [&]() {
+        if (video.isPlaying())
+            video.pause();
+        else
+            video.play(can);
+    });
+    can.bindToButton(TSGL_LEFT, TSGL_PRESS, [&]() {
+        video.seek(std::max(0, video.getFrame() - (int) video.getFrameRate()));
+    });
+    can.bindToButton(TSGL_RIGHT, TSGL_PRESS, [&]() {
+        video.seek(std::min(video.getFrameCount() - 1, video.getFrame() + (int) video.getFrameRate()));
+    });
+
+    video.setLooping(true);
+    video.play(can);
+    while (can.isOpen())
+        can.sleep();
+    std::cout << video.getDroppedFrames() << " frames dropped" << std::endl;
+}
+
+//Takes command-line arguments for the width and height of the window, and the video to play
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+
+    // Play the given video, or a plasma animation generated the first time the test is run
+    VideoSurface * video;
+    if (argc > 3) {
+        video = new VideoSurface(0, 0, 0, argv[3], w, h, 0, 0, 0);
+    } else {
+        const int VW = 480, VH = 480, FRAMES = 240;
+        const std::string file = "plasma.rgba";
+        if (!std::ifstream(file.c_str()) && !createPlasmaVideo(file, VW, VH, FRAMES))
+            return 1;
+        video = VideoSurface::openRaw(0, 0, 0, file, VW, VH, 60, w, h, 0, 0, 0);
+    }
+
+    Canvas c(-1, -1, w, h, "Video Surface (space to pause, arrows to seek)");
+    c.add(video);
+    c.start();
+    videoSurfaceFunction(c, *video);
+    c.wait();
+    delete video;
+}
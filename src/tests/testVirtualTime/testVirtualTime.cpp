@@ -0,0 +1,70 @@
+/*
+ * testVirtualTime.cpp
+ *
+ * Usage: ./testVirtualTime <width> <height> <numFramesToRecord>
+ */
+
+#include <tsgl.h>
+
+using namespace tsgl;
+
+/*!
+ * \brief Bounces balls under gravity, one fixed step per frame, optionally recording the result to disk.
+ * \details
+ * - Put the Canvas on virtual time, so that each call to sleep() is exactly one frame of simulated time,
+ *   however long the frame really took.
+ * - Each frame, advance every ball by one step of <code>dt</code> seconds, bouncing it off the walls.
+ * - If \b frames is positive, record that many frames to Image000000.png and on. On virtual time the
+ *   recording runs as fast as the machine can draw and save the frames, and the same run always produces
+ *   the same images.
+ * .
+ * \param can Reference to the Canvas being drawn to.
+ * \param frames The number of frames to record, or 0 to just watch.
+ */
+void virtualTimeFunction(Canvas& can, int frames) {
+    const int BALLS = 64;
+    const float RADIUS = 12, GRAVITY = -600;
+    const float dt = 1.0f / FPS;
+    const float W = can.getWindowWidth() / 2 - RADIUS, H = can.getWindowHeight() / 2 - RADIUS;
+    std::vector<Circle*> balls;
+    std::vector<float> x(BALLS), y(BALLS), vx(BALLS), vy(BALLS);
+    for (int i = 0; i < BALLS; ++i) {
+        x[i] = -W + 2 * W * i / BALLS;
+        y[i] = H * (0.2f + 0.8f * ((i * 37) % BALLS) / BALLS);
+        vx[i] = 40.0f * ((i * 13) % 11 - 5);
+        vy[i] = 0;
+        balls.push_back(new Circle(x[i], y[i], 0, RADIUS, 0, 0, 0, Colors::highContrastColor(i)));
+        can.add(balls.back());
+    }
+
+    can.setVirtualTime(true);
+    if (frames > 0)
+        can.recordForNumFrames(frames);
+    while (can.isOpen()) {
+        can.sleep();
+        for (int i = 0; i < BALLS; ++i) {
+            vy[i] += GRAVITY * dt;
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            if (fabs(x[i]) > W) { x[i] = (x[i] > 0) ? W : -W; vx[i] = -vx[i]; }
+            if (y[i] < -H)      { y[i] = -H; vy[i] = -0.9f * vy[i]; }
+            balls[i]->setCenter(x[i], y[i], 0);
+        }
+        if (frames > 0 && can.getFrameNumber() > frames) {
+            std::cout << frames << " frames (" << can.getTime() << " seconds of animation) recorded at "
+                      << can.getFPS() << " frames per second" << std::endl;
+            can.close();
+        }
+    }
+}
+
+//Takes command-line arguments for the width and height of the window, and the number of frames to record
+int main(int argc, char* argv[]) {
+    int w = (argc > 1) ? atoi(argv[1]) : 0.9*Canvas::getDisplayHeight();
+    int h = (argc > 2) ? atoi(argv[2]) : w;
+    if (w <= 0 || h <= 0)     //Checked the passed width and height if they are valid
+      w = h = 960;            //If not, set the width and height to a default value
+    int frames = (argc > 3) ? atoi(argv[3]) : 0;
+    Canvas c(-1, -1, w, h, "Virtual Time", BLACK);
+    c.run(virtualTimeFunction, frames);
+}
@@ -13,9 +13,22 @@
 #include <TSGL/CartesianCanvas.h>
 #include <TSGL/Color.h>
 #include <TSGL/Error.h>
+#include <TSGL/ImageLoader.h>
+#include <TSGL/ImageOps.h>
+#include <TSGL/InputQueue.h>
 #include <TSGL/IntegralViewer.h>
 #include <TSGL/Keynums.h>
+#include <TSGL/MappedFile.h>
+#include <TSGL/PostEffects.h>
+#include <TSGL/ProfiledMutex.h>
+#include <TSGL/Random.h>
+#include <TSGL/RenderService.h>
+#include <TSGL/ShaderBackground.h>
+#include <TSGL/ShaderCache.h>
+#include <TSGL/SpatialGrid.h>
 #include <TSGL/Spectrogram.h>
+#include <TSGL/ThreadPool.h>
+#include <TSGL/ThreadTimeline.h>
 #include <TSGL/Timer.h>
 #include <TSGL/Util.h>
 #include <TSGL/VisualTaskQueue.h>